@@ -0,0 +1,898 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+/* This program measures the performance of isl on a collection of inputs.
+ *
+ * Each input file is handled in the same way as by the corresponding
+ * command-line tool, depending on its extension.
+ *	.st, .in	isl_codegen
+ *	.ai		isl_flow
+ *	.sc		isl_schedule
+ *	.pip		isl_pip
+ * Additionally, synthetic inputs of increasing size can be generated
+ * for each of these categories.
+ *
+ * Each input is handled a given number of times and for each input
+ * a line is printed with the minimal and median wall clock time,
+ * the peak memory use, the number of operations (as counted by
+ * isl_ctx_next_operation) and the number of tableau pivots.
+ * If the platform supports it, each run is performed in a separate
+ * process such that runs do not affect each other and
+ * such that the peak memory use can be measured for each run separately.
+ *
+ * In --compare mode, the program instead reads the output of two
+ * earlier runs and reports the inputs for which the median time or
+ * the number of operations increased by more than a given threshold.
+ */
+
+#include <isl_config.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+#if defined(HAVE_SYS_WAIT_H) && defined(HAVE_UNISTD_H)
+#include <unistd.h>
+#include <sys/wait.h>
+#define BENCH_FORK
+#endif
+
+#include <isl_ctx_private.h>
+#include <isl_map_private.h>
+#include "isl/arg.h"
+#include "isl/options.h"
+#include "isl/ast_build.h"
+#include "isl/flow.h"
+#include "isl/schedule.h"
+#include "isl/set.h"
+#include "isl/stream.h"
+#include "isl/union_map.h"
+#include "isl/val.h"
+
+struct options {
+	struct isl_options	*isl;
+	int			 repeat;
+	int			 synthetic;
+	unsigned		 compare;
+	int			 threshold;
+};
+
+ISL_ARGS_START(struct options, options_args)
+ISL_ARG_CHILD(struct options, isl, "isl", &isl_options_args, "isl options")
+ISL_ARG_INT(struct options, repeat, 'r', "repeat", "n", 3,
+	"number of times each input is handled")
+ISL_ARG_INT(struct options, synthetic, 0, "synthetic", "n", 0,
+	"also handle synthetic inputs of sizes 1 to n in each category")
+ISL_ARG_BOOL(struct options, compare, 0, "compare", 0,
+	"compare the results of two earlier runs")
+ISL_ARG_INT(struct options, threshold, 0, "threshold", "percent", 10,
+	"minimal increase that is reported as a regression")
+ISL_ARGS_END
+
+ISL_ARG_DEF(options, struct options, options_args)
+
+/* Construct an AST from the schedule map, context and options in "s",
+ * as in isl_codegen.
+ */
+static __isl_give isl_ast_node *codegen_from_union_map(
+	__isl_take isl_union_map *schedule, __isl_keep isl_stream *s)
+{
+	isl_set *context;
+	isl_union_map *options;
+	isl_ast_build *build;
+	isl_ast_node *tree;
+
+	context = isl_stream_read_set(s);
+	options = isl_stream_read_union_map(s);
+
+	build = isl_ast_build_from_context(context);
+	build = isl_ast_build_set_options(build, options);
+	tree = isl_ast_build_node_from_schedule_map(build, schedule);
+	isl_ast_build_free(build);
+
+	return tree;
+}
+
+/* Generate and print an AST for the input in "s", as in isl_codegen.
+ */
+static isl_stat run_codegen(__isl_keep isl_stream *s)
+{
+	isl_ctx *ctx = isl_stream_get_ctx(s);
+	struct isl_obj obj;
+	isl_ast_node *tree;
+	char *str;
+	isl_stat r;
+
+	obj = isl_stream_read_obj(s);
+	if (!obj.v)
+		return isl_stat_error;
+	if (obj.type == isl_obj_map) {
+		isl_union_map *umap = isl_union_map_from_map(obj.v);
+		tree = codegen_from_union_map(umap, s);
+	} else if (obj.type == isl_obj_union_map) {
+		tree = codegen_from_union_map(obj.v, s);
+	} else if (obj.type == isl_obj_schedule) {
+		isl_ast_build *build = isl_ast_build_alloc(ctx);
+		tree = isl_ast_build_node_from_schedule(build, obj.v);
+		isl_ast_build_free(build);
+	} else {
+		obj.type->free(obj.v);
+		isl_die(ctx, isl_error_invalid, "unknown input",
+			return isl_stat_error);
+	}
+
+	str = isl_ast_node_to_C_str(tree);
+	isl_ast_node_free(tree);
+	r = str ? isl_stat_ok : isl_stat_error;
+	free(str);
+
+	return r;
+}
+
+/* Compute and print the dependences for the input in "s",
+ * as in isl_flow.
+ */
+static isl_stat run_flow(__isl_keep isl_stream *s)
+{
+	isl_union_access_info *access;
+	isl_union_flow *flow;
+	char *str;
+	isl_stat r;
+
+	access = isl_stream_read_union_access_info(s);
+	flow = isl_union_access_info_compute_flow(access);
+	str = isl_union_flow_to_str(flow);
+	isl_union_flow_free(flow);
+	r = str ? isl_stat_ok : isl_stat_error;
+	free(str);
+
+	return r;
+}
+
+/* Compute and print a schedule for the input in "s",
+ * as in isl_schedule.
+ */
+static isl_stat run_schedule(__isl_keep isl_stream *s)
+{
+	isl_schedule_constraints *sc;
+	isl_schedule *schedule;
+	char *str;
+	isl_stat r;
+
+	sc = isl_stream_read_schedule_constraints(s);
+	schedule = isl_schedule_constraints_compute_schedule(sc);
+	str = isl_schedule_to_str(schedule);
+	isl_schedule_free(schedule);
+	r = str ? isl_stat_ok : isl_stat_error;
+	free(str);
+
+	return r;
+}
+
+/* Solve the parametric integer programming problem in "s",
+ * as in isl_pip with the default options.
+ * That is, read the context constraints, the big parameter column,
+ * the problem constraints and the optional keywords,
+ * interpret the dimensions of the context as parameters,
+ * reinterpret the last dimensions of the problem as parameters
+ * if they are not already parameters and compute the lexicographic minimum or maximum.
+ */
+static isl_stat run_pip(__isl_keep isl_stream *s)
+{
+	isl_ctx *ctx = isl_stream_get_ctx(s);
+	isl_basic_set *context, *bset;
+	isl_set *set, *empty;
+	isl_val *v;
+	struct isl_token *tok;
+	isl_size dim, nparam, nparam_bset;
+	int max = 0, urs_parms = 0, urs_unknowns = 0;
+	char *str;
+	isl_stat r;
+
+	context = isl_stream_read_basic_set(s);
+	v = isl_stream_read_val(s);
+	isl_val_free(v);
+	bset = isl_stream_read_basic_set(s);
+	while ((tok = isl_stream_next_token(s)) != NULL) {
+		str = NULL;
+		if (isl_token_has_str(tok))
+			str = isl_token_get_str(ctx, tok);
+		isl_token_free(tok);
+		if (!str)
+			continue;
+		if (strncasecmp(str, "Maximize", 8) == 0)
+			max = 1;
+		if (strncasecmp(str, "Rational", 8) == 0)
+			bset = isl_basic_set_set_rational(bset);
+		if (strncasecmp(str, "Urs_parms", 9) == 0)
+			urs_parms = 1;
+		if (strncasecmp(str, "Urs_unknowns", 12) == 0)
+			urs_unknowns = 1;
+		free(str);
+	}
+
+	if (!urs_parms)
+		context = isl_basic_set_intersect(context,
+		isl_basic_set_positive_orthant(isl_basic_set_get_space(context)));
+	dim = isl_basic_set_dim(context, isl_dim_set);
+	if (dim < 0)
+		context = isl_basic_set_free(context);
+	else
+		context = isl_basic_set_move_dims(context, isl_dim_param, 0,
+						    isl_dim_set, 0, dim);
+	context = isl_basic_set_params(context);
+	nparam = isl_basic_set_dim(context, isl_dim_param);
+	nparam_bset = isl_basic_set_dim(bset, isl_dim_param);
+	dim = isl_basic_set_dim(bset, isl_dim_set);
+	if (nparam < 0 || nparam_bset < 0 || dim < 0)
+		bset = isl_basic_set_free(bset);
+	else if (nparam != nparam_bset)
+		bset = isl_basic_set_move_dims(bset, isl_dim_param, 0,
+					    isl_dim_set, dim - nparam, nparam);
+	if (!urs_unknowns)
+		bset = isl_basic_set_intersect(bset,
+		isl_basic_set_positive_orthant(isl_basic_set_get_space(bset)));
+
+	if (max)
+		set = isl_basic_set_partial_lexmax(bset, context, &empty);
+	else
+		set = isl_basic_set_partial_lexmin(bset, context, &empty);
+
+	str = isl_set_to_str(set);
+	isl_set_free(set);
+	isl_set_free(empty);
+	r = str ? isl_stat_ok : isl_stat_error;
+	free(str);
+
+	return r;
+}
+
+/* A category of inputs.
+ * "name" is the name of the category.
+ * "suffix" is the list of file name extensions of inputs in the category.
+ * "run" handles a single input.
+ * "generate" generates a synthetic input of a given size.
+ */
+struct bench_kind {
+	const char *name;
+	const char *suffix[3];
+	isl_stat (*run)(__isl_keep isl_stream *s);
+	isl_stat (*generate)(isl_printer **p, int n);
+};
+
+/* Generate a schedule map for an "n"-dimensional loop nest
+ * with two statements that is tiled with tiles of size 16,
+ * along with a context and options for isl_codegen.
+ */
+static isl_stat generate_codegen(isl_printer **p, int n)
+{
+	const char *name[] = { "S", "T" };
+	int i, k;
+
+	*p = isl_printer_print_str(*p, "[N] -> {");
+	for (k = 0; k < 2; ++k) {
+		if (k)
+			*p = isl_printer_print_str(*p, ";");
+		*p = isl_printer_print_str(*p, " ");
+		*p = isl_printer_print_str(*p, name[k]);
+		*p = isl_printer_print_str(*p, "[");
+		for (i = 0; i < n; ++i) {
+			*p = isl_printer_print_str(*p, i ? ", i" : "i");
+			*p = isl_printer_print_int(*p, i);
+		}
+		*p = isl_printer_print_str(*p, "] -> [");
+		for (i = 0; i < 2 * n; ++i) {
+			*p = isl_printer_print_str(*p, i ? ", " : "");
+			*p = isl_printer_print_str(*p,
+					    i < n ? "floor(i" : "i");
+			*p = isl_printer_print_int(*p, i % n);
+			if (i < n)
+				*p = isl_printer_print_str(*p, "/16)");
+		}
+		*p = isl_printer_print_str(*p, k ? ", 1]" : ", 0]");
+		for (i = 0; i < n; ++i) {
+			*p = isl_printer_print_str(*p, i ? " and " : " : ");
+			*p = isl_printer_print_str(*p, k && i ? "i" : "0");
+			if (k && i)
+				*p = isl_printer_print_int(*p, i - 1);
+			*p = isl_printer_print_str(*p, " <= i");
+			*p = isl_printer_print_int(*p, i);
+			*p = isl_printer_print_str(*p, " < N");
+		}
+	}
+	*p = isl_printer_print_str(*p, " }\n[N] -> { : N >= 0 }\n{ }\n");
+
+	return *p ? isl_stat_ok : isl_stat_error;
+}
+
+/* Generate the accesses of a chain of "n" + 1 statements
+ * inside a single loop for isl_flow.
+ * Statement k writes A<k>[i] and statement k + 1 reads A<k>[i - 1].
+ */
+static isl_stat generate_flow(isl_printer **p, int n)
+{
+	int k;
+
+	*p = isl_printer_print_str(*p, "sink: [N] -> {");
+	for (k = 0; k < n; ++k) {
+		*p = isl_printer_print_str(*p, k ? "; S" : " S");
+		*p = isl_printer_print_int(*p, k + 1);
+		*p = isl_printer_print_str(*p, "[i] -> A");
+		*p = isl_printer_print_int(*p, k);
+		*p = isl_printer_print_str(*p, "[i - 1] : 1 <= i < N");
+	}
+	*p = isl_printer_print_str(*p, " }\nmust_source: [N] -> {");
+	for (k = 0; k <= n; ++k) {
+		*p = isl_printer_print_str(*p, k ? "; S" : " S");
+		*p = isl_printer_print_int(*p, k);
+		*p = isl_printer_print_str(*p, "[i] -> A");
+		*p = isl_printer_print_int(*p, k);
+		*p = isl_printer_print_str(*p, "[i] : 0 <= i < N");
+	}
+	*p = isl_printer_print_str(*p, " }\nschedule_map: {");
+	for (k = 0; k <= n; ++k) {
+		*p = isl_printer_print_str(*p, k ? "; S" : " S");
+		*p = isl_printer_print_int(*p, k);
+		*p = isl_printer_print_str(*p, "[i] -> [i, ");
+		*p = isl_printer_print_int(*p, k);
+		*p = isl_printer_print_str(*p, "]");
+	}
+	*p = isl_printer_print_str(*p, " }\n");
+
+	return *p ? isl_stat_ok : isl_stat_error;
+}
+
+/* Generate schedule constraints for a sequence of "n" + 1
+ * three-point stencil statements inside a time loop for isl_schedule.
+ * Statement k + 1 depends on the neighbors of the element
+ * computed by statement k and statement 0 depends on
+ * the neighbors of the element computed by statement n
+ * in the previous time step.
+ */
+static isl_stat generate_schedule(isl_printer **p, int n)
+{
+	int k, d;
+
+	*p = isl_printer_print_str(*p, "domain: \"[T, N] -> {");
+	for (k = 0; k <= n; ++k) {
+		*p = isl_printer_print_str(*p, k ? "; S" : " S");
+		*p = isl_printer_print_int(*p, k);
+		*p = isl_printer_print_str(*p,
+				"[t, i] : 0 <= t < T and 1 <= i < N - 1");
+	}
+	*p = isl_printer_print_str(*p, " }\"\nvalidity: \"{");
+	for (k = 0; k <= n; ++k) {
+		for (d = -1; d <= 1; ++d) {
+			*p = isl_printer_print_str(*p,
+					    k || d != -1 ? "; S" : " S");
+			*p = isl_printer_print_int(*p, k);
+			*p = isl_printer_print_str(*p, "[t, i] -> S");
+			*p = isl_printer_print_int(*p, k < n ? k + 1 : 0);
+			*p = isl_printer_print_str(*p,
+					    k < n ? "[t, i + " : "[t + 1, i + ");
+			*p = isl_printer_print_int(*p, d);
+			*p = isl_printer_print_str(*p, "]");
+		}
+	}
+	*p = isl_printer_print_str(*p, " }\"\nproximity: \"{");
+	for (k = 0; k <= n; ++k) {
+		*p = isl_printer_print_str(*p, k ? "; S" : " S");
+		*p = isl_printer_print_int(*p, k);
+		*p = isl_printer_print_str(*p, "[t, i] -> S");
+		*p = isl_printer_print_int(*p, k < n ? k + 1 : 0);
+		*p = isl_printer_print_str(*p, k < n ? "[t, i]" : "[t + 1, i]");
+	}
+	*p = isl_printer_print_str(*p, " }\"\n");
+
+	return *p ? isl_stat_ok : isl_stat_error;
+}
+
+/* Print a row of a PolyLib constraint matrix with "n" columns,
+ * with the given type (1 for an inequality), coefficients at
+ * positions "pos1" and "pos2" (if not negative) and constant "cst".
+ */
+static void print_polylib_row(isl_printer **p, int n, int pos1, int c1,
+	int pos2, int c2, int cst)
+{
+	int i;
+
+	*p = isl_printer_print_int(*p, 1);
+	for (i = 0; i < n; ++i) {
+		*p = isl_printer_print_str(*p, " ");
+		*p = isl_printer_print_int(*p,
+				    i == pos1 ? c1 : i == pos2 ? c2 : 0);
+	}
+	*p = isl_printer_print_str(*p, " ");
+	*p = isl_printer_print_int(*p, cst);
+	*p = isl_printer_print_str(*p, "\n");
+}
+
+/* Generate a parametric integer programming problem in "n" + 1
+ * unknowns x_i for isl_pip.
+ * The unknowns are bounded by the single parameter p,
+ * consecutive unknowns differ by at most 2 and
+ * their weighted sum is at least p.
+ */
+static isl_stat generate_pip(isl_printer **p, int n)
+{
+	int i;
+	int n_var = n + 1;
+	int n_col = n_var + 1;
+
+	*p = isl_printer_print_str(*p, "1 3\n1 1 0\n\n-1\n\n");
+	*p = isl_printer_print_int(*p, 2 * n_var + 2 * n + 1);
+	*p = isl_printer_print_str(*p, " ");
+	*p = isl_printer_print_int(*p, n_col + 2);
+	*p = isl_printer_print_str(*p, "\n");
+	for (i = 0; i < n_var; ++i) {
+		print_polylib_row(p, n_col, i, 1, -1, 0, 0);
+		print_polylib_row(p, n_col, i, -1, n_var, 1, 0);
+	}
+	for (i = 0; i < n; ++i) {
+		print_polylib_row(p, n_col, i, 1, i + 1, -1, 2);
+		print_polylib_row(p, n_col, i, -1, i + 1, 1, 2);
+	}
+	*p = isl_printer_print_int(*p, 1);
+	for (i = 0; i < n_var; ++i) {
+		*p = isl_printer_print_str(*p, " ");
+		*p = isl_printer_print_int(*p, i + 1);
+	}
+	*p = isl_printer_print_str(*p, " -1 0\n");
+
+	return *p ? isl_stat_ok : isl_stat_error;
+}
+
+static struct bench_kind kinds[] = {
+	{ "codegen", { ".st", ".in", NULL }, &run_codegen, &generate_codegen },
+	{ "flow", { ".ai", NULL }, &run_flow, &generate_flow },
+	{ "schedule", { ".sc", NULL }, &run_schedule, &generate_schedule },
+	{ "pip", { ".pip", NULL }, &run_pip, &generate_pip },
+};
+
+/* Return the category of inputs with a file name ending in the extension
+ * of "name", or NULL if there is no such category.
+ */
+static struct bench_kind *find_kind(const char *name)
+{
+	int i, j;
+	size_t len = strlen(name);
+
+	for (i = 0; i < sizeof(kinds) / sizeof(kinds[0]); ++i) {
+		for (j = 0; kinds[i].suffix[j]; ++j) {
+			size_t n = strlen(kinds[i].suffix[j]);
+			if (len > n &&
+			    strcmp(name + len - n, kinds[i].suffix[j]) == 0)
+				return &kinds[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* The results of a single run.
+ * "ok" is set if the input was handled successfully.
+ * "time" is the wall clock time in seconds.
+ * "max_rss" is the peak resident set size in kilobytes,
+ * or -1 if it is not available.
+ */
+struct bench_sample {
+	int		ok;
+	double		time;
+	long		max_rss;
+	unsigned long	operations;
+	long		pivots;
+};
+
+/* Return the current wall clock time in seconds.
+ */
+static double now(void)
+{
+#ifdef HAVE_SYS_TIME_H
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Return the peak resident set size of the current process in kilobytes,
+ * or -1 if it is not available.
+ */
+static long max_rss(void)
+{
+#ifdef HAVE_SYS_RESOURCE_H
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return usage.ru_maxrss;
+#endif
+	return -1;
+}
+
+/* Handle the input in "data" of length "len" once using "kind"
+ * and store the results in "sample".
+ */
+static void run_once(isl_ctx *ctx, struct bench_kind *kind,
+	const char *data, size_t len, struct bench_sample *sample)
+{
+	isl_stream *s;
+	isl_stat r = isl_stat_error;
+	double start;
+
+	isl_ctx_reset_error(ctx);
+	isl_ctx_reset_operations(ctx);
+	ctx->stats->tab_pivots = 0;
+
+	start = now();
+	s = isl_stream_new_buffer(ctx, data, len);
+	if (s)
+		r = kind->run(s);
+	isl_stream_free(s);
+	sample->time = now() - start;
+
+	sample->ok = r >= 0 && isl_ctx_last_error(ctx) == isl_error_none;
+	sample->operations = ctx->operations;
+	sample->pivots = ctx->stats->tab_pivots;
+	sample->max_rss = max_rss();
+}
+
+/* Handle the input in "data" of length "len" once using "kind"
+ * and store the results in "sample".
+ * If possible, the input is handled in a child process
+ * such that any state left behind in "ctx" (e.g., in caches)
+ * does not affect later runs and such that the peak memory use
+ * only reflects this run.
+ * A child process that does not report back (e.g., because it crashed)
+ * is treated as a failed run.
+ */
+static void measure(isl_ctx *ctx, struct bench_kind *kind,
+	const char *data, size_t len, struct bench_sample *sample)
+{
+#ifdef BENCH_FORK
+	int fd[2];
+	pid_t pid;
+	ssize_t n;
+
+	fflush(stdout);
+	if (pipe(fd) == 0 && (pid = fork()) >= 0) {
+		if (pid == 0) {
+			close(fd[0]);
+			run_once(ctx, kind, data, len, sample);
+			n = write(fd[1], sample, sizeof(*sample));
+			_exit(n == sizeof(*sample) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		close(fd[1]);
+		n = read(fd[0], sample, sizeof(*sample));
+		close(fd[0]);
+		waitpid(pid, NULL, 0);
+		if (n != sizeof(*sample))
+			memset(sample, 0, sizeof(*sample));
+		return;
+	}
+#endif
+	run_once(ctx, kind, data, len, sample);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *) a;
+	double y = *(const double *) b;
+
+	return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void print_header(void)
+{
+	printf("# input\tcategory\tstatus\truns\tmin_time\tmedian_time"
+		"\tmax_rss_kb\toperations\tpivots\n");
+}
+
+/* Handle the input called "name" in "data" of length "len"
+ * "repeat" times using "kind" and print a line with the results.
+ * The number of operations and pivots are reported for the first run.
+ * Return -1 if any of the runs failed.
+ */
+static int bench_input(isl_ctx *ctx, const char *name, struct bench_kind *kind,
+	const char *data, size_t len, int repeat)
+{
+	struct bench_sample first = { 0 }, sample;
+	double *times;
+	long rss = -1;
+	int i, ok = 1;
+
+	times = isl_alloc_array(ctx, double, repeat);
+	if (!times)
+		return -1;
+	for (i = 0; i < repeat; ++i) {
+		measure(ctx, kind, data, len, &sample);
+		if (i == 0)
+			first = sample;
+		if (!sample.ok)
+			ok = 0;
+		if (sample.max_rss > rss)
+			rss = sample.max_rss;
+		times[i] = sample.time;
+	}
+	qsort(times, repeat, sizeof(double), &cmp_double);
+	printf("%s\t%s\t%s\t%d\t%.6f\t%.6f\t%ld\t%lu\t%ld\n", name, kind->name,
+		ok ? "ok" : "error", repeat, times[0], times[repeat / 2],
+		rss, first.operations, first.pivots);
+	fflush(stdout);
+	free(times);
+
+	return ok ? 0 : -1;
+}
+
+/* Read the entire contents of the file called "name".
+ * The caller is responsible for freeing the result.
+ */
+static char *read_file(isl_ctx *ctx, const char *name, size_t *len)
+{
+	FILE *file;
+	char *data = NULL;
+	size_t size = 0, n;
+
+	*len = 0;
+	file = fopen(name, "rb");
+	if (!file)
+		isl_die(ctx, isl_error_invalid, "unable to open input",
+			return NULL);
+	do {
+		char *grown;
+
+		size = size ? 2 * size : 4096;
+		grown = isl_realloc_array(ctx, data, char, size);
+		if (!grown) {
+			free(data);
+			fclose(file);
+			return NULL;
+		}
+		data = grown;
+		n = fread(data + *len, 1, size - *len, file);
+		*len += n;
+	} while (*len == size);
+	fclose(file);
+
+	return data;
+}
+
+/* Benchmark the input in the file called "name".
+ */
+static int bench_file(isl_ctx *ctx, const char *name, int repeat)
+{
+	struct bench_kind *kind;
+	char *data;
+	size_t len;
+	int r;
+
+	kind = find_kind(name);
+	if (!kind)
+		isl_die(ctx, isl_error_invalid, "unknown input type",
+			return -1);
+	data = read_file(ctx, name, &len);
+	if (!data)
+		return -1;
+	r = bench_input(ctx, name, kind, data, len, repeat);
+	free(data);
+
+	return r;
+}
+
+/* Benchmark synthetic inputs of sizes 1 to "n" in each category.
+ */
+static int bench_synthetic(isl_ctx *ctx, int n, int repeat)
+{
+	int i, k;
+	int r = 0;
+
+	for (k = 0; k < sizeof(kinds) / sizeof(kinds[0]); ++k) {
+		for (i = 1; i <= n; ++i) {
+			isl_printer *p;
+			char *data;
+			char name[64];
+
+			p = isl_printer_to_str(ctx);
+			if (kinds[k].generate(&p, i) < 0) {
+				isl_printer_free(p);
+				return -1;
+			}
+			data = isl_printer_get_str(p);
+			isl_printer_free(p);
+			if (!data)
+				return -1;
+			snprintf(name, sizeof(name), "synthetic/%s-%d",
+				kinds[k].name, i);
+			if (bench_input(ctx, name, &kinds[k],
+					data, strlen(data), repeat) < 0)
+				r = -1;
+			free(data);
+		}
+	}
+
+	return r;
+}
+
+/* The results for a single input as read back from an earlier run.
+ */
+struct bench_record {
+	char		*name;
+	double		 time;
+	unsigned long	 operations;
+};
+
+/* Read the results of an earlier run from the file called "name".
+ * Lines starting with '#' are ignored.
+ * Return the number of records stored in *records or -1 on error.
+ */
+static int read_records(isl_ctx *ctx, const char *name,
+	struct bench_record **records)
+{
+	char *data, *line, *next;
+	size_t len;
+	int n = 0, size = 0;
+
+	*records = NULL;
+	data = read_file(ctx, name, &len);
+	if (!data)
+		return -1;
+	data[len > 0 && data[len - 1] == '\n' ? len - 1 : len] = '\0';
+	for (line = data; line; line = next) {
+		char *field[9];
+		int i;
+
+		next = strchr(line, '\n');
+		if (next)
+			*next++ = '\0';
+		if (line[0] == '#' || line[0] == '\0')
+			continue;
+		for (i = 0; i < 9 && line; ++i) {
+			field[i] = line;
+			line = strchr(line, '\t');
+			if (line)
+				*line++ = '\0';
+		}
+		if (i < 9)
+			continue;
+		if (n >= size) {
+			struct bench_record *grown;
+			size = size ? 2 * size : 64;
+			grown = isl_realloc_array(ctx, *records,
+						struct bench_record, size);
+			if (!grown)
+				break;
+			*records = grown;
+		}
+		(*records)[n].name = strdup(field[0]);
+		(*records)[n].time = strtod(field[5], NULL);
+		(*records)[n].operations = strtoul(field[7], NULL, 10);
+		n++;
+	}
+	free(data);
+
+	return n;
+}
+
+static void free_records(struct bench_record *records, int n)
+{
+	int i;
+
+	for (i = 0; i < n; ++i)
+		free(records[i].name);
+	free(records);
+}
+
+/* Return the relative increase in percent from "old" to "new".
+ */
+static double increase(double old, double new)
+{
+	if (old <= 0)
+		return new > 0 ? 100 : 0;
+	return 100 * (new - old) / old;
+}
+
+/* Compare the results of the runs in the files "old_name" and "new_name".
+ * An input is flagged as a regression if its median time increased
+ * by more than "threshold" percent (and by more than a millisecond
+ * in order to ignore noise on very short runs) or
+ * if its number of operations increased by more than "threshold" percent.
+ * Return -1 if any regressions were found.
+ */
+static int compare(isl_ctx *ctx, const char *old_name, const char *new_name,
+	int threshold)
+{
+	struct bench_record *old, *new;
+	int n_old, n_new;
+	int i, j, n_regression = 0;
+
+	n_old = read_records(ctx, old_name, &old);
+	n_new = read_records(ctx, new_name, &new);
+	if (n_old < 0 || n_new < 0) {
+		free_records(old, n_old < 0 ? 0 : n_old);
+		free_records(new, n_new < 0 ? 0 : n_new);
+		return -1;
+	}
+
+	printf("# input\told_time\tnew_time\ttime_change\t"
+		"operations_change\tstatus\n");
+	for (i = 0; i < n_new; ++i) {
+		double dt, dop;
+		int regression;
+
+		for (j = 0; j < n_old; ++j)
+			if (strcmp(old[j].name, new[i].name) == 0)
+				break;
+		if (j >= n_old) {
+			printf("%s\t-\t%.6f\t-\t-\tnew\n",
+				new[i].name, new[i].time);
+			continue;
+		}
+		dt = increase(old[j].time, new[i].time);
+		dop = increase(old[j].operations, new[i].operations);
+		regression = (dt > threshold &&
+			      new[i].time - old[j].time > 1e-3) ||
+			     dop > threshold;
+		if (regression)
+			n_regression++;
+		printf("%s\t%.6f\t%.6f\t%+.1f%%\t%+.1f%%\t%s\n",
+			new[i].name, old[j].time, new[i].time, dt, dop,
+			regression ? "REGRESSION" : "ok");
+	}
+	printf("# %d regression(s)\n", n_regression);
+
+	free_records(old, n_old);
+	free_records(new, n_new);
+
+	return n_regression ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	isl_ctx *ctx;
+	struct options *options;
+	int i, r = 0;
+
+	options = options_new_with_defaults();
+	assert(options);
+	argc = options_parse(options, argc, argv, 0);
+	ctx = isl_ctx_alloc_with_options(&options_args, options);
+	isl_options_set_ast_build_detect_min_max(ctx, 1);
+
+	for (i = 1; i < argc; ++i)
+		if (argv[i][0] == '-')
+			isl_die(ctx, isl_error_invalid, "unrecognized option",
+				goto error);
+
+	if (options->compare) {
+		if (argc != 3)
+			isl_die(ctx, isl_error_invalid,
+				"expecting two result files", goto error);
+		r = compare(ctx, argv[1], argv[2], options->threshold);
+	} else {
+		if (options->repeat < 1)
+			isl_die(ctx, isl_error_invalid,
+				"expecting positive number of repetitions",
+				goto error);
+		print_header();
+		for (i = 1; i < argc; ++i)
+			if (bench_file(ctx, argv[i], options->repeat) < 0)
+				r = -1;
+		if (bench_synthetic(ctx, options->synthetic,
+				    options->repeat) < 0)
+			r = -1;
+	}
+
+	isl_ctx_free(ctx);
+	return r < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+error:
+	isl_ctx_free(ctx);
+	return EXIT_FAILURE;
+}
@@ -5,9 +5,11 @@
 #include <isl_scan.h>
 #include "isl/val.h"
 #include "isl/options.h"
+#include "server.h"
 
 struct bound_options {
 	struct isl_options	*isl;
+	struct server_options	*server;
 	unsigned		 verify;
 	int			 print_all;
 	int			 continue_on_error;
@@ -16,6 +18,8 @@ struct bound_options {
 ISL_ARGS_START(struct bound_options, bound_options_args)
 ISL_ARG_CHILD(struct bound_options, isl, "isl", &isl_options_args,
 	"isl options")
+ISL_ARG_CHILD(struct bound_options, server, "server", &server_options_args,
+	"server options")
 ISL_ARG_BOOL(struct bound_options, verify, 'T', "verify", 0, NULL)
 ISL_ARG_BOOL(struct bound_options, print_all, 'A', "print-all", 0, NULL)
 ISL_ARG_BOOL(struct bound_options, continue_on_error, '\0', "continue-on-error", 0, NULL)
@@ -235,24 +239,20 @@ static int check_solution(__isl_take isl_pw_qpolynomial_fold *pwf,
 	return 0;
 }
 
-int main(int argc, char **argv)
+/* Read a piecewise quasipolynomial (fold) from "s" and
+ * print an upper bound to "out" or, if requested,
+ * check the correctness of the bound.
+ */
+static isl_stat bound(__isl_keep isl_stream *s, FILE *out, void *user)
 {
+	struct bound_options *options = user;
 	isl_ctx *ctx;
 	isl_pw_qpolynomial_fold *copy;
 	isl_pw_qpolynomial_fold *pwf;
-	isl_stream *s;
 	struct isl_obj obj;
-	struct bound_options *options;
 	isl_bool exact;
-	int r = 0;
-
-	options = bound_options_new_with_defaults();
-	assert(options);
-	argc = bound_options_parse(options, argc, argv, ISL_ARG_ALL);
 
-	ctx = isl_ctx_alloc_with_options(&bound_options_args, options);
-
-	s = isl_stream_new_file(ctx, stdin);
+	ctx = isl_stream_get_ctx(s);
 	obj = isl_stream_read_obj(s);
 	if (obj.type == isl_obj_pw_qpolynomial)
 		pwf = isl_pw_qpolynomial_fold_from_pw_qpolynomial(isl_fold_max,
@@ -261,7 +261,8 @@ int main(int argc, char **argv)
 		pwf = obj.v;
 	else {
 		obj.type->free(obj.v);
-		isl_die(ctx, isl_error_invalid, "invalid input", goto error);
+		isl_die(ctx, isl_error_invalid, "invalid input",
+			return isl_stat_error);
 	}
 
 	if (options->verify)
@@ -270,19 +271,41 @@ int main(int argc, char **argv)
 	pwf = isl_pw_qpolynomial_fold_bound(pwf, &exact);
 	pwf = isl_pw_qpolynomial_fold_coalesce(pwf);
 
-	if (options->verify) {
-		r = check_solution(copy, pwf, exact, options);
+	if (options->verify)
+		return check_solution(copy, pwf, exact, options) < 0 ?
+			isl_stat_error : isl_stat_ok;
+
+	if (!exact)
+		fprintf(out, "# NOT exact\n");
+	isl_pw_qpolynomial_fold_print(pwf, out, 0);
+	fprintf(out, "\n");
+	isl_pw_qpolynomial_fold_free(pwf);
+
+	return isl_stat_ok;
+}
+
+int main(int argc, char **argv)
+{
+	isl_ctx *ctx;
+	isl_stream *s;
+	struct bound_options *options;
+	int r = 0;
+
+	options = bound_options_new_with_defaults();
+	assert(options);
+	argc = bound_options_parse(options, argc, argv, ISL_ARG_ALL);
+
+	ctx = isl_ctx_alloc_with_options(&bound_options_args, options);
+
+	if (server_is_enabled(options->server)) {
+		r = server_run(ctx, options->server, &bound, options);
 	} else {
-		if (!exact)
-			printf("# NOT exact\n");
-		isl_pw_qpolynomial_fold_print(pwf, stdout, 0);
-		fprintf(stdout, "\n");
-		isl_pw_qpolynomial_fold_free(pwf);
+		s = isl_stream_new_file(ctx, stdin);
+		if (bound(s, stdout, options) < 0 && options->verify)
+			r = -1;
+		isl_stream_free(s);
 	}
 
-error:
-	isl_stream_free(s);
-
 	isl_ctx_free(ctx);
 
 	return r;
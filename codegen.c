@@ -29,15 +29,19 @@
 #include "isl/union_map.h"
 #include "isl/stream.h"
 #include "isl/schedule_node.h"
+#include "server.h"
 
 struct options {
 	struct isl_options	*isl;
+	struct server_options	*server;
 	unsigned		 atomic;
 	unsigned		 separate;
 };
 
 ISL_ARGS_START(struct options, options_args)
 ISL_ARG_CHILD(struct options, isl, "isl", &isl_options_args, "isl options")
+ISL_ARG_CHILD(struct options, server, "server", &server_options_args,
+	"server options")
 ISL_ARG_BOOL(struct options, atomic, 0, "atomic", 0,
 	"globally set the atomic option")
 ISL_ARG_BOOL(struct options, separate, 0, "separate", 0,
@@ -194,33 +198,25 @@ static __isl_give isl_ast_node *construct_ast_from_schedule(
 	return tree;
 }
 
-/* Read an object from stdin.
+/* Read an object from "s".
  * If it is a (union) map, then assume an input specified by
  * schedule map, context and options and construct an AST from
  * those elements
  * If it is a schedule object, then construct the AST from the schedule.
+ * Print the AST to "out".
  */
-int main(int argc, char **argv)
+static isl_stat generate(__isl_keep isl_stream *s, FILE *out, void *user)
 {
 	isl_ctx *ctx;
-	isl_stream *s;
 	isl_ast_node *tree = NULL;
-	struct options *options;
 	isl_printer *p;
 	struct isl_obj obj;
-	int r = EXIT_SUCCESS;
+	isl_stat r = isl_stat_ok;
 
-	options = cg_options_new_with_defaults();
-	assert(options);
-	ctx = isl_ctx_alloc_with_options(&options_args, options);
-	isl_options_set_ast_build_detect_min_max(ctx, 1);
-	isl_options_set_ast_print_outermost_block(ctx, 0);
-	argc = cg_options_parse(options, argc, argv, ISL_ARG_ALL);
-
-	s = isl_stream_new_file(ctx, stdin);
+	ctx = isl_stream_get_ctx(s);
 	obj = isl_stream_read_obj(s);
 	if (obj.v == NULL) {
-		r = EXIT_FAILURE;
+		r = isl_stat_error;
 	} else if (obj.type == isl_obj_map) {
 		isl_union_map *umap;
 
@@ -233,17 +229,44 @@ int main(int argc, char **argv)
 	} else {
 		obj.type->free(obj.v);
 		isl_die(ctx, isl_error_invalid, "unknown input",
-			r = EXIT_FAILURE);
+			r = isl_stat_error);
 	}
-	isl_stream_free(s);
 
-	p = isl_printer_to_file(ctx, stdout);
+	p = isl_printer_to_file(ctx, out);
 	p = isl_printer_set_output_format(p, ISL_FORMAT_C);
 	p = isl_printer_print_ast_node(p, tree);
 	isl_printer_free(p);
 
 	isl_ast_node_free(tree);
 
+	return r;
+}
+
+/* Generate code for the input read from stdin or,
+ * in one of the server modes, for each of the requests.
+ */
+int main(int argc, char **argv)
+{
+	isl_ctx *ctx;
+	isl_stream *s;
+	struct options *options;
+	int r;
+
+	options = cg_options_new_with_defaults();
+	assert(options);
+	ctx = isl_ctx_alloc_with_options(&options_args, options);
+	isl_options_set_ast_build_detect_min_max(ctx, 1);
+	isl_options_set_ast_print_outermost_block(ctx, 0);
+	argc = cg_options_parse(options, argc, argv, ISL_ARG_ALL);
+
+	if (server_is_enabled(options->server)) {
+		r = server_run(ctx, options->server, &generate, NULL);
+	} else {
+		s = isl_stream_new_file(ctx, stdin);
+		r = generate(s, stdout, NULL) < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+		isl_stream_free(s);
+	}
+
 	isl_ctx_free(ctx);
 	return r;
 }
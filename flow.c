@@ -10,35 +10,75 @@
  * prints the corresponding dependences.
  */
 
+#include <stdlib.h>
+#include "isl/arg.h"
 #include "isl/options.h"
 #include "isl/printer.h"
 #include "isl/union_map.h"
 #include "isl/flow.h"
 #include "isl/schedule.h"
+#include "isl/stream.h"
+#include "server.h"
 
-int main(int argc, char **argv)
+struct options {
+	struct isl_options	*isl;
+	struct server_options	*server;
+};
+
+ISL_ARGS_START(struct options, options_args)
+ISL_ARG_CHILD(struct options, isl, "isl", &isl_options_args, "isl options")
+ISL_ARG_CHILD(struct options, server, "server", &server_options_args,
+	"server options")
+ISL_ARGS_END
+
+ISL_ARG_DEF(options, struct options, options_args)
+
+/* Read an isl_union_access_info object from "s" and
+ * print the corresponding dependences to "out".
+ */
+static isl_stat compute_flow(__isl_keep isl_stream *s, FILE *out, void *user)
 {
 	isl_ctx *ctx;
 	isl_printer *p;
 	isl_union_access_info *access;
 	isl_union_flow *flow;
-	struct isl_options *options;
-
-	options = isl_options_new_with_defaults();
-	argc = isl_options_parse(options, argc, argv, ISL_ARG_ALL);
-	ctx = isl_ctx_alloc_with_options(&isl_options_args, options);
+	isl_stat r;
 
-	access = isl_union_access_info_read_from_file(ctx, stdin);
+	ctx = isl_stream_get_ctx(s);
+	access = isl_stream_read_union_access_info(s);
 	flow = isl_union_access_info_compute_flow(access);
 
-	p = isl_printer_to_file(ctx, stdout);
+	p = isl_printer_to_file(ctx, out);
 	p = isl_printer_set_yaml_style(p, ISL_YAML_STYLE_BLOCK);
 	p = isl_printer_print_union_flow(p, flow);
+	r = p ? isl_stat_ok : isl_stat_error;
 	isl_printer_free(p);
 
 	isl_union_flow_free(flow);
 
+	return r;
+}
+
+int main(int argc, char **argv)
+{
+	isl_ctx *ctx;
+	isl_stream *s;
+	struct options *options;
+	int r = EXIT_SUCCESS;
+
+	options = options_new_with_defaults();
+	argc = options_parse(options, argc, argv, ISL_ARG_ALL);
+	ctx = isl_ctx_alloc_with_options(&options_args, options);
+
+	if (server_is_enabled(options->server)) {
+		r = server_run(ctx, options->server, &compute_flow, NULL);
+	} else {
+		s = isl_stream_new_file(ctx, stdin);
+		compute_flow(s, stdout, NULL);
+		isl_stream_free(s);
+	}
+
 	isl_ctx_free(ctx);
 
-	return 0;
+	return r;
 }
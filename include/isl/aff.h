@@ -401,6 +401,8 @@ __isl_give isl_pw_aff *isl_pw_aff_gist_params(__isl_take isl_pw_aff *pwaff,
 __isl_export
 __isl_give isl_val *isl_pw_aff_eval(__isl_take isl_pw_aff *pa,
 	__isl_take isl_point *pnt);
+__isl_give isl_val_list *isl_pw_aff_eval_si_array(__isl_keep isl_pw_aff *pa,
+	int n, const long *coords);
 
 __isl_overload
 __isl_give isl_pw_aff *isl_pw_aff_pullback_multi_aff(
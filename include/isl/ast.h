@@ -242,6 +242,22 @@ __isl_give isl_printer *isl_ast_node_if_print(__isl_keep isl_ast_node *node,
 __isl_export
 __isl_give char *isl_ast_node_to_C_str(__isl_keep isl_ast_node *node);
 
+__isl_give isl_ast_bytecode *isl_ast_node_compile_bytecode(
+	__isl_keep isl_ast_node *node);
+__isl_null isl_ast_bytecode *isl_ast_bytecode_free(
+	__isl_take isl_ast_bytecode *bc);
+isl_ctx *isl_ast_bytecode_get_ctx(__isl_keep isl_ast_bytecode *bc);
+isl_size isl_ast_bytecode_n_param(__isl_keep isl_ast_bytecode *bc);
+__isl_give isl_id *isl_ast_bytecode_get_param_id(
+	__isl_keep isl_ast_bytecode *bc, int pos);
+isl_size isl_ast_bytecode_n_stmt(__isl_keep isl_ast_bytecode *bc);
+__isl_give isl_id *isl_ast_bytecode_get_stmt_id(
+	__isl_keep isl_ast_bytecode *bc, int pos);
+isl_stat isl_ast_bytecode_run(__isl_keep isl_ast_bytecode *bc,
+	const long *param,
+	isl_stat (*fn)(int stmt, int n_arg, const long *arg, void *user),
+	void *user);
+
 ISL_DECLARE_LIST_FN(ast_expr)
 ISL_DECLARE_EXPORTED_LIST_FN(ast_node)
 
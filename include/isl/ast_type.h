@@ -99,6 +99,9 @@ enum isl_ast_loop_type {
 struct isl_ast_print_options;
 typedef struct isl_ast_print_options isl_ast_print_options;
 
+struct isl_ast_bytecode;
+typedef struct isl_ast_bytecode isl_ast_bytecode;
+
 ISL_DECLARE_LIST_TYPE(ast_expr)
 ISL_DECLARE_EXPORTED_LIST_TYPE(ast_node)
 
@@ -0,0 +1,91 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+#ifndef ISL_BINARY_H
+#define ISL_BINARY_H
+
+#include <stdio.h>
+#include "isl/ctx.h"
+#include "isl/set_type.h"
+#include "isl/map_type.h"
+#include "isl/union_set_type.h"
+#include "isl/union_map_type.h"
+#include "isl/aff_type.h"
+#include "isl/schedule_type.h"
+#include "isl/flow.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void *isl_basic_set_to_binary(__isl_keep isl_basic_set *bset, size_t *size);
+void *isl_basic_map_to_binary(__isl_keep isl_basic_map *bmap, size_t *size);
+void *isl_set_to_binary(__isl_keep isl_set *set, size_t *size);
+void *isl_map_to_binary(__isl_keep isl_map *map, size_t *size);
+void *isl_union_set_to_binary(__isl_keep isl_union_set *uset, size_t *size);
+void *isl_union_map_to_binary(__isl_keep isl_union_map *umap, size_t *size);
+void *isl_pw_multi_aff_to_binary(__isl_keep isl_pw_multi_aff *pma,
+	size_t *size);
+void *isl_schedule_to_binary(__isl_keep isl_schedule *schedule, size_t *size);
+void *isl_union_access_info_to_binary(__isl_keep isl_union_access_info *info,
+	size_t *size);
+
+isl_stat isl_basic_set_write_binary_file(__isl_keep isl_basic_set *bset,
+	FILE *out);
+isl_stat isl_basic_map_write_binary_file(__isl_keep isl_basic_map *bmap,
+	FILE *out);
+isl_stat isl_set_write_binary_file(__isl_keep isl_set *set, FILE *out);
+isl_stat isl_map_write_binary_file(__isl_keep isl_map *map, FILE *out);
+isl_stat isl_union_set_write_binary_file(__isl_keep isl_union_set *uset,
+	FILE *out);
+isl_stat isl_union_map_write_binary_file(__isl_keep isl_union_map *umap,
+	FILE *out);
+isl_stat isl_pw_multi_aff_write_binary_file(__isl_keep isl_pw_multi_aff *pma,
+	FILE *out);
+isl_stat isl_schedule_write_binary_file(__isl_keep isl_schedule *schedule,
+	FILE *out);
+isl_stat isl_union_access_info_write_binary_file(
+	__isl_keep isl_union_access_info *info, FILE *out);
+
+__isl_give isl_basic_set *isl_basic_set_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size);
+__isl_give isl_basic_map *isl_basic_map_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size);
+__isl_give isl_set *isl_set_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size);
+__isl_give isl_map *isl_map_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size);
+__isl_give isl_union_set *isl_union_set_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size);
+__isl_give isl_union_map *isl_union_map_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size);
+__isl_give isl_pw_multi_aff *isl_pw_multi_aff_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size);
+__isl_give isl_schedule *isl_schedule_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size);
+__isl_give isl_union_access_info *isl_union_access_info_read_from_binary(
+	isl_ctx *ctx, const void *buf, size_t size);
+
+__isl_give isl_basic_set *isl_basic_set_read_from_binary_file(isl_ctx *ctx,
+	FILE *in);
+__isl_give isl_basic_map *isl_basic_map_read_from_binary_file(isl_ctx *ctx,
+	FILE *in);
+__isl_give isl_set *isl_set_read_from_binary_file(isl_ctx *ctx, FILE *in);
+__isl_give isl_map *isl_map_read_from_binary_file(isl_ctx *ctx, FILE *in);
+__isl_give isl_union_set *isl_union_set_read_from_binary_file(isl_ctx *ctx,
+	FILE *in);
+__isl_give isl_union_map *isl_union_map_read_from_binary_file(isl_ctx *ctx,
+	FILE *in);
+__isl_give isl_pw_multi_aff *isl_pw_multi_aff_read_from_binary_file(
+	isl_ctx *ctx, FILE *in);
+__isl_give isl_schedule *isl_schedule_read_from_binary_file(isl_ctx *ctx,
+	FILE *in);
+__isl_give isl_union_access_info *isl_union_access_info_read_from_binary_file(
+	isl_ctx *ctx, FILE *in);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
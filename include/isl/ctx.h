@@ -70,6 +70,25 @@ extern "C" {
  */
 struct isl_stats {
 	long	gbr_solved_lps;
+	long	vertices_cache_hits;
+	long	vertices_cache_misses;
+	long	subset_plain;
+	long	subset_sample;
+	long	subset_full;
+	long	subset_cache_hits;
+	long	subset_cache_misses;
+	long	closure_exact;
+	long	closure_approx;
+	long	closure_budget_exceeded;
+	unsigned long	closure_operations;
+	long	closure_cache_hits;
+	long	closure_cache_misses;
+	long	intern_hits;
+	long	intern_misses;
+	long	lp_float_used;
+	long	lp_float_fallback;
+	long	tab_pivots;
+	long	ast_plain_separated;
 };
 enum isl_error {
 	isl_error_none = 0,
@@ -175,6 +194,26 @@ void isl_ctx_set_max_operations(isl_ctx *ctx, unsigned long max_operations);
 unsigned long isl_ctx_get_max_operations(isl_ctx *ctx);
 void isl_ctx_reset_operations(isl_ctx *ctx);
 
+void isl_ctx_set_max_memory(isl_ctx *ctx, unsigned long max_memory);
+unsigned long isl_ctx_get_max_memory(isl_ctx *ctx);
+unsigned long isl_ctx_get_memory(isl_ctx *ctx);
+unsigned long isl_ctx_get_peak_memory(isl_ctx *ctx);
+void isl_ctx_reset_peak_memory(isl_ctx *ctx);
+
+isl_stat isl_ctx_trace_start(isl_ctx *ctx, const char *filename);
+isl_stat isl_ctx_trace_start_file(isl_ctx *ctx, FILE *file);
+isl_stat isl_ctx_trace_stop(isl_ctx *ctx);
+
+isl_stat isl_ctx_foreach_profile_entry(isl_ctx *ctx,
+	isl_stat (*fn)(const char *name, long calls, double time,
+		unsigned long bytes, void *user), void *user);
+isl_stat isl_ctx_reset_profile(isl_ctx *ctx);
+
+void isl_ctx_set_disjunct_callback(isl_ctx *ctx,
+	isl_stat (*fn)(isl_ctx *ctx, const char *name, int pos, int n,
+		int n_result, unsigned long operations, void *user),
+	void *user);
+
 #define ISL_ARG_CTX_DECL(prefix,st,args)				\
 st *isl_ctx_peek_ ## prefix(isl_ctx *ctx);
 
@@ -9,6 +9,7 @@
 #include "isl/union_map_type.h"
 #include "isl/schedule.h"
 #include "isl/printer.h"
+#include "isl/stream.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -105,6 +106,8 @@ isl_ctx *isl_union_access_info_get_ctx(
 
 __isl_give isl_union_access_info *isl_union_access_info_read_from_file(
 	isl_ctx *ctx, FILE *input);
+__isl_give isl_union_access_info *isl_stream_read_union_access_info(
+	isl_stream *s);
 __isl_give isl_printer *isl_printer_print_union_access_info(
 	__isl_take isl_printer *p, __isl_keep isl_union_access_info *access);
 __isl_give char *isl_union_access_info_to_str(
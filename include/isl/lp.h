@@ -25,6 +25,9 @@ enum isl_lp_result {
 extern "C" {
 #endif
 
+isl_stat isl_options_set_lp_float(isl_ctx *ctx, int val);
+int isl_options_get_lp_float(isl_ctx *ctx);
+
 __isl_give isl_val *isl_basic_set_min_lp_val(__isl_keep isl_basic_set *bset,
 	__isl_keep isl_aff *obj);
 __isl_give isl_val *isl_basic_set_max_lp_val(__isl_keep isl_basic_set *bset,
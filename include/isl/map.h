@@ -141,6 +141,8 @@ __isl_give isl_basic_map *isl_map_plain_unshifted_simple_hull(
 	__isl_take isl_map *map);
 __isl_give isl_basic_map *isl_map_unshifted_simple_hull_from_map_list(
 	__isl_take isl_map *map, __isl_take isl_map_list *list);
+__isl_give isl_basic_map *isl_map_budget_hull(__isl_take isl_map *map,
+	int max_lp);
 
 __isl_export
 __isl_give isl_basic_map *isl_basic_map_intersect_domain(
@@ -606,6 +608,8 @@ __isl_export
 isl_bool isl_map_is_empty(__isl_keep isl_map *map);
 __isl_export
 isl_bool isl_map_is_subset(__isl_keep isl_map *map1, __isl_keep isl_map *map2);
+isl_stat isl_options_set_subset_cache_size(isl_ctx *ctx, int val);
+int isl_options_get_subset_cache_size(isl_ctx *ctx);
 __isl_export
 isl_bool isl_map_is_strict_subset(__isl_keep isl_map *map1,
 	__isl_keep isl_map *map2);
@@ -709,6 +713,8 @@ __isl_give isl_fixed_box *isl_map_get_range_simple_fixed_box_hull(
 
 __isl_export
 __isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map);
+__isl_give isl_map *isl_map_coalesce_add_basic_map(__isl_take isl_map *map,
+	__isl_take isl_basic_map *bmap);
 
 isl_bool isl_map_plain_is_equal(__isl_keep isl_map *map1,
 	__isl_keep isl_map *map2);
@@ -731,6 +737,12 @@ __isl_give isl_map *isl_map_reaching_path_lengths(__isl_take isl_map *map,
 	isl_bool *exact);
 __isl_give isl_map *isl_map_transitive_closure(__isl_take isl_map *map,
 	isl_bool *exact);
+__isl_give isl_map *isl_map_transitive_closure_bounded(
+	__isl_take isl_map *map, unsigned long max_operations, isl_bool *exact);
+isl_stat isl_options_set_closure_cache_size(isl_ctx *ctx, int val);
+int isl_options_get_closure_cache_size(isl_ctx *ctx);
+isl_stat isl_options_set_intern_basic_maps(isl_ctx *ctx, int val);
+int isl_options_get_intern_basic_maps(isl_ctx *ctx);
 
 __isl_give isl_map *isl_map_lex_le_map(__isl_take isl_map *map1,
 	__isl_take isl_map *map2);
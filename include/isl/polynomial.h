@@ -256,6 +256,8 @@ __isl_give isl_pw_qpolynomial *isl_pw_qpolynomial_fix_val(
 __isl_export
 __isl_give isl_val *isl_pw_qpolynomial_eval(
 	__isl_take isl_pw_qpolynomial *pwqp, __isl_take isl_point *pnt);
+__isl_give isl_val_list *isl_pw_qpolynomial_eval_si_array(
+	__isl_keep isl_pw_qpolynomial *pwqp, int n, const long *coords);
 
 __isl_give isl_val *isl_pw_qpolynomial_max(__isl_take isl_pw_qpolynomial *pwqp);
 __isl_give isl_val *isl_pw_qpolynomial_min(__isl_take isl_pw_qpolynomial *pwqp);
@@ -472,6 +474,8 @@ __isl_give isl_pw_qpolynomial_fold *isl_pw_qpolynomial_fold_drop_unused_params(
 
 __isl_give isl_val *isl_pw_qpolynomial_fold_eval(
 	__isl_take isl_pw_qpolynomial_fold *pwf, __isl_take isl_point *pnt);
+__isl_give isl_val_list *isl_pw_qpolynomial_fold_eval_si_array(
+	__isl_keep isl_pw_qpolynomial_fold *pwf, int n, const long *coords);
 
 isl_size isl_pw_qpolynomial_fold_n_piece(
 	__isl_keep isl_pw_qpolynomial_fold *pwf);
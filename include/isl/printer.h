@@ -12,6 +12,9 @@ extern "C" {
 
 __isl_give isl_printer *isl_printer_to_file(isl_ctx *ctx, FILE *file);
 __isl_give isl_printer *isl_printer_to_str(isl_ctx *ctx);
+__isl_give isl_printer *isl_printer_to_callback(isl_ctx *ctx,
+	isl_stat (*write)(const char *data, size_t len, void *user),
+	void *user);
 __isl_null isl_printer *isl_printer_free(__isl_take isl_printer *printer);
 
 isl_ctx *isl_printer_get_ctx(__isl_keep isl_printer *printer);
@@ -9,6 +9,7 @@
 #include "isl/set_type.h"
 #include "isl/list.h"
 #include "isl/printer_type.h"
+#include "isl/stream.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -113,6 +114,8 @@ __isl_give isl_schedule_constraints *isl_schedule_constraints_read_from_str(
 	isl_ctx *ctx, const char *str);
 __isl_give isl_schedule_constraints *isl_schedule_constraints_read_from_file(
 	isl_ctx *ctx, FILE *input);
+__isl_give isl_schedule_constraints *isl_stream_read_schedule_constraints(
+	isl_stream *s);
 __isl_give isl_printer *isl_printer_print_schedule_constraints(
 	__isl_take isl_printer *p, __isl_keep isl_schedule_constraints *sc);
 void isl_schedule_constraints_dump(__isl_keep isl_schedule_constraints *sc);
@@ -307,6 +307,8 @@ __isl_give isl_basic_set *isl_set_plain_unshifted_simple_hull(
 	__isl_take isl_set *set);
 __isl_give isl_basic_set *isl_set_unshifted_simple_hull_from_set_list(
 	__isl_take isl_set *set, __isl_take isl_set_list *list);
+__isl_give isl_basic_set *isl_set_budget_hull(__isl_take isl_set *set,
+	int max_lp);
 __isl_give isl_basic_set *isl_set_bounded_simple_hull(__isl_take isl_set *set);
 
 __isl_export
@@ -508,6 +510,8 @@ __isl_give isl_fixed_box *isl_set_get_simple_fixed_box_hull(
 
 __isl_export
 __isl_give isl_set *isl_set_coalesce(__isl_take isl_set *set);
+__isl_give isl_set *isl_set_coalesce_add_basic_set(__isl_take isl_set *set,
+	__isl_take isl_basic_set *bset);
 
 int isl_set_plain_cmp(__isl_keep isl_set *set1, __isl_keep isl_set *set2);
 isl_bool isl_set_plain_is_equal(__isl_keep isl_set *set1,
@@ -54,6 +54,10 @@ typedef struct isl_stream isl_stream;
 
 __isl_give isl_stream *isl_stream_new_file(isl_ctx *ctx, FILE *file);
 __isl_give isl_stream *isl_stream_new_str(isl_ctx *ctx, const char *str);
+__isl_give isl_stream *isl_stream_new_buffer(isl_ctx *ctx, const char *buf,
+	size_t len);
+__isl_give isl_stream *isl_stream_new_mapped_file(isl_ctx *ctx,
+	const char *filename);
 void isl_stream_free(__isl_take isl_stream *s);
 
 isl_ctx *isl_stream_get_ctx(__isl_keep isl_stream *s);
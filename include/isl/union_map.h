@@ -328,6 +328,9 @@ __isl_give isl_union_map *isl_union_map_power(__isl_take isl_union_map *umap,
 	isl_bool *exact);
 __isl_give isl_union_map *isl_union_map_transitive_closure(
 	__isl_take isl_union_map *umap, isl_bool *exact);
+__isl_give isl_union_map *isl_union_map_transitive_closure_bounded(
+	__isl_take isl_union_map *umap, unsigned long max_operations,
+	isl_bool *exact);
 
 __isl_give isl_union_map *isl_union_map_lex_lt_union_map(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2);
@@ -23,6 +23,7 @@
 #include "isl_tab.h"
 #include <isl_mat_private.h>
 #include <isl_vec_private.h>
+#include <isl_trace_private.h>
 
 #include <bset_to_bmap.c>
 #include <bset_from_bmap.c>
@@ -956,12 +957,16 @@ __isl_give isl_basic_set *isl_basic_set_detect_equalities(
 
 __isl_give isl_map *isl_map_detect_equalities(__isl_take isl_map *map)
 {
+	ISL_TRACE_UN(isl_map, isl_map_detect_equalities, map);
+
 	return isl_map_inline_foreach_basic_map(map,
 					    &isl_basic_map_detect_equalities);
 }
 
 __isl_give isl_set *isl_set_detect_equalities(__isl_take isl_set *set)
 {
+	ISL_TRACE_UN(isl_set, isl_set_detect_equalities, set);
+
 	return set_from_map(isl_map_detect_equalities(set_to_map(set)));
 }
 
@@ -0,0 +1,866 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+#include <isl_ast_private.h>
+#include <isl_val_private.h>
+#include "isl/id.h"
+
+/* The instructions of the bytecode.
+ *
+ * The interpreter maintains a stack of values and
+ * an array of variable values.
+ *
+ * isl_ast_bc_halt		stop execution
+ * isl_ast_bc_const v		push the constant "v"
+ * isl_ast_bc_load s		push the value of variable "s"
+ * isl_ast_bc_store s		pop a value and store it in variable "s"
+ * isl_ast_bc_add, ...		pop two values and push the result of
+ *				the corresponding operation
+ * isl_ast_bc_neg		negate the value on top of the stack
+ * isl_ast_bc_jump t		continue execution at position "t"
+ * isl_ast_bc_jump_if_zero t	pop a value and continue execution
+ *				at position "t" if it is zero
+ * isl_ast_bc_call s n		pop "n" values and call the user callback
+ *				on statement "s" with these values as arguments
+ */
+enum isl_ast_bc_op {
+	isl_ast_bc_halt,
+	isl_ast_bc_const,
+	isl_ast_bc_load,
+	isl_ast_bc_store,
+	isl_ast_bc_add,
+	isl_ast_bc_sub,
+	isl_ast_bc_mul,
+	isl_ast_bc_neg,
+	isl_ast_bc_div,
+	isl_ast_bc_fdiv_q,
+	isl_ast_bc_rem,
+	isl_ast_bc_min,
+	isl_ast_bc_max,
+	isl_ast_bc_and,
+	isl_ast_bc_or,
+	isl_ast_bc_eq,
+	isl_ast_bc_le,
+	isl_ast_bc_lt,
+	isl_ast_bc_ge,
+	isl_ast_bc_gt,
+	isl_ast_bc_jump,
+	isl_ast_bc_jump_if_zero,
+	isl_ast_bc_call
+};
+
+/* A compiled isl_ast_node.
+ *
+ * "code" contains the "len" elements of the bytecode,
+ * with room for "size" elements.
+ * The variables of the program consist of the loop iterators
+ * in "iterator", followed by the parameters in "param",
+ * i.e., the free identifiers that appear in the expressions.
+ * "stmt" contains the identifiers of the user statements,
+ * i.e., the functions called in the user nodes.
+ * "depth" is the depth of the stack at the current position
+ * during compilation and "max_depth" is the maximal depth
+ * that is reached during execution.
+ */
+struct isl_ast_bytecode {
+	isl_ctx *ctx;
+
+	isl_id_list *iterator;
+	isl_id_list *param;
+	isl_id_list *stmt;
+
+	int len;
+	int size;
+	long *code;
+
+	int depth;
+	int max_depth;
+};
+
+/* Free "bc" and return NULL.
+ */
+__isl_null isl_ast_bytecode *isl_ast_bytecode_free(
+	__isl_take isl_ast_bytecode *bc)
+{
+	if (!bc)
+		return NULL;
+
+	isl_id_list_free(bc->iterator);
+	isl_id_list_free(bc->param);
+	isl_id_list_free(bc->stmt);
+	free(bc->code);
+	isl_ctx_deref(bc->ctx);
+	free(bc);
+
+	return NULL;
+}
+
+isl_ctx *isl_ast_bytecode_get_ctx(__isl_keep isl_ast_bytecode *bc)
+{
+	return bc ? bc->ctx : NULL;
+}
+
+/* Return the position of "id" in "list" or the size of "list"
+ * if it does not appear in "list".
+ */
+static int find_id(__isl_keep isl_id_list *list, __isl_keep isl_id *id)
+{
+	int i;
+	isl_size n;
+
+	n = isl_id_list_n_id(list);
+	if (n < 0)
+		return -1;
+	for (i = 0; i < n; ++i) {
+		isl_id *id_i;
+
+		id_i = isl_id_list_get_at(list, i);
+		isl_id_free(id_i);
+		if (id_i == id)
+			return i;
+	}
+
+	return n;
+}
+
+/* Return the position of "id" in "*list", adding it to the end
+ * of "*list" if it does not appear in the list yet.
+ */
+static int find_or_add_id(__isl_keep isl_id_list **list,
+	__isl_keep isl_id *id)
+{
+	int pos;
+
+	pos = find_id(*list, id);
+	if (pos < 0 || pos < isl_id_list_n_id(*list))
+		return pos;
+	*list = isl_id_list_add(*list, isl_id_copy(id));
+	if (!*list)
+		return -1;
+	return pos;
+}
+
+/* Append "n" elements "v" to the bytecode of "bc" and
+ * update the stack depth by "delta".
+ * Return the position of the first element.
+ */
+static int emit(__isl_keep isl_ast_bytecode *bc, int n, long *v, int delta)
+{
+	int i;
+	int pos;
+
+	if (bc->len + n > bc->size) {
+		long *code;
+		int size = 2 * (bc->len + n);
+
+		code = isl_realloc_array(bc->ctx, bc->code, long, size);
+		if (!code)
+			return -1;
+		bc->code = code;
+		bc->size = size;
+	}
+	pos = bc->len;
+	for (i = 0; i < n; ++i)
+		bc->code[bc->len++] = v[i];
+	bc->depth += delta;
+	if (bc->depth > bc->max_depth)
+		bc->max_depth = bc->depth;
+
+	return pos;
+}
+
+/* Append the instruction "op" without operands to the bytecode of "bc".
+ * "delta" is the effect of the instruction on the stack depth.
+ */
+static isl_stat emit_op(__isl_keep isl_ast_bytecode *bc, enum isl_ast_bc_op op,
+	int delta)
+{
+	long v[] = { op };
+
+	return emit(bc, 1, v, delta) < 0 ? isl_stat_error : isl_stat_ok;
+}
+
+/* Append the instruction "op" with operand "arg" to the bytecode of "bc".
+ * "delta" is the effect of the instruction on the stack depth.
+ * Return the position of the operand such that it can be
+ * patched later by the caller.
+ */
+static int emit_op_arg(__isl_keep isl_ast_bytecode *bc, enum isl_ast_bc_op op,
+	long arg, int delta)
+{
+	long v[] = { op, arg };
+	int pos;
+
+	pos = emit(bc, 2, v, delta);
+	return pos < 0 ? -1 : pos + 1;
+}
+
+/* Return the slot of the variable "id" in "bc".
+ * If "id" is not a loop iterator, then it is treated as a parameter.
+ */
+static int id_slot(__isl_keep isl_ast_bytecode *bc, __isl_keep isl_id *id)
+{
+	int pos;
+	isl_size n_iterator;
+
+	n_iterator = isl_id_list_n_id(bc->iterator);
+	if (n_iterator < 0)
+		return -1;
+	pos = find_id(bc->iterator, id);
+	if (pos < 0 || pos < n_iterator)
+		return pos;
+	pos = find_or_add_id(&bc->param, id);
+	if (pos < 0)
+		return -1;
+	return n_iterator + pos;
+}
+
+static isl_stat compile_expr(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr);
+
+/* Append code for evaluating argument "pos" of the operation "expr".
+ */
+static isl_stat compile_arg(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr, int pos)
+{
+	isl_ast_expr *arg;
+	isl_stat r;
+
+	arg = isl_ast_expr_op_get_arg(expr, pos);
+	r = compile_expr(bc, arg);
+	isl_ast_expr_free(arg);
+
+	return r;
+}
+
+/* Append code for evaluating the operation "expr",
+ * which is of the form "arg_0 op arg_1 op ... op arg_n",
+ * with "op" a left associative binary operator.
+ */
+static isl_stat compile_nary(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr, enum isl_ast_bc_op op)
+{
+	int i;
+	isl_size n;
+
+	n = isl_ast_expr_op_get_n_arg(expr);
+	if (n < 0)
+		return isl_stat_error;
+	if (n < 1)
+		isl_die(bc->ctx, isl_error_invalid,
+			"expecting at least one argument",
+			return isl_stat_error);
+	if (compile_arg(bc, expr, 0) < 0)
+		return isl_stat_error;
+	for (i = 1; i < n; ++i) {
+		if (compile_arg(bc, expr, i) < 0)
+			return isl_stat_error;
+		if (emit_op(bc, op, -1) < 0)
+			return isl_stat_error;
+	}
+
+	return isl_stat_ok;
+}
+
+/* Append code for evaluating the conditional expression "expr"
+ * of the form "arg_0 ? arg_1 : arg_2".
+ */
+static isl_stat compile_select(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr)
+{
+	int to_else, to_end;
+
+	if (compile_arg(bc, expr, 0) < 0)
+		return isl_stat_error;
+	to_else = emit_op_arg(bc, isl_ast_bc_jump_if_zero, 0, -1);
+	if (to_else < 0 || compile_arg(bc, expr, 1) < 0)
+		return isl_stat_error;
+	to_end = emit_op_arg(bc, isl_ast_bc_jump, 0, 0);
+	if (to_end < 0)
+		return isl_stat_error;
+	bc->depth--;
+	bc->code[to_else] = bc->len;
+	if (compile_arg(bc, expr, 2) < 0)
+		return isl_stat_error;
+	bc->code[to_end] = bc->len;
+
+	return isl_stat_ok;
+}
+
+/* Append code for evaluating the short-circuit operation "expr",
+ * i.e., "arg_0 && arg_1" if "is_and" is set and "arg_0 || arg_1" otherwise.
+ * These are evaluated as "arg_0 ? arg_1 : 0" and "arg_0 ? 1 : arg_1".
+ */
+static isl_stat compile_short_circuit(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr, int is_and)
+{
+	int to_else, to_end;
+
+	if (compile_arg(bc, expr, 0) < 0)
+		return isl_stat_error;
+	to_else = emit_op_arg(bc, isl_ast_bc_jump_if_zero, 0, -1);
+	if (to_else < 0)
+		return isl_stat_error;
+	if (is_and ? compile_arg(bc, expr, 1) < 0 :
+		  emit_op_arg(bc, isl_ast_bc_const, 1, 1) < 0)
+		return isl_stat_error;
+	to_end = emit_op_arg(bc, isl_ast_bc_jump, 0, 0);
+	if (to_end < 0)
+		return isl_stat_error;
+	bc->depth--;
+	bc->code[to_else] = bc->len;
+	if (is_and ? emit_op_arg(bc, isl_ast_bc_const, 0, 1) < 0 :
+		  compile_arg(bc, expr, 1) < 0)
+		return isl_stat_error;
+	bc->code[to_end] = bc->len;
+
+	return isl_stat_ok;
+}
+
+/* Append code for evaluating the operation "expr".
+ * Calls, accesses, member accesses and address-of operations
+ * are not supported inside expressions.
+ */
+static isl_stat compile_op(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr)
+{
+	switch (isl_ast_expr_op_get_type(expr)) {
+	case isl_ast_expr_op_error:
+		return isl_stat_error;
+	case isl_ast_expr_op_and:
+		return compile_nary(bc, expr, isl_ast_bc_and);
+	case isl_ast_expr_op_or:
+		return compile_nary(bc, expr, isl_ast_bc_or);
+	case isl_ast_expr_op_and_then:
+		return compile_short_circuit(bc, expr, 1);
+	case isl_ast_expr_op_or_else:
+		return compile_short_circuit(bc, expr, 0);
+	case isl_ast_expr_op_max:
+		return compile_nary(bc, expr, isl_ast_bc_max);
+	case isl_ast_expr_op_min:
+		return compile_nary(bc, expr, isl_ast_bc_min);
+	case isl_ast_expr_op_minus:
+		if (compile_arg(bc, expr, 0) < 0)
+			return isl_stat_error;
+		return emit_op(bc, isl_ast_bc_neg, 0);
+	case isl_ast_expr_op_add:
+		return compile_nary(bc, expr, isl_ast_bc_add);
+	case isl_ast_expr_op_sub:
+		return compile_nary(bc, expr, isl_ast_bc_sub);
+	case isl_ast_expr_op_mul:
+		return compile_nary(bc, expr, isl_ast_bc_mul);
+	case isl_ast_expr_op_div:
+	case isl_ast_expr_op_pdiv_q:
+		return compile_nary(bc, expr, isl_ast_bc_div);
+	case isl_ast_expr_op_fdiv_q:
+		return compile_nary(bc, expr, isl_ast_bc_fdiv_q);
+	case isl_ast_expr_op_pdiv_r:
+	case isl_ast_expr_op_zdiv_r:
+		return compile_nary(bc, expr, isl_ast_bc_rem);
+	case isl_ast_expr_op_cond:
+	case isl_ast_expr_op_select:
+		return compile_select(bc, expr);
+	case isl_ast_expr_op_eq:
+		return compile_nary(bc, expr, isl_ast_bc_eq);
+	case isl_ast_expr_op_le:
+		return compile_nary(bc, expr, isl_ast_bc_le);
+	case isl_ast_expr_op_lt:
+		return compile_nary(bc, expr, isl_ast_bc_lt);
+	case isl_ast_expr_op_ge:
+		return compile_nary(bc, expr, isl_ast_bc_ge);
+	case isl_ast_expr_op_gt:
+		return compile_nary(bc, expr, isl_ast_bc_gt);
+	case isl_ast_expr_op_call:
+	case isl_ast_expr_op_access:
+	case isl_ast_expr_op_member:
+	case isl_ast_expr_op_address_of:
+		break;
+	}
+
+	isl_die(bc->ctx, isl_error_unsupported,
+		"unsupported operation in expression", return isl_stat_error);
+}
+
+/* Append code for pushing the integer "expr" onto the stack.
+ */
+static isl_stat compile_int(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr)
+{
+	isl_val *v;
+	isl_bool ok;
+	long c = 0;
+
+	v = isl_ast_expr_int_get_val(expr);
+	ok = isl_val_is_int(v);
+	if (ok == isl_bool_true) {
+		ok = isl_bool_ok(isl_int_fits_slong(v->n));
+		c = isl_int_get_si(v->n);
+	}
+	isl_val_free(v);
+	if (ok < 0)
+		return isl_stat_error;
+	if (!ok)
+		isl_die(bc->ctx, isl_error_unsupported,
+			"constant does not fit in a long",
+			return isl_stat_error);
+
+	return emit_op_arg(bc, isl_ast_bc_const, c, 1) < 0 ?
+		isl_stat_error : isl_stat_ok;
+}
+
+/* Append code for pushing the value of the identifier "expr"
+ * onto the stack.
+ */
+static isl_stat compile_id(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr)
+{
+	isl_id *id;
+	int slot;
+
+	id = isl_ast_expr_id_get_id(expr);
+	slot = id ? id_slot(bc, id) : -1;
+	isl_id_free(id);
+	if (slot < 0)
+		return isl_stat_error;
+
+	return emit_op_arg(bc, isl_ast_bc_load, slot, 1) < 0 ?
+		isl_stat_error : isl_stat_ok;
+}
+
+/* Append code for evaluating "expr" and pushing the result
+ * onto the stack.
+ */
+static isl_stat compile_expr(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_expr *expr)
+{
+	switch (isl_ast_expr_get_type(expr)) {
+	case isl_ast_expr_error:
+		return isl_stat_error;
+	case isl_ast_expr_op:
+		return compile_op(bc, expr);
+	case isl_ast_expr_id:
+		return compile_id(bc, expr);
+	case isl_ast_expr_int:
+		return compile_int(bc, expr);
+	}
+
+	return isl_stat_error;
+}
+
+/* Return the slot of the iterator of the for node "node".
+ */
+static int iterator_slot(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_node *node)
+{
+	isl_id *id;
+	int slot;
+
+	id = isl_ast_expr_id_get_id(node->u.f.iterator);
+	slot = id ? find_id(bc->iterator, id) : -1;
+	isl_id_free(id);
+
+	return slot;
+}
+
+static isl_stat compile_node(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_node *node);
+
+/* Append code for executing the for node "node".
+ *
+ * The iterator is initialized to the initial value and,
+ * unless the loop is degenerate, the body is executed and
+ * the iterator is incremented for as long as the condition holds.
+ */
+static isl_stat compile_for(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_node *node)
+{
+	int slot;
+	int start, to_end;
+
+	slot = iterator_slot(bc, node);
+	if (slot < 0 || compile_expr(bc, node->u.f.init) < 0 ||
+	    emit_op_arg(bc, isl_ast_bc_store, slot, -1) < 0)
+		return isl_stat_error;
+	if (node->u.f.degenerate)
+		return compile_node(bc, node->u.f.body);
+
+	start = bc->len;
+	if (compile_expr(bc, node->u.f.cond) < 0)
+		return isl_stat_error;
+	to_end = emit_op_arg(bc, isl_ast_bc_jump_if_zero, 0, -1);
+	if (to_end < 0 || compile_node(bc, node->u.f.body) < 0)
+		return isl_stat_error;
+	if (emit_op_arg(bc, isl_ast_bc_load, slot, 1) < 0 ||
+	    compile_expr(bc, node->u.f.inc) < 0 ||
+	    emit_op(bc, isl_ast_bc_add, -1) < 0 ||
+	    emit_op_arg(bc, isl_ast_bc_store, slot, -1) < 0 ||
+	    emit_op_arg(bc, isl_ast_bc_jump, start, 0) < 0)
+		return isl_stat_error;
+	bc->code[to_end] = bc->len;
+
+	return isl_stat_ok;
+}
+
+/* Append code for executing the if node "node".
+ */
+static isl_stat compile_if(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_node *node)
+{
+	int to_else, to_end;
+
+	if (compile_expr(bc, node->u.i.guard) < 0)
+		return isl_stat_error;
+	to_else = emit_op_arg(bc, isl_ast_bc_jump_if_zero, 0, -1);
+	if (to_else < 0 || compile_node(bc, node->u.i.then) < 0)
+		return isl_stat_error;
+	if (!node->u.i.else_node) {
+		bc->code[to_else] = bc->len;
+		return isl_stat_ok;
+	}
+	to_end = emit_op_arg(bc, isl_ast_bc_jump, 0, 0);
+	if (to_end < 0)
+		return isl_stat_error;
+	bc->code[to_else] = bc->len;
+	if (compile_node(bc, node->u.i.else_node) < 0)
+		return isl_stat_error;
+	bc->code[to_end] = bc->len;
+
+	return isl_stat_ok;
+}
+
+/* Append code for executing the block node "node".
+ */
+static isl_stat compile_block(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_node *node)
+{
+	int i;
+	isl_size n;
+
+	n = isl_ast_node_list_n_ast_node(node->u.b.children);
+	if (n < 0)
+		return isl_stat_error;
+	for (i = 0; i < n; ++i) {
+		isl_ast_node *child;
+		isl_stat r;
+
+		child = isl_ast_node_list_get_at(node->u.b.children, i);
+		r = compile_node(bc, child);
+		isl_ast_node_free(child);
+		if (r < 0)
+			return isl_stat_error;
+	}
+
+	return isl_stat_ok;
+}
+
+/* Append code for executing the user node "node".
+ * The expression of the node is required to be a call
+ * of a function identified by an identifier.
+ * The arguments are evaluated and passed to the user callback,
+ * along with the position of the function identifier in bc->stmt.
+ */
+static isl_stat compile_user(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_node *node)
+{
+	int i;
+	int stmt;
+	isl_size n;
+	isl_id *id;
+	isl_ast_expr *expr, *fn;
+	long v[3];
+
+	expr = node->u.e.expr;
+	if (isl_ast_expr_get_type(expr) != isl_ast_expr_op ||
+	    isl_ast_expr_op_get_type(expr) != isl_ast_expr_op_call)
+		isl_die(bc->ctx, isl_error_unsupported,
+			"expecting call expression", return isl_stat_error);
+	fn = isl_ast_expr_op_get_arg(expr, 0);
+	id = isl_ast_expr_id_get_id(fn);
+	isl_ast_expr_free(fn);
+	if (!id)
+		return isl_stat_error;
+	stmt = find_or_add_id(&bc->stmt, id);
+	isl_id_free(id);
+	n = isl_ast_expr_op_get_n_arg(expr);
+	if (stmt < 0 || n < 0)
+		return isl_stat_error;
+
+	for (i = 1; i < n; ++i)
+		if (compile_arg(bc, expr, i) < 0)
+			return isl_stat_error;
+	v[0] = isl_ast_bc_call;
+	v[1] = stmt;
+	v[2] = n - 1;
+
+	return emit(bc, 3, v, -(n - 1)) < 0 ? isl_stat_error : isl_stat_ok;
+}
+
+/* Append code for executing "node".
+ * Mark nodes are transparent.
+ */
+static isl_stat compile_node(__isl_keep isl_ast_bytecode *bc,
+	__isl_keep isl_ast_node *node)
+{
+	if (!node)
+		return isl_stat_error;
+
+	switch (node->type) {
+	case isl_ast_node_error:
+		return isl_stat_error;
+	case isl_ast_node_for:
+		return compile_for(bc, node);
+	case isl_ast_node_if:
+		return compile_if(bc, node);
+	case isl_ast_node_block:
+		return compile_block(bc, node);
+	case isl_ast_node_mark:
+		return compile_node(bc, node->u.m.node);
+	case isl_ast_node_user:
+		return compile_user(bc, node);
+	}
+
+	return isl_stat_error;
+}
+
+/* If "node" is a for node, then add its iterator to the list
+ * of iterators in "user".
+ */
+static isl_bool collect_iterator(__isl_keep isl_ast_node *node, void *user)
+{
+	isl_ast_bytecode *bc = user;
+	isl_id *id;
+	int pos;
+
+	if (isl_ast_node_get_type(node) != isl_ast_node_for)
+		return isl_bool_true;
+
+	id = isl_ast_expr_id_get_id(node->u.f.iterator);
+	if (!id)
+		return isl_bool_error;
+	pos = find_or_add_id(&bc->iterator, id);
+	isl_id_free(id);
+
+	return pos < 0 ? isl_bool_error : isl_bool_true;
+}
+
+/* Compile "node" into bytecode that can be executed
+ * by isl_ast_bytecode_run.
+ *
+ * The loop iterators are collected first such that
+ * any other identifier that appears in an expression
+ * can be identified as a parameter.
+ */
+__isl_give isl_ast_bytecode *isl_ast_node_compile_bytecode(
+	__isl_keep isl_ast_node *node)
+{
+	isl_ctx *ctx;
+	isl_ast_bytecode *bc;
+
+	if (!node)
+		return NULL;
+
+	ctx = isl_ast_node_get_ctx(node);
+	bc = isl_calloc_type(ctx, struct isl_ast_bytecode);
+	if (!bc)
+		return NULL;
+	bc->ctx = ctx;
+	isl_ctx_ref(ctx);
+	bc->iterator = isl_id_list_alloc(ctx, 0);
+	bc->param = isl_id_list_alloc(ctx, 0);
+	bc->stmt = isl_id_list_alloc(ctx, 0);
+	if (!bc->iterator || !bc->param || !bc->stmt)
+		return isl_ast_bytecode_free(bc);
+
+	if (isl_ast_node_foreach_descendant_top_down(node,
+					&collect_iterator, bc) < 0)
+		return isl_ast_bytecode_free(bc);
+	if (compile_node(bc, node) < 0 ||
+	    emit_op(bc, isl_ast_bc_halt, 0) < 0)
+		return isl_ast_bytecode_free(bc);
+
+	return bc;
+}
+
+/* Return the number of parameters of "bc",
+ * i.e., the number of values that need to be passed
+ * to isl_ast_bytecode_run.
+ */
+isl_size isl_ast_bytecode_n_param(__isl_keep isl_ast_bytecode *bc)
+{
+	if (!bc)
+		return isl_size_error;
+	return isl_id_list_n_id(bc->param);
+}
+
+/* Return the identifier of the parameter at position "pos" of "bc".
+ */
+__isl_give isl_id *isl_ast_bytecode_get_param_id(
+	__isl_keep isl_ast_bytecode *bc, int pos)
+{
+	if (!bc)
+		return NULL;
+	return isl_id_list_get_at(bc->param, pos);
+}
+
+/* Return the number of user statements of "bc".
+ */
+isl_size isl_ast_bytecode_n_stmt(__isl_keep isl_ast_bytecode *bc)
+{
+	if (!bc)
+		return isl_size_error;
+	return isl_id_list_n_id(bc->stmt);
+}
+
+/* Return the identifier of the user statement at position "pos" of "bc",
+ * i.e., the identifier that is passed as "stmt" to the callback
+ * of isl_ast_bytecode_run.
+ */
+__isl_give isl_id *isl_ast_bytecode_get_stmt_id(
+	__isl_keep isl_ast_bytecode *bc, int pos)
+{
+	if (!bc)
+		return NULL;
+	return isl_id_list_get_at(bc->stmt, pos);
+}
+
+/* Return floor(a / b), with b non-zero.
+ */
+static long fdiv_q(long a, long b)
+{
+	long q = a / b;
+
+	if (q * b != a && (a < 0) != (b < 0))
+		q--;
+	return q;
+}
+
+/* Execute the bytecode "bc" with the parameters set to "param",
+ * the values of which are given in the order
+ * of isl_ast_bytecode_get_param_id.
+ * "fn" is called on each executed user statement with
+ * the position of the statement identifier
+ * (see isl_ast_bytecode_get_stmt_id) and the values of the arguments.
+ * If "fn" returns isl_stat_error, then execution is aborted.
+ * "fn" may be NULL, in which case the user statements are skipped.
+ *
+ * All computations are performed using native long integers
+ * without overflow checks.
+ */
+isl_stat isl_ast_bytecode_run(__isl_keep isl_ast_bytecode *bc,
+	const long *param,
+	isl_stat (*fn)(int stmt, int n_arg, const long *arg, void *user),
+	void *user)
+{
+	isl_size n_iterator, n_param;
+	long *var, *stack, *sp;
+	long *code;
+	long a, b;
+	int pc;
+	isl_stat r = isl_stat_ok;
+
+	if (!bc)
+		return isl_stat_error;
+	n_iterator = isl_id_list_n_id(bc->iterator);
+	n_param = isl_id_list_n_id(bc->param);
+	if (n_iterator < 0 || n_param < 0)
+		return isl_stat_error;
+	if (n_param > 0 && !param)
+		isl_die(bc->ctx, isl_error_invalid,
+			"parameter values not specified", return isl_stat_error);
+
+	var = isl_alloc_array(bc->ctx, long, n_iterator + n_param);
+	stack = isl_alloc_array(bc->ctx, long, bc->max_depth);
+	if ((n_iterator + n_param && !var) || (bc->max_depth && !stack)) {
+		free(var);
+		free(stack);
+		return isl_stat_error;
+	}
+	for (pc = 0; pc < n_param; ++pc)
+		var[n_iterator + pc] = param[pc];
+
+	code = bc->code;
+	sp = stack;
+	pc = 0;
+	for (;;) {
+		switch (code[pc]) {
+		case isl_ast_bc_halt:
+			goto done;
+		case isl_ast_bc_const:
+			*sp++ = code[pc + 1];
+			pc += 2;
+			continue;
+		case isl_ast_bc_load:
+			*sp++ = var[code[pc + 1]];
+			pc += 2;
+			continue;
+		case isl_ast_bc_store:
+			var[code[pc + 1]] = *--sp;
+			pc += 2;
+			continue;
+		case isl_ast_bc_neg:
+			sp[-1] = -sp[-1];
+			pc++;
+			continue;
+		case isl_ast_bc_jump:
+			pc = code[pc + 1];
+			continue;
+		case isl_ast_bc_jump_if_zero:
+			pc = *--sp ? pc + 2 : code[pc + 1];
+			continue;
+		case isl_ast_bc_call:
+			sp -= code[pc + 2];
+			if (fn && fn(code[pc + 1], code[pc + 2], sp, user) < 0) {
+				r = isl_stat_error;
+				goto done;
+			}
+			pc += 3;
+			continue;
+		}
+
+		b = *--sp;
+		a = sp[-1];
+		switch (code[pc]) {
+		case isl_ast_bc_add:	a = a + b; break;
+		case isl_ast_bc_sub:	a = a - b; break;
+		case isl_ast_bc_mul:	a = a * b; break;
+		case isl_ast_bc_min:	a = a < b ? a : b; break;
+		case isl_ast_bc_max:	a = a > b ? a : b; break;
+		case isl_ast_bc_and:	a = a && b; break;
+		case isl_ast_bc_or:	a = a || b; break;
+		case isl_ast_bc_eq:	a = a == b; break;
+		case isl_ast_bc_le:	a = a <= b; break;
+		case isl_ast_bc_lt:	a = a < b; break;
+		case isl_ast_bc_ge:	a = a >= b; break;
+		case isl_ast_bc_gt:	a = a > b; break;
+		case isl_ast_bc_div:
+		case isl_ast_bc_fdiv_q:
+		case isl_ast_bc_rem:
+			if (b == 0) {
+				isl_handle_error(bc->ctx, isl_error_invalid,
+					"division by zero", __FILE__, __LINE__);
+				r = isl_stat_error;
+				goto done;
+			}
+			if (code[pc] == isl_ast_bc_div)
+				a = a / b;
+			else if (code[pc] == isl_ast_bc_fdiv_q)
+				a = fdiv_q(a, b);
+			else
+				a = a % b;
+			break;
+		default:
+			isl_handle_error(bc->ctx, isl_error_internal,
+				"invalid instruction", __FILE__, __LINE__);
+			r = isl_stat_error;
+			goto done;
+		}
+		sp[-1] = a;
+		pc++;
+	}
+
+done:
+	free(var);
+	free(stack);
+	return r;
+}
@@ -11,6 +11,8 @@
  */
 
 #include <limits.h>
+#include <isl_ctx_private.h>
+#include <isl_map_private.h>
 #include "isl/id.h"
 #include "isl/val.h"
 #include "isl/space.h"
@@ -22,12 +24,17 @@
 #include "isl/union_map.h"
 #include "isl/schedule_node.h"
 #include "isl/options.h"
+#include <isl_seq.h>
 #include <isl_sort.h>
 #include <isl_tarjan.h>
 #include <isl_ast_private.h>
 #include <isl_ast_build_expr.h>
 #include <isl_ast_build_private.h>
 #include <isl_ast_graft_private.h>
+#include <isl_trace_private.h>
+#include <isl_profile_private.h>
+
+#include <bset_to_bmap.c>
 
 /* Try and reduce the number of disjuncts in the representation of "set",
  * without dropping explicit representations of local variables.
@@ -1859,8 +1866,77 @@ done:
 	return list;
 }
 
+/* Is it obvious that all elements of "i" lie before all elements of "j"
+ * in set dimension "pos"?
+ * In particular, are there constant bounds in the constraints
+ * that only involve this dimension that show that this is the case?
+ */
+static isl_bool plain_before(__isl_keep isl_basic_set *i,
+	__isl_keep isl_basic_set *j, int pos)
+{
+	int has_lower, has_upper, has_other;
+	isl_size off;
+	isl_bool before = isl_bool_false;
+	isl_int upper, lower, other;
+
+	off = isl_basic_set_var_offset(i, isl_dim_set);
+	if (off < 0)
+		return isl_bool_error;
+	pos += off;
+
+	isl_int_init(upper);
+	isl_int_init(lower);
+	isl_int_init(other);
+	if (isl_basic_map_plain_var_bounds(bset_to_bmap(i), pos,
+			&other, &has_other, &upper, &has_upper) < 0 ||
+	    isl_basic_map_plain_var_bounds(bset_to_bmap(j), pos,
+			&lower, &has_lower, &other, &has_other) < 0)
+		before = isl_bool_error;
+	else if (has_upper && has_lower)
+		before = isl_bool_ok(isl_int_lt(upper, lower));
+	isl_int_clear(upper);
+	isl_int_clear(lower);
+	isl_int_clear(other);
+
+	return before;
+}
+
+/* Is it obvious that "i" and "j" do not share any values
+ * for the first "depth" set dimensions?
+ *
+ * This is a cheap test that avoids the construction and
+ * emptiness check of a product of "i" and "j" in the common case
+ * where the domains are separated by a constant outer dimension,
+ * e.g., because they belong to different children of a sequence.
+ * The number of times this test succeeds is kept track of
+ * in the ast_plain_separated statistic.
+ */
+static isl_bool plain_disjoint_outer(__isl_keep isl_basic_set *i,
+	__isl_keep isl_basic_set *j, int depth)
+{
+	int l;
+
+	for (l = 0; l < depth; ++l) {
+		isl_bool before;
+
+		before = plain_before(i, j, l);
+		if (before == isl_bool_false)
+			before = plain_before(j, i, l);
+		if (before == isl_bool_true)
+			isl_basic_set_get_ctx(i)->stats->ast_plain_separated++;
+		if (before < 0 || before)
+			return before;
+	}
+
+	return isl_bool_false;
+}
+
 /* Does any element of i follow or coincide with any element of j
  * at the current depth for equal values of the outer dimensions?
+ *
+ * First check if it is obvious that they do not share
+ * any values of the outer dimensions or that i obviously lies before j
+ * at the current depth.
  */
 static isl_bool domain_follows_at_depth(__isl_keep isl_basic_set *i,
 	__isl_keep isl_basic_set *j, void *user)
@@ -1868,8 +1944,15 @@ static isl_bool domain_follows_at_depth(__isl_keep isl_basic_set *i,
 	int depth = *(int *) user;
 	isl_basic_map *test;
 	isl_bool empty;
+	isl_bool plain;
 	int l;
 
+	plain = plain_disjoint_outer(i, j, depth);
+	if (plain == isl_bool_false)
+		plain = plain_before(i, j, depth);
+	if (plain < 0 || plain)
+		return isl_bool_not(plain);
+
 	test = isl_basic_map_from_domain_and_range(isl_basic_set_copy(i),
 						    isl_basic_set_copy(j));
 	for (l = 0; l < depth; ++l)
@@ -2097,6 +2180,8 @@ static __isl_give isl_ast_graft_list *generate_sorted_domains(
 }
 
 /* Do i and j share any values for the outer dimensions?
+ *
+ * First check if it is obvious that they do not.
  */
 static isl_bool shared_outer(__isl_keep isl_basic_set *i,
 	__isl_keep isl_basic_set *j, void *user)
@@ -2104,8 +2189,13 @@ static isl_bool shared_outer(__isl_keep isl_basic_set *i,
 	int depth = *(int *) user;
 	isl_basic_map *test;
 	isl_bool empty;
+	isl_bool disjoint;
 	int l;
 
+	disjoint = plain_disjoint_outer(i, j, depth);
+	if (disjoint < 0 || disjoint)
+		return isl_bool_not(disjoint);
+
 	test = isl_basic_map_from_domain_and_range(isl_basic_set_copy(i),
 						    isl_basic_set_copy(j));
 	for (l = 0; l < depth; ++l)
@@ -5145,14 +5235,21 @@ error:
  * The main computation is performed on an inverse schedule (with
  * the schedule domain in the domain and the elements to be executed
  * in the range) called "executed".
+ *
+ * The calls performed during AST generation are not recorded
+ * in the trace of the isl_ctx, if any.
  */
 __isl_give isl_ast_node *isl_ast_build_node_from_schedule_map(
 	__isl_keep isl_ast_build *build, __isl_take isl_union_map *schedule)
 {
+	isl_ctx *ctx;
 	isl_ast_graft_list *list;
 	isl_ast_node *node;
 	isl_union_map *executed;
 
+	ctx = isl_ast_build_get_ctx(build);
+	isl_trace_suppress(ctx);
+	isl_profile_enter(ctx, isl_profile_ast_gen);
 	build = isl_ast_build_copy(build);
 	build = isl_ast_build_set_single_valued(build, 0);
 	schedule = isl_union_map_coalesce(schedule);
@@ -5161,6 +5258,8 @@ __isl_give isl_ast_node *isl_ast_build_node_from_schedule_map(
 	list = generate_code(executed, isl_ast_build_copy(build), 0);
 	node = isl_ast_node_from_graft_list(list, build);
 	isl_ast_build_free(build);
+	isl_profile_leave(ctx, isl_profile_ast_gen);
+	isl_trace_resume(ctx);
 
 	return node;
 }
@@ -5911,12 +6010,16 @@ error:
  *
  * The construction starts at the root node of the schedule,
  * which is assumed to be a domain node.
+ *
+ * The calls performed during AST generation are not recorded
+ * in the trace of the isl_ctx, if any.
  */
 __isl_give isl_ast_node *isl_ast_build_node_from_schedule(
 	__isl_keep isl_ast_build *build, __isl_take isl_schedule *schedule)
 {
 	isl_ctx *ctx;
 	isl_schedule_node *node;
+	isl_ast_node *ast;
 
 	if (!build || !schedule)
 		goto error;
@@ -5934,7 +6037,12 @@ __isl_give isl_ast_node *isl_ast_build_node_from_schedule(
 		isl_die(ctx, isl_error_unsupported,
 			"expecting root domain node",
 			build = isl_ast_build_free(build));
-	return build_ast_from_domain(build, node);
+	isl_trace_suppress(ctx);
+	isl_profile_enter(ctx, isl_profile_ast_gen);
+	ast = build_ast_from_domain(build, node);
+	isl_profile_leave(ctx, isl_profile_ast_gen);
+	isl_trace_resume(ctx);
+	return ast;
 error:
 	isl_schedule_free(schedule);
 	return NULL;
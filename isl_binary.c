@@ -0,0 +1,2551 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <isl_ctx_private.h>
+#include <isl_map_private.h>
+#include <isl_union_map_private.h>
+#include <isl_aff_private.h>
+#include <isl_flow_private.h>
+#include <isl_local_space_private.h>
+#include <isl_mat_private.h>
+#include <isl_schedule_band.h>
+#include <isl_schedule_private.h>
+#include <isl_space_private.h>
+#include <isl_val_private.h>
+#include <isl_vec_private.h>
+#include <isl_seq.h>
+#include <isl/id.h>
+#include <isl/binary.h>
+
+#include <bset_to_bmap.c>
+#include <bset_from_bmap.c>
+#include <set_to_map.c>
+#include <set_from_map.c>
+#include <uset_to_umap.c>
+#include <uset_from_umap.c>
+
+/* The binary format consists of a header followed by a payload.
+ *
+ * The header consists of the four bytes "ISLB", a version byte,
+ * a byte describing the kind of object and the length of the payload,
+ * encoded as a variable length integer.
+ *
+ * The payload consists of a table of identifiers,
+ * a table of spaces and the description of the object itself.
+ * Identifiers are represented by their names.
+ * Any user pointers associated to identifiers are not preserved.
+ * Spaces refer to identifiers by their position in the table (plus one,
+ * with zero meaning that there is no identifier), while
+ * the description of the object refers to spaces by their position
+ * in the space table.  In particular, each distinct space (and
+ * each distinct identifier) is only stored once.
+ *
+ * Unsigned integers are stored in a variable length encoding
+ * with seven bits per byte, least significant bits first and
+ * the most significant bit of each byte set if more bytes follow.
+ * Coefficients are stored as an unsigned integer u.
+ * If the least significant bit of u is zero, then u >> 1
+ * is the zigzag encoding of the (small) coefficient.
+ * Otherwise, (u >> 1) & 1 is the sign of the coefficient and
+ * u >> 2 is the number of bytes of its absolute value, which follow
+ * with the least significant byte first.
+ */
+#define ISL_BINARY_VERSION	2
+
+/* The kinds of objects that can be stored.
+ * Sets are stored as the corresponding kinds of maps.
+ */
+enum isl_binary_kind {
+	isl_binary_basic_map = 1,
+	isl_binary_map,
+	isl_binary_union_map,
+	isl_binary_pw_multi_aff,
+	isl_binary_schedule,
+	isl_binary_union_access_info
+};
+
+/* The maximal nesting depth of wrapped spaces.
+ * Spaces are read recursively, so the depth needs to be bounded
+ * to avoid running out of stack space on crafted input.
+ */
+#define ISL_BINARY_MAX_NESTING	256
+
+/* The maximal depth of a schedule tree.
+ * Schedule trees are also read recursively.
+ */
+#define ISL_BINARY_MAX_TREE_DEPTH	1024
+
+/* The magnitude of the coefficients that are stored in the short format.
+ */
+#define ISL_BINARY_SMALL	(1L << 60)
+
+/* A growable byte buffer.
+ */
+struct isl_binary_buf {
+	unsigned char *data;
+	size_t len;
+	size_t size;
+};
+
+/* Data used while writing an object.
+ *
+ * "ids" and "spaces" collect the identifiers and spaces encountered
+ * so far, with "hash" the full hashes of the spaces.
+ * "space_buf" contains the encoding of the spaces in "spaces" and
+ * "body" the encoding of the object itself.
+ */
+struct isl_binary_writer {
+	isl_ctx *ctx;
+	int error;
+
+	int n_id;
+	int size_id;
+	isl_id **ids;
+
+	int n_space;
+	int size_space;
+	isl_space **spaces;
+	uint32_t *hash;
+
+	struct isl_binary_buf space_buf;
+	struct isl_binary_buf body;
+};
+
+/* Data used while reading an object.
+ *
+ * "p" points to the next byte to be read, while "end" points
+ * right after the last byte that may be read.
+ */
+struct isl_binary_reader {
+	isl_ctx *ctx;
+	const unsigned char *p;
+	const unsigned char *end;
+
+	int n_id;
+	isl_id **ids;
+
+	int n_space;
+	isl_space **spaces;
+};
+
+/* Make sure "buf" has room for "n" more bytes.
+ */
+static isl_stat buf_grow(isl_ctx *ctx, struct isl_binary_buf *buf, size_t n)
+{
+	size_t size;
+	unsigned char *data;
+
+	if (buf->len + n <= buf->size)
+		return isl_stat_ok;
+	size = 2 * buf->size;
+	if (size < buf->len + n)
+		size = buf->len + n + 64;
+	data = isl_realloc_array(ctx, buf->data, unsigned char, size);
+	if (!data)
+		return isl_stat_error;
+	buf->data = data;
+	buf->size = size;
+	return isl_stat_ok;
+}
+
+static isl_stat buf_put_bytes(isl_ctx *ctx, struct isl_binary_buf *buf,
+	const void *data, size_t n)
+{
+	if (buf_grow(ctx, buf, n) < 0)
+		return isl_stat_error;
+	memcpy(buf->data + buf->len, data, n);
+	buf->len += n;
+	return isl_stat_ok;
+}
+
+static isl_stat buf_put_byte(isl_ctx *ctx, struct isl_binary_buf *buf,
+	unsigned char c)
+{
+	return buf_put_bytes(ctx, buf, &c, 1);
+}
+
+/* Append the variable length encoding of "u" to "buf".
+ */
+static isl_stat buf_put_uint(isl_ctx *ctx, struct isl_binary_buf *buf,
+	unsigned long u)
+{
+	unsigned char data[2 * sizeof(unsigned long)];
+	size_t n = 0;
+
+	do {
+		data[n] = u & 0x7f;
+		u >>= 7;
+		if (u)
+			data[n] |= 0x80;
+		++n;
+	} while (u);
+
+	return buf_put_bytes(ctx, buf, data, n);
+}
+
+/* Append the encoding of the coefficient "v" to "buf".
+ */
+static isl_stat buf_put_int(isl_ctx *ctx, struct isl_binary_buf *buf,
+	isl_int v)
+{
+	isl_val *val;
+	isl_size n;
+	unsigned long u;
+	unsigned char *chunks;
+
+	if (isl_int_fits_slong(v)) {
+		long s = isl_int_get_si(v);
+
+		if (s > -ISL_BINARY_SMALL && s < ISL_BINARY_SMALL) {
+			u = s < 0 ? 2 * (unsigned long) -s - 1 : 2 * s;
+			return buf_put_uint(ctx, buf, u << 1);
+		}
+	}
+
+	val = isl_val_int_from_isl_int(ctx, v);
+	n = isl_val_n_abs_num_chunks(val, 1);
+	if (n < 0) {
+		isl_val_free(val);
+		return isl_stat_error;
+	}
+	u = ((unsigned long) n << 2) | (isl_int_is_neg(v) << 1) | 1;
+	if (buf_put_uint(ctx, buf, u) < 0 || buf_grow(ctx, buf, n) < 0) {
+		isl_val_free(val);
+		return isl_stat_error;
+	}
+	chunks = buf->data + buf->len;
+	if (isl_val_get_abs_num_chunks(val, 1, chunks) < 0) {
+		isl_val_free(val);
+		return isl_stat_error;
+	}
+	buf->len += n;
+	isl_val_free(val);
+	return isl_stat_ok;
+}
+
+static isl_stat buf_put_string(isl_ctx *ctx, struct isl_binary_buf *buf,
+	const char *s)
+{
+	size_t len;
+
+	if (!s)
+		return buf_put_uint(ctx, buf, 0);
+	len = strlen(s);
+	if (buf_put_uint(ctx, buf, 1 + len) < 0)
+		return isl_stat_error;
+	return buf_put_bytes(ctx, buf, s, len);
+}
+
+static void writer_init(struct isl_binary_writer *w, isl_ctx *ctx)
+{
+	memset(w, 0, sizeof(*w));
+	w->ctx = ctx;
+}
+
+static void writer_clear(struct isl_binary_writer *w)
+{
+	int i;
+
+	for (i = 0; i < w->n_space; ++i)
+		isl_space_free(w->spaces[i]);
+	free(w->spaces);
+	free(w->hash);
+	free(w->ids);
+	free(w->space_buf.data);
+	free(w->body.data);
+}
+
+/* Return the position of "id" in the identifier table of "w" plus one,
+ * adding it to the table if needed.
+ * Return 0 if "id" is NULL.
+ * Identifiers are unique within an isl_ctx, so they can be compared
+ * by pointer.
+ */
+static int writer_id(struct isl_binary_writer *w, __isl_take isl_id *id)
+{
+	int i;
+
+	if (!id)
+		return 0;
+	for (i = 0; i < w->n_id; ++i)
+		if (w->ids[i] == id)
+			break;
+	if (i >= w->n_id) {
+		if (w->n_id >= w->size_id) {
+			isl_id **ids;
+			int size = 2 * w->size_id + 8;
+
+			ids = isl_realloc_array(w->ctx, w->ids, isl_id *, size);
+			if (!ids) {
+				w->error = 1;
+				isl_id_free(id);
+				return 0;
+			}
+			w->ids = ids;
+			w->size_id = size;
+		}
+		w->ids[w->n_id++] = id;
+	}
+	isl_id_free(id);
+	return 1 + i;
+}
+
+/* Append the identifier of the given dimension or tuple of "space"
+ * to the space buffer of "w".
+ */
+static void writer_put_dim_id(struct isl_binary_writer *w,
+	__isl_keep isl_space *space, enum isl_dim_type type, int pos)
+{
+	isl_bool has_id;
+	isl_id *id = NULL;
+
+	if (pos < 0)
+		has_id = isl_space_has_tuple_id(space, type);
+	else
+		has_id = isl_space_has_dim_id(space, type, pos);
+	if (has_id < 0)
+		w->error = 1;
+	if (has_id > 0 && pos < 0)
+		id = isl_space_get_tuple_id(space, type);
+	else if (has_id > 0)
+		id = isl_space_get_dim_id(space, type, pos);
+	if (buf_put_uint(w->ctx, &w->space_buf, writer_id(w, id)) < 0)
+		w->error = 1;
+}
+
+/* Append the encoding of the tuple of "space" of type "type"
+ * to the space buffer of "w".
+ * If the tuple is a wrapped map space, then it is described
+ * by the encodings of the domain and range tuples of this map space.
+ * "depth" is the number of wrapped spaces in which this tuple is nested.
+ * Tuples that are nested too deeply cannot be read back,
+ * so they are rejected here.
+ */
+static void writer_put_tuple(struct isl_binary_writer *w,
+	__isl_keep isl_space *space, enum isl_dim_type type, int depth)
+{
+	int i;
+	isl_bool wrapping;
+	isl_size n;
+
+	writer_put_dim_id(w, space, type, -1);
+	if (type == isl_dim_in)
+		wrapping = isl_space_domain_is_wrapping(space);
+	else if (isl_space_is_set(space))
+		wrapping = isl_space_is_wrapping(space);
+	else
+		wrapping = isl_space_range_is_wrapping(space);
+	if (wrapping < 0 ||
+	    buf_put_byte(w->ctx, &w->space_buf, wrapping) < 0) {
+		w->error = 1;
+		return;
+	}
+	if (wrapping && depth >= ISL_BINARY_MAX_NESTING) {
+		w->error = 1;
+		isl_die(w->ctx, isl_error_unsupported,
+			"space too deeply nested for binary format", return);
+	}
+	if (wrapping) {
+		isl_space *nested = isl_space_copy(space);
+
+		if (type == isl_dim_in)
+			nested = isl_space_domain(nested);
+		else if (!isl_space_is_set(space))
+			nested = isl_space_range(nested);
+		nested = isl_space_unwrap(nested);
+		if (!nested)
+			w->error = 1;
+		else {
+			writer_put_tuple(w, nested, isl_dim_in, depth + 1);
+			writer_put_tuple(w, nested, isl_dim_out, depth + 1);
+		}
+		isl_space_free(nested);
+		return;
+	}
+
+	n = isl_space_dim(space, type);
+	if (n < 0 || buf_put_uint(w->ctx, &w->space_buf, n) < 0) {
+		w->error = 1;
+		return;
+	}
+	for (i = 0; i < n; ++i)
+		writer_put_dim_id(w, space, type, i);
+}
+
+/* Are "space1" and "space2" the same, including the identifiers
+ * of their dimensions, also inside nested spaces?
+ * isl_space_is_equal ignores the identifiers of the input and
+ * output dimensions, while they are stored in the space table.
+ */
+static isl_bool space_is_identical(__isl_keep isl_space *space1,
+	__isl_keep isl_space *space2)
+{
+	int i;
+	isl_bool equal;
+
+	equal = isl_space_is_equal(space1, space2);
+	if (equal < 0 || !equal)
+		return equal;
+	equal = isl_space_has_equal_ids(space1, space2);
+	for (i = 0; equal == isl_bool_true && i < 2; ++i)
+		if (space1->nested[i])
+			equal = space_is_identical(space1->nested[i],
+						    space2->nested[i]);
+	return equal;
+}
+
+/* Return the position of "space" in the space table of "w",
+ * appending its encoding to the space buffer if it does not
+ * appear in the table yet.
+ * Spaces that only differ in the identifiers of their dimensions
+ * are stored separately.
+ *
+ * A space is encoded as a byte specifying whether it is
+ * a parameter space (0), a set space (1) or a map space (2),
+ * followed by the number of parameters and their identifiers, and
+ * the encoding of its tuples.
+ */
+static int writer_space(struct isl_binary_writer *w,
+	__isl_keep isl_space *space)
+{
+	int i, kind;
+	uint32_t hash;
+	isl_size nparam;
+
+	if (!space) {
+		w->error = 1;
+		return 0;
+	}
+	hash = isl_space_get_full_hash(space);
+	for (i = 0; i < w->n_space; ++i) {
+		isl_bool equal;
+
+		if (w->hash[i] != hash)
+			continue;
+		equal = space_is_identical(w->spaces[i], space);
+		if (equal < 0)
+			w->error = 1;
+		if (equal)
+			return i;
+	}
+
+	if (w->n_space >= w->size_space) {
+		int size = 2 * w->size_space + 8;
+		isl_space **spaces;
+		uint32_t *hashes;
+
+		spaces = isl_realloc_array(w->ctx, w->spaces, isl_space *, size);
+		if (spaces)
+			w->spaces = spaces;
+		hashes = isl_realloc_array(w->ctx, w->hash, uint32_t, size);
+		if (hashes)
+			w->hash = hashes;
+		if (!spaces || !hashes) {
+			w->error = 1;
+			return 0;
+		}
+		w->size_space = size;
+	}
+	w->spaces[w->n_space] = isl_space_copy(space);
+	w->hash[w->n_space] = hash;
+
+	if (isl_space_is_params(space))
+		kind = 0;
+	else if (isl_space_is_set(space))
+		kind = 1;
+	else
+		kind = 2;
+	nparam = isl_space_dim(space, isl_dim_param);
+	if (nparam < 0 ||
+	    buf_put_byte(w->ctx, &w->space_buf, kind) < 0 ||
+	    buf_put_uint(w->ctx, &w->space_buf, nparam) < 0)
+		w->error = 1;
+	for (i = 0; i < nparam; ++i)
+		writer_put_dim_id(w, space, isl_dim_param, i);
+	if (kind == 2)
+		writer_put_tuple(w, space, isl_dim_in, 0);
+	if (kind >= 1)
+		writer_put_tuple(w, space, isl_dim_out, 0);
+
+	return w->n_space++;
+}
+
+/* Append the encoding of "bmap", without its space, to the body of "w".
+ * That is, append the number of local variables, equality constraints
+ * and inequality constraints, whether "bmap" is rational, and
+ * the coefficients of the local variables, equality constraints
+ * and inequality constraints.
+ */
+static void writer_put_basic_map_body(struct isl_binary_writer *w,
+	__isl_keep isl_basic_map *bmap)
+{
+	int i, j;
+	isl_size total;
+	isl_ctx *ctx = w->ctx;
+	struct isl_binary_buf *body = &w->body;
+
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	if (total < 0) {
+		w->error = 1;
+		return;
+	}
+	if (buf_put_uint(ctx, body, bmap->n_div) < 0 ||
+	    buf_put_uint(ctx, body, bmap->n_eq) < 0 ||
+	    buf_put_uint(ctx, body, bmap->n_ineq) < 0 ||
+	    buf_put_byte(ctx, body,
+			ISL_F_ISSET(bmap, ISL_BASIC_MAP_RATIONAL)) < 0) {
+		w->error = 1;
+		return;
+	}
+	for (i = 0; i < bmap->n_div; ++i)
+		for (j = 0; j < 2 + total; ++j)
+			if (buf_put_int(ctx, body, bmap->div[i][j]) < 0)
+				w->error = 1;
+	for (i = 0; i < bmap->n_eq; ++i)
+		for (j = 0; j < 1 + total; ++j)
+			if (buf_put_int(ctx, body, bmap->eq[i][j]) < 0)
+				w->error = 1;
+	for (i = 0; i < bmap->n_ineq; ++i)
+		for (j = 0; j < 1 + total; ++j)
+			if (buf_put_int(ctx, body, bmap->ineq[i][j]) < 0)
+				w->error = 1;
+}
+
+static void writer_put_basic_map(struct isl_binary_writer *w,
+	__isl_keep isl_basic_map *bmap)
+{
+	int space;
+
+	space = writer_space(w, isl_basic_map_peek_space(bmap));
+	if (buf_put_uint(w->ctx, &w->body, space) < 0)
+		w->error = 1;
+	writer_put_basic_map_body(w, bmap);
+}
+
+/* Append the encoding of "map" to the body of "w".
+ * That is, append its space, the number of basic maps and
+ * the basic maps themselves.
+ * Whether the basic maps are known to be disjoint is not stored
+ * since this property cannot be trusted on input.
+ */
+static void writer_put_map(struct isl_binary_writer *w,
+	__isl_keep isl_map *map)
+{
+	int i;
+	int space;
+
+	if (!map) {
+		w->error = 1;
+		return;
+	}
+	space = writer_space(w, isl_map_peek_space(map));
+	if (buf_put_uint(w->ctx, &w->body, space) < 0 ||
+	    buf_put_uint(w->ctx, &w->body, map->n) < 0) {
+		w->error = 1;
+		return;
+	}
+	for (i = 0; i < map->n; ++i)
+		writer_put_basic_map_body(w, map->p[i]);
+}
+
+static isl_stat put_map(__isl_take isl_map *map, void *user)
+{
+	struct isl_binary_writer *w = user;
+
+	writer_put_map(w, map);
+	isl_map_free(map);
+
+	return w->error ? isl_stat_error : isl_stat_ok;
+}
+
+/* Append the encoding of "umap" to the body of "w".
+ * That is, append its (parameter) space, the number of maps and
+ * the maps themselves.
+ */
+static void writer_put_union_map(struct isl_binary_writer *w,
+	__isl_keep isl_union_map *umap)
+{
+	int space;
+	isl_size n;
+
+	space = writer_space(w, isl_union_map_peek_space(umap));
+	n = isl_union_map_n_map(umap);
+	if (n < 0 ||
+	    buf_put_uint(w->ctx, &w->body, space) < 0 ||
+	    buf_put_uint(w->ctx, &w->body, n) < 0) {
+		w->error = 1;
+		return;
+	}
+	if (isl_union_map_foreach_map(umap, &put_map, w) < 0)
+		w->error = 1;
+}
+
+/* Append the encoding of "aff", without its space, to the body of "w".
+ * That is, append the number of local variables,
+ * their explicit representations and the denominator, constant term and
+ * coefficients of "aff".
+ * The space of "aff" is not stored since it is the domain space
+ * of the multi affine expression containing it.
+ */
+static void writer_put_aff_body(struct isl_binary_writer *w,
+	__isl_keep isl_aff *aff)
+{
+	int i, j;
+	isl_mat *div;
+	isl_ctx *ctx = w->ctx;
+	struct isl_binary_buf *body = &w->body;
+
+	if (!aff) {
+		w->error = 1;
+		return;
+	}
+	div = aff->ls->div;
+	if (buf_put_uint(ctx, body, div->n_row) < 0) {
+		w->error = 1;
+		return;
+	}
+	for (i = 0; i < div->n_row; ++i)
+		for (j = 0; j < div->n_col; ++j)
+			if (buf_put_int(ctx, body, div->row[i][j]) < 0)
+				w->error = 1;
+	for (j = 0; j < aff->v->size; ++j)
+		if (buf_put_int(ctx, body, aff->v->el[j]) < 0)
+			w->error = 1;
+}
+
+/* Append the encoding of "ma" to the body of "w".
+ * That is, append its space and its affine expressions.
+ * The number of affine expressions is determined by the space.
+ */
+static void writer_put_multi_aff(struct isl_binary_writer *w,
+	__isl_keep isl_multi_aff *ma)
+{
+	int i;
+	int space;
+	isl_size n;
+
+	space = writer_space(w, isl_multi_aff_peek_space(ma));
+	n = isl_multi_aff_size(ma);
+	if (n < 0 || buf_put_uint(w->ctx, &w->body, space) < 0) {
+		w->error = 1;
+		return;
+	}
+	for (i = 0; i < n; ++i) {
+		isl_aff *aff;
+
+		aff = isl_multi_aff_get_at(ma, i);
+		writer_put_aff_body(w, aff);
+		isl_aff_free(aff);
+	}
+}
+
+static isl_stat put_piece(__isl_take isl_set *set, __isl_take isl_multi_aff *ma,
+	void *user)
+{
+	struct isl_binary_writer *w = user;
+
+	writer_put_map(w, set_to_map(set));
+	writer_put_multi_aff(w, ma);
+	isl_set_free(set);
+	isl_multi_aff_free(ma);
+
+	return w->error ? isl_stat_error : isl_stat_ok;
+}
+
+/* Append the encoding of "pma" to the body of "w".
+ * That is, append its space, the number of cells and,
+ * for each cell, the encoding of the cell and
+ * that of the associated multi affine expression.
+ */
+static void writer_put_pw_multi_aff(struct isl_binary_writer *w,
+	__isl_keep isl_pw_multi_aff *pma)
+{
+	int space;
+	isl_size n;
+
+	space = writer_space(w, isl_pw_multi_aff_peek_space(pma));
+	n = isl_pw_multi_aff_n_piece(pma);
+	if (n < 0 ||
+	    buf_put_uint(w->ctx, &w->body, space) < 0 ||
+	    buf_put_uint(w->ctx, &w->body, n) < 0) {
+		w->error = 1;
+		return;
+	}
+	if (isl_pw_multi_aff_foreach_piece(pma, &put_piece, w) < 0)
+		w->error = 1;
+}
+
+static isl_stat put_pw_aff_piece(__isl_take isl_set *set,
+	__isl_take isl_aff *aff, void *user)
+{
+	struct isl_binary_writer *w = user;
+
+	writer_put_map(w, set_to_map(set));
+	writer_put_aff_body(w, aff);
+	isl_set_free(set);
+	isl_aff_free(aff);
+
+	return w->error ? isl_stat_error : isl_stat_ok;
+}
+
+/* Append the encoding of "pa" to the body of "w".
+ * That is, append its space, the number of cells and,
+ * for each cell, the encoding of the cell and
+ * that of the associated affine expression.
+ */
+static void writer_put_pw_aff(struct isl_binary_writer *w,
+	__isl_keep isl_pw_aff *pa)
+{
+	int space;
+	isl_size n;
+
+	space = writer_space(w, isl_pw_aff_peek_space(pa));
+	n = isl_pw_aff_n_piece(pa);
+	if (n < 0 ||
+	    buf_put_uint(w->ctx, &w->body, space) < 0 ||
+	    buf_put_uint(w->ctx, &w->body, n) < 0) {
+		w->error = 1;
+		return;
+	}
+	if (isl_pw_aff_foreach_piece(pa, &put_pw_aff_piece, w) < 0)
+		w->error = 1;
+}
+
+static isl_stat put_pw_aff(__isl_take isl_pw_aff *pa, void *user)
+{
+	struct isl_binary_writer *w = user;
+
+	writer_put_pw_aff(w, pa);
+	isl_pw_aff_free(pa);
+
+	return w->error ? isl_stat_error : isl_stat_ok;
+}
+
+/* Append the encoding of "upa" to the body of "w".
+ * That is, append its (parameter) space, the number of
+ * piecewise affine expressions and the expressions themselves.
+ */
+static void writer_put_union_pw_aff(struct isl_binary_writer *w,
+	__isl_keep isl_union_pw_aff *upa)
+{
+	int space;
+	isl_size n;
+	isl_space *upa_space;
+
+	upa_space = isl_union_pw_aff_get_space(upa);
+	space = writer_space(w, upa_space);
+	isl_space_free(upa_space);
+	n = isl_union_pw_aff_n_pw_aff(upa);
+	if (n < 0 ||
+	    buf_put_uint(w->ctx, &w->body, space) < 0 ||
+	    buf_put_uint(w->ctx, &w->body, n) < 0) {
+		w->error = 1;
+		return;
+	}
+	if (isl_union_pw_aff_foreach_pw_aff(upa, &put_pw_aff, w) < 0)
+		w->error = 1;
+}
+
+/* Append the encoding of "mupa" to the body of "w".
+ * That is, append its space and its union piecewise affine expressions.
+ * The number of these expressions is determined by the space.
+ * If there are no such expressions, then the domain of "mupa"
+ * is stored explicitly.
+ */
+static void writer_put_multi_union_pw_aff(struct isl_binary_writer *w,
+	__isl_keep isl_multi_union_pw_aff *mupa)
+{
+	int i;
+	int space;
+	isl_size n;
+
+	space = writer_space(w, isl_multi_union_pw_aff_peek_space(mupa));
+	n = isl_multi_union_pw_aff_size(mupa);
+	if (n < 0 || buf_put_uint(w->ctx, &w->body, space) < 0) {
+		w->error = 1;
+		return;
+	}
+	for (i = 0; i < n; ++i) {
+		isl_union_pw_aff *upa;
+
+		upa = isl_multi_union_pw_aff_get_at(mupa, i);
+		writer_put_union_pw_aff(w, upa);
+		isl_union_pw_aff_free(upa);
+	}
+	if (n == 0) {
+		isl_union_set *dom;
+
+		dom = isl_multi_union_pw_aff_domain(
+					isl_multi_union_pw_aff_copy(mupa));
+		if (!dom)
+			w->error = 1;
+		else
+			writer_put_union_map(w, uset_to_umap(dom));
+		isl_union_set_free(dom);
+	}
+}
+
+static isl_stat put_pw_multi_aff(__isl_take isl_pw_multi_aff *pma,
+	void *user)
+{
+	struct isl_binary_writer *w = user;
+
+	writer_put_pw_multi_aff(w, pma);
+	isl_pw_multi_aff_free(pma);
+
+	return w->error ? isl_stat_error : isl_stat_ok;
+}
+
+/* Append the encoding of "upma" to the body of "w".
+ * That is, append its (parameter) space, the number of
+ * piecewise multi affine expressions and the expressions themselves.
+ */
+static void writer_put_union_pw_multi_aff(struct isl_binary_writer *w,
+	__isl_keep isl_union_pw_multi_aff *upma)
+{
+	int space;
+	isl_size n;
+	isl_space *upma_space;
+
+	upma_space = isl_union_pw_multi_aff_get_space(upma);
+	space = writer_space(w, upma_space);
+	isl_space_free(upma_space);
+	n = isl_union_pw_multi_aff_n_pw_multi_aff(upma);
+	if (n < 0 ||
+	    buf_put_uint(w->ctx, &w->body, space) < 0 ||
+	    buf_put_uint(w->ctx, &w->body, n) < 0) {
+		w->error = 1;
+		return;
+	}
+	if (isl_union_pw_multi_aff_foreach_pw_multi_aff(upma,
+						&put_pw_multi_aff, w) < 0)
+		w->error = 1;
+}
+
+/* Append the encoding of the band root of "tree" to the body of "w".
+ * That is, append its partial schedule, whether it is permutable,
+ * whether each of its members is coincident and its AST build options,
+ * including the loop AST generation types.
+ */
+static void writer_put_band(struct isl_binary_writer *w,
+	__isl_keep isl_schedule_tree *tree)
+{
+	int i;
+	isl_size n;
+	isl_bool permutable;
+	isl_multi_union_pw_aff *mupa;
+	isl_union_set *options;
+
+	mupa = isl_schedule_tree_band_get_partial_schedule(tree);
+	writer_put_multi_union_pw_aff(w, mupa);
+	isl_multi_union_pw_aff_free(mupa);
+
+	n = isl_schedule_tree_band_n_member(tree);
+	permutable = isl_schedule_tree_band_get_permutable(tree);
+	if (n < 0 || permutable < 0 ||
+	    buf_put_byte(w->ctx, &w->body, permutable) < 0) {
+		w->error = 1;
+		return;
+	}
+	for (i = 0; i < n; ++i) {
+		isl_bool coincident;
+
+		coincident = isl_schedule_tree_band_member_get_coincident(tree,
+									i);
+		if (coincident < 0 ||
+		    buf_put_byte(w->ctx, &w->body, coincident) < 0)
+			w->error = 1;
+	}
+
+	options = isl_schedule_tree_band_get_ast_build_options(tree);
+	if (!options)
+		w->error = 1;
+	else
+		writer_put_union_map(w, uset_to_umap(options));
+	isl_union_set_free(options);
+}
+
+/* Append the encoding of the schedule tree "tree" to the body of "w".
+ * That is, append the type of the root node, the information
+ * specific to this type of node, the number of (explicit) children and
+ * the children themselves.
+ * "depth" is the depth of "tree" in the complete schedule tree.
+ */
+static void writer_put_schedule_tree(struct isl_binary_writer *w,
+	__isl_keep isl_schedule_tree *tree, int depth)
+{
+	int i;
+	isl_size n;
+	enum isl_schedule_node_type type;
+	isl_set *set = NULL;
+	isl_union_map *umap = NULL;
+
+	if (depth >= ISL_BINARY_MAX_TREE_DEPTH) {
+		w->error = 1;
+		isl_die(w->ctx, isl_error_unsupported,
+			"schedule tree too deep for binary output", return);
+	}
+	type = isl_schedule_tree_get_type(tree);
+	n = isl_schedule_tree_n_children(tree);
+	if (type < 0 || n < 0 || buf_put_byte(w->ctx, &w->body, type) < 0) {
+		w->error = 1;
+		return;
+	}
+
+	switch (type) {
+	case isl_schedule_node_error:
+		break;
+	case isl_schedule_node_band:
+		writer_put_band(w, tree);
+		break;
+	case isl_schedule_node_context:
+		set = isl_schedule_tree_context_get_context(tree);
+		break;
+	case isl_schedule_node_domain:
+		umap = uset_to_umap(isl_schedule_tree_domain_get_domain(tree));
+		break;
+	case isl_schedule_node_expansion:
+	{
+		isl_union_pw_multi_aff *contraction;
+
+		contraction = isl_schedule_tree_expansion_get_contraction(tree);
+		if (!contraction)
+			w->error = 1;
+		else
+			writer_put_union_pw_multi_aff(w, contraction);
+		isl_union_pw_multi_aff_free(contraction);
+		umap = isl_schedule_tree_expansion_get_expansion(tree);
+		break;
+	}
+	case isl_schedule_node_extension:
+		umap = isl_schedule_tree_extension_get_extension(tree);
+		break;
+	case isl_schedule_node_filter:
+		umap = uset_to_umap(isl_schedule_tree_filter_get_filter(tree));
+		break;
+	case isl_schedule_node_guard:
+		set = isl_schedule_tree_guard_get_guard(tree);
+		break;
+	case isl_schedule_node_mark:
+		if (buf_put_uint(w->ctx, &w->body,
+			    writer_id(w, isl_schedule_tree_mark_get_id(tree))) < 0)
+			w->error = 1;
+		break;
+	case isl_schedule_node_leaf:
+	case isl_schedule_node_sequence:
+	case isl_schedule_node_set:
+		break;
+	}
+	if (type == isl_schedule_node_context ||
+	    type == isl_schedule_node_guard) {
+		if (!set)
+			w->error = 1;
+		else
+			writer_put_map(w, set_to_map(set));
+	}
+	if (type == isl_schedule_node_domain ||
+	    type == isl_schedule_node_expansion ||
+	    type == isl_schedule_node_extension ||
+	    type == isl_schedule_node_filter) {
+		if (!umap)
+			w->error = 1;
+		else
+			writer_put_union_map(w, umap);
+	}
+	isl_set_free(set);
+	isl_union_map_free(umap);
+
+	if (buf_put_uint(w->ctx, &w->body, n) < 0) {
+		w->error = 1;
+		return;
+	}
+	for (i = 0; !w->error && i < n; ++i) {
+		isl_schedule_tree *child;
+
+		child = isl_schedule_tree_get_child(tree, i);
+		if (!child)
+			w->error = 1;
+		else
+			writer_put_schedule_tree(w, child, depth + 1);
+		isl_schedule_tree_free(child);
+	}
+}
+
+/* Append the encoding of "info" to the body of "w".
+ * That is, append the access relations, in the order of
+ * enum isl_access_type, followed by whether the execution order
+ * is represented by a schedule and the schedule tree or
+ * the schedule map.
+ */
+static void writer_put_union_access_info(struct isl_binary_writer *w,
+	__isl_keep isl_union_access_info *info)
+{
+	enum isl_access_type i;
+	isl_schedule *schedule;
+
+	for (i = isl_access_sink; i < isl_access_end; ++i)
+		writer_put_union_map(w,
+			isl_union_access_info_peek_access(info, i));
+	schedule = isl_union_access_info_peek_schedule(info);
+	if (buf_put_byte(w->ctx, &w->body, schedule != NULL) < 0) {
+		w->error = 1;
+		return;
+	}
+	if (schedule)
+		writer_put_schedule_tree(w, schedule->root, 0);
+	else
+		writer_put_union_map(w,
+			isl_union_access_info_peek_schedule_map(info));
+}
+
+/* Combine the header, the tables and the body collected in "w"
+ * for an object of kind "kind" into a single buffer and
+ * return this buffer, storing its size in "size".
+ * The caller is responsible for freeing the buffer.
+ */
+static void *writer_finish(struct isl_binary_writer *w,
+	enum isl_binary_kind kind, size_t *size)
+{
+	int i;
+	struct isl_binary_buf ids = { NULL, 0, 0 };
+	struct isl_binary_buf out = { NULL, 0, 0 };
+	isl_ctx *ctx = w->ctx;
+
+	if (w->error)
+		goto error;
+
+	if (buf_put_uint(ctx, &ids, w->n_id) < 0)
+		goto error;
+	for (i = 0; i < w->n_id; ++i)
+		if (buf_put_string(ctx, &ids,
+				isl_id_get_name(w->ids[i])) < 0)
+			goto error;
+	if (buf_put_uint(ctx, &ids, w->n_space) < 0)
+		goto error;
+
+	if (buf_put_bytes(ctx, &out, "ISLB", 4) < 0 ||
+	    buf_put_byte(ctx, &out, ISL_BINARY_VERSION) < 0 ||
+	    buf_put_byte(ctx, &out, kind) < 0 ||
+	    buf_put_uint(ctx, &out,
+			ids.len + w->space_buf.len + w->body.len) < 0 ||
+	    buf_put_bytes(ctx, &out, ids.data, ids.len) < 0 ||
+	    buf_put_bytes(ctx, &out, w->space_buf.data,
+			w->space_buf.len) < 0 ||
+	    buf_put_bytes(ctx, &out, w->body.data, w->body.len) < 0)
+		goto error;
+
+	free(ids.data);
+	writer_clear(w);
+	if (size)
+		*size = out.len;
+	return out.data;
+error:
+	free(ids.data);
+	free(out.data);
+	writer_clear(w);
+	return NULL;
+}
+
+/* Write "data" of size "size" to "out" and free it.
+ */
+static isl_stat write_file(isl_ctx *ctx, void *data, size_t size, FILE *out)
+{
+	size_t written;
+
+	if (!data)
+		return isl_stat_error;
+	written = fwrite(data, 1, size, out);
+	free(data);
+	if (written != size)
+		isl_die(ctx, isl_error_unknown, "unable to write binary data",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Return a binary representation of "bmap", storing its size in "size".
+ * The caller is responsible for freeing the result.
+ */
+void *isl_basic_map_to_binary(__isl_keep isl_basic_map *bmap, size_t *size)
+{
+	struct isl_binary_writer w;
+
+	if (!bmap)
+		return NULL;
+	writer_init(&w, isl_basic_map_get_ctx(bmap));
+	writer_put_basic_map(&w, bmap);
+	return writer_finish(&w, isl_binary_basic_map, size);
+}
+
+void *isl_basic_set_to_binary(__isl_keep isl_basic_set *bset, size_t *size)
+{
+	return isl_basic_map_to_binary(bset_to_bmap(bset), size);
+}
+
+/* Return a binary representation of "map", storing its size in "size".
+ * The caller is responsible for freeing the result.
+ */
+void *isl_map_to_binary(__isl_keep isl_map *map, size_t *size)
+{
+	struct isl_binary_writer w;
+
+	if (!map)
+		return NULL;
+	writer_init(&w, isl_map_get_ctx(map));
+	writer_put_map(&w, map);
+	return writer_finish(&w, isl_binary_map, size);
+}
+
+void *isl_set_to_binary(__isl_keep isl_set *set, size_t *size)
+{
+	return isl_map_to_binary(set_to_map(set), size);
+}
+
+/* Return a binary representation of "umap", storing its size in "size".
+ * The caller is responsible for freeing the result.
+ */
+void *isl_union_map_to_binary(__isl_keep isl_union_map *umap, size_t *size)
+{
+	struct isl_binary_writer w;
+
+	if (!umap)
+		return NULL;
+	writer_init(&w, isl_union_map_get_ctx(umap));
+	writer_put_union_map(&w, umap);
+	return writer_finish(&w, isl_binary_union_map, size);
+}
+
+void *isl_union_set_to_binary(__isl_keep isl_union_set *uset, size_t *size)
+{
+	return isl_union_map_to_binary(uset_to_umap(uset), size);
+}
+
+/* Return a binary representation of "pma", storing its size in "size".
+ * The caller is responsible for freeing the result.
+ */
+void *isl_pw_multi_aff_to_binary(__isl_keep isl_pw_multi_aff *pma,
+	size_t *size)
+{
+	struct isl_binary_writer w;
+
+	if (!pma)
+		return NULL;
+	writer_init(&w, isl_pw_multi_aff_get_ctx(pma));
+	writer_put_pw_multi_aff(&w, pma);
+	return writer_finish(&w, isl_binary_pw_multi_aff, size);
+}
+
+/* Return a binary representation of "schedule", storing its size in "size".
+ * The caller is responsible for freeing the result.
+ */
+void *isl_schedule_to_binary(__isl_keep isl_schedule *schedule, size_t *size)
+{
+	struct isl_binary_writer w;
+
+	if (!schedule)
+		return NULL;
+	writer_init(&w, isl_schedule_get_ctx(schedule));
+	writer_put_schedule_tree(&w, schedule->root, 0);
+	return writer_finish(&w, isl_binary_schedule, size);
+}
+
+/* Return a binary representation of "info", storing its size in "size".
+ * The caller is responsible for freeing the result.
+ */
+void *isl_union_access_info_to_binary(__isl_keep isl_union_access_info *info,
+	size_t *size)
+{
+	struct isl_binary_writer w;
+
+	if (!info)
+		return NULL;
+	writer_init(&w, isl_union_access_info_get_ctx(info));
+	writer_put_union_access_info(&w, info);
+	return writer_finish(&w, isl_binary_union_access_info, size);
+}
+
+isl_stat isl_basic_map_write_binary_file(__isl_keep isl_basic_map *bmap,
+	FILE *out)
+{
+	size_t size;
+	void *data;
+
+	data = isl_basic_map_to_binary(bmap, &size);
+	return write_file(isl_basic_map_get_ctx(bmap), data, size, out);
+}
+
+isl_stat isl_basic_set_write_binary_file(__isl_keep isl_basic_set *bset,
+	FILE *out)
+{
+	return isl_basic_map_write_binary_file(bset_to_bmap(bset), out);
+}
+
+isl_stat isl_map_write_binary_file(__isl_keep isl_map *map, FILE *out)
+{
+	size_t size;
+	void *data;
+
+	data = isl_map_to_binary(map, &size);
+	return write_file(isl_map_get_ctx(map), data, size, out);
+}
+
+isl_stat isl_set_write_binary_file(__isl_keep isl_set *set, FILE *out)
+{
+	return isl_map_write_binary_file(set_to_map(set), out);
+}
+
+isl_stat isl_union_map_write_binary_file(__isl_keep isl_union_map *umap,
+	FILE *out)
+{
+	size_t size;
+	void *data;
+
+	data = isl_union_map_to_binary(umap, &size);
+	return write_file(isl_union_map_get_ctx(umap), data, size, out);
+}
+
+isl_stat isl_union_set_write_binary_file(__isl_keep isl_union_set *uset,
+	FILE *out)
+{
+	return isl_union_map_write_binary_file(uset_to_umap(uset), out);
+}
+
+isl_stat isl_pw_multi_aff_write_binary_file(__isl_keep isl_pw_multi_aff *pma,
+	FILE *out)
+{
+	size_t size;
+	void *data;
+
+	data = isl_pw_multi_aff_to_binary(pma, &size);
+	return write_file(isl_pw_multi_aff_get_ctx(pma), data, size, out);
+}
+
+isl_stat isl_schedule_write_binary_file(__isl_keep isl_schedule *schedule,
+	FILE *out)
+{
+	size_t size;
+	void *data;
+
+	data = isl_schedule_to_binary(schedule, &size);
+	return write_file(isl_schedule_get_ctx(schedule), data, size, out);
+}
+
+isl_stat isl_union_access_info_write_binary_file(
+	__isl_keep isl_union_access_info *info, FILE *out)
+{
+	size_t size;
+	void *data;
+
+	data = isl_union_access_info_to_binary(info, &size);
+	return write_file(isl_union_access_info_get_ctx(info), data, size, out);
+}
+
+static void reader_clear(struct isl_binary_reader *r)
+{
+	int i;
+
+	for (i = 0; i < r->n_id; ++i)
+		isl_id_free(r->ids[i]);
+	free(r->ids);
+	for (i = 0; i < r->n_space; ++i)
+		isl_space_free(r->spaces[i]);
+	free(r->spaces);
+}
+
+static isl_stat truncated(struct isl_binary_reader *r)
+{
+	isl_die(r->ctx, isl_error_invalid, "truncated binary input",
+		return isl_stat_error);
+}
+
+static isl_stat reader_get_byte(struct isl_binary_reader *r, int *c)
+{
+	if (r->p >= r->end)
+		return truncated(r);
+	*c = *r->p++;
+	return isl_stat_ok;
+}
+
+/* Read a boolean value, stored in a single byte, from "r".
+ */
+static isl_stat reader_get_bool(struct isl_binary_reader *r, int *b)
+{
+	if (reader_get_byte(r, b) < 0)
+		return isl_stat_error;
+	if (*b > 1)
+		isl_die(r->ctx, isl_error_invalid,
+			"invalid boolean in binary input",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Read an unsigned integer in variable length encoding from "r".
+ */
+static isl_stat reader_get_uint(struct isl_binary_reader *r,
+	unsigned long *u)
+{
+	int shift = 0;
+
+	*u = 0;
+	for (;;) {
+		unsigned char c;
+
+		if (r->p >= r->end)
+			return truncated(r);
+		if (shift >= 8 * sizeof(unsigned long))
+			isl_die(r->ctx, isl_error_invalid,
+				"integer too large in binary input",
+				return isl_stat_error);
+		c = *r->p++;
+		*u |= (unsigned long) (c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return isl_stat_ok;
+		shift += 7;
+	}
+}
+
+/* Read an unsigned integer from "r" that should be at most "max".
+ */
+static isl_stat reader_get_bounded(struct isl_binary_reader *r, int *v,
+	unsigned long max)
+{
+	unsigned long u;
+
+	if (reader_get_uint(r, &u) < 0)
+		return isl_stat_error;
+	if (u > max)
+		isl_die(r->ctx, isl_error_invalid,
+			"invalid value in binary input",
+			return isl_stat_error);
+	*v = u;
+	return isl_stat_ok;
+}
+
+/* Read a coefficient from "r" and store it in "v".
+ */
+static isl_stat reader_get_int(struct isl_binary_reader *r, isl_int v)
+{
+	unsigned long u, n;
+	isl_val *val;
+
+	if (reader_get_uint(r, &u) < 0)
+		return isl_stat_error;
+	if (!(u & 1)) {
+		u >>= 1;
+		if (u & 1)
+			isl_int_set_si(v, -(long) (u >> 1) - 1);
+		else
+			isl_int_set_si(v, (long) (u >> 1));
+		return isl_stat_ok;
+	}
+
+	n = u >> 2;
+	if (n > (unsigned long) (r->end - r->p))
+		return truncated(r);
+	val = isl_val_int_from_chunks(r->ctx, n, 1, r->p);
+	r->p += n;
+	if (!val)
+		return isl_stat_error;
+	if (u & 2)
+		isl_int_neg(v, val->n);
+	else
+		isl_int_set(v, val->n);
+	isl_val_free(val);
+	return isl_stat_ok;
+}
+
+/* Read a reference to an identifier from "r".
+ * Return NULL if the reference refers to no identifier.
+ * The caller needs to check for errors using "error".
+ */
+static __isl_give isl_id *reader_get_id(struct isl_binary_reader *r,
+	int *error)
+{
+	int i;
+
+	if (reader_get_bounded(r, &i, r->n_id) < 0) {
+		*error = 1;
+		return NULL;
+	}
+	if (i == 0)
+		return NULL;
+	return isl_id_copy(r->ids[i - 1]);
+}
+
+/* Set the identifier of the tuple of "space" of type "type", or
+ * of the dimension at position "pos" if it is not negative,
+ * to the identifier read from "r", if any.
+ */
+static __isl_give isl_space *reader_set_id(struct isl_binary_reader *r,
+	__isl_take isl_space *space, enum isl_dim_type type, int pos)
+{
+	int error = 0;
+	isl_id *id;
+
+	id = reader_get_id(r, &error);
+	if (error)
+		return isl_space_free(space);
+	if (!id)
+		return space;
+	if (pos < 0)
+		return isl_space_set_tuple_id(space, type, id);
+	return isl_space_set_dim_id(space, type, pos, id);
+}
+
+/* Read the encoding of a tuple from "r", as written by writer_put_tuple,
+ * and return a set space with this tuple and the parameters of "params".
+ * "depth" is the number of wrapped spaces in which this tuple is nested.
+ */
+static __isl_give isl_space *reader_get_tuple(struct isl_binary_reader *r,
+	__isl_keep isl_space *params, int depth)
+{
+	int i, n, error = 0;
+	int wrapping;
+	isl_id *id;
+	isl_space *space;
+
+	id = reader_get_id(r, &error);
+	if (error || reader_get_byte(r, &wrapping) < 0)
+		goto error;
+	if (wrapping && depth >= ISL_BINARY_MAX_NESTING)
+		isl_die(r->ctx, isl_error_invalid,
+			"space too deeply nested in binary input", goto error);
+	if (wrapping) {
+		isl_space *dom, *ran;
+
+		dom = reader_get_tuple(r, params, depth + 1);
+		ran = reader_get_tuple(r, params, depth + 1);
+		space = isl_space_map_from_domain_and_range(dom, ran);
+		space = isl_space_wrap(space);
+	} else {
+		if (reader_get_bounded(r, &n, r->end - r->p) < 0)
+			goto error;
+		space = isl_space_set_from_params(isl_space_copy(params));
+		space = isl_space_add_dims(space, isl_dim_set, n);
+		for (i = 0; i < n; ++i)
+			space = reader_set_id(r, space, isl_dim_set, i);
+	}
+	if (id)
+		space = isl_space_set_tuple_id(space, isl_dim_set, id);
+	return space;
+error:
+	isl_id_free(id);
+	return NULL;
+}
+
+/* Read the encoding of a space from "r", as written by writer_space.
+ */
+static __isl_give isl_space *reader_get_space(struct isl_binary_reader *r)
+{
+	int i, kind, nparam;
+	isl_space *params, *space;
+
+	if (reader_get_byte(r, &kind) < 0 ||
+	    reader_get_bounded(r, &nparam, r->end - r->p) < 0)
+		return NULL;
+	if (kind > 2)
+		isl_die(r->ctx, isl_error_invalid,
+			"invalid space in binary input", return NULL);
+	params = isl_space_params_alloc(r->ctx, nparam);
+	for (i = 0; i < nparam; ++i)
+		params = reader_set_id(r, params, isl_dim_param, i);
+	if (!params)
+		return NULL;
+	if (kind == 0)
+		return params;
+	if (kind == 1) {
+		space = reader_get_tuple(r, params, 0);
+	} else {
+		isl_space *dom, *ran;
+
+		dom = reader_get_tuple(r, params, 0);
+		ran = reader_get_tuple(r, params, 0);
+		space = isl_space_map_from_domain_and_range(dom, ran);
+	}
+	isl_space_free(params);
+	return space;
+}
+
+/* Read the identifier and space tables from "r".
+ */
+static isl_stat reader_get_tables(struct isl_binary_reader *r)
+{
+	int i, n;
+
+	if (reader_get_bounded(r, &n, r->end - r->p) < 0)
+		return isl_stat_error;
+	r->ids = isl_calloc_array(r->ctx, isl_id *, n);
+	if (n && !r->ids)
+		return isl_stat_error;
+	for (i = 0; i < n; ++i) {
+		int len;
+		char *name = NULL;
+
+		if (reader_get_bounded(r, &len, 1 + (r->end - r->p)) < 0)
+			return isl_stat_error;
+		if (len > 0) {
+			name = isl_alloc_array(r->ctx, char, len);
+			if (!name)
+				return isl_stat_error;
+			memcpy(name, r->p, len - 1);
+			name[len - 1] = '\0';
+			r->p += len - 1;
+		}
+		r->ids[i] = isl_id_alloc(r->ctx, name, NULL);
+		free(name);
+		if (!r->ids[i])
+			return isl_stat_error;
+		r->n_id = i + 1;
+	}
+
+	if (reader_get_bounded(r, &n, r->end - r->p) < 0)
+		return isl_stat_error;
+	r->spaces = isl_calloc_array(r->ctx, isl_space *, n);
+	if (n && !r->spaces)
+		return isl_stat_error;
+	for (i = 0; i < n; ++i) {
+		r->spaces[i] = reader_get_space(r);
+		if (!r->spaces[i])
+			return isl_stat_error;
+		r->n_space = i + 1;
+	}
+
+	return isl_stat_ok;
+}
+
+/* Read a reference to a space from "r" and return a copy of the space.
+ */
+static __isl_give isl_space *reader_space(struct isl_binary_reader *r)
+{
+	int i;
+
+	if (r->n_space == 0)
+		isl_die(r->ctx, isl_error_invalid,
+			"missing space in binary input", return NULL);
+	if (reader_get_bounded(r, &i, r->n_space - 1) < 0)
+		return NULL;
+	return isl_space_copy(r->spaces[i]);
+}
+
+/* Read a row of "n" coefficients from "r" into "row".
+ */
+static isl_stat reader_get_row(struct isl_binary_reader *r, isl_int *row,
+	int n)
+{
+	int i;
+
+	for (i = 0; i < n; ++i)
+		if (reader_get_int(r, row[i]) < 0)
+			return isl_stat_error;
+	return isl_stat_ok;
+}
+
+/* Check that "n" rows of "len" coefficients each can be read from "r".
+ * Since each coefficient takes up at least one byte,
+ * the input needs to contain at least n * len more bytes.
+ * This check is performed before allocating memory for the rows
+ * such that a small input cannot trigger a large allocation.
+ */
+static isl_stat reader_check_rows(struct isl_binary_reader *r,
+	unsigned long n, unsigned long len)
+{
+	if (len != 0 && n > (unsigned long) (r->end - r->p) / len)
+		isl_die(r->ctx, isl_error_invalid,
+			"invalid number of rows in binary input",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Check that the explicit representation "row" of local variable "div"
+ * out of "n_div" local variables in a space of dimension "dim",
+ * which has been read from binary input, is valid, if any.
+ * That is, check that the denominator is not negative and
+ * that the representation of a local variable with a non-zero
+ * denominator only involves earlier local variables.
+ * A zero denominator marks a local variable without
+ * explicit representation, as written by writer_put_basic_map_body.
+ */
+static isl_stat check_div(isl_ctx *ctx, isl_int *row, int div, int dim,
+	int n_div)
+{
+	if (isl_int_is_neg(row[0]))
+		isl_die(ctx, isl_error_invalid,
+			"negative denominator in binary input",
+			return isl_stat_error);
+	if (isl_int_is_zero(row[0]))
+		return isl_stat_ok;
+	if (isl_seq_first_non_zero(row + 2 + dim + div, n_div - div) != -1)
+		isl_die(ctx, isl_error_invalid,
+			"local variable depends on itself or "
+			"later local variable in binary input",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Read the encoding of a basic map in "space" from "r",
+ * as written by writer_put_basic_map_body.
+ * The explicit representations of the local variables are checked
+ * for validity since they are not necessarily produced by isl.
+ */
+static __isl_give isl_basic_map *reader_get_basic_map_body(
+	struct isl_binary_reader *r, __isl_take isl_space *space)
+{
+	int i, k;
+	int n_div, n_eq, n_ineq, rational;
+	isl_size dim;
+	unsigned long max = r->end - r->p;
+	isl_basic_map *bmap;
+
+	dim = isl_space_dim(space, isl_dim_all);
+	if (dim < 0 ||
+	    reader_get_bounded(r, &n_div, max) < 0 ||
+	    reader_get_bounded(r, &n_eq, max) < 0 ||
+	    reader_get_bounded(r, &n_ineq, max) < 0 ||
+	    reader_get_byte(r, &rational) < 0 ||
+	    reader_check_rows(r, n_div, 2 + (unsigned long) dim + n_div) < 0 ||
+	    reader_check_rows(r, (unsigned long) n_eq + n_ineq,
+				1 + (unsigned long) dim + n_div) < 0) {
+		isl_space_free(space);
+		return NULL;
+	}
+
+	bmap = isl_basic_map_alloc_space(space, n_div, n_eq, n_ineq);
+	for (i = 0; bmap && i < n_div; ++i) {
+		k = isl_basic_map_alloc_div(bmap);
+		if (k < 0 ||
+		    reader_get_row(r, bmap->div[k], 2 + dim + n_div) < 0)
+			bmap = isl_basic_map_free(bmap);
+	}
+	for (i = 0; bmap && i < n_div; ++i)
+		if (check_div(r->ctx, bmap->div[i], i, dim, n_div) < 0)
+			bmap = isl_basic_map_free(bmap);
+	for (i = 0; bmap && i < n_eq; ++i) {
+		k = isl_basic_map_alloc_equality(bmap);
+		if (k < 0 ||
+		    reader_get_row(r, bmap->eq[k], 1 + dim + n_div) < 0)
+			bmap = isl_basic_map_free(bmap);
+	}
+	for (i = 0; bmap && i < n_ineq; ++i) {
+		k = isl_basic_map_alloc_inequality(bmap);
+		if (k < 0 ||
+		    reader_get_row(r, bmap->ineq[k], 1 + dim + n_div) < 0)
+			bmap = isl_basic_map_free(bmap);
+	}
+	if (bmap && rational)
+		bmap = isl_basic_map_set_rational(bmap);
+	bmap = isl_basic_map_simplify(bmap);
+	bmap = isl_basic_map_finalize(bmap);
+
+	return bmap;
+}
+
+static __isl_give isl_basic_map *reader_get_basic_map(
+	struct isl_binary_reader *r)
+{
+	return reader_get_basic_map_body(r, reader_space(r));
+}
+
+/* Read the encoding of a map from "r", as written by writer_put_map.
+ */
+static __isl_give isl_map *reader_get_map(struct isl_binary_reader *r)
+{
+	int i, n;
+	isl_space *space;
+	isl_map *map;
+
+	space = reader_space(r);
+	if (!space || reader_get_bounded(r, &n, r->end - r->p) < 0) {
+		isl_space_free(space);
+		return NULL;
+	}
+
+	map = isl_map_alloc_space(isl_space_copy(space), n, 0);
+	for (i = 0; map && i < n; ++i) {
+		isl_basic_map *bmap;
+
+		bmap = reader_get_basic_map_body(r, isl_space_copy(space));
+		map = isl_map_add_basic_map(map, bmap);
+	}
+	isl_space_free(space);
+
+	return map;
+}
+
+/* Read the encoding of a union map from "r",
+ * as written by writer_put_union_map.
+ */
+static __isl_give isl_union_map *reader_get_union_map(
+	struct isl_binary_reader *r)
+{
+	int i, n;
+	isl_union_map *umap;
+
+	umap = isl_union_map_empty(reader_space(r));
+	if (reader_get_bounded(r, &n, r->end - r->p) < 0)
+		return isl_union_map_free(umap);
+	for (i = 0; umap && i < n; ++i)
+		umap = isl_union_map_add_map(umap, reader_get_map(r));
+
+	return umap;
+}
+
+/* Read the encoding of a set from "r", as written by writer_put_map.
+ */
+static __isl_give isl_set *reader_get_set(struct isl_binary_reader *r)
+{
+	isl_map *map;
+	isl_bool is_set;
+
+	map = reader_get_map(r);
+	is_set = isl_space_is_set(isl_map_peek_space(map));
+	if (is_set < 0)
+		return set_from_map(isl_map_free(map));
+	if (!is_set)
+		isl_die(r->ctx, isl_error_invalid, "expecting set",
+			return set_from_map(isl_map_free(map)));
+	return set_from_map(map);
+}
+
+/* isl_union_map_every_map callback that checks whether "map" is a set.
+ */
+static isl_bool map_is_set(__isl_keep isl_map *map, void *user)
+{
+	return isl_space_is_set(isl_map_peek_space(map));
+}
+
+/* Read the encoding of a union set from "r",
+ * as written by writer_put_union_map.
+ */
+static __isl_give isl_union_set *reader_get_union_set(
+	struct isl_binary_reader *r)
+{
+	isl_union_map *umap;
+	isl_bool is_set;
+
+	umap = reader_get_union_map(r);
+	is_set = isl_union_map_every_map(umap, &map_is_set, NULL);
+	if (is_set < 0)
+		return isl_union_map_free(umap);
+	if (!is_set)
+		isl_die(r->ctx, isl_error_invalid, "expecting union set",
+			return isl_union_map_free(umap));
+	return uset_from_umap(umap);
+}
+
+/* Read the encoding of an affine expression on the domain "space" from "r",
+ * as written by writer_put_aff_body.
+ * As in reader_get_basic_map_body, the explicit representations
+ * of the local variables are checked for validity.
+ * Local variables without explicit representation are rejected
+ * by isl_aff_alloc_vec.
+ */
+static __isl_give isl_aff *reader_get_aff_body(struct isl_binary_reader *r,
+	__isl_keep isl_space *space)
+{
+	int i;
+	int n_div;
+	isl_size dim;
+	isl_mat *div;
+	isl_vec *v;
+	isl_local_space *ls;
+
+	dim = isl_space_dim(space, isl_dim_all);
+	if (dim < 0 || reader_get_bounded(r, &n_div, r->end - r->p) < 0 ||
+	    reader_check_rows(r, 1 + (unsigned long) n_div,
+				2 + (unsigned long) dim + n_div) < 0)
+		return NULL;
+
+	div = isl_mat_alloc(r->ctx, n_div, 2 + dim + n_div);
+	for (i = 0; div && i < n_div; ++i)
+		if (reader_get_row(r, div->row[i], 2 + dim + n_div) < 0 ||
+		    check_div(r->ctx, div->row[i], i, dim, n_div) < 0)
+			div = isl_mat_free(div);
+	v = isl_vec_alloc(r->ctx, 2 + dim + n_div);
+	if (div && v && reader_get_row(r, v->el, v->size) < 0)
+		v = isl_vec_free(v);
+	if (v && isl_int_is_neg(v->el[0])) {
+		isl_vec_free(v);
+		isl_mat_free(div);
+		isl_die(r->ctx, isl_error_invalid,
+			"negative denominator in binary input", return NULL);
+	}
+	ls = isl_local_space_alloc_div(isl_space_copy(space), div);
+	return isl_aff_alloc_vec(ls, v);
+}
+
+/* Read the encoding of a multi affine expression from "r",
+ * as written by writer_put_multi_aff.
+ */
+static __isl_give isl_multi_aff *reader_get_multi_aff(
+	struct isl_binary_reader *r)
+{
+	int i;
+	isl_size n;
+	isl_space *space, *domain;
+	isl_multi_aff *ma;
+
+	space = reader_space(r);
+	domain = isl_space_domain(isl_space_copy(space));
+	ma = isl_multi_aff_zero(space);
+	n = isl_multi_aff_size(ma);
+	if (n < 0)
+		ma = isl_multi_aff_free(ma);
+	for (i = 0; ma && i < n; ++i)
+		ma = isl_multi_aff_set_at(ma, i, reader_get_aff_body(r, domain));
+	isl_space_free(domain);
+
+	return ma;
+}
+
+/* Check that the cell "set" of a piecewise expression read from "r"
+ * is disjoint from the union "dom" of the earlier cells and
+ * add it to "dom".
+ * The cells of a piecewise expression need to be disjoint,
+ * but this is not guaranteed for input that was not produced by isl.
+ */
+static isl_stat reader_add_cell(struct isl_binary_reader *r,
+	isl_set **dom, __isl_keep isl_set *set)
+{
+	isl_bool disjoint;
+
+	disjoint = isl_set_is_disjoint(*dom, set);
+	if (disjoint < 0)
+		return isl_stat_error;
+	if (!disjoint)
+		isl_die(r->ctx, isl_error_invalid,
+			"overlapping cells in binary input",
+			return isl_stat_error);
+	*dom = isl_set_union_disjoint(*dom, isl_set_copy(set));
+	return *dom ? isl_stat_ok : isl_stat_error;
+}
+
+/* Read the encoding of a piecewise multi affine expression from "r",
+ * as written by writer_put_pw_multi_aff.
+ * The cells are added in the order in which they were written,
+ * keeping track of their union in "dom".
+ */
+static __isl_give isl_pw_multi_aff *reader_get_pw_multi_aff(
+	struct isl_binary_reader *r)
+{
+	int i, n;
+	isl_set *dom;
+	isl_pw_multi_aff *pma;
+
+	pma = isl_pw_multi_aff_empty(reader_space(r));
+	dom = isl_set_empty(isl_pw_multi_aff_get_domain_space(pma));
+	if (reader_get_bounded(r, &n, r->end - r->p) < 0)
+		pma = isl_pw_multi_aff_free(pma);
+	for (i = 0; pma && i < n; ++i) {
+		isl_set *set;
+		isl_multi_aff *ma;
+
+		set = set_from_map(reader_get_map(r));
+		ma = reader_get_multi_aff(r);
+		if (reader_add_cell(r, &dom, set) < 0)
+			pma = isl_pw_multi_aff_free(pma);
+		pma = isl_pw_multi_aff_add_disjoint(pma,
+					isl_pw_multi_aff_alloc(set, ma));
+	}
+	isl_set_free(dom);
+
+	return pma;
+}
+
+/* Read the encoding of a piecewise affine expression from "r",
+ * as written by writer_put_pw_aff.
+ * As in reader_get_pw_multi_aff, the cells are checked to be disjoint.
+ */
+static __isl_give isl_pw_aff *reader_get_pw_aff(struct isl_binary_reader *r)
+{
+	int i, n;
+	isl_size n_out;
+	isl_space *space;
+	isl_set *dom;
+	isl_pw_aff *pa;
+
+	space = reader_space(r);
+	n_out = isl_space_dim(space, isl_dim_out);
+	if (n_out >= 0 && n_out != 1)
+		isl_die(r->ctx, isl_error_invalid,
+			"expecting single output in binary input",
+			space = isl_space_free(space));
+	pa = isl_pw_aff_empty(isl_space_copy(space));
+	space = isl_space_domain(space);
+	dom = isl_set_empty(isl_space_copy(space));
+	if (reader_get_bounded(r, &n, r->end - r->p) < 0)
+		pa = isl_pw_aff_free(pa);
+	for (i = 0; pa && i < n; ++i) {
+		isl_set *set;
+		isl_aff *aff;
+
+		set = set_from_map(reader_get_map(r));
+		aff = reader_get_aff_body(r, space);
+		if (reader_add_cell(r, &dom, set) < 0)
+			pa = isl_pw_aff_free(pa);
+		pa = isl_pw_aff_add_disjoint(pa, isl_pw_aff_alloc(set, aff));
+	}
+	isl_set_free(dom);
+	isl_space_free(space);
+
+	return pa;
+}
+
+/* Read the encoding of a union piecewise affine expression from "r",
+ * as written by writer_put_union_pw_aff.
+ */
+static __isl_give isl_union_pw_aff *reader_get_union_pw_aff(
+	struct isl_binary_reader *r)
+{
+	int i, n;
+	isl_union_pw_aff *upa;
+
+	upa = isl_union_pw_aff_empty(reader_space(r));
+	if (reader_get_bounded(r, &n, r->end - r->p) < 0)
+		return isl_union_pw_aff_free(upa);
+	for (i = 0; upa && i < n; ++i)
+		upa = isl_union_pw_aff_add_pw_aff(upa, reader_get_pw_aff(r));
+
+	return upa;
+}
+
+/* Read the encoding of a multi union piecewise affine expression from "r",
+ * as written by writer_put_multi_union_pw_aff.
+ */
+static __isl_give isl_multi_union_pw_aff *reader_get_multi_union_pw_aff(
+	struct isl_binary_reader *r)
+{
+	int i;
+	isl_size n;
+	isl_space *space;
+	isl_union_pw_aff_list *list;
+	isl_multi_union_pw_aff *mupa;
+
+	space = reader_space(r);
+	if (isl_space_check_is_set(space) < 0)
+		space = isl_space_free(space);
+	n = isl_space_dim(space, isl_dim_set);
+	if (n < 0) {
+		isl_space_free(space);
+		return NULL;
+	}
+	list = isl_union_pw_aff_list_alloc(r->ctx, n);
+	for (i = 0; list && i < n; ++i)
+		list = isl_union_pw_aff_list_add(list,
+						reader_get_union_pw_aff(r));
+	mupa = isl_multi_union_pw_aff_from_union_pw_aff_list(space, list);
+	if (mupa && n == 0)
+		mupa = isl_multi_union_pw_aff_intersect_domain(mupa,
+						reader_get_union_set(r));
+
+	return mupa;
+}
+
+/* Read the encoding of a union piecewise multi affine expression from "r",
+ * as written by writer_put_union_pw_multi_aff.
+ */
+static __isl_give isl_union_pw_multi_aff *reader_get_union_pw_multi_aff(
+	struct isl_binary_reader *r)
+{
+	int i, n;
+	isl_union_pw_multi_aff *upma;
+
+	upma = isl_union_pw_multi_aff_empty(reader_space(r));
+	if (reader_get_bounded(r, &n, r->end - r->p) < 0)
+		return isl_union_pw_multi_aff_free(upma);
+	for (i = 0; upma && i < n; ++i)
+		upma = isl_union_pw_multi_aff_add_pw_multi_aff(upma,
+						reader_get_pw_multi_aff(r));
+
+	return upma;
+}
+
+/* Read the encoding of a band from "r", as written by writer_put_band.
+ */
+static __isl_give isl_schedule_band *reader_get_band(
+	struct isl_binary_reader *r)
+{
+	int i, permutable;
+	isl_size n;
+	isl_schedule_band *band;
+
+	band = isl_schedule_band_from_multi_union_pw_aff(
+					reader_get_multi_union_pw_aff(r));
+	n = isl_schedule_band_n_member(band);
+	if (n < 0 || reader_get_bool(r, &permutable) < 0)
+		return isl_schedule_band_free(band);
+	band = isl_schedule_band_set_permutable(band, permutable);
+	for (i = 0; band && i < n; ++i) {
+		int coincident;
+
+		if (reader_get_bool(r, &coincident) < 0)
+			return isl_schedule_band_free(band);
+		band = isl_schedule_band_member_set_coincident(band, i,
+								coincident);
+	}
+	if (!band)
+		return NULL;
+
+	return isl_schedule_band_set_ast_build_options(band,
+						reader_get_union_set(r));
+}
+
+static __isl_give isl_schedule_tree *reader_get_schedule_tree(
+	struct isl_binary_reader *r, int depth);
+
+/* Read the "n" children of a sequence or set node of type "type"
+ * at depth "depth" from "r" and return the corresponding tree.
+ * The children of such nodes are filter nodes in schedule trees
+ * constructed by isl, so the same is required of the input.
+ */
+static __isl_give isl_schedule_tree *reader_get_children(
+	struct isl_binary_reader *r, enum isl_schedule_node_type type, int n,
+	int depth)
+{
+	int i;
+	isl_schedule_tree_list *list;
+
+	if (n == 0)
+		isl_die(r->ctx, isl_error_invalid,
+			"missing children in binary input", return NULL);
+	list = isl_schedule_tree_list_alloc(r->ctx, n);
+	for (i = 0; list && i < n; ++i) {
+		isl_schedule_tree *child;
+
+		child = reader_get_schedule_tree(r, depth + 1);
+		if (child && isl_schedule_tree_get_type(child) !=
+						isl_schedule_node_filter)
+			isl_die(r->ctx, isl_error_invalid,
+				"expecting filter child in binary input",
+				child = isl_schedule_tree_free(child));
+		list = isl_schedule_tree_list_add(list, child);
+	}
+
+	return isl_schedule_tree_from_children(type, list);
+}
+
+/* Read the encoding of a schedule tree at depth "depth" from "r",
+ * as written by writer_put_schedule_tree.
+ *
+ * The information specific to the root node is read first and
+ * is then inserted on top of the single child, if any.
+ * Nodes other than leaves, sequences and sets have at most one child.
+ * Since the tree is read recursively, its depth is bounded.
+ */
+static __isl_give isl_schedule_tree *reader_get_schedule_tree(
+	struct isl_binary_reader *r, int depth)
+{
+	int type, n, error = 0;
+	isl_set *set = NULL;
+	isl_union_set *uset = NULL;
+	isl_union_map *umap = NULL;
+	isl_union_pw_multi_aff *upma = NULL;
+	isl_schedule_band *band = NULL;
+	isl_id *mark = NULL;
+	isl_schedule_tree *tree = NULL;
+
+	if (depth >= ISL_BINARY_MAX_TREE_DEPTH)
+		isl_die(r->ctx, isl_error_invalid,
+			"schedule tree too deep in binary input", return NULL);
+	if (reader_get_byte(r, &type) < 0)
+		return NULL;
+	switch (type) {
+	case isl_schedule_node_band:
+		band = reader_get_band(r);
+		error = !band;
+		break;
+	case isl_schedule_node_context:
+	case isl_schedule_node_guard:
+		set = reader_get_set(r);
+		error = !set;
+		break;
+	case isl_schedule_node_domain:
+	case isl_schedule_node_filter:
+		uset = reader_get_union_set(r);
+		error = !uset;
+		break;
+	case isl_schedule_node_expansion:
+		upma = reader_get_union_pw_multi_aff(r);
+		umap = upma ? reader_get_union_map(r) : NULL;
+		error = !umap;
+		break;
+	case isl_schedule_node_extension:
+		umap = reader_get_union_map(r);
+		error = !umap;
+		break;
+	case isl_schedule_node_mark:
+		mark = reader_get_id(r, &error);
+		if (!error && !mark)
+			isl_die(r->ctx, isl_error_invalid,
+				"missing mark identifier in binary input",
+				error = 1);
+		break;
+	case isl_schedule_node_leaf:
+	case isl_schedule_node_sequence:
+	case isl_schedule_node_set:
+		break;
+	default:
+		isl_die(r->ctx, isl_error_invalid,
+			"invalid schedule tree node type in binary input",
+			return NULL);
+	}
+	if (!error && reader_get_bounded(r, &n, r->end - r->p) < 0)
+		error = 1;
+	if (!error && type != isl_schedule_node_sequence &&
+	    type != isl_schedule_node_set &&
+	    n > (type != isl_schedule_node_leaf))
+		isl_die(r->ctx, isl_error_invalid,
+			"invalid number of children in binary input",
+			error = 1);
+	if (!error && (type == isl_schedule_node_sequence ||
+			type == isl_schedule_node_set))
+		return reader_get_children(r, type, n, depth);
+	if (!error)
+		tree = n ? reader_get_schedule_tree(r, depth + 1) :
+			    isl_schedule_tree_leaf(r->ctx);
+	if (!tree)
+		goto error;
+
+	switch (type) {
+	case isl_schedule_node_band:
+		return isl_schedule_tree_insert_band(tree, band);
+	case isl_schedule_node_context:
+		return isl_schedule_tree_insert_context(tree, set);
+	case isl_schedule_node_guard:
+		return isl_schedule_tree_insert_guard(tree, set);
+	case isl_schedule_node_domain:
+		return isl_schedule_tree_insert_domain(tree, uset);
+	case isl_schedule_node_filter:
+		return isl_schedule_tree_insert_filter(tree, uset);
+	case isl_schedule_node_expansion:
+		return isl_schedule_tree_insert_expansion(tree, upma, umap);
+	case isl_schedule_node_extension:
+		return isl_schedule_tree_insert_extension(tree, umap);
+	case isl_schedule_node_mark:
+		return isl_schedule_tree_insert_mark(tree, mark);
+	}
+	return tree;
+error:
+	isl_set_free(set);
+	isl_union_set_free(uset);
+	isl_union_map_free(umap);
+	isl_union_pw_multi_aff_free(upma);
+	isl_schedule_band_free(band);
+	isl_id_free(mark);
+	return NULL;
+}
+
+/* Read the encoding of a schedule from "r",
+ * as written by writer_put_schedule_tree.
+ */
+static __isl_give isl_schedule *reader_get_schedule(
+	struct isl_binary_reader *r)
+{
+	return isl_schedule_from_schedule_tree(r->ctx,
+					reader_get_schedule_tree(r, 0));
+}
+
+/* Read the encoding of an isl_union_access_info object from "r",
+ * as written by writer_put_union_access_info.
+ */
+static __isl_give isl_union_access_info *reader_get_union_access_info(
+	struct isl_binary_reader *r)
+{
+	int has_schedule;
+	isl_union_access_info *info;
+
+	info = isl_union_access_info_from_sink(reader_get_union_map(r));
+	if (info)
+		info = isl_union_access_info_set_must_source(info,
+						reader_get_union_map(r));
+	if (info)
+		info = isl_union_access_info_set_may_source(info,
+						reader_get_union_map(r));
+	if (info)
+		info = isl_union_access_info_set_kill(info,
+						reader_get_union_map(r));
+	if (!info)
+		return NULL;
+	if (reader_get_bool(r, &has_schedule) < 0)
+		return isl_union_access_info_free(info);
+	if (has_schedule)
+		return isl_union_access_info_set_schedule(info,
+						reader_get_schedule(r));
+	return isl_union_access_info_set_schedule_map(info,
+						reader_get_union_map(r));
+}
+
+/* Read the header of an object of kind "kind" from "r" and
+ * restrict "r" to the payload.
+ */
+static isl_stat reader_get_header(struct isl_binary_reader *r,
+	enum isl_binary_kind kind)
+{
+	int version, read_kind;
+	unsigned long len;
+
+	if (r->end - r->p < 4)
+		return truncated(r);
+	if (memcmp(r->p, "ISLB", 4) != 0)
+		isl_die(r->ctx, isl_error_invalid, "not isl binary data",
+			return isl_stat_error);
+	r->p += 4;
+	if (reader_get_byte(r, &version) < 0 ||
+	    reader_get_byte(r, &read_kind) < 0 ||
+	    reader_get_uint(r, &len) < 0)
+		return isl_stat_error;
+	if (version != ISL_BINARY_VERSION)
+		isl_die(r->ctx, isl_error_unsupported,
+			"unsupported binary format version",
+			return isl_stat_error);
+	if (read_kind != kind)
+		isl_die(r->ctx, isl_error_invalid,
+			"unexpected kind of object in binary input",
+			return isl_stat_error);
+	if (len > (unsigned long) (r->end - r->p))
+		return truncated(r);
+	r->end = r->p + len;
+	return reader_get_tables(r);
+}
+
+/* Initialize "r" for reading the "size" bytes at "buf"
+ * and read the header of an object of kind "kind".
+ */
+static isl_stat reader_init(struct isl_binary_reader *r, isl_ctx *ctx,
+	const void *buf, size_t size, enum isl_binary_kind kind)
+{
+	memset(r, 0, sizeof(*r));
+	r->ctx = ctx;
+	if (!buf)
+		return isl_stat_error;
+	r->p = buf;
+	r->end = r->p + size;
+	return reader_get_header(r, kind);
+}
+
+/* Check that the entire payload of "r" has been consumed.
+ */
+static isl_stat reader_check_end(struct isl_binary_reader *r)
+{
+	if (r->p != r->end)
+		isl_die(r->ctx, isl_error_invalid,
+			"trailing data in binary input", return isl_stat_error);
+	return isl_stat_ok;
+}
+
+__isl_give isl_basic_map *isl_basic_map_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size)
+{
+	struct isl_binary_reader r;
+	isl_basic_map *bmap = NULL;
+
+	if (reader_init(&r, ctx, buf, size, isl_binary_basic_map) >= 0)
+		bmap = reader_get_basic_map(&r);
+	if (bmap && reader_check_end(&r) < 0)
+		bmap = isl_basic_map_free(bmap);
+	reader_clear(&r);
+
+	return bmap;
+}
+
+__isl_give isl_basic_set *isl_basic_set_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size)
+{
+	isl_basic_map *bmap;
+	isl_bool is_set;
+
+	bmap = isl_basic_map_read_from_binary(ctx, buf, size);
+	is_set = isl_space_is_set(isl_basic_map_peek_space(bmap));
+	if (is_set < 0)
+		return bset_from_bmap(isl_basic_map_free(bmap));
+	if (!is_set)
+		isl_die(ctx, isl_error_invalid, "expecting basic set",
+			return bset_from_bmap(isl_basic_map_free(bmap)));
+	return bset_from_bmap(bmap);
+}
+
+__isl_give isl_map *isl_map_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size)
+{
+	struct isl_binary_reader r;
+	isl_map *map = NULL;
+
+	if (reader_init(&r, ctx, buf, size, isl_binary_map) >= 0)
+		map = reader_get_map(&r);
+	if (map && reader_check_end(&r) < 0)
+		map = isl_map_free(map);
+	reader_clear(&r);
+
+	return map;
+}
+
+__isl_give isl_set *isl_set_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size)
+{
+	isl_map *map;
+	isl_bool is_set;
+
+	map = isl_map_read_from_binary(ctx, buf, size);
+	is_set = isl_space_is_set(isl_map_peek_space(map));
+	if (is_set < 0)
+		return set_from_map(isl_map_free(map));
+	if (!is_set)
+		isl_die(ctx, isl_error_invalid, "expecting set",
+			return set_from_map(isl_map_free(map)));
+	return set_from_map(map);
+}
+
+__isl_give isl_union_map *isl_union_map_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size)
+{
+	struct isl_binary_reader r;
+	isl_union_map *umap = NULL;
+
+	if (reader_init(&r, ctx, buf, size, isl_binary_union_map) >= 0)
+		umap = reader_get_union_map(&r);
+	if (umap && reader_check_end(&r) < 0)
+		umap = isl_union_map_free(umap);
+	reader_clear(&r);
+
+	return umap;
+}
+
+__isl_give isl_pw_multi_aff *isl_pw_multi_aff_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size)
+{
+	struct isl_binary_reader r;
+	isl_pw_multi_aff *pma = NULL;
+
+	if (reader_init(&r, ctx, buf, size, isl_binary_pw_multi_aff) >= 0)
+		pma = reader_get_pw_multi_aff(&r);
+	if (pma && reader_check_end(&r) < 0)
+		pma = isl_pw_multi_aff_free(pma);
+	reader_clear(&r);
+
+	return pma;
+}
+
+__isl_give isl_schedule *isl_schedule_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size)
+{
+	struct isl_binary_reader r;
+	isl_schedule *schedule = NULL;
+
+	if (reader_init(&r, ctx, buf, size, isl_binary_schedule) >= 0)
+		schedule = reader_get_schedule(&r);
+	if (schedule && reader_check_end(&r) < 0)
+		schedule = isl_schedule_free(schedule);
+	reader_clear(&r);
+
+	return schedule;
+}
+
+__isl_give isl_union_access_info *isl_union_access_info_read_from_binary(
+	isl_ctx *ctx, const void *buf, size_t size)
+{
+	struct isl_binary_reader r;
+	isl_union_access_info *info = NULL;
+
+	if (reader_init(&r, ctx, buf, size, isl_binary_union_access_info) >= 0)
+		info = reader_get_union_access_info(&r);
+	if (info && reader_check_end(&r) < 0)
+		info = isl_union_access_info_free(info);
+	reader_clear(&r);
+
+	return info;
+}
+
+__isl_give isl_union_set *isl_union_set_read_from_binary(isl_ctx *ctx,
+	const void *buf, size_t size)
+{
+	isl_union_map *umap;
+	isl_bool is_set;
+
+	umap = isl_union_map_read_from_binary(ctx, buf, size);
+	is_set = isl_union_map_every_map(umap, &map_is_set, NULL);
+	if (is_set < 0)
+		return isl_union_map_free(umap);
+	if (!is_set)
+		isl_die(ctx, isl_error_invalid, "expecting union set",
+			return isl_union_map_free(umap));
+	return uset_from_umap(umap);
+}
+
+/* Read a single object from "in", with the header of the object
+ * taking the same form as in reader_get_header.
+ * Return a buffer containing the entire object and
+ * store its size in "size".
+ * The caller is responsible for freeing the buffer.
+ */
+static void *read_file(isl_ctx *ctx, FILE *in, size_t *size)
+{
+	unsigned char header[6 + 2 * sizeof(unsigned long)];
+	unsigned char *data;
+	unsigned long len = 0;
+	size_t n = 6;
+	int shift = 0;
+
+	if (fread(header, 1, 6, in) != 6)
+		isl_die(ctx, isl_error_invalid, "unable to read binary header",
+			return NULL);
+	do {
+		int c;
+
+		if (n >= sizeof(header))
+			isl_die(ctx, isl_error_invalid,
+				"invalid binary header", return NULL);
+		c = fgetc(in);
+		if (c == EOF)
+			isl_die(ctx, isl_error_invalid,
+				"unable to read binary header", return NULL);
+		header[n++] = c;
+		len |= (unsigned long) (c & 0x7f) << shift;
+		shift += 7;
+	} while (header[n - 1] & 0x80);
+
+	data = isl_alloc_array(ctx, unsigned char, n + len);
+	if (!data)
+		return NULL;
+	memcpy(data, header, n);
+	if (fread(data + n, 1, len, in) != len) {
+		free(data);
+		isl_die(ctx, isl_error_invalid, "truncated binary input",
+			return NULL);
+	}
+	*size = n + len;
+	return data;
+}
+
+__isl_give isl_basic_map *isl_basic_map_read_from_binary_file(isl_ctx *ctx,
+	FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_basic_map *bmap;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	bmap = isl_basic_map_read_from_binary(ctx, data, size);
+	free(data);
+	return bmap;
+}
+
+__isl_give isl_basic_set *isl_basic_set_read_from_binary_file(isl_ctx *ctx,
+	FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_basic_set *bset;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	bset = isl_basic_set_read_from_binary(ctx, data, size);
+	free(data);
+	return bset;
+}
+
+__isl_give isl_map *isl_map_read_from_binary_file(isl_ctx *ctx, FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_map *map;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	map = isl_map_read_from_binary(ctx, data, size);
+	free(data);
+	return map;
+}
+
+__isl_give isl_set *isl_set_read_from_binary_file(isl_ctx *ctx, FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_set *set;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	set = isl_set_read_from_binary(ctx, data, size);
+	free(data);
+	return set;
+}
+
+__isl_give isl_union_map *isl_union_map_read_from_binary_file(isl_ctx *ctx,
+	FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_union_map *umap;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	umap = isl_union_map_read_from_binary(ctx, data, size);
+	free(data);
+	return umap;
+}
+
+__isl_give isl_union_set *isl_union_set_read_from_binary_file(isl_ctx *ctx,
+	FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_union_set *uset;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	uset = isl_union_set_read_from_binary(ctx, data, size);
+	free(data);
+	return uset;
+}
+
+__isl_give isl_pw_multi_aff *isl_pw_multi_aff_read_from_binary_file(
+	isl_ctx *ctx, FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_pw_multi_aff *pma;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	pma = isl_pw_multi_aff_read_from_binary(ctx, data, size);
+	free(data);
+	return pma;
+}
+
+__isl_give isl_schedule *isl_schedule_read_from_binary_file(isl_ctx *ctx,
+	FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_schedule *schedule;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	schedule = isl_schedule_read_from_binary(ctx, data, size);
+	free(data);
+	return schedule;
+}
+
+__isl_give isl_union_access_info *isl_union_access_info_read_from_binary_file(
+	isl_ctx *ctx, FILE *in)
+{
+	size_t size;
+	void *data;
+	isl_union_access_info *info;
+
+	data = read_file(ctx, in, &size);
+	if (!data)
+		return NULL;
+	info = isl_union_access_info_read_from_binary(ctx, data, size);
+	free(data);
+	return info;
+}
@@ -39,6 +39,10 @@ int isl_blk_is_error(struct isl_blk block)
 	return block.size == -1 && block.data == NULL;
 }
 
+/* Free "block", which is accounted to "ctx".
+ * Blocks kept in the cache of "ctx" remain accounted to "ctx"
+ * until they are freed by this function.
+ */
 static void isl_blk_free_force(struct isl_ctx *ctx, struct isl_blk block)
 {
 	int i;
@@ -46,19 +50,30 @@ static void isl_blk_free_force(struct isl_ctx *ctx, struct isl_blk block)
 	for (i = 0; i < block.size; ++i)
 		isl_int_clear(block.data[i]);
 	free(block.data);
+	isl_ctx_memory_release(ctx, block.size * sizeof(isl_int));
 }
 
+/* Extend "block" to hold at least "new_n" elements,
+ * accounting the extra memory to "ctx".
+ */
 static struct isl_blk extend(struct isl_ctx *ctx, struct isl_blk block,
 				size_t new_n)
 {
 	int i;
 	isl_int *p;
+	size_t extra;
 
 	if (block.size >= new_n)
 		return block;
 
+	extra = (new_n - block.size) * sizeof(isl_int);
+	if (isl_ctx_memory_acquire(ctx, extra) < 0) {
+		isl_blk_free_force(ctx, block);
+		return isl_blk_error();
+	}
 	p = isl_realloc_array(ctx, block.data, isl_int, new_n);
 	if (!p) {
+		isl_ctx_memory_release(ctx, extra);
 		isl_blk_free_force(ctx, block);
 		return isl_blk_error();
 	}
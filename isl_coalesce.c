@@ -32,9 +32,12 @@
 #include <isl_aff_private.h>
 #include <isl_equalities.h>
 #include <isl_constraint_private.h>
+#include <isl_trace_private.h>
+#include <isl_profile_private.h>
 
 #include <set_to_map.c>
 #include <set_from_map.c>
+#include <bset_to_bmap.c>
 
 #define STATUS_ERROR		-1
 #define STATUS_REDUNDANT	 1
@@ -4163,6 +4166,48 @@ static __isl_give isl_map *update_basic_maps(__isl_take isl_map *map,
 	return map;
 }
 
+/* Set up the entries in "info" for the basic maps of "map",
+ * which is assumed to have a single reference.
+ *
+ * We factor out any (hidden) common factor from the constraint
+ * coefficients, construct a tableau for each basic map,
+ * detect implicit equalities and redundant constraints and
+ * compute the hash of the apparent affine hull.
+ * Basic maps that turn out to be empty are dropped.
+ */
+static isl_stat init_coalesce_info(__isl_keep isl_map *map,
+	struct isl_coalesce_info *info)
+{
+	int i;
+
+	for (i = 0; i < map->n; ++i) {
+		map->p[i] = isl_basic_map_reduce_coefficients(map->p[i]);
+		if (!map->p[i])
+			return isl_stat_error;
+		info[i].bmap = isl_basic_map_copy(map->p[i]);
+		info[i].tab = isl_tab_from_basic_map(info[i].bmap, 0);
+		if (!info[i].tab)
+			return isl_stat_error;
+		if (!ISL_F_ISSET(info[i].bmap, ISL_BASIC_MAP_NO_IMPLICIT))
+			if (isl_tab_detect_implicit_equalities(info[i].tab) < 0)
+				return isl_stat_error;
+		info[i].bmap = isl_tab_make_equalities_explicit(info[i].tab,
+								info[i].bmap);
+		if (!info[i].bmap)
+			return isl_stat_error;
+		if (!ISL_F_ISSET(info[i].bmap, ISL_BASIC_MAP_NO_REDUNDANT))
+			if (isl_tab_detect_redundant(info[i].tab) < 0)
+				return isl_stat_error;
+		if (coalesce_info_set_hull_hash(&info[i]) < 0)
+			return isl_stat_error;
+	}
+	for (i = map->n - 1; i >= 0; --i)
+		if (info[i].tab->empty)
+			drop(&info[i]);
+
+	return isl_stat_ok;
+}
+
 /* For each pair of basic maps in the map, check if the union of the two
  * can be represented by a single basic map.
  * If so, replace the pair by the single basic map and start over.
@@ -4187,10 +4232,12 @@ static __isl_give isl_map *update_basic_maps(__isl_take isl_map *map,
  * isl_basic_map_gauss in update_basic_maps resolves this as well.
  * For each basic map, we also compute the hash of the apparent affine hull
  * for use in coalesce.
+ *
+ * The result is marked as having been coalesced, such that
+ * isl_map_coalesce_add_basic_map can avoid coalescing it again.
  */
-__isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map)
+static __isl_give isl_map *map_coalesce(__isl_take isl_map *map)
 {
-	int i;
 	unsigned n;
 	isl_ctx *ctx;
 	struct isl_coalesce_info *info = NULL;
@@ -4199,8 +4246,10 @@ __isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map)
 	if (!map)
 		return NULL;
 
-	if (map->n <= 1)
+	if (map->n <= 1) {
+		ISL_F_SET(map, ISL_MAP_COALESCED);
 		return map;
+	}
 
 	ctx = isl_map_get_ctx(map);
 	map = isl_map_sort_divs(map);
@@ -4215,30 +4264,8 @@ __isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map)
 	if (!info)
 		goto error;
 
-	for (i = 0; i < map->n; ++i) {
-		map->p[i] = isl_basic_map_reduce_coefficients(map->p[i]);
-		if (!map->p[i])
-			goto error;
-		info[i].bmap = isl_basic_map_copy(map->p[i]);
-		info[i].tab = isl_tab_from_basic_map(info[i].bmap, 0);
-		if (!info[i].tab)
-			goto error;
-		if (!ISL_F_ISSET(info[i].bmap, ISL_BASIC_MAP_NO_IMPLICIT))
-			if (isl_tab_detect_implicit_equalities(info[i].tab) < 0)
-				goto error;
-		info[i].bmap = isl_tab_make_equalities_explicit(info[i].tab,
-								info[i].bmap);
-		if (!info[i].bmap)
-			goto error;
-		if (!ISL_F_ISSET(info[i].bmap, ISL_BASIC_MAP_NO_REDUNDANT))
-			if (isl_tab_detect_redundant(info[i].tab) < 0)
-				goto error;
-		if (coalesce_info_set_hull_hash(&info[i]) < 0)
-			goto error;
-	}
-	for (i = map->n - 1; i >= 0; --i)
-		if (info[i].tab->empty)
-			drop(&info[i]);
+	if (init_coalesce_info(map, info) < 0)
+		goto error;
 
 	if (coalesce(ctx, n, info) < 0)
 		goto error;
@@ -4247,6 +4274,8 @@ __isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map)
 
 	clear_coalesce_info(n, info);
 
+	if (map)
+		ISL_F_SET(map, ISL_MAP_COALESCED);
 	return map;
 error:
 	clear_coalesce_info(n, info);
@@ -4254,11 +4283,251 @@ error:
 	return NULL;
 }
 
+/* Coalesce "map", recording the call in the trace and
+ * in the profile of its isl_ctx, if needed.
+ */
+__isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map)
+{
+	isl_ctx *ctx;
+
+	ISL_TRACE_UN(isl_map, isl_map_coalesce, map);
+
+	ctx = isl_map_get_ctx(map);
+	isl_profile_enter(ctx, isl_profile_coalesce);
+	map = map_coalesce(map);
+	isl_profile_leave(ctx, isl_profile_coalesce);
+
+	return map;
+}
+
 /* For each pair of basic sets in the set, check if the union of the two
  * can be represented by a single basic set.
  * If so, replace the pair by the single basic set and start over.
  */
 __isl_give isl_set *isl_set_coalesce(__isl_take isl_set *set)
 {
+	ISL_TRACE_UN(isl_set, isl_set_coalesce, set);
+
 	return set_from_map(isl_map_coalesce(set_to_map(set)));
 }
+
+/* Is "upper" smaller than "lower" - 1, meaning that there is
+ * at least one integer value strictly in between the two?
+ */
+static int gap(isl_int upper, isl_int lower)
+{
+	int gap;
+	isl_int t;
+
+	isl_int_init(t);
+	isl_int_sub(t, lower, upper);
+	gap = isl_int_cmp_si(t, 1) > 0;
+	isl_int_clear(t);
+
+	return gap;
+}
+
+/* Are "bmap1" and "bmap2" separated along some variable by the
+ * constant bounds that appear directly in their constraints?
+ * That is, is there a variable such that the constant upper bound
+ * in one of them is smaller than the constant lower bound
+ * in the other by more than one?
+ * Basic maps with this property are not considered as candidates
+ * for coalescing in isl_map_coalesce_add_basic_map.
+ * The bounds are not used if either of the basic maps is rational
+ * or has any local variables since the integer points of such
+ * basic maps need not be consecutive.
+ */
+static isl_bool bounds_separated(__isl_keep isl_basic_map *bmap1,
+	__isl_keep isl_basic_map *bmap2)
+{
+	int i;
+	isl_size n1, n2;
+	isl_bool separated = isl_bool_false;
+	isl_int lower1, upper1, lower2, upper2;
+
+	n1 = isl_basic_map_dim(bmap1, isl_dim_all);
+	n2 = isl_basic_map_dim(bmap2, isl_dim_all);
+	if (n1 < 0 || n2 < 0)
+		return isl_bool_error;
+	if (ISL_F_ISSET(bmap1, ISL_BASIC_MAP_RATIONAL) ||
+	    ISL_F_ISSET(bmap2, ISL_BASIC_MAP_RATIONAL) ||
+	    bmap1->n_div != 0 || bmap2->n_div != 0)
+		return isl_bool_false;
+
+	isl_int_init(lower1);
+	isl_int_init(upper1);
+	isl_int_init(lower2);
+	isl_int_init(upper2);
+	for (i = 0; !separated && i < n1; ++i) {
+		int has_lower1, has_upper1, has_lower2, has_upper2;
+
+		if (isl_basic_map_plain_var_bounds(bmap1, i, &lower1,
+				&has_lower1, &upper1, &has_upper1) < 0 ||
+		    isl_basic_map_plain_var_bounds(bmap2, i, &lower2,
+				&has_lower2, &upper2, &has_upper2) < 0) {
+			separated = isl_bool_error;
+			break;
+		}
+		if (has_upper1 && has_lower2 && gap(upper1, lower2))
+			separated = isl_bool_true;
+		if (has_upper2 && has_lower1 && gap(upper2, lower1))
+			separated = isl_bool_true;
+	}
+	isl_int_clear(lower1);
+	isl_int_clear(upper1);
+	isl_int_clear(lower2);
+	isl_int_clear(upper2);
+
+	return separated;
+}
+
+/* Try and coalesce the first basic map of "map", which is assumed
+ * to have a single reference, with the other basic maps of "map".
+ * The other basic maps are assumed not to coalesce with each other
+ * and are therefore not compared to each other.
+ * Set *grown if the first basic map got combined with
+ * any of the other basic maps, i.e., if it may now coalesce
+ * with basic maps that were not considered before.
+ * If the first basic map is kept, then it remains in the first position.
+ */
+static __isl_give isl_map *coalesce_first(__isl_take isl_map *map,
+	int *grown)
+{
+	isl_ctx *ctx;
+	int n;
+	struct isl_coalesce_info *info;
+
+	*grown = 0;
+	if (!map)
+		return NULL;
+	if (map->n <= 1)
+		return map;
+
+	ctx = isl_map_get_ctx(map);
+	n = map->n;
+	info = isl_calloc_array(ctx, struct isl_coalesce_info, n);
+	if (!info)
+		return isl_map_free(map);
+
+	if (init_coalesce_info(map, info) < 0)
+		goto error;
+	if (!info[0].removed &&
+	    coalesce_range(ctx, info, 0, 1, 1, n) < 0)
+		goto error;
+	*grown = !info[0].removed && info[0].modified;
+
+	map = update_basic_maps(map, n, info);
+
+	clear_coalesce_info(n, info);
+
+	return map;
+error:
+	clear_coalesce_info(n, info);
+	isl_map_free(map);
+	return NULL;
+}
+
+/* Add "bmap" to "map", trying to combine it with the basic maps
+ * already in "map", where "map" is assumed to have been coalesced.
+ * If "map" is not marked as such, then it is coalesced first.
+ *
+ * Rather than reconsidering all pairs of basic maps as in
+ * isl_map_coalesce, only "bmap" is compared to the basic maps of "map"
+ * and only to those that are not separated from "bmap"
+ * by their constant bounds (see bounds_separated).
+ * These candidates are collected in a map with "bmap"
+ * in the first position.  If "bmap" gets combined with
+ * any of the candidates, then the result may have grown
+ * such that it is no longer separated from some of
+ * the remaining basic maps.  The process is then repeated with
+ * the result taking the place of "bmap" and the candidates
+ * moved to "done".
+ *
+ * The result is marked as having been coalesced.
+ */
+__isl_give isl_map *isl_map_coalesce_add_basic_map(__isl_take isl_map *map,
+	__isl_take isl_basic_map *bmap)
+{
+	int i;
+	int grown;
+	isl_map *done = NULL, *cand = NULL, *rest = NULL;
+	isl_space *space = NULL;
+
+	if (map && !ISL_F_ISSET(map, ISL_MAP_COALESCED))
+		map = isl_map_coalesce(map);
+	rest = isl_map_cow(map);
+	bmap = isl_basic_map_sort_divs(bmap);
+	if (isl_map_basic_map_check_equal_space(rest, bmap) < 0)
+		goto error;
+	if (isl_basic_map_plain_is_empty(bmap)) {
+		isl_basic_map_free(bmap);
+		return rest;
+	}
+
+	space = isl_map_get_space(rest);
+	done = isl_map_alloc_space(isl_space_copy(space), rest->n + 1, 0);
+	do {
+		isl_map *sep;
+
+		cand = isl_map_alloc_space(isl_space_copy(space),
+					    1 + rest->n, 0);
+		cand = isl_map_add_basic_map(cand, bmap);
+		bmap = NULL;
+		sep = isl_map_alloc_space(isl_space_copy(space), rest->n, 0);
+		if (!cand || cand->n != 1 || !sep) {
+			isl_map_free(sep);
+			goto error;
+		}
+		for (i = 0; i < rest->n; ++i) {
+			isl_bool separated;
+			isl_basic_map *bmap_i;
+
+			separated = bounds_separated(cand->p[0], rest->p[i]);
+			if (separated < 0)
+				sep = isl_map_free(sep);
+			bmap_i = isl_basic_map_copy(rest->p[i]);
+			if (separated)
+				sep = isl_map_add_basic_map(sep, bmap_i);
+			else
+				cand = isl_map_add_basic_map(cand, bmap_i);
+		}
+		isl_map_free(rest);
+		rest = sep;
+		cand = coalesce_first(cand, &grown);
+		if (!cand || !rest || !done)
+			goto error;
+		for (i = 0; i < cand->n; ++i) {
+			if (grown && i == 0)
+				bmap = isl_basic_map_copy(cand->p[i]);
+			else
+				done = isl_map_add_basic_map(done,
+					    isl_basic_map_copy(cand->p[i]));
+		}
+		cand = isl_map_free(cand);
+		if (!done || (grown && !bmap))
+			goto error;
+	} while (grown && rest->n > 0);
+
+	if (bmap)
+		done = isl_map_add_basic_map(done, bmap);
+	isl_space_free(space);
+	map = isl_map_union_disjoint(done, rest);
+	if (map)
+		ISL_F_SET(map, ISL_MAP_COALESCED);
+	return map;
+error:
+	isl_space_free(space);
+	isl_map_free(done);
+	isl_map_free(cand);
+	isl_map_free(rest);
+	isl_basic_map_free(bmap);
+	return NULL;
+}
+
+__isl_give isl_set *isl_set_coalesce_add_basic_set(__isl_take isl_set *set,
+	__isl_take isl_basic_set *bset)
+{
+	return set_from_map(isl_map_coalesce_add_basic_map(set_to_map(set),
+							bset_to_bmap(bset)));
+}
@@ -2496,6 +2496,304 @@ __isl_give isl_basic_set *isl_set_unshifted_simple_hull(
 	return isl_map_unshifted_simple_hull(set);
 }
 
+/* Try and add a bound in the direction of the linear part of "ineq"
+ * on the whole of "set" to "hull", using at most "*budget" LP solves.
+ * "*budget" is decremented by the number of LP solves that were performed.
+ * A negative "*budget" means that there is no limit.
+ *
+ * If "hull" already contains a translate of "ineq", then there is
+ * nothing to be done.
+ * Otherwise, the constant term is computed as the maximum over
+ * all basic sets of the constant term that is needed for
+ * the constraint to be valid on that basic set.
+ * For basic sets that contain a translate of "ineq", the constant term
+ * of that translate is used, without solving any LP.
+ * Since this translate is valid on the basic set, the result is still
+ * a valid bound, even if it may not be a tight one.
+ * For the other basic sets, the minimal value of the linear part
+ * is computed through an LP.
+ * If this LP problem is unbounded or if the budget is exhausted,
+ * then no bound is added.
+ *
+ * Note that the two inequality constraints corresponding to an equality are
+ * represented by the same inequality constraint in data->p[j].table,
+ * as in set_max_constant_term.
+ */
+static __isl_give isl_basic_set *add_budget_bound(
+	__isl_take isl_basic_set *hull, struct sh_data *data,
+	__isl_keep isl_set *set, isl_int *ineq, int *budget)
+{
+	uint32_t c_hash;
+	struct ineq_cmp_data v;
+	struct isl_hash_table_entry *entry;
+	int j, k;
+	int has_bound = 0;
+	enum isl_lp_result res = isl_lp_ok;
+	isl_size total;
+	isl_int opt;
+
+	total = isl_basic_set_dim(hull, isl_dim_all);
+	if (total < 0)
+		return isl_basic_set_free(hull);
+
+	v.len = total;
+	v.p = ineq;
+	c_hash = isl_seq_get_hash(ineq + 1, v.len);
+
+	entry = isl_hash_table_find(hull->ctx, data->hull_table, c_hash,
+					has_ineq, &v, 0);
+	if (!entry)
+		return isl_basic_set_free(hull);
+	if (entry != isl_hash_table_entry_none)
+		return hull;
+
+	k = isl_basic_set_alloc_inequality(hull);
+	if (k < 0)
+		return isl_basic_set_free(hull);
+	isl_seq_cpy(hull->ineq[k] + 1, ineq + 1, v.len);
+	v.p = hull->ineq[k];
+
+	for (j = 0; j < set->n; ++j) {
+		int neg;
+		isl_int *ineq_j;
+
+		entry = isl_hash_table_find(hull->ctx, data->p[j].table,
+						c_hash, &has_ineq, &v, 0);
+		if (!entry)
+			return isl_basic_set_free(hull);
+		if (entry == isl_hash_table_entry_none)
+			continue;
+
+		ineq_j = entry->data;
+		neg = isl_seq_is_neg(ineq_j + 1, ineq + 1, v.len);
+		if (neg)
+			isl_int_neg(ineq_j[0], ineq_j[0]);
+		if (!has_bound || isl_int_gt(ineq_j[0], hull->ineq[k][0]))
+			isl_int_set(hull->ineq[k][0], ineq_j[0]);
+		if (neg)
+			isl_int_neg(ineq_j[0], ineq_j[0]);
+		has_bound = 1;
+	}
+
+	isl_int_init(opt);
+	for (j = 0; j < set->n; ++j) {
+		entry = isl_hash_table_find(hull->ctx, data->p[j].table,
+						c_hash, &has_ineq, &v, 0);
+		if (!entry) {
+			res = isl_lp_error;
+			break;
+		}
+		if (entry != isl_hash_table_entry_none)
+			continue;
+		if (*budget == 0) {
+			res = isl_lp_unbounded;
+			break;
+		}
+		if (*budget > 0)
+			(*budget)--;
+		if (!data->p[j].tab)
+			data->p[j].tab = isl_tab_from_basic_set(set->p[j], 0);
+		if (!data->p[j].tab) {
+			res = isl_lp_error;
+			break;
+		}
+		if (!has_bound)
+			isl_int_set_si(hull->ineq[k][0], 0);
+		res = isl_tab_min(data->p[j].tab, hull->ineq[k],
+				    data->ctx->one, &opt, NULL, 0);
+		if (res == isl_lp_empty)
+			continue;
+		if (res != isl_lp_ok)
+			break;
+		if (!has_bound || isl_int_is_neg(opt))
+			isl_int_sub(hull->ineq[k][0], hull->ineq[k][0], opt);
+		has_bound = 1;
+	}
+	isl_int_clear(opt);
+
+	if (j < set->n && res == isl_lp_error)
+		return isl_basic_set_free(hull);
+	if (j < set->n || !has_bound)
+		return isl_basic_set_free_inequality(hull, 1);
+
+	entry = isl_hash_table_find(hull->ctx, data->hull_table, c_hash,
+					has_ineq, &v, 1);
+	if (!entry)
+		return isl_basic_set_free(hull);
+	entry->data = hull->ineq[k];
+
+	return hull;
+}
+
+/* Add bounds to "hull" in the octagonal directions of the first "n"
+ * variables of "set", i.e., in the directions x_i and -x_i and
+ * in the directions x_i + x_j, x_i - x_j, -x_i + x_j and -x_i - x_j
+ * for all pairs of variables, using at most "*budget" LP solves.
+ * The directions along a single variable are considered first.
+ */
+static __isl_give isl_basic_set *add_octagon_bounds(
+	__isl_take isl_basic_set *hull, struct sh_data *data,
+	__isl_keep isl_set *set, int n, int *budget)
+{
+	int i, j, s;
+	isl_size total;
+	isl_vec *dir;
+
+	total = isl_basic_set_dim(hull, isl_dim_all);
+	if (total < 0)
+		return isl_basic_set_free(hull);
+	dir = isl_vec_alloc(isl_set_get_ctx(set), 1 + total);
+	if (!dir)
+		return isl_basic_set_free(hull);
+	isl_seq_clr(dir->el, dir->size);
+
+	for (i = 0; i < n; ++i) {
+		for (s = 0; s < 2; ++s) {
+			isl_int_set_si(dir->el[1 + i], s ? -1 : 1);
+			hull = add_budget_bound(hull, data, set, dir->el,
+						budget);
+		}
+		isl_int_set_si(dir->el[1 + i], 0);
+	}
+	for (i = 0; i < n; ++i) {
+		for (j = i + 1; j < n; ++j) {
+			for (s = 0; s < 4; ++s) {
+				isl_int_set_si(dir->el[1 + i], s & 1 ? -1 : 1);
+				isl_int_set_si(dir->el[1 + j], s & 2 ? -1 : 1);
+				hull = add_budget_bound(hull, data, set,
+							dir->el, budget);
+			}
+			isl_int_set_si(dir->el[1 + i], 0);
+			isl_int_set_si(dir->el[1 + j], 0);
+		}
+	}
+
+	isl_vec_free(dir);
+	return hull;
+}
+
+/* Compute a superset of the convex hull of "set" using at most
+ * "max_lp" LP solves, or an unlimited number if "max_lp" is negative.
+ * The directions of the constraints of the result are taken from
+ * the constraints of the basic sets in "set", followed by
+ * the octagonal directions of the first "n" variables.
+ * The directions are considered in this order until the budget
+ * is exhausted.  After that, only those directions for which
+ * a bound can be derived without solving any LP are added.
+ */
+static __isl_give isl_basic_set *uset_budget_hull(__isl_take isl_set *set,
+	int n, int max_lp)
+{
+	struct sh_data *data = NULL;
+	struct isl_basic_set *hull = NULL;
+	unsigned n_ineq;
+	int i, j, k;
+	isl_size dim;
+
+	dim = isl_set_dim(set, isl_dim_all);
+	if (dim < 0)
+		goto error;
+
+	n_ineq = 2 * n * n;
+	for (i = 0; i < set->n; ++i) {
+		if (!set->p[i])
+			goto error;
+		n_ineq += 2 * set->p[i]->n_eq + set->p[i]->n_ineq;
+	}
+
+	hull = isl_basic_set_alloc_space(isl_space_copy(set->dim), 0, 0, n_ineq);
+	if (!hull)
+		goto error;
+
+	data = sh_data_alloc(set, n_ineq);
+	if (!data)
+		goto error;
+
+	for (i = 0; i < set->n; ++i) {
+		isl_basic_set *bset = set->p[i];
+
+		for (j = 0; j < bset->n_eq; ++j) {
+			for (k = 0; k < 2; ++k) {
+				isl_seq_neg(bset->eq[j], bset->eq[j], 1 + dim);
+				hull = add_budget_bound(hull, data, set,
+						    bset->eq[j], &max_lp);
+			}
+		}
+		for (j = 0; j < bset->n_ineq; ++j)
+			hull = add_budget_bound(hull, data, set,
+						bset->ineq[j], &max_lp);
+	}
+	hull = add_octagon_bounds(hull, data, set, n, &max_lp);
+
+	sh_data_free(data);
+	isl_set_free(set);
+
+	return hull;
+error:
+	sh_data_free(data);
+	isl_basic_set_free(hull);
+	isl_set_free(set);
+	return NULL;
+}
+
+/* Compute a superset of the convex hull of "map" using at most
+ * "max_lp" LP solves, or an unlimited number if "max_lp" is negative.
+ * The result is described by (translates of) the constraints
+ * of the basic maps in "map" and by octagonal constraints
+ * on the parameters and the input and output dimensions.
+ *
+ * As in map_simple_hull, the computation is performed on the underlying
+ * set after the integer divisions have been aligned and the result
+ * is intersected with the affine hull of "map".
+ */
+__isl_give isl_basic_map *isl_map_budget_hull(__isl_take isl_map *map,
+	int max_lp)
+{
+	struct isl_set *set = NULL;
+	struct isl_basic_map *model = NULL;
+	struct isl_basic_map *hull;
+	struct isl_basic_map *affine_hull;
+	struct isl_basic_set *bset = NULL;
+	isl_size n;
+
+	if (!map || map->n <= 1)
+		return map_simple_hull_trivial(map);
+
+	map = isl_map_detect_equalities(map);
+	if (!map || map->n <= 1)
+		return map_simple_hull_trivial(map);
+	n = isl_map_dim(map, isl_dim_all);
+	if (n < 0) {
+		isl_map_free(map);
+		return NULL;
+	}
+	affine_hull = isl_map_affine_hull(isl_map_copy(map));
+	map = isl_map_align_divs_internal(map);
+	model = map ? isl_basic_map_copy(map->p[0]) : NULL;
+
+	set = isl_map_underlying_set(map);
+
+	bset = uset_budget_hull(set, n, max_lp);
+
+	hull = isl_basic_map_overlying_set(bset, model);
+
+	hull = isl_basic_map_intersect(hull, affine_hull);
+	hull = isl_basic_map_remove_redundancies(hull);
+
+	if (hull) {
+		ISL_F_SET(hull, ISL_BASIC_MAP_NO_IMPLICIT);
+		ISL_F_SET(hull, ISL_BASIC_MAP_ALL_EQUALITIES);
+	}
+
+	return isl_basic_map_finalize(hull);
+}
+
+__isl_give isl_basic_set *isl_set_budget_hull(__isl_take isl_set *set,
+	int max_lp)
+{
+	return bset_from_bmap(isl_map_budget_hull(set_to_map(set), max_lp));
+}
+
 /* Drop all inequalities from "bmap1" that do not also appear in "bmap2".
  * A constraint that appears with different constant terms
  * in "bmap1" and "bmap2" is also kept, with the least restrictive
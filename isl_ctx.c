@@ -10,6 +10,8 @@
 #include <isl_ctx_private.h>
 #include "isl/vec.h"
 #include <isl_options_private.h>
+#include <isl_trace_private.h>
+#include <isl_profile_private.h>
 
 #define __isl_calloc(type,size)		((type *)calloc(1, size))
 #define __isl_calloc_type(type)		__isl_calloc(type,sizeof(type))
@@ -83,6 +85,165 @@ int isl_ctx_next_operation(isl_ctx *ctx)
 	return 0;
 }
 
+/* Account for "size" more bytes of memory being used by "ctx".
+ * Return isl_stat_error if this would exceed the maximal amount
+ * of memory that "ctx" is allowed to use, if any.
+ * In this case, the memory should not be allocated.
+ * The accounted memory is also recorded in the profile, if any.
+ */
+isl_stat isl_ctx_memory_acquire(isl_ctx *ctx, size_t size)
+{
+	if (!ctx)
+		return isl_stat_error;
+	if (ctx->max_memory &&
+	    (size > ctx->max_memory || ctx->memory > ctx->max_memory - size))
+		isl_die(ctx, isl_error_quota,
+			"maximal amount of memory exceeded",
+			return isl_stat_error);
+	ctx->memory += size;
+	if (ctx->memory > ctx->peak_memory)
+		ctx->peak_memory = ctx->memory;
+	isl_profile_alloc(ctx, size);
+	return isl_stat_ok;
+}
+
+/* Account for "size" bytes of memory no longer being used by "ctx".
+ */
+void isl_ctx_memory_release(isl_ctx *ctx, size_t size)
+{
+	if (!ctx)
+		return;
+	ctx->memory -= size;
+}
+
+/* An entry in a cache attached to an isl_ctx.
+ * "data" describes both the input of the cached computation and
+ * its result, while "hash" is a hash value of the input.
+ */
+struct isl_ctx_cache_entry {
+	uint32_t hash;
+	void *data;
+};
+
+/* A cache of the results of some computation, attached to an isl_ctx.
+ * "size" is the maximal number of entries in the cache and
+ * "n" is the number of entries that are currently in use.
+ * Once the cache is full, the entry at position "next" is
+ * replaced by the next result that gets added.
+ * "tag" identifies the values of the options (other than the size)
+ * that the cached results depend on.
+ * "free_data" frees the data of an entry.
+ */
+struct isl_ctx_cache {
+	int size;
+	int tag;
+	int n;
+	int next;
+	void (*free_data)(void *data);
+	struct isl_ctx_cache_entry *entry;
+};
+
+/* Free all entries in the cache "*cache_p" as well as the cache itself.
+ *
+ * The caches of an isl_ctx need to be freed before the isl_ctx itself
+ * since the cached objects hold references to the isl_ctx.
+ */
+void isl_ctx_cache_free(struct isl_ctx_cache **cache_p)
+{
+	int i;
+	struct isl_ctx_cache *cache = *cache_p;
+
+	if (!cache)
+		return;
+
+	for (i = 0; i < cache->n; ++i)
+		cache->free_data(cache->entry[i].data);
+	free(cache->entry);
+	free(cache);
+	*cache_p = NULL;
+}
+
+/* Return the cache "*cache_p" of "ctx", allocating it if needed
+ * with room for "size" entries, the data of which is freed
+ * using "free_data".
+ * Return NULL if caching has been disabled by setting "size"
+ * to a non-positive value.
+ * If the size of the cache or the options identified by "tag"
+ * were changed since it was allocated, then the old cache is discarded.
+ */
+struct isl_ctx_cache *isl_ctx_cache_get(isl_ctx *ctx,
+	struct isl_ctx_cache **cache_p, int size, int tag,
+	void (*free_data)(void *data))
+{
+	struct isl_ctx_cache *cache = *cache_p;
+
+	if (cache && (cache->size != size || cache->tag != tag))
+		isl_ctx_cache_free(cache_p);
+	if (size <= 0)
+		return NULL;
+	if (*cache_p)
+		return *cache_p;
+
+	cache = isl_calloc_type(ctx, struct isl_ctx_cache);
+	if (!cache)
+		return NULL;
+	cache->entry = isl_calloc_array(ctx, struct isl_ctx_cache_entry, size);
+	if (!cache->entry) {
+		free(cache);
+		return NULL;
+	}
+	cache->size = size;
+	cache->tag = tag;
+	cache->free_data = free_data;
+	*cache_p = cache;
+
+	return cache;
+}
+
+/* Look for an entry in "cache" with hash value "hash" that
+ * matches "val" according to "eq" and return its data.
+ * Return NULL if no such entry can be found or if an error occurs.
+ */
+void *isl_ctx_cache_find(struct isl_ctx_cache *cache, uint32_t hash,
+	isl_bool (*eq)(const void *data, const void *val), const void *val)
+{
+	int i;
+
+	for (i = 0; i < cache->n; ++i) {
+		isl_bool equal;
+
+		if (cache->entry[i].hash != hash)
+			continue;
+		equal = eq(cache->entry[i].data, val);
+		if (equal < 0)
+			return NULL;
+		if (equal)
+			return cache->entry[i].data;
+	}
+
+	return NULL;
+}
+
+/* Add an entry with data "data" and hash value "hash" to "cache",
+ * replacing the oldest entry if the cache is full.
+ * The cache takes ownership of "data".
+ */
+void isl_ctx_cache_add(struct isl_ctx_cache *cache, uint32_t hash,
+	void *data)
+{
+	struct isl_ctx_cache_entry *entry;
+
+	if (cache->n < cache->size) {
+		entry = &cache->entry[cache->n++];
+	} else {
+		entry = &cache->entry[cache->next];
+		cache->next = (cache->next + 1) % cache->size;
+		cache->free_data(entry->data);
+	}
+	entry->hash = hash;
+	entry->data = data;
+}
+
 /* Call malloc and complain if it fails.
  * If ctx is NULL, then return NULL.
  */
@@ -248,6 +409,7 @@ isl_ctx *isl_ctx_alloc_with_options(struct isl_args *args, void *user_opt)
 
 	ctx->operations = 0;
 	isl_ctx_set_max_operations(ctx, ctx->opt->max_operations);
+	isl_ctx_set_max_memory(ctx, ctx->opt->max_memory);
 
 	return ctx;
 error:
@@ -283,12 +445,61 @@ void isl_ctx_deref(struct isl_ctx *ctx)
 static void print_stats(isl_ctx *ctx)
 {
 	fprintf(stderr, "operations: %lu\n", ctx->operations);
+	if (ctx->stats->tab_pivots)
+		fprintf(stderr, "tableau pivots: %ld\n",
+			ctx->stats->tab_pivots);
+	if (ctx->memory || ctx->peak_memory)
+		fprintf(stderr, "memory: %lu bytes in use, %lu bytes peak\n",
+			ctx->memory, ctx->peak_memory);
+	if (ctx->opt->vertices_cache_size > 0)
+		fprintf(stderr, "vertices cache: %ld hits, %ld misses\n",
+			ctx->stats->vertices_cache_hits,
+			ctx->stats->vertices_cache_misses);
+	if (ctx->stats->subset_plain || ctx->stats->subset_sample ||
+	    ctx->stats->subset_full)
+		fprintf(stderr,
+			"subset checks: %ld plain, %ld sample, %ld full\n",
+			ctx->stats->subset_plain, ctx->stats->subset_sample,
+			ctx->stats->subset_full);
+	if (ctx->opt->subset_cache_size > 0)
+		fprintf(stderr, "subset cache: %ld hits, %ld misses\n",
+			ctx->stats->subset_cache_hits,
+			ctx->stats->subset_cache_misses);
+	if (ctx->stats->closure_exact || ctx->stats->closure_approx ||
+	    ctx->stats->closure_budget_exceeded)
+		fprintf(stderr, "transitive closures: %ld exact, "
+			"%ld approximate, %ld over budget, %lu operations\n",
+			ctx->stats->closure_exact, ctx->stats->closure_approx,
+			ctx->stats->closure_budget_exceeded,
+			ctx->stats->closure_operations);
+	if (ctx->opt->closure_cache_size > 0)
+		fprintf(stderr, "closure cache: %ld hits, %ld misses\n",
+			ctx->stats->closure_cache_hits,
+			ctx->stats->closure_cache_misses);
+	if (ctx->opt->intern_basic_maps)
+		fprintf(stderr, "interned basic maps: %ld hits, %ld misses\n",
+			ctx->stats->intern_hits, ctx->stats->intern_misses);
+	if (ctx->opt->lp_float)
+		fprintf(stderr, "floating point LP bases: %ld used, "
+			"%ld fallbacks\n", ctx->stats->lp_float_used,
+			ctx->stats->lp_float_fallback);
+	if (ctx->stats->ast_plain_separated)
+		fprintf(stderr, "AST generation: %ld pairs of domains "
+			"separated by constant bounds\n",
+			ctx->stats->ast_plain_separated);
+	isl_profile_print(ctx, stderr);
 }
 
 void isl_ctx_free(struct isl_ctx *ctx)
 {
 	if (!ctx)
 		return;
+	isl_ctx_cache_free(&ctx->vertices_cache);
+	isl_ctx_cache_free(&ctx->subset_cache);
+	isl_ctx_cache_free(&ctx->closure_cache);
+	isl_basic_map_intern_table_clear(ctx);
+	isl_token_cache_clear(ctx);
+	isl_trace_free(ctx);
 	if (ctx->ref != 0)
 		isl_die(ctx, isl_error_invalid,
 			"isl_ctx not freed as some objects still reference it",
@@ -296,6 +507,7 @@ void isl_ctx_free(struct isl_ctx *ctx)
 
 	if (ctx->opt->print_stats)
 		print_stats(ctx);
+	isl_profile_free(ctx);
 
 	isl_hash_table_clear(&ctx->id_table);
 	isl_blk_clear_cache(ctx);
@@ -407,3 +619,82 @@ void isl_ctx_reset_operations(isl_ctx *ctx)
 		return;
 	ctx->operations = 0;
 }
+
+/* Set the maximal number of bytes of memory that can be accounted
+ * to "ctx" to "max_memory".  A value of zero means that no bound is imposed.
+ */
+void isl_ctx_set_max_memory(isl_ctx *ctx, unsigned long max_memory)
+{
+	if (!ctx)
+		return;
+	ctx->max_memory = max_memory;
+}
+
+/* Return the maximal number of bytes of memory that can be accounted
+ * to "ctx".
+ */
+unsigned long isl_ctx_get_max_memory(isl_ctx *ctx)
+{
+	return ctx ? ctx->max_memory : 0;
+}
+
+/* Return the number of bytes of memory currently accounted to "ctx".
+ */
+unsigned long isl_ctx_get_memory(isl_ctx *ctx)
+{
+	return ctx ? ctx->memory : 0;
+}
+
+/* Return the maximal number of bytes of memory that were accounted
+ * to "ctx" at any one time since the creation of "ctx" or
+ * the last call to isl_ctx_reset_peak_memory.
+ */
+unsigned long isl_ctx_get_peak_memory(isl_ctx *ctx)
+{
+	return ctx ? ctx->peak_memory : 0;
+}
+
+/* Reset the peak memory usage of "ctx" to its current memory usage.
+ */
+void isl_ctx_reset_peak_memory(isl_ctx *ctx)
+{
+	if (!ctx)
+		return;
+	ctx->peak_memory = ctx->memory;
+}
+
+/* Set the function that should be called by operations
+ * that process the disjuncts of their input one by one
+ * after each disjunct has been processed.
+ * A NULL "fn" removes any previously set callback.
+ */
+void isl_ctx_set_disjunct_callback(isl_ctx *ctx,
+	isl_stat (*fn)(isl_ctx *ctx, const char *name, int pos, int n,
+		int n_result, unsigned long operations, void *user),
+	void *user)
+{
+	if (!ctx)
+		return;
+	ctx->disjunct_fn = fn;
+	ctx->disjunct_user = user;
+}
+
+/* Report that the operation called "name" has finished processing
+ * disjunct "pos" out of "n", resulting in "n_result" disjuncts
+ * and taking "operations" operations, to the callback set by
+ * isl_ctx_set_disjunct_callback, if any.
+ * If the callback returns an error, then the operation is aborted.
+ */
+isl_stat isl_ctx_report_disjunct(isl_ctx *ctx, const char *name, int pos,
+	int n, int n_result, unsigned long operations)
+{
+	if (!ctx)
+		return isl_stat_error;
+	if (!ctx->disjunct_fn)
+		return isl_stat_ok;
+	if (ctx->disjunct_fn(ctx, name, pos, n, n_result, operations,
+				ctx->disjunct_user) < 0)
+		isl_die(ctx, isl_error_abort, "aborted by disjunct callback",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
@@ -39,9 +39,45 @@ struct isl_ctx {
 
 	unsigned long		operations;
 	unsigned long		max_operations;
+
+	unsigned long		memory;
+	unsigned long		max_memory;
+	unsigned long		peak_memory;
+
+	isl_stat (*disjunct_fn)(isl_ctx *ctx, const char *name, int pos, int n,
+				int n_result, unsigned long operations,
+				void *user);
+	void			*disjunct_user;
+
+	struct isl_ctx_cache		*vertices_cache;
+	struct isl_ctx_cache		*subset_cache;
+	struct isl_ctx_cache		*closure_cache;
+	struct isl_basic_map_intern_table	*basic_map_intern;
+	struct isl_token_cache		*token_cache;
+
+	int				trace_option_handled;
+	struct isl_trace		*trace;
+
+	struct isl_profile		*profile;
 };
 
 int isl_ctx_next_operation(isl_ctx *ctx);
+isl_stat isl_ctx_memory_acquire(isl_ctx *ctx, size_t size);
+void isl_ctx_memory_release(isl_ctx *ctx, size_t size);
+isl_stat isl_ctx_report_disjunct(isl_ctx *ctx, const char *name, int pos,
+	int n, int n_result, unsigned long operations);
+
+struct isl_ctx_cache *isl_ctx_cache_get(isl_ctx *ctx,
+	struct isl_ctx_cache **cache_p, int size, int tag,
+	void (*free_data)(void *data));
+void isl_ctx_cache_free(struct isl_ctx_cache **cache_p);
+void *isl_ctx_cache_find(struct isl_ctx_cache *cache, uint32_t hash,
+	isl_bool (*eq)(const void *data, const void *val), const void *val);
+void isl_ctx_cache_add(struct isl_ctx_cache *cache, uint32_t hash,
+	void *data);
+
+void isl_token_cache_clear(isl_ctx *ctx);
+void isl_basic_map_intern_table_clear(isl_ctx *ctx);
 
 void isl_ctx_set_full_error(isl_ctx *ctx, enum isl_error error, const char *msg,
 	const char *file, int line);
@@ -15,6 +15,7 @@
 #include <isl_aff_private.h>
 #include <isl_mat_private.h>
 #include <isl_factorization.h>
+#include <isl_profile_private.h>
 
 /*
  * Let C be a cone and define
@@ -839,19 +840,23 @@ static __isl_give isl_basic_set *basic_set_coefficients(
 __isl_give isl_basic_set *isl_basic_set_coefficients(
 	__isl_take isl_basic_set *bset)
 {
+	isl_ctx *ctx;
 	isl_space *space;
 
 	if (!bset)
 		return NULL;
+	ctx = isl_basic_set_get_ctx(bset);
 	if (bset->n_div)
-		isl_die(bset->ctx, isl_error_invalid,
+		isl_die(ctx, isl_error_invalid,
 			"input set not allowed to have local variables",
 			goto error);
 
 	space = isl_basic_set_get_space(bset);
 	space = isl_space_coefficients(space);
 
+	isl_profile_enter(ctx, isl_profile_farkas);
 	bset = basic_set_coefficients(bset);
+	isl_profile_leave(ctx, isl_profile_farkas);
 	bset = isl_basic_set_reset_space(bset, space);
 	return bset;
 error:
@@ -866,19 +871,23 @@ error:
 __isl_give isl_basic_set *isl_basic_set_solutions(
 	__isl_take isl_basic_set *bset)
 {
+	isl_ctx *ctx;
 	isl_space *space;
 
 	if (!bset)
 		return NULL;
+	ctx = isl_basic_set_get_ctx(bset);
 	if (bset->n_div)
-		isl_die(bset->ctx, isl_error_invalid,
+		isl_die(ctx, isl_error_invalid,
 			"input set not allowed to have local variables",
 			goto error);
 
 	space = isl_basic_set_get_space(bset);
 	space = isl_space_solutions(space);
 
+	isl_profile_enter(ctx, isl_profile_farkas);
 	bset = farkas(bset, -1);
+	isl_profile_leave(ctx, isl_profile_farkas);
 	bset = isl_basic_set_reset_space(bset, space);
 	return bset;
 error:
@@ -22,9 +22,10 @@
 #include "isl/map.h"
 #include "isl/union_set.h"
 #include "isl/union_map.h"
-#include "isl/flow.h"
+#include <isl_flow_private.h>
 #include "isl/schedule_node.h"
 #include <isl_sort.h>
+#include <isl_trace_private.h>
 #include "isl/stream.h"
 
 enum isl_restriction_type {
@@ -1467,25 +1468,6 @@ error:
 	return NULL;
 }
 
-/* The different types of access relations that isl_union_access_info
- * keeps track of.
-
- * "isl_access_sink" represents the sink accesses.
- * "isl_access_must_source" represents the definite source accesses.
- * "isl_access_may_source" represents the possible source accesses.
- * "isl_access_kill" represents the kills.
- *
- * isl_access_sink is sometimes treated differently and
- * should therefore appear first.
- */
-enum isl_access_type {
-	isl_access_sink,
-	isl_access_must_source,
-	isl_access_may_source,
-	isl_access_kill,
-	isl_access_end
-};
-
 /* This structure represents the input for a dependence analysis computation.
  *
  * "access" contains the access relations.
@@ -1742,6 +1724,36 @@ error:
 	return NULL;
 }
 
+/* Return the access relation of type "type" of "info".
+ */
+__isl_keep isl_union_map *isl_union_access_info_peek_access(
+	__isl_keep isl_union_access_info *info, enum isl_access_type type)
+{
+	if (!info)
+		return NULL;
+	return info->access[type];
+}
+
+/* Return the schedule of "info", if any.
+ */
+__isl_keep isl_schedule *isl_union_access_info_peek_schedule(
+	__isl_keep isl_union_access_info *info)
+{
+	if (!info)
+		return NULL;
+	return info->schedule;
+}
+
+/* Return the schedule map of "info", if any.
+ */
+__isl_keep isl_union_map *isl_union_access_info_peek_schedule_map(
+	__isl_keep isl_union_access_info *info)
+{
+	if (!info)
+		return NULL;
+	return info->schedule_map;
+}
+
 __isl_give isl_union_access_info *isl_union_access_info_copy(
 	__isl_keep isl_union_access_info *access)
 {
@@ -3210,6 +3222,9 @@ __isl_give isl_union_flow *isl_union_access_info_compute_flow(
 	isl_union_map *must = NULL, *may = NULL;
 	isl_union_flow *flow;
 
+	if (isl_ctx_is_tracing(isl_union_access_info_get_ctx(access)))
+		return isl_union_access_info_trace_compute_flow(access);
+
 	has_kill = isl_union_access_has_kill(access);
 	if (has_kill < 0)
 		goto error;
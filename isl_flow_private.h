@@ -0,0 +1,32 @@
+#ifndef ISL_FLOW_PRIVATE_H
+#define ISL_FLOW_PRIVATE_H
+
+#include <isl/flow.h>
+
+/* The different types of access relations that isl_union_access_info
+ * keeps track of.
+
+ * "isl_access_sink" represents the sink accesses.
+ * "isl_access_must_source" represents the definite source accesses.
+ * "isl_access_may_source" represents the possible source accesses.
+ * "isl_access_kill" represents the kills.
+ *
+ * isl_access_sink is sometimes treated differently and
+ * should therefore appear first.
+ */
+enum isl_access_type {
+	isl_access_sink,
+	isl_access_must_source,
+	isl_access_may_source,
+	isl_access_kill,
+	isl_access_end
+};
+
+__isl_keep isl_union_map *isl_union_access_info_peek_access(
+	__isl_keep isl_union_access_info *info, enum isl_access_type type);
+__isl_keep isl_schedule *isl_union_access_info_peek_schedule(
+	__isl_keep isl_union_access_info *info);
+__isl_keep isl_union_map *isl_union_access_info_peek_schedule_map(
+	__isl_keep isl_union_access_info *info);
+
+#endif
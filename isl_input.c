@@ -32,6 +32,7 @@
 #include <isl_vec_private.h>
 #include "isl/list.h"
 #include <isl_val_private.h>
+#include <isl_trace_private.h>
 
 struct variable {
 	char    	    	*name;
@@ -3025,7 +3026,7 @@ static struct isl_obj obj_read_disjuncts(__isl_keep isl_stream *s,
 	return obj;
 }
 
-static struct isl_obj obj_read(__isl_keep isl_stream *s)
+static struct isl_obj read_obj(__isl_keep isl_stream *s)
 {
 	isl_map *map = NULL;
 	struct isl_token *tok;
@@ -3136,6 +3137,21 @@ error:
 	return obj;
 }
 
+/* Read an object from "s".
+ * The calls performed while parsing the object are not recorded
+ * in the trace of the isl_ctx, if any.
+ */
+static struct isl_obj obj_read(__isl_keep isl_stream *s)
+{
+	struct isl_obj obj;
+
+	isl_trace_suppress(s->ctx);
+	obj = read_obj(s);
+	isl_trace_resume(s->ctx);
+
+	return obj;
+}
+
 struct isl_obj isl_stream_read_obj(__isl_keep isl_stream *s)
 {
 	return obj_read(s);
@@ -4238,7 +4254,7 @@ error:
  * The core isl_multi_union_pw_aff ([...]) is read by
  * read_multi_union_pw_aff_core.
  */
-__isl_give isl_multi_union_pw_aff *isl_stream_read_multi_union_pw_aff(
+static __isl_give isl_multi_union_pw_aff *read_multi_union_pw_aff(
 	__isl_keep isl_stream *s)
 {
 	isl_multi_union_pw_aff *mupa;
@@ -4260,6 +4276,22 @@ __isl_give isl_multi_union_pw_aff *isl_stream_read_multi_union_pw_aff(
 	return mupa;
 }
 
+/* Read an isl_multi_union_pw_aff from "s".
+ * The calls performed while parsing the object are not recorded
+ * in the trace of the isl_ctx, if any.
+ */
+__isl_give isl_multi_union_pw_aff *isl_stream_read_multi_union_pw_aff(
+	__isl_keep isl_stream *s)
+{
+	isl_multi_union_pw_aff *mupa;
+
+	isl_trace_suppress(s->ctx);
+	mupa = read_multi_union_pw_aff(s);
+	isl_trace_resume(s->ctx);
+
+	return mupa;
+}
+
 #undef TYPE_BASE
 #define TYPE_BASE	multi_union_pw_aff
 #include "isl_read_from_str_templ.c"
@@ -22,6 +22,16 @@
 #include <bset_to_bmap.c>
 #include <set_to_map.c>
 
+/* Compute the minimum (or maximum if "maximize" is set) of "f"/"denom"
+ * over "bmap" using a tableau.
+ * If the lp-float option is set and the caller is not interested
+ * in the optimal point, then first try and move the tableau
+ * close to an optimal basis using floating point computations.
+ * Since the exact optimization still starts from the result,
+ * the optimal value is not affected.
+ * The optimal point may however be different, so the floating point
+ * start is not used when "sol" is set.
+ */
 static enum isl_lp_result isl_tab_solve_lp(__isl_keep isl_basic_map *bmap,
 	int maximize, isl_int *f, isl_int denom, isl_int *opt,
 	isl_int *opt_denom, __isl_give isl_vec **sol)
@@ -37,6 +47,8 @@ static enum isl_lp_result isl_tab_solve_lp(__isl_keep isl_basic_map *bmap,
 
 	bmap = isl_basic_map_gauss(bmap, NULL);
 	tab = isl_tab_from_basic_map(bmap, 0);
+	if (!sol && bmap && bmap->ctx->opt->lp_float)
+		tab = isl_tab_float_warm_start(tab, f);
 	res = isl_tab_min(tab, f, denom, opt, opt_denom, 0);
 	if (res == isl_lp_ok && sol) {
 		*sol = isl_tab_get_sample_value(tab);
@@ -48,6 +48,7 @@
 #include <isl_morph.h>
 #include <isl_val_private.h>
 #include <isl_printer_private.h>
+#include <isl_trace_private.h>
 
 #include <bset_to_bmap.c>
 #include <bset_from_bmap.c>
@@ -1284,6 +1285,16 @@ isl_bool isl_map_is_params(__isl_keep isl_map *map)
 	return isl_space_is_params(map->dim);
 }
 
+/* Initialize the freshly allocated "bmap" with room for
+ * "extra" local variables, "n_eq" equality constraints and
+ * "n_ineq" inequality constraints.
+ *
+ * The memory of the arrays of pointers to the constraints is
+ * accounted to "ctx" before they are allocated and recorded
+ * in bmap->memory such that isl_basic_map_free releases it
+ * if anything goes wrong.  The memory of the constraints themselves
+ * is accounted by isl_blk.
+ */
 static __isl_give isl_basic_map *basic_map_init(isl_ctx *ctx,
 	__isl_take isl_basic_map *bmap, unsigned extra,
 	unsigned n_eq, unsigned n_ineq)
@@ -1299,6 +1310,11 @@ static __isl_give isl_basic_map *basic_map_init(isl_ctx *ctx,
 	if (n_var < 0)
 		return isl_basic_map_free(bmap);
 
+	if (isl_ctx_memory_acquire(ctx,
+			(n_eq + n_ineq + extra) * sizeof(isl_int *)) < 0)
+		return isl_basic_map_free(bmap);
+	bmap->memory += (n_eq + n_ineq + extra) * sizeof(isl_int *);
+
 	bmap->block = isl_blk_alloc(ctx, (n_ineq + n_eq) * row_size);
 	if (isl_blk_is_error(bmap->block))
 		goto error;
@@ -1378,9 +1394,16 @@ __isl_give isl_basic_map *isl_basic_map_alloc_space(__isl_take isl_space *space,
 
 	if (!space)
 		return NULL;
+	if (isl_ctx_memory_acquire(space->ctx,
+			sizeof(struct isl_basic_map)) < 0)
+		goto error;
 	bmap = isl_calloc_type(space->ctx, struct isl_basic_map);
-	if (!bmap)
+	if (!bmap) {
+		isl_ctx_memory_release(space->ctx,
+			sizeof(struct isl_basic_map));
 		goto error;
+	}
+	bmap->memory = sizeof(struct isl_basic_map);
 	bmap->dim = space;
 
 	return basic_map_init(space->ctx, bmap, extra, n_eq, n_ineq);
@@ -1449,6 +1472,7 @@ __isl_give isl_basic_map *isl_basic_map_dup(__isl_keep isl_basic_map *bmap)
 	if (!dup)
 		return NULL;
 	dup->flags = bmap->flags;
+	ISL_F_CLR(dup, ISL_BASIC_MAP_INTERNED);
 	dup->sample = isl_vec_copy(bmap->sample);
 	return dup;
 }
@@ -1507,6 +1531,7 @@ __isl_null isl_basic_map *isl_basic_map_free(__isl_take isl_basic_map *bmap)
 	if (--bmap->ref > 0)
 		return NULL;
 
+	isl_ctx_memory_release(bmap->ctx, bmap->memory);
 	isl_ctx_deref(bmap->ctx);
 	free(bmap->div);
 	isl_blk_free(bmap->ctx, bmap->block2);
@@ -2013,6 +2038,7 @@ __isl_give isl_basic_map *isl_basic_map_extend(__isl_take isl_basic_map *base,
 	if (ext) {
 		ext->flags = flags;
 		ISL_F_CLR(ext, ISL_BASIC_SET_FINAL);
+		ISL_F_CLR(ext, ISL_BASIC_MAP_INTERNED);
 	}
 
 	return ext;
@@ -2092,16 +2118,24 @@ __isl_give isl_set *isl_set_cow(__isl_take isl_set *set)
  * performed on the result.
  *
  * Otherwise, create a duplicate (without any cached information).
+ *
+ * The result is no longer considered to be coalesced
+ * since the basic maps may be modified in place.
  */
 __isl_give isl_map *isl_map_cow(__isl_take isl_map *map)
 {
 	if (!map)
 		return NULL;
 
-	if (map->ref == 1)
-		return clear_caches(map);
-	map->ref--;
-	return isl_map_dup(map);
+	if (map->ref == 1) {
+		map = clear_caches(map);
+	} else {
+		map->ref--;
+		map = isl_map_dup(map);
+	}
+	if (map)
+		ISL_F_CLR(map, ISL_MAP_COALESCED);
+	return map;
 }
 
 static void swap_vars(struct isl_blk blk, isl_int *a,
@@ -2459,12 +2493,15 @@ __isl_give isl_basic_set *isl_basic_set_drop(__isl_take isl_basic_set *bset,
 }
 
 /* No longer consider "map" to be normalized.
+ * Since the basic maps may be about to change, the map
+ * can also no longer be considered to be coalesced.
  */
 static __isl_give isl_map *isl_map_unmark_normalized(__isl_take isl_map *map)
 {
 	if (!map)
 		return NULL;
 	ISL_F_CLR(map, ISL_MAP_NORMALIZED);
+	ISL_F_CLR(map, ISL_MAP_COALESCED);
 	return map;
 }
 
@@ -3961,6 +3998,8 @@ error:
 __isl_give isl_map *isl_map_intersect(__isl_take isl_map *map1,
 	__isl_take isl_map *map2)
 {
+	ISL_TRACE_BIN(isl_map, isl_map_intersect, map1, map2);
+
 	isl_map_align_params_bin(&map1, &map2);
 	return map_intersect(map1, map2);
 }
@@ -3968,6 +4007,8 @@ __isl_give isl_map *isl_map_intersect(__isl_take isl_map *map1,
 __isl_give isl_set *isl_set_intersect(__isl_take isl_set *set1,
 	__isl_take isl_set *set2)
 {
+	ISL_TRACE_BIN(isl_set, isl_set_intersect, set1, set2);
+
 	return set_from_map(isl_map_intersect(set_to_map(set1),
 					      set_to_map(set2)));
 }
@@ -6280,6 +6321,15 @@ __isl_give isl_map *isl_map_from_domain_and_range(__isl_take isl_set *domain,
 	return isl_map_apply_range(isl_map_reverse(domain), range);
 }
 
+/* Return the number of bytes of memory allocated for an isl_map
+ * with room for "n" basic maps.
+ */
+static size_t map_memory(int n)
+{
+	return sizeof(struct isl_map) +
+		(n - 1) * sizeof(struct isl_basic_map *);
+}
+
 /* Return a newly allocated isl_map with given space and flags and
  * room for "n" basic maps.
  * Make sure that all cached information is cleared.
@@ -6294,11 +6344,13 @@ __isl_give isl_map *isl_map_alloc_space(__isl_take isl_space *space, int n,
 	if (n < 0)
 		isl_die(space->ctx, isl_error_internal,
 			"negative number of basic maps", goto error);
-	map = isl_calloc(space->ctx, struct isl_map,
-			sizeof(struct isl_map) +
-			(n - 1) * sizeof(struct isl_basic_map *));
-	if (!map)
+	if (isl_ctx_memory_acquire(space->ctx, map_memory(n)) < 0)
+		goto error;
+	map = isl_calloc(space->ctx, struct isl_map, map_memory(n));
+	if (!map) {
+		isl_ctx_memory_release(space->ctx, map_memory(n));
 		goto error;
+	}
 
 	map->ctx = space->ctx;
 	isl_ctx_ref(map->ctx);
@@ -6455,6 +6507,10 @@ __isl_give isl_map *isl_map_add_basic_map(__isl_take isl_map *map,
 	if (isl_map_basic_map_check_equal_space(map, bmap) < 0)
 		goto error;
 	isl_assert(map->ctx, map->n < map->size, goto error);
+	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_FINAL))
+		bmap = isl_basic_map_intern(bmap);
+	if (!bmap)
+		goto error;
 	map->p[map->n] = bmap;
 	map->n++;
 	map = isl_map_unmark_normalized(map);
@@ -6478,6 +6534,7 @@ __isl_null isl_map *isl_map_free(__isl_take isl_map *map)
 		return NULL;
 
 	clear_caches(map);
+	isl_ctx_memory_release(map->ctx, map_memory(map->size));
 	isl_ctx_deref(map->ctx);
 	for (i = 0; i < map->n; ++i)
 		isl_basic_map_free(map->p[i]);
@@ -8151,10 +8208,83 @@ error:
 	return NULL;
 }
 
+/* Combine the "n" maps in "list", computed from the basic maps of "map",
+ * into a single map, freeing the elements of "list".
+ * The basic maps are added in the order of "list", such that
+ * the result does not depend on the order in which the elements
+ * of "list" were computed.
+ * If any of the elements is obviously a universe,
+ * then the result is that universe, as in isl_map_union.
+ * Similarly, if "map" is not known to be disjoint, then
+ * an element that is obviously equal to the combination
+ * of the previous elements is skipped.
+ * The result is only marked disjoint if "map" is disjoint and
+ * all elements of "list" are disjoint.
+ */
+static __isl_give isl_map *merge_disjunct_results(__isl_keep isl_map *map,
+	isl_map **list, int n)
+{
+	int i, j;
+	int total = 0;
+	int disjoint;
+	isl_bool universe = isl_bool_false;
+	isl_map *res = NULL;
+
+	disjoint = ISL_F_ISSET(map, ISL_MAP_DISJOINT);
+	for (i = 0; i < n; ++i) {
+		universe = isl_map_plain_is_universe(list[i]);
+		if (universe < 0 || universe)
+			break;
+		total += list[i]->n;
+		if (list[i]->n > 1 && !ISL_F_ISSET(list[i], ISL_MAP_DISJOINT))
+			disjoint = 0;
+	}
+
+	if (universe > 0) {
+		res = list[i];
+		list[i] = NULL;
+	} else if (universe == isl_bool_false) {
+		res = isl_map_alloc_space(isl_map_get_space(map), total,
+					disjoint ? ISL_MAP_DISJOINT : 0);
+		for (i = 0; res && i < n; ++i) {
+			isl_bool equal = isl_bool_false;
+
+			if (!ISL_F_ISSET(map, ISL_MAP_DISJOINT) && res->n > 0)
+				equal = isl_map_plain_is_equal(res, list[i]);
+			if (equal < 0)
+				res = isl_map_free(res);
+			if (equal)
+				continue;
+			for (j = 0; res && j < list[i]->n; ++j)
+				res = isl_map_add_basic_map(res,
+					isl_basic_map_copy(list[i]->p[j]));
+		}
+		if (res && res->n <= 1)
+			ISL_F_SET(res, ISL_MAP_DISJOINT);
+	}
+
+	for (i = 0; i < n; ++i)
+		isl_map_free(list[i]);
+	return res;
+}
+
+/* Compute explicit representations for the local variables
+ * of each of the basic maps of "map".
+ *
+ * The basic maps are handled independently of each other and
+ * the results are only combined at the end, avoiding the construction
+ * of intermediate unions.
+ * After each basic map has been handled, the callback set by
+ * isl_ctx_set_disjunct_callback is informed about
+ * the number of basic maps this resulted in and
+ * the number of operations this took.
+ */
 __isl_give isl_map *isl_map_compute_divs(__isl_take isl_map *map)
 {
-	int i;
+	int i, n;
 	int known;
+	isl_ctx *ctx;
+	isl_map **list;
 	struct isl_map *res;
 
 	if (!map)
@@ -8170,15 +8300,29 @@ __isl_give isl_map *isl_map_compute_divs(__isl_take isl_map *map)
 	if (known)
 		return map;
 
-	res = isl_basic_map_compute_divs(isl_basic_map_copy(map->p[0]));
-	for (i = 1 ; i < map->n; ++i) {
-		struct isl_map *r2;
-		r2 = isl_basic_map_compute_divs(isl_basic_map_copy(map->p[i]));
-		if (ISL_F_ISSET(map, ISL_MAP_DISJOINT))
-			res = isl_map_union_disjoint(res, r2);
-		else
-			res = isl_map_union(res, r2);
+	ctx = isl_map_get_ctx(map);
+	n = map->n;
+	list = isl_calloc_array(ctx, isl_map *, n);
+	if (!list)
+		return isl_map_free(map);
+	for (i = 0; i < n; ++i) {
+		unsigned long operations = ctx->operations;
+
+		list[i] = isl_basic_map_compute_divs(
+					isl_basic_map_copy(map->p[i]));
+		if (!list[i] ||
+		    isl_ctx_report_disjunct(ctx, "compute_divs", i, n,
+				list[i]->n, ctx->operations - operations) < 0)
+			break;
+	}
+	if (i < n) {
+		for (i = 0; i < n; ++i)
+			isl_map_free(list[i]);
+		res = NULL;
+	} else {
+		res = merge_disjunct_results(map, list, n);
 	}
+	free(list);
 	isl_map_free(map);
 
 	return res;
@@ -8316,6 +8460,8 @@ __isl_give isl_map *isl_map_union(__isl_take isl_map *map1,
 {
 	int equal;
 
+	ISL_TRACE_BIN(isl_map, isl_map_union, map1, map2);
+
 	if (isl_map_align_params_bin(&map1, &map2) < 0)
 		goto error;
 
@@ -8349,6 +8495,8 @@ __isl_give isl_set *isl_set_union_disjoint(
 __isl_give isl_set *isl_set_union(__isl_take isl_set *set1,
 	__isl_take isl_set *set2)
 {
+	ISL_TRACE_BIN(isl_set, isl_set_union, set1, set2);
+
 	return set_from_map(isl_map_union(set_to_map(set1), set_to_map(set2)));
 }
 
@@ -8683,6 +8831,8 @@ __isl_give isl_map *isl_map_intersect_range_wrapped_domain(
 __isl_give isl_map *isl_map_apply_domain(__isl_take isl_map *map1,
 	__isl_take isl_map *map2)
 {
+	ISL_TRACE_BIN(isl_map, isl_map_apply_domain, map1, map2);
+
 	if (isl_map_align_params_bin(&map1, &map2) < 0)
 		goto error;
 	map1 = isl_map_reverse(map1);
@@ -8701,6 +8851,8 @@ __isl_give isl_map *isl_map_apply_range(__isl_take isl_map *map1,
 	struct isl_map *result;
 	int i, j;
 
+	ISL_TRACE_BIN(isl_map, isl_map_apply_range, map1, map2);
+
 	if (isl_map_align_params_bin(&map1, &map2) < 0)
 		goto error;
 
@@ -9204,6 +9356,8 @@ isl_bool isl_basic_map_is_equal(__isl_keep isl_basic_map *bmap1,
 
 	if (!bmap1 || !bmap2)
 		return isl_bool_error;
+	if (bmap1 == bmap2)
+		return isl_bool_true;
 	is_subset = isl_basic_map_is_subset(bmap1, bmap2);
 	if (is_subset != isl_bool_true)
 		return is_subset;
@@ -9336,6 +9490,8 @@ isl_bool isl_basic_map_is_strict_subset(__isl_keep isl_basic_map *bmap1,
 
 	if (!bmap1 || !bmap2)
 		return isl_bool_error;
+	if (bmap1 == bmap2)
+		return isl_bool_false;
 	is_subset = isl_basic_map_is_subset(bmap1, bmap2);
 	if (is_subset != isl_bool_true)
 		return is_subset;
@@ -10191,6 +10347,57 @@ isl_bool isl_basic_map_plain_is_fixed(__isl_keep isl_basic_map *bmap,
 		isl_basic_map_offset(bmap, type) - 1 + pos, val);
 }
 
+/* Look for constant bounds on variable "pos" of "bmap",
+ * with "pos" the position of the variable among all variables,
+ * in the constraints of "bmap" that do not involve any other variables.
+ * Set *has_lower and *has_upper depending on whether
+ * a lower and an upper bound was found and
+ * store the tightest such bounds in "lower" and "upper".
+ */
+isl_stat isl_basic_map_plain_var_bounds(__isl_keep isl_basic_map *bmap,
+	int pos, isl_int *lower, int *has_lower, isl_int *upper, int *has_upper)
+{
+	int i;
+	isl_size total;
+	isl_int v;
+
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	if (total < 0)
+		return isl_stat_error;
+
+	*has_lower = *has_upper = 0;
+	isl_int_init(v);
+	for (i = 0; i < bmap->n_eq + bmap->n_ineq; ++i) {
+		int eq = i < bmap->n_eq;
+		isl_int *c = eq ? bmap->eq[i] : bmap->ineq[i - bmap->n_eq];
+
+		if (isl_int_is_zero(c[1 + pos]))
+			continue;
+		if (isl_seq_first_non_zero(c + 1, pos) != -1)
+			continue;
+		if (isl_seq_first_non_zero(c + 1 + pos + 1,
+					    total - pos - 1) != -1)
+			continue;
+		if (eq || isl_int_is_pos(c[1 + pos])) {
+			isl_int_neg(v, c[0]);
+			isl_int_cdiv_q(v, v, c[1 + pos]);
+			if (!*has_lower || isl_int_gt(v, *lower))
+				isl_int_set(*lower, v);
+			*has_lower = 1;
+		}
+		if (eq || isl_int_is_neg(c[1 + pos])) {
+			isl_int_neg(v, c[0]);
+			isl_int_fdiv_q(v, v, c[1 + pos]);
+			if (!*has_upper || isl_int_lt(v, *upper))
+				isl_int_set(*upper, v);
+			*has_upper = 1;
+		}
+	}
+	isl_int_clear(v);
+
+	return isl_stat_ok;
+}
+
 /* If "bmap" obviously lies on a hyperplane where the given dimension
  * has a fixed value, then return that value.
  * Otherwise return NaN.
@@ -11303,6 +11510,241 @@ uint32_t isl_basic_set_get_hash(__isl_keep isl_basic_set *bset)
 	return isl_basic_map_get_hash(bset_to_bmap(bset));
 }
 
+/* Compute a hash value of the representation of "bmap",
+ * consistent with isl_basic_map_plain_cmp.
+ * In particular, unlike isl_basic_map_get_hash, "bmap" is not
+ * normalized first.
+ */
+static uint32_t basic_map_plain_hash(__isl_keep isl_basic_map *bmap)
+{
+	int i;
+	uint32_t hash = isl_hash_init();
+	isl_size total;
+
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	if (total < 0)
+		return 0;
+	isl_hash_hash(hash, isl_space_get_full_hash(bmap->dim));
+	isl_hash_byte(hash, ISL_F_ISSET(bmap, ISL_BASIC_MAP_RATIONAL) ? 1 : 0);
+	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY))
+		return hash;
+	isl_hash_byte(hash, bmap->n_eq & 0xFF);
+	for (i = 0; i < bmap->n_eq; ++i)
+		isl_hash_hash(hash, isl_seq_get_hash(bmap->eq[i], 1 + total));
+	isl_hash_byte(hash, bmap->n_ineq & 0xFF);
+	for (i = 0; i < bmap->n_ineq; ++i)
+		isl_hash_hash(hash, isl_seq_get_hash(bmap->ineq[i], 1 + total));
+	isl_hash_byte(hash, bmap->n_div & 0xFF);
+	for (i = 0; i < bmap->n_div; ++i) {
+		if (isl_int_is_zero(bmap->div[i][0]))
+			continue;
+		isl_hash_byte(hash, i & 0xFF);
+		isl_hash_hash(hash, isl_seq_get_hash(bmap->div[i], 1 + 1 + total));
+	}
+	return hash;
+}
+
+/* A table of interned basic maps, attached to an isl_ctx.
+ * "table" maps the hash value computed by basic_map_plain_hash
+ * to the interned basic map.  The table holds a reference
+ * to each of these basic maps.
+ * Once the number of elements in the table reaches "sweep",
+ * the basic maps that are only referenced by the table are removed.
+ */
+struct isl_basic_map_intern_table {
+	struct isl_hash_table *table;
+	int sweep;
+};
+
+/* Free the basic map stored in hash table entry "entry".
+ */
+static isl_stat free_interned(void **entry, void *user)
+{
+	isl_basic_map_free(*entry);
+	return isl_stat_ok;
+}
+
+/* Free all basic maps in the interning table of "ctx" as well
+ * as the table itself.
+ *
+ * This needs to be called before "ctx" itself is freed
+ * since the interned basic maps hold references to "ctx".
+ */
+void isl_basic_map_intern_table_clear(isl_ctx *ctx)
+{
+	struct isl_basic_map_intern_table *intern;
+
+	if (!ctx || !ctx->basic_map_intern)
+		return;
+
+	intern = ctx->basic_map_intern;
+	ctx->basic_map_intern = NULL;
+	isl_hash_table_foreach(ctx, intern->table, &free_interned, NULL);
+	isl_hash_table_free(ctx, intern->table);
+	free(intern);
+}
+
+/* Return the interning table of "ctx", allocating it if needed.
+ */
+static struct isl_basic_map_intern_table *get_intern_table(isl_ctx *ctx)
+{
+	struct isl_basic_map_intern_table *intern;
+
+	if (ctx->basic_map_intern)
+		return ctx->basic_map_intern;
+
+	intern = isl_calloc_type(ctx, struct isl_basic_map_intern_table);
+	if (!intern)
+		return NULL;
+	intern->table = isl_hash_table_alloc(ctx, 256);
+	if (!intern->table) {
+		free(intern);
+		return NULL;
+	}
+	intern->sweep = 256;
+	ctx->basic_map_intern = intern;
+
+	return intern;
+}
+
+/* isl_hash_table_find callback that never matches.
+ * This is used to insert elements that are known to be distinct.
+ */
+static isl_bool no_match(const void *entry, const void *val)
+{
+	return isl_bool_false;
+}
+
+/* Remove the basic maps from "intern" that are only referenced
+ * by the table itself, by moving the other basic maps
+ * to a fresh hash table.
+ * The next sweep is scheduled for when the table has doubled in size
+ * compared to the number of elements that remain.
+ */
+static isl_stat intern_table_sweep(isl_ctx *ctx,
+	struct isl_basic_map_intern_table *intern)
+{
+	size_t h, size;
+	struct isl_hash_table *table;
+	struct isl_hash_table_entry *entries;
+
+	table = isl_hash_table_alloc(ctx, intern->table->n);
+	if (!table)
+		return isl_stat_error;
+
+	entries = intern->table->entries;
+	size = (size_t) 1 << intern->table->bits;
+	for (h = 0; h < size; ++h) {
+		isl_basic_map *bmap = entries[h].data;
+		struct isl_hash_table_entry *entry;
+
+		if (!bmap)
+			continue;
+		if (bmap->ref == 1) {
+			isl_basic_map_free(bmap);
+			continue;
+		}
+		entry = isl_hash_table_find(ctx, table, entries[h].hash,
+					    &no_match, NULL, 1);
+		if (!entry) {
+			isl_basic_map_free(bmap);
+			continue;
+		}
+		entry->data = bmap;
+	}
+	isl_hash_table_free(ctx, intern->table);
+	intern->table = table;
+	intern->sweep = 2 * table->n;
+	if (intern->sweep < 256)
+		intern->sweep = 256;
+
+	return isl_stat_ok;
+}
+
+/* isl_hash_table_find callback for checking whether the interned
+ * basic map "entry" has the same representation as "val".
+ */
+static isl_bool basic_map_plain_is_equal_entry(const void *entry,
+	const void *val)
+{
+	isl_basic_map *bmap1 = (isl_basic_map *) entry;
+	isl_basic_map *bmap2 = (isl_basic_map *) val;
+
+	return isl_basic_map_plain_is_equal(bmap1, bmap2);
+}
+
+/* Transfer information that is known about "bmap" to "interned",
+ * where both basic maps are known to have the same representation.
+ * If they are both empty, then their representations
+ * may be different and so nothing is transferred.
+ */
+static void transfer_known(__isl_keep isl_basic_map *interned,
+	__isl_keep isl_basic_map *bmap)
+{
+	unsigned known = ISL_BASIC_MAP_NO_IMPLICIT |
+			 ISL_BASIC_MAP_NO_REDUNDANT |
+			 ISL_BASIC_MAP_ALL_EQUALITIES |
+			 ISL_BASIC_MAP_SORTED |
+			 ISL_BASIC_MAP_NORMALIZED_DIVS;
+
+	if (ISL_F_ISSET(interned, ISL_BASIC_MAP_EMPTY))
+		return;
+	interned->flags |= bmap->flags & known;
+	if (!interned->sample && bmap->sample)
+		interned->sample = isl_vec_copy(bmap->sample);
+}
+
+/* Return a basic map that is plainly equal to "bmap" and
+ * that is shared by all basic maps that have been interned before
+ * with the same representation, if the intern-basic-maps option is set.
+ * Return "bmap" itself otherwise.
+ *
+ * The table keeps a reference to each of the interned basic maps.
+ * This means that any user of such a basic map who wants
+ * to modify it will obtain a copy through isl_basic_map_cow.
+ */
+__isl_give isl_basic_map *isl_basic_map_intern(__isl_take isl_basic_map *bmap)
+{
+	isl_ctx *ctx;
+	uint32_t hash;
+	struct isl_basic_map_intern_table *intern;
+	struct isl_hash_table_entry *entry;
+	isl_basic_map *interned;
+
+	if (!bmap)
+		return NULL;
+	ctx = isl_basic_map_get_ctx(bmap);
+	if (!ctx->opt->intern_basic_maps)
+		return bmap;
+	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_INTERNED))
+		return bmap;
+
+	intern = get_intern_table(ctx);
+	if (!intern)
+		return isl_basic_map_free(bmap);
+	if (intern->table->n >= intern->sweep &&
+	    intern_table_sweep(ctx, intern) < 0)
+		return isl_basic_map_free(bmap);
+
+	hash = basic_map_plain_hash(bmap);
+	entry = isl_hash_table_find(ctx, intern->table, hash,
+				    &basic_map_plain_is_equal_entry, bmap, 1);
+	if (!entry)
+		return isl_basic_map_free(bmap);
+	if (entry->data) {
+		ctx->stats->intern_hits++;
+		interned = entry->data;
+		transfer_known(interned, bmap);
+		isl_basic_map_free(bmap);
+		return isl_basic_map_copy(interned);
+	}
+
+	ctx->stats->intern_misses++;
+	ISL_F_SET(bmap, ISL_BASIC_MAP_INTERNED);
+	entry->data = isl_basic_map_copy(bmap);
+	return bmap;
+}
+
 uint32_t isl_map_get_hash(__isl_keep isl_map *map)
 {
 	int i;
@@ -12516,6 +12958,7 @@ __isl_give isl_basic_map *isl_basic_map_realign(__isl_take isl_basic_map *bmap,
 
 	flags = bmap->flags;
 	ISL_FL_CLR(flags, ISL_BASIC_MAP_FINAL);
+	ISL_FL_CLR(flags, ISL_BASIC_MAP_INTERNED);
 	ISL_FL_CLR(flags, ISL_BASIC_MAP_SORTED);
 	ISL_FL_CLR(flags, ISL_BASIC_MAP_NORMALIZED_DIVS);
 	res = isl_basic_map_alloc_space(space, n_div, bmap->n_eq, bmap->n_ineq);
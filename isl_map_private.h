@@ -44,6 +44,7 @@ struct isl_basic_map {
 #define ISL_BASIC_MAP_NORMALIZED_DIVS	(1 << 6)
 #define ISL_BASIC_MAP_ALL_EQUALITIES	(1 << 7)
 #define ISL_BASIC_MAP_REDUCED_COEFFICIENTS	(1 << 8)
+#define ISL_BASIC_MAP_INTERNED		(1 << 9)
 #define ISL_BASIC_SET_FINAL		(1 << 0)
 #define ISL_BASIC_SET_EMPTY		(1 << 1)
 #define ISL_BASIC_SET_NO_IMPLICIT	(1 << 2)
@@ -53,10 +54,14 @@ struct isl_basic_map {
 #define ISL_BASIC_SET_NORMALIZED_DIVS	(1 << 6)
 #define ISL_BASIC_SET_ALL_EQUALITIES	(1 << 7)
 #define ISL_BASIC_SET_REDUCED_COEFFICIENTS	(1 << 8)
+#define ISL_BASIC_SET_INTERNED		(1 << 9)
 	unsigned flags;
 
 	struct isl_ctx *ctx;
 
+	/* bytes accounted to ctx, excluding those of block and block2 */
+	size_t memory;
+
 	isl_space *dim;
 	unsigned extra;
 
@@ -97,8 +102,10 @@ struct isl_map {
 	int ref;
 #define ISL_MAP_DISJOINT		(1 << 0)
 #define ISL_MAP_NORMALIZED		(1 << 1)
+#define ISL_MAP_COALESCED		(1 << 2)
 #define ISL_SET_DISJOINT		(1 << 0)
 #define ISL_SET_NORMALIZED		(1 << 1)
+#define ISL_SET_COALESCED		(1 << 2)
 	unsigned flags;
 	isl_basic_map *cached_simple_hull[2];
 
@@ -135,6 +142,7 @@ __isl_give isl_basic_map *isl_basic_map_mark_final(
 	__isl_take isl_basic_map *bmap);
 __isl_give isl_basic_map *isl_basic_map_finalize(
 	__isl_take isl_basic_map *bmap);
+__isl_give isl_basic_map *isl_basic_map_intern(__isl_take isl_basic_map *bmap);
 __isl_give isl_basic_map *isl_basic_map_extend_constraints(
 	__isl_take isl_basic_map *base, unsigned n_eq, unsigned n_ineq);
 __isl_give isl_basic_map *isl_basic_map_simplify(
@@ -516,6 +524,8 @@ isl_bool isl_map_is_params(__isl_keep isl_map *map);
 
 isl_bool isl_basic_set_plain_dim_is_fixed(__isl_keep isl_basic_set *bset,
 	unsigned dim, isl_int *val);
+isl_stat isl_basic_map_plain_var_bounds(__isl_keep isl_basic_map *bmap,
+	int pos, isl_int *lower, int *has_lower, isl_int *upper, int *has_upper);
 
 __isl_give isl_set *isl_set_plain_gist_basic_set(__isl_take isl_set *set,
 	__isl_take isl_basic_set *context);
@@ -22,6 +22,8 @@
 #include <isl_space_private.h>
 #include <isl_mat_private.h>
 #include <isl_vec_private.h>
+#include <isl_trace_private.h>
+#include <isl_profile_private.h>
 
 #include <bset_to_bmap.c>
 #include <bset_from_bmap.c>
@@ -1513,7 +1515,8 @@ __isl_give isl_basic_map *isl_basic_map_eliminate_pure_unit_divs(
 	return eliminate_selected_unit_divs(bmap, &is_pure_unit_div, NULL);
 }
 
-__isl_give isl_basic_map *isl_basic_map_simplify(__isl_take isl_basic_map *bmap)
+static __isl_give isl_basic_map *basic_map_simplify(
+	__isl_take isl_basic_map *bmap)
 {
 	int progress = 1;
 	if (!bmap)
@@ -1545,6 +1548,18 @@ __isl_give isl_basic_map *isl_basic_map_simplify(__isl_take isl_basic_map *bmap)
 	return bmap;
 }
 
+__isl_give isl_basic_map *isl_basic_map_simplify(__isl_take isl_basic_map *bmap)
+{
+	isl_ctx *ctx;
+
+	ctx = isl_basic_map_get_ctx(bmap);
+	isl_profile_enter(ctx, isl_profile_simplify);
+	bmap = basic_map_simplify(bmap);
+	isl_profile_leave(ctx, isl_profile_simplify);
+
+	return bmap;
+}
+
 __isl_give isl_basic_set *isl_basic_set_simplify(
 	__isl_take isl_basic_set *bset)
 {
@@ -3678,6 +3693,8 @@ __isl_give isl_map *isl_map_gist(__isl_take isl_map *map,
 	isl_bool subset;
 	isl_basic_map *hull;
 
+	ISL_TRACE_BIN(isl_map, isl_map_gist, map, context);
+
 	is_universe = isl_map_plain_is_universe(map);
 	if (is_universe >= 0 && !is_universe)
 		is_universe = isl_map_plain_is_universe(context);
@@ -3756,6 +3773,8 @@ __isl_give isl_set *isl_set_gist_params_basic_set(__isl_take isl_set *set,
 __isl_give isl_set *isl_set_gist(__isl_take isl_set *set,
 	__isl_take isl_set *context)
 {
+	ISL_TRACE_BIN(isl_set, isl_set_gist, set, context);
+
 	return set_from_map(isl_map_gist(set_to_map(set), set_to_map(context)));
 }
 
@@ -7,13 +7,17 @@
  * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
  */
 
+#include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl_seq.h>
+#include <isl_options_private.h>
 #include "isl/set.h"
 #include "isl/map.h"
 #include "isl_tab.h"
 #include <isl_point_private.h>
 #include <isl_vec_private.h>
+#include <isl_trace_private.h>
+#include <isl_profile_private.h>
 
 #include <set_to_map.c>
 #include <set_from_map.c>
@@ -481,6 +485,13 @@ struct isl_subtract_diff_collector {
 };
 
 /* isl_subtract_diff_collector callback.
+ *
+ * Since the basic maps collected in sdc->diff are disjoint from
+ * each other and since "bmap" is disjoint from all of them,
+ * "bmap" can simply be appended to sdc->diff.
+ * The room for the basic maps is grown geometrically
+ * such that collecting many pieces does not require
+ * repeated copying of the ones that were collected before.
  */
 static isl_stat basic_map_subtract_add(struct isl_diff_collector *dc,
 			    __isl_take isl_basic_map *bmap)
@@ -488,8 +499,11 @@ static isl_stat basic_map_subtract_add(struct isl_diff_collector *dc,
 	struct isl_subtract_diff_collector *sdc;
 	sdc = (struct isl_subtract_diff_collector *)dc;
 
-	sdc->diff = isl_map_union_disjoint(sdc->diff,
-			isl_map_from_basic_map(bmap));
+	sdc->diff = isl_map_cow(sdc->diff);
+	if (sdc->diff && sdc->diff->n >= sdc->diff->size)
+		sdc->diff = isl_map_grow(sdc->diff,
+					sdc->diff->n > 0 ? sdc->diff->n : 1);
+	sdc->diff = isl_map_add_basic_map(sdc->diff, bmap);
 
 	return sdc->diff ? isl_stat_ok : isl_stat_error;
 }
@@ -509,6 +523,121 @@ static __isl_give isl_map *basic_map_subtract(__isl_take isl_basic_map *bmap,
 	return sdc.diff;
 }
 
+/* Constant bounds on the variables of a basic map, other than
+ * the local variables, that can be read off directly from
+ * the constraints that involve a single variable.
+ *
+ * "rational" is set if the basic map is rational.
+ * "dim" is the number of variables.
+ * "bound" contains the lower bound of variable i at position 2 * i and
+ * the upper bound at position 2 * i + 1, with "has_bound"
+ * indicating whether the corresponding bound is available.
+ * The bounds are rounded to integer values, so they are only
+ * valid for the integer points of the basic map.
+ */
+struct isl_plain_box {
+	int rational;
+	int dim;
+	int *has_bound;
+	isl_vec *bound;
+};
+
+/* Free the memory allocated by plain_box_init.
+ */
+static void plain_box_clear(struct isl_plain_box *box)
+{
+	free(box->has_bound);
+	isl_vec_free(box->bound);
+}
+
+/* Initialize "box" to the constant bounds on the variables of "bmap"
+ * that can be read off directly from its constraints.
+ */
+static isl_stat plain_box_init(struct isl_plain_box *box,
+	__isl_keep isl_basic_map *bmap)
+{
+	int i;
+	isl_size dim;
+	isl_ctx *ctx;
+
+	box->has_bound = NULL;
+	box->bound = NULL;
+	dim = isl_basic_map_dim(bmap, isl_dim_all);
+	if (dim < 0)
+		return isl_stat_error;
+	dim -= bmap->n_div;
+	ctx = isl_basic_map_get_ctx(bmap);
+	box->rational = ISL_F_ISSET(bmap, ISL_BASIC_MAP_RATIONAL);
+	box->dim = dim;
+	box->has_bound = isl_alloc_array(ctx, int, 2 * dim);
+	box->bound = isl_vec_alloc(ctx, 2 * dim);
+	if ((dim && !box->has_bound) || !box->bound)
+		return isl_stat_error;
+
+	for (i = 0; i < dim; ++i)
+		if (isl_basic_map_plain_var_bounds(bmap, i,
+			    &box->bound->el[2 * i], &box->has_bound[2 * i],
+			    &box->bound->el[2 * i + 1],
+			    &box->has_bound[2 * i + 1]) < 0)
+			return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
+/* Is it obvious from "box1" and "box2" that the corresponding
+ * basic maps are disjoint?
+ * That is, is there a variable with disjoint ranges in the two boxes?
+ * The bounds are not used if either of the basic maps is rational
+ * since they only apply to integer points.
+ */
+static int plain_box_is_disjoint(struct isl_plain_box *box1,
+	struct isl_plain_box *box2)
+{
+	int i;
+
+	if (box1->rational || box2->rational)
+		return 0;
+	for (i = 0; i < box1->dim; ++i) {
+		if (box1->has_bound[2 * i + 1] && box2->has_bound[2 * i] &&
+		    isl_int_lt(box1->bound->el[2 * i + 1],
+				box2->bound->el[2 * i]))
+			return 1;
+		if (box2->has_bound[2 * i + 1] && box1->has_bound[2 * i] &&
+		    isl_int_lt(box2->bound->el[2 * i + 1],
+				box1->bound->el[2 * i]))
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Return the set difference between "bmap" with bounding box "box" and
+ * "map", where "map_box" contains the bounding boxes
+ * of the basic maps in "map".
+ *
+ * The basic maps of "map" that are obviously disjoint from "bmap"
+ * do not affect the result and are dropped before
+ * calling basic_map_subtract.
+ */
+static __isl_give isl_map *basic_map_subtract_pruned(
+	__isl_take isl_basic_map *bmap, struct isl_plain_box *box,
+	__isl_keep isl_map *map, struct isl_plain_box *map_box)
+{
+	int i;
+	isl_map *pruned;
+
+	pruned = isl_map_alloc_space(isl_map_get_space(map), map->n,
+					map->flags);
+	for (i = 0; i < map->n; ++i) {
+		if (plain_box_is_disjoint(box, &map_box[i]))
+			continue;
+		pruned = isl_map_add_basic_map(pruned,
+					isl_basic_map_copy(map->p[i]));
+	}
+
+	return basic_map_subtract(bmap, pruned);
+}
+
 /* Return an empty map living in the same space as "map1" and "map2".
  */
 static __isl_give isl_map *replace_pair_by_empty( __isl_take isl_map *map1,
@@ -529,13 +658,18 @@ static __isl_give isl_map *replace_pair_by_empty( __isl_take isl_map *map1,
  * then return an empty map in the same space.
  *
  * If "map1" and "map2" are disjoint, then simply return "map1".
+ *
+ * The bounding boxes of the basic maps in "map2" are computed
+ * only once and are used to avoid subtracting basic maps of "map2"
+ * from basic maps of "map1" that are obviously disjoint.
  */
-__isl_give isl_map *isl_map_subtract( __isl_take isl_map *map1,
+static __isl_give isl_map *map_subtract(__isl_take isl_map *map1,
 	__isl_take isl_map *map2)
 {
 	int i;
 	int equal, disjoint;
 	struct isl_map *diff;
+	struct isl_plain_box *box = NULL;
 
 	if (isl_map_align_params_bin(&map1, &map2) < 0)
 		goto error;
@@ -564,30 +698,71 @@ __isl_give isl_map *isl_map_subtract( __isl_take isl_map *map1,
 	map1 = isl_map_remove_empty_parts(map1);
 	map2 = isl_map_remove_empty_parts(map2);
 
+	box = isl_calloc_array(map1->ctx, struct isl_plain_box, map2->n);
+	if (map2->n && !box)
+		goto error;
+	for (i = 0; i < map2->n; ++i)
+		if (plain_box_init(&box[i], map2->p[i]) < 0)
+			goto error;
+
 	diff = isl_map_empty(isl_map_get_space(map1));
 	for (i = 0; i < map1->n; ++i) {
 		struct isl_map *d;
-		d = basic_map_subtract(isl_basic_map_copy(map1->p[i]),
-				       isl_map_copy(map2));
+		struct isl_plain_box box1;
+
+		if (plain_box_init(&box1, map1->p[i]) < 0)
+			d = NULL;
+		else
+			d = basic_map_subtract_pruned(
+				isl_basic_map_copy(map1->p[i]), &box1,
+				map2, box);
+		plain_box_clear(&box1);
 		if (ISL_F_ISSET(map1, ISL_MAP_DISJOINT))
 			diff = isl_map_union_disjoint(diff, d);
 		else
 			diff = isl_map_union(diff, d);
 	}
 
+	for (i = 0; i < map2->n; ++i)
+		plain_box_clear(&box[i]);
+	free(box);
 	isl_map_free(map1);
 	isl_map_free(map2);
 
 	return diff;
 error:
+	for (i = 0; box && i < map2->n; ++i)
+		plain_box_clear(&box[i]);
+	free(box);
 	isl_map_free(map1);
 	isl_map_free(map2);
 	return NULL;
 }
 
+/* Return the set difference between map1 and map2,
+ * recording the call in the trace and in the profile
+ * of the isl_ctx, if needed.
+ */
+__isl_give isl_map *isl_map_subtract( __isl_take isl_map *map1,
+	__isl_take isl_map *map2)
+{
+	isl_ctx *ctx;
+
+	ISL_TRACE_BIN(isl_map, isl_map_subtract, map1, map2);
+
+	ctx = isl_map_get_ctx(map1);
+	isl_profile_enter(ctx, isl_profile_subtract);
+	map1 = map_subtract(map1, map2);
+	isl_profile_leave(ctx, isl_profile_subtract);
+
+	return map1;
+}
+
 __isl_give isl_set *isl_set_subtract(__isl_take isl_set *set1,
 	__isl_take isl_set *set2)
 {
+	ISL_TRACE_BIN(isl_set, isl_set_subtract, set1, set2);
+
 	return set_from_map(isl_map_subtract(set_to_map(set1),
 					    set_to_map(set2)));
 }
@@ -824,56 +999,314 @@ static isl_bool map_is_singleton_subset(__isl_keep isl_map *map1,
 	return is_subset;
 }
 
-static isl_bool map_is_subset(__isl_keep isl_map *map1,
+/* Is the element "pnt" of the space of "map" an element of "map"?
+ * Assumes "map" has known divs.
+ */
+static isl_bool map_plain_contains_point(__isl_keep isl_map *map,
+	__isl_keep isl_point *pnt)
+{
+	int i;
+	isl_bool found = isl_bool_false;
+
+	for (i = 0; i < map->n; ++i) {
+		found = isl_basic_map_contains_point(map->p[i], pnt);
+		if (found < 0 || found)
+			break;
+	}
+
+	return found;
+}
+
+/* Is there a basic map in "map1" with a cached sample point
+ * that does not belong to "map2"?
+ * If so, then "map1" is obviously not a subset of "map2".
+ * Assumes "map2" has known divs.
+ *
+ * Only integer samples that are known to be elements of their basic maps
+ * are taken into account.  The sample points of the basic maps
+ * in "map1" are typically available because "map1" has been
+ * checked for emptiness.
+ */
+static isl_bool sample_refutes_subset(__isl_keep isl_map *map1,
 	__isl_keep isl_map *map2)
 {
-	isl_bool is_subset = isl_bool_false;
-	isl_bool empty, single;
-	isl_bool rat1, rat2;
+	int i;
+	isl_size dim;
 
-	if (!map1 || !map2)
+	dim = isl_map_dim(map1, isl_dim_all);
+	if (dim < 0 || !map2)
 		return isl_bool_error;
 
+	for (i = 0; i < map1->n; ++i) {
+		isl_basic_map *bmap = map1->p[i];
+		isl_vec *vec;
+		isl_point *pnt;
+		isl_bool contains;
+
+		if (!bmap->sample || ISL_F_ISSET(bmap, ISL_BASIC_MAP_RATIONAL))
+			continue;
+		if (bmap->sample->size < 1 + dim ||
+		    !isl_int_is_one(bmap->sample->el[0]))
+			continue;
+		contains = isl_basic_map_contains(bmap, bmap->sample);
+		if (contains < 0)
+			return isl_bool_error;
+		if (!contains)
+			continue;
+		vec = isl_vec_copy(bmap->sample);
+		vec = isl_vec_cow(vec);
+		if (vec)
+			vec->size = 1 + dim;
+		pnt = isl_point_alloc(isl_map_get_space(map1), vec);
+		if (!pnt)
+			return isl_bool_error;
+		contains = map_plain_contains_point(map2, pnt);
+		isl_point_free(pnt);
+		if (contains < 0 || !contains)
+			return isl_bool_not(contains);
+	}
+
+	return isl_bool_false;
+}
+
+/* Remove the basic maps from "map1" that are plainly equal to
+ * some basic map in "map2".
+ * These basic maps are obviously subsets of "map2" and
+ * can therefore be ignored in the computation of the difference.
+ */
+static __isl_give isl_map *drop_plain_subsets(__isl_take isl_map *map1,
+	__isl_keep isl_map *map2)
+{
+	int i, j;
+
+	if (!map1 || !map2)
+		return isl_map_free(map1);
+
+	for (i = map1->n - 1; i >= 0; --i) {
+		for (j = 0; j < map2->n; ++j) {
+			isl_bool equal;
+
+			equal = isl_basic_map_plain_is_equal(map1->p[i],
+							map2->p[j]);
+			if (equal < 0)
+				return isl_map_free(map1);
+			if (!equal)
+				continue;
+			map1 = isl_map_cow(map1);
+			if (!map1)
+				return NULL;
+			isl_basic_map_free(map1->p[i]);
+			map1->n--;
+			if (i != map1->n) {
+				map1->p[i] = map1->p[map1->n];
+				ISL_F_CLR(map1, ISL_MAP_NORMALIZED);
+			}
+			break;
+		}
+	}
+
+	return map1;
+}
+
+/* Perform some plain checks for deciding whether "map1"
+ * is a subset of "map2".
+ * Return isl_bool_true if these checks are able to decide the result and
+ * store the result in "is_subset" in that case.
+ */
+static isl_bool plain_decide_subset(__isl_keep isl_map *map1,
+	__isl_keep isl_map *map2, isl_bool *is_subset)
+{
+	isl_bool empty, equal;
+	isl_bool rat1, rat2;
+
+	*is_subset = isl_bool_false;
 	if (!isl_map_has_equal_space(map1, map2))
-		return isl_bool_false;
+		return isl_bool_true;
 
 	empty = isl_map_is_empty(map1);
-	if (empty < 0)
-		return isl_bool_error;
-	if (empty)
-		return isl_bool_true;
+	if (empty < 0 || empty) {
+		*is_subset = empty;
+		return empty < 0 ? isl_bool_error : isl_bool_true;
+	}
 
 	empty = isl_map_is_empty(map2);
-	if (empty < 0)
-		return isl_bool_error;
-	if (empty)
-		return isl_bool_false;
+	if (empty < 0 || empty)
+		return empty;
 
 	rat1 = isl_map_has_rational(map1);
 	rat2 = isl_map_has_rational(map2);
 	if (rat1 < 0 || rat2 < 0)
 		return isl_bool_error;
 	if (rat1 && !rat2)
-		return isl_bool_false;
+		return isl_bool_true;
 
-	if (isl_map_plain_is_universe(map2))
+	if (isl_map_plain_is_universe(map2)) {
+		*is_subset = isl_bool_true;
 		return isl_bool_true;
+	}
+
+	equal = isl_map_plain_is_equal(map1, map2);
+	*is_subset = equal;
+	return equal;
+}
+
+/* Is "map1" a subset of "map2"?
+ *
+ * The check is performed in layers of increasing cost.
+ * First, a collection of plain checks are performed.
+ * Then, check if the cached sample point of any basic map of "map1"
+ * lies outside of "map2".
+ * Finally, check whether the difference of the basic maps
+ * of "map1" that do not plainly appear in "map2" with "map2" is empty.
+ * The layer that decides the result is recorded in the statistics
+ * of the context.
+ */
+static isl_bool map_is_subset_layered(__isl_keep isl_map *map1,
+	__isl_keep isl_map *map2)
+{
+	isl_ctx *ctx;
+	isl_bool is_subset = isl_bool_false;
+	isl_bool decided, single, refuted;
+
+	if (!map1 || !map2)
+		return isl_bool_error;
+
+	ctx = isl_map_get_ctx(map1);
+	decided = plain_decide_subset(map1, map2, &is_subset);
+	if (decided < 0)
+		return isl_bool_error;
+	if (decided) {
+		ctx->stats->subset_plain++;
+		return is_subset;
+	}
 
 	single = isl_map_plain_is_singleton(map1);
 	if (single < 0)
 		return isl_bool_error;
 	map2 = isl_map_compute_divs(isl_map_copy(map2));
 	if (single) {
+		ctx->stats->subset_plain++;
 		is_subset = map_is_singleton_subset(map1, map2);
 		isl_map_free(map2);
 		return is_subset;
 	}
+
+	refuted = sample_refutes_subset(map1, map2);
+	if (refuted < 0 || refuted) {
+		if (refuted)
+			ctx->stats->subset_sample++;
+		isl_map_free(map2);
+		return isl_bool_not(refuted);
+	}
+
+	ctx->stats->subset_full++;
+	map1 = drop_plain_subsets(isl_map_copy(map1), map2);
 	is_subset = map_diff_is_empty(map1, map2);
+	isl_map_free(map1);
 	isl_map_free(map2);
 
 	return is_subset;
 }
 
+/* The data of an entry in the subset cache, recording that "map1"
+ * is a subset of "map2" if "is_subset" is set and that it is not otherwise.
+ * When looking up a pair of maps in the cache,
+ * "is_subset" is not used.
+ */
+struct isl_subset_cache_data {
+	isl_map *map1;
+	isl_map *map2;
+	isl_bool is_subset;
+};
+
+static void subset_cache_data_free(void *user)
+{
+	struct isl_subset_cache_data *data = user;
+
+	isl_map_free(data->map1);
+	isl_map_free(data->map2);
+	free(data);
+}
+
+/* isl_ctx_cache_find callback that checks whether the cache entry
+ * with data "entry" holds the result for the pair of maps in "val".
+ *
+ * The maps are compared using isl_map_plain_is_equal, which
+ * immediately returns true if they are the same object.
+ */
+static isl_bool has_pair(const void *entry, const void *val)
+{
+	const struct isl_subset_cache_data *data = entry;
+	const struct isl_subset_cache_data *pair = val;
+	isl_bool equal;
+
+	equal = isl_map_plain_is_equal(data->map1, pair->map1);
+	if (equal != isl_bool_true)
+		return equal;
+	return isl_map_plain_is_equal(data->map2, pair->map2);
+}
+
+/* Record in "cache" that "map1" is a subset of "map2"
+ * if "is_subset" is set and that it is not otherwise.
+ */
+static void subset_cache_add(isl_ctx *ctx, struct isl_ctx_cache *cache,
+	uint32_t hash, __isl_keep isl_map *map1, __isl_keep isl_map *map2,
+	isl_bool is_subset)
+{
+	struct isl_subset_cache_data *data;
+
+	data = isl_alloc_type(ctx, struct isl_subset_cache_data);
+	if (!data)
+		return;
+	data->map1 = isl_map_copy(map1);
+	data->map2 = isl_map_copy(map2);
+	data->is_subset = is_subset;
+	isl_ctx_cache_add(cache, hash, data);
+}
+
+/* Is "map1" a subset of "map2"?
+ *
+ * If the subset-cache-size option is set, then first check
+ * whether the same question has already been answered
+ * for identical inputs in the same isl_ctx.
+ */
+static isl_bool map_is_subset(__isl_keep isl_map *map1,
+	__isl_keep isl_map *map2)
+{
+	isl_ctx *ctx;
+	uint32_t hash;
+	isl_bool is_subset;
+	struct isl_ctx_cache *cache;
+	struct isl_subset_cache_data pair, *data;
+
+	if (!map1 || !map2)
+		return isl_bool_error;
+
+	ctx = isl_map_get_ctx(map1);
+	cache = isl_ctx_cache_get(ctx, &ctx->subset_cache,
+				ctx->opt->subset_cache_size, 0,
+				&subset_cache_data_free);
+	if (!cache)
+		return map_is_subset_layered(map1, map2);
+
+	hash = isl_hash_init();
+	isl_hash_hash(hash, isl_map_get_hash(map1));
+	isl_hash_hash(hash, isl_map_get_hash(map2));
+	pair.map1 = map1;
+	pair.map2 = map2;
+	data = isl_ctx_cache_find(cache, hash, &has_pair, &pair);
+	if (data) {
+		ctx->stats->subset_cache_hits++;
+		return data->is_subset;
+	}
+	ctx->stats->subset_cache_misses++;
+	is_subset = map_is_subset_layered(map1, map2);
+	if (is_subset >= 0)
+		subset_cache_add(ctx, cache, hash, map1, map2, is_subset);
+
+	return is_subset;
+}
+
 isl_bool isl_map_is_subset(__isl_keep isl_map *map1, __isl_keep isl_map *map2)
 {
 	return isl_map_align_params_map_map_and_test(map1, map2,
@@ -885,9 +1318,20 @@ isl_bool isl_set_is_subset(__isl_keep isl_set *set1, __isl_keep isl_set *set2)
 	return isl_map_is_subset(set_to_map(set1), set_to_map(set2));
 }
 
+/* Return a representation of "map" in terms of disjoint basic maps.
+ *
+ * Each basic map is added in turn to the disjoint union of
+ * the previous basic maps, by collecting the parts of the basic map
+ * that do not appear in this union.
+ * After each basic map has been handled, the callback set by
+ * isl_ctx_set_disjunct_callback is informed about
+ * the number of basic maps in the union and
+ * the number of operations this took.
+ */
 __isl_give isl_map *isl_map_make_disjoint(__isl_take isl_map *map)
 {
 	int i;
+	isl_ctx *ctx;
 	struct isl_subtract_diff_collector sdc;
 	sdc.dc.add = &basic_map_subtract_add;
 
@@ -904,12 +1348,16 @@ __isl_give isl_map *isl_map_make_disjoint(__isl_take isl_map *map)
 	if (!map || map->n <= 1)
 		return map;
 
+	ctx = isl_map_get_ctx(map);
 	sdc.diff = isl_map_from_basic_map(isl_basic_map_copy(map->p[0]));
 
 	for (i = 1; i < map->n; ++i) {
+		unsigned long operations = ctx->operations;
 		struct isl_basic_map *bmap = isl_basic_map_copy(map->p[i]);
 		struct isl_map *copy = isl_map_copy(sdc.diff);
-		if (basic_map_collect_diff(bmap, copy, &sdc.dc) < 0) {
+		if (basic_map_collect_diff(bmap, copy, &sdc.dc) < 0 ||
+		    isl_ctx_report_disjunct(ctx, "make_disjoint", i, map->n,
+				sdc.diff->n, ctx->operations - operations) < 0) {
 			isl_map_free(sdc.diff);
 			sdc.diff = NULL;
 			break;
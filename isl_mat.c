@@ -50,15 +50,27 @@ uint32_t isl_mat_get_hash(__isl_keep isl_mat *mat)
 	return hash;
 }
 
+/* Return the number of bytes of memory accounted to the isl_ctx
+ * for an isl_mat with room for "max_row" rows, excluding
+ * the memory of the elements themselves, which is accounted
+ * by isl_blk.
+ */
+static size_t mat_memory(unsigned max_row)
+{
+	return sizeof(struct isl_mat) + max_row * sizeof(isl_int *);
+}
+
 __isl_give isl_mat *isl_mat_alloc(isl_ctx *ctx,
 	unsigned n_row, unsigned n_col)
 {
 	int i;
 	struct isl_mat *mat;
 
+	if (isl_ctx_memory_acquire(ctx, mat_memory(n_row)) < 0)
+		return NULL;
 	mat = isl_alloc_type(ctx, struct isl_mat);
 	if (!mat)
-		return NULL;
+		goto error_memory;
 
 	mat->row = NULL;
 	mat->block = isl_blk_alloc(ctx, n_row * n_col);
@@ -78,6 +90,7 @@ __isl_give isl_mat *isl_mat_alloc(isl_ctx *ctx,
 	mat->ref = 1;
 	mat->n_row = n_row;
 	mat->n_col = n_col;
+	mat->max_row = n_row;
 	mat->max_col = n_col;
 	mat->flags = 0;
 
@@ -85,6 +98,8 @@ __isl_give isl_mat *isl_mat_alloc(isl_ctx *ctx,
 error:
 	isl_blk_free(ctx, mat->block);
 	free(mat);
+error_memory:
+	isl_ctx_memory_release(ctx, mat_memory(n_row));
 	return NULL;
 }
 
@@ -126,10 +141,19 @@ __isl_give isl_mat *isl_mat_extend(__isl_take isl_mat *mat,
 	mat->block = isl_blk_extend(mat->ctx, mat->block, n_row * mat->max_col);
 	if (isl_blk_is_error(mat->block))
 		goto error;
-	row = isl_realloc_array(mat->ctx, mat->row, isl_int *, n_row);
-	if (n_row && !row)
-		goto error;
-	mat->row = row;
+	if (n_row > mat->max_row) {
+		size_t extra = mat_memory(n_row) - mat_memory(mat->max_row);
+
+		if (isl_ctx_memory_acquire(mat->ctx, extra) < 0)
+			goto error;
+		row = isl_realloc_array(mat->ctx, mat->row, isl_int *, n_row);
+		if (!row) {
+			isl_ctx_memory_release(mat->ctx, extra);
+			goto error;
+		}
+		mat->row = row;
+		mat->max_row = n_row;
+	}
 
 	for (i = 0; i < mat->n_row; ++i)
 		mat->row[i] = mat->block.data + (mat->row[i] - old);
@@ -151,9 +175,11 @@ __isl_give isl_mat *isl_mat_sub_alloc6(isl_ctx *ctx, isl_int **row,
 	int i;
 	struct isl_mat *mat;
 
+	if (isl_ctx_memory_acquire(ctx, mat_memory(n_row)) < 0)
+		return NULL;
 	mat = isl_alloc_type(ctx, struct isl_mat);
 	if (!mat)
-		return NULL;
+		goto error_memory;
 	mat->row = isl_alloc_array(ctx, isl_int *, n_row);
 	if (n_row && !mat->row)
 		goto error;
@@ -164,11 +190,14 @@ __isl_give isl_mat *isl_mat_sub_alloc6(isl_ctx *ctx, isl_int **row,
 	mat->ref = 1;
 	mat->n_row = n_row;
 	mat->n_col = n_col;
+	mat->max_row = n_row;
 	mat->block = isl_blk_empty();
 	mat->flags = ISL_MAT_BORROWED;
 	return mat;
 error:
 	free(mat);
+error_memory:
+	isl_ctx_memory_release(ctx, mat_memory(n_row));
 	return NULL;
 }
 
@@ -247,6 +276,7 @@ __isl_null isl_mat *isl_mat_free(__isl_take isl_mat *mat)
 
 	if (!ISL_F_ISSET(mat, ISL_MAT_BORROWED))
 		isl_blk_free(mat->ctx, mat->block);
+	isl_ctx_memory_release(mat->ctx, mat_memory(mat->max_row));
 	isl_ctx_deref(mat->ctx);
 	free(mat->row);
 	free(mat);
@@ -17,6 +17,8 @@ struct isl_mat {
 
 	isl_int **row;
 
+	/* number of elements allocated for "row"; n_row <= max_row */
+	unsigned max_row;
 	/* actual size of the rows in memory; n_col <= max_col */
 	unsigned max_col;
 
@@ -130,6 +130,24 @@ ISL_ARG_BOOL(struct isl_options, bernstein_triangulate, 0,
 	"triangulate domains during Bernstein expansion")
 ISL_ARG_BOOL(struct isl_options, pip_symmetry, 0, "pip-symmetry", 1,
 	"detect simple symmetries in PIP input")
+ISL_ARG_INT(struct isl_options, vertices_cache_size, 0,
+	"vertices-cache-size", "size", 0, "number of parametric vertex "
+	"computations to keep in the per-context cache. "
+	"A value of 0 disables the cache.")
+ISL_ARG_INT(struct isl_options, subset_cache_size, 0,
+	"subset-cache-size", "size", 0, "number of subset checks "
+	"to keep in the per-context cache. "
+	"A value of 0 disables the cache.")
+ISL_ARG_INT(struct isl_options, closure_cache_size, 0,
+	"closure-cache-size", "size", 0, "number of transitive closures "
+	"to keep in the per-context cache. "
+	"A value of 0 disables the cache.")
+ISL_ARG_BOOL(struct isl_options, intern_basic_maps, 0,
+	"intern-basic-maps", 0, "share the representation of "
+	"identical finalized basic maps")
+ISL_ARG_BOOL(struct isl_options, lp_float, 0, "lp-float", 0,
+	"start LP solving with a floating point simplex and "
+	"verify the result exactly")
 ISL_ARG_CHOICE(struct isl_options, convex, 0, "convex-hull", \
 	convex,	ISL_CONVEX_HULL_WRAP, "convex hull algorithm to use")
 ISL_ARG_BOOL(struct isl_options, coalesce_bounded_wrapping, 0,
@@ -221,6 +239,11 @@ ISL_ARG_BOOL(struct isl_options, print_stats, 0, "print-stats", 0,
 	"print statistics for every isl_ctx")
 ISL_ARG_ULONG(struct isl_options, max_operations, 0,
 	"max-operations", 0, "default number of maximal operations per isl_ctx")
+ISL_ARG_ULONG(struct isl_options, max_memory, 0,
+	"max-memory", 0, "default maximal number of bytes of memory "
+	"accounted to an isl_ctx")
+ISL_ARG_STR(struct isl_options, trace_file, 0, "trace-file", "file", NULL,
+	"record calls of traced functions in \"file\"")
 ISL_ARG_VERSION(print_version)
 ISL_ARGS_END
 
@@ -241,6 +264,31 @@ ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	pip_symmetry)
 
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	vertices_cache_size)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	vertices_cache_size)
+
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	subset_cache_size)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	subset_cache_size)
+
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	closure_cache_size)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	closure_cache_size)
+
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	intern_basic_maps)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	intern_basic_maps)
+
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	lp_float)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	lp_float)
+
 ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	coalesce_bounded_wrapping)
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
@@ -29,6 +29,16 @@ struct isl_options {
 
 	int			pip_symmetry;
 
+	int			vertices_cache_size;
+
+	int			subset_cache_size;
+
+	int			closure_cache_size;
+
+	int			intern_basic_maps;
+
+	int			lp_float;
+
 	#define			ISL_CONVEX_HULL_WRAP	0
 	#define			ISL_CONVEX_HULL_FM	1
 	int			convex;
@@ -70,6 +80,8 @@ struct isl_options {
 
 	int			print_stats;
 	unsigned long		max_operations;
+	unsigned long		max_memory;
+	char			*trace_file;
 };
 
 #endif
@@ -14,6 +14,8 @@
  * and Cerebras Systems, 1237 E Arques Ave, Sunnyvale, CA, USA
  */
 
+#include <limits.h>
+#include <math.h>
 #include <isl_map_private.h>
 #include <isl_point_private.h>
 #include "isl/set.h"
@@ -883,3 +885,365 @@ __isl_give isl_printer *isl_printer_print_point(
 	p = isl_printer_print_str(p, " }");
 	return p;
 }
+
+/* A compiled representation of a basic set for testing
+ * whether integer points belong to the basic set using
+ * native integer arithmetic.
+ *
+ * "div" contains the definitions of the "n_div" local variables,
+ * each of which is of the form floor((div[1 + i] * x_i) / div[0]),
+ * where x_0 = 1, x_1, ..., x_dim are the set variables and
+ * x_{dim + 1}, ... are the earlier local variables.
+ * "eq" and "ineq" contain the "n_eq" equality and
+ * "n_ineq" inequality constraints of the basic set,
+ * with all rows of length 1 + dim + n_div (2 + dim + n_div for "div").
+ */
+struct isl_point_filter_piece {
+	int n_div;
+	int n_eq;
+	int n_ineq;
+	long *div;
+	long *eq;
+	long *ineq;
+};
+
+/* A compiled representation of a set for testing
+ * whether integer points belong to the set.
+ *
+ * "set" is the original set.
+ * "dim" is the total number of set variables (including the parameters).
+ * If "native" is set, then membership is tested by evaluating
+ * the constraints of each of the "n" pieces in "p" using
+ * native integer arithmetic, with "val" used as scratch space
+ * for the values of the variables.
+ * This is only done if it is guaranteed that no overflow can occur
+ * for points with coordinates of absolute value at most "bound".
+ * Otherwise, membership is tested through isl_set_contains_point.
+ */
+struct isl_point_filter {
+	isl_set *set;
+	int dim;
+	long bound;
+
+	int native;
+	int n;
+	struct isl_point_filter_piece *p;
+	long *val;
+};
+
+/* Upper bound on the absolute value of any intermediate result
+ * computed by a native point filter.
+ * This leaves plenty of room below LONG_MAX for the inaccuracies
+ * introduced by computing the bounds in floating point arithmetic.
+ */
+#define ISL_POINT_FILTER_LIMIT	((double) LONG_MAX / 8)
+
+/* Free "filter" and return NULL.
+ */
+__isl_null isl_point_filter *isl_point_filter_free(
+	__isl_take isl_point_filter *filter)
+{
+	int i;
+
+	if (!filter)
+		return NULL;
+
+	isl_set_free(filter->set);
+	if (filter->p) {
+		for (i = 0; i < filter->n; ++i) {
+			free(filter->p[i].div);
+			free(filter->p[i].eq);
+			free(filter->p[i].ineq);
+		}
+	}
+	free(filter->p);
+	free(filter->val);
+	free(filter);
+
+	return NULL;
+}
+
+/* Copy the "n" coefficients in "src" to "dst" and
+ * return an upper bound on the absolute value of the inner product
+ * of this row with a vector with elements bounded by "bound",
+ * or -1 if some coefficient does not fit in a long or
+ * if the upper bound is too large for native integer arithmetic.
+ */
+static double compile_row(isl_int *src, int n, long *dst, double *bound)
+{
+	int i;
+	double max = 0;
+
+	for (i = 0; i < n; ++i) {
+		if (!isl_int_fits_slong(src[i]))
+			return -1;
+		dst[i] = isl_int_get_si(src[i]);
+		max += fabs((double) dst[i]) * bound[i];
+		if (max > ISL_POINT_FILTER_LIMIT)
+			return -1;
+	}
+
+	return max;
+}
+
+/* Compile the basic set "bset" with "dim" set variables into "piece",
+ * assuming all set variables are bounded by "bound[1 + i]" in absolute value.
+ * "bound" has room for the bounds on the local variables of "bset",
+ * which are computed along the way.
+ * Since the bound on a local variable is only available after
+ * its explicit representation has been compiled, this representation
+ * may only involve earlier local variables.
+ * Only the corresponding coefficients are compiled since
+ * those are the only ones that are used by piece_contains.
+ * Return isl_bool_false if the compiled representation
+ * is not guaranteed to be free from overflow.
+ */
+static isl_bool compile_basic_set(__isl_keep isl_basic_set *bset, int dim,
+	double *bound, struct isl_point_filter_piece *piece)
+{
+	int i;
+	unsigned total;
+	isl_ctx *ctx;
+
+	ctx = isl_basic_set_get_ctx(bset);
+	total = dim + bset->n_div;
+	piece->n_div = bset->n_div;
+	piece->n_eq = bset->n_eq;
+	piece->n_ineq = bset->n_ineq;
+	piece->div = isl_alloc_array(ctx, long, bset->n_div * (2 + total));
+	piece->eq = isl_alloc_array(ctx, long, bset->n_eq * (1 + total));
+	piece->ineq = isl_alloc_array(ctx, long, bset->n_ineq * (1 + total));
+	if ((bset->n_div && !piece->div) || (bset->n_eq && !piece->eq) ||
+	    (bset->n_ineq && !piece->ineq))
+		return isl_bool_error;
+
+	for (i = 0; i < bset->n_div; ++i) {
+		long *row = piece->div + i * (2 + total);
+		double max;
+
+		if (isl_int_is_zero(bset->div[i][0]))
+			return isl_bool_false;
+		max = compile_row(bset->div[i], 1, row, bound);
+		if (max < 0 || row[0] <= 0)
+			return isl_bool_false;
+		if (isl_seq_first_non_zero(bset->div[i] + 2 + dim + i,
+					    bset->n_div - i) != -1)
+			return isl_bool_false;
+		max = compile_row(bset->div[i] + 1, 1 + dim + i, row + 1, bound);
+		if (max < 0)
+			return isl_bool_false;
+		bound[1 + dim + i] = max / row[0] + 1;
+	}
+	for (i = 0; i < bset->n_eq; ++i)
+		if (compile_row(bset->eq[i], 1 + total,
+				piece->eq + i * (1 + total), bound) < 0)
+			return isl_bool_false;
+	for (i = 0; i < bset->n_ineq; ++i)
+		if (compile_row(bset->ineq[i], 1 + total,
+				piece->ineq + i * (1 + total), bound) < 0)
+			return isl_bool_false;
+
+	return isl_bool_true;
+}
+
+/* Try and compile the basic sets of filter->set
+ * for evaluation using native integer arithmetic.
+ * The local variables of filter->set need to have known explicit
+ * representations for this to be possible.
+ * Empty basic sets are skipped.
+ * If compilation fails, then filter->native is left unset.
+ */
+static isl_stat compile_filter(__isl_keep isl_point_filter *filter)
+{
+	int i;
+	int max_div;
+	isl_ctx *ctx;
+	isl_set *set;
+	double *bound = NULL;
+	isl_bool ok = isl_bool_true;
+
+	set = isl_set_compute_divs(isl_set_copy(filter->set));
+	if (!set)
+		return isl_stat_error;
+	ctx = isl_set_get_ctx(set);
+
+	max_div = 0;
+	for (i = 0; i < set->n; ++i) {
+		isl_bool known;
+
+		known = isl_basic_map_divs_known(set->p[i]);
+		if (known < 0)
+			goto error;
+		if (!known)
+			goto done;
+		if (set->p[i]->n_div > max_div)
+			max_div = set->p[i]->n_div;
+	}
+
+	filter->p = isl_calloc_array(ctx, struct isl_point_filter_piece,
+					set->n);
+	filter->val = isl_alloc_array(ctx, long, 1 + filter->dim + max_div);
+	bound = isl_alloc_array(ctx, double, 1 + filter->dim + max_div);
+	if ((set->n && !filter->p) || !filter->val || !bound)
+		goto error;
+	bound[0] = 1;
+	for (i = 0; i < filter->dim; ++i)
+		bound[1 + i] = filter->bound;
+
+	filter->n = 0;
+	for (i = 0; ok == isl_bool_true && i < set->n; ++i) {
+		if (ISL_F_ISSET(set->p[i], ISL_BASIC_SET_EMPTY))
+			continue;
+		ok = compile_basic_set(set->p[i], filter->dim, bound,
+					&filter->p[filter->n++]);
+	}
+	if (ok < 0)
+		goto error;
+	filter->native = ok;
+done:
+	free(bound);
+	isl_set_free(set);
+	return isl_stat_ok;
+error:
+	free(bound);
+	isl_set_free(set);
+	return isl_stat_error;
+}
+
+/* Construct a filter for testing whether integer points
+ * with coordinates of absolute value at most "bound" belong to "set".
+ *
+ * The filter uses native integer arithmetic if possible and
+ * falls back to isl_set_contains_point otherwise.
+ */
+__isl_give isl_point_filter *isl_point_filter_alloc(__isl_keep isl_set *set,
+	long bound)
+{
+	isl_ctx *ctx;
+	isl_size dim;
+	isl_point_filter *filter;
+
+	dim = isl_set_dim(set, isl_dim_all);
+	if (dim < 0)
+		return NULL;
+	ctx = isl_set_get_ctx(set);
+	if (bound < 0)
+		isl_die(ctx, isl_error_invalid, "negative bound", return NULL);
+	filter = isl_calloc_type(ctx, struct isl_point_filter);
+	if (!filter)
+		return NULL;
+	filter->set = isl_set_copy(set);
+	filter->dim = dim;
+	filter->bound = bound;
+	if (compile_filter(filter) < 0)
+		return isl_point_filter_free(filter);
+
+	return filter;
+}
+
+/* Return the inner product of the first "n" elements of "row" and "val".
+ */
+static long inner_product(long *row, long *val, int n)
+{
+	int i;
+	long v = 0;
+
+	for (i = 0; i < n; ++i)
+		v += row[i] * val[i];
+
+	return v;
+}
+
+/* Does the point with (1 + dim + piece->n_div) coordinates "val",
+ * the first 1 + dim of which have been set by the caller,
+ * satisfy the constraints of "piece"?
+ * The values of the local variables are computed first.
+ */
+static int piece_contains(struct isl_point_filter_piece *piece, int dim,
+	long *val)
+{
+	int i;
+	int total = dim + piece->n_div;
+
+	for (i = 0; i < piece->n_div; ++i) {
+		long *row = piece->div + i * (2 + total);
+		long v = inner_product(row + 1, val, 1 + dim + i);
+		long q = v / row[0];
+
+		if (q * row[0] != v && v < 0)
+			q--;
+		val[1 + dim + i] = q;
+	}
+	for (i = 0; i < piece->n_eq; ++i)
+		if (inner_product(piece->eq + i * (1 + total), val,
+				    1 + total) != 0)
+			return 0;
+	for (i = 0; i < piece->n_ineq; ++i)
+		if (inner_product(piece->ineq + i * (1 + total), val,
+				    1 + total) < 0)
+			return 0;
+
+	return 1;
+}
+
+/* Construct an integer point in "space" with coordinates "coords".
+ */
+__isl_give isl_point *isl_point_from_si_array(__isl_take isl_space *space,
+	const long *coords)
+{
+	int i;
+	isl_size dim;
+	isl_vec *vec;
+
+	dim = isl_space_dim(space, isl_dim_all);
+	if (dim < 0)
+		goto error;
+	vec = isl_vec_alloc(isl_space_get_ctx(space), 1 + dim);
+	if (!vec)
+		goto error;
+	isl_int_set_si(vec->el[0], 1);
+	for (i = 0; i < dim; ++i)
+		isl_int_set_si(vec->el[1 + i], coords[i]);
+
+	return isl_point_alloc(space, vec);
+error:
+	isl_space_free(space);
+	return NULL;
+}
+
+/* Does the integer point with coordinates "coords" belong to
+ * the set represented by "filter"?
+ *
+ * If any of the coordinates exceeds the bound for which "filter"
+ * was compiled or if "filter" could not be compiled, then
+ * fall back to isl_set_contains_point.
+ */
+isl_bool isl_point_filter_contains(__isl_keep isl_point_filter *filter,
+	const long *coords)
+{
+	int i;
+	isl_bool found;
+	isl_point *pnt;
+
+	if (!filter)
+		return isl_bool_error;
+
+	for (i = 0; filter->native && i < filter->dim; ++i)
+		if (coords[i] > filter->bound || coords[i] < -filter->bound)
+			break;
+	if (filter->native && i >= filter->dim) {
+		filter->val[0] = 1;
+		for (i = 0; i < filter->dim; ++i)
+			filter->val[1 + i] = coords[i];
+		for (i = 0; i < filter->n; ++i)
+			if (piece_contains(&filter->p[i], filter->dim,
+					    filter->val))
+				return isl_bool_true;
+		return isl_bool_false;
+	}
+
+	pnt = isl_point_from_si_array(isl_set_get_space(filter->set), coords);
+	found = isl_set_contains_point(filter->set, pnt);
+	isl_point_free(pnt);
+	return found;
+}
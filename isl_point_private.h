@@ -4,6 +4,7 @@
 #include "isl/space.h"
 #include "isl/point.h"
 #include "isl/vec.h"
+#include "isl/set_type.h"
 
 struct isl_point {
 	int		ref;
@@ -28,4 +29,17 @@ isl_stat isl_point_check_named_params(__isl_keep isl_point *pnt);
 __isl_give isl_point *isl_point_align_params(__isl_take isl_point *pnt,
 	__isl_take isl_space *model);
 
+__isl_give isl_point *isl_point_from_si_array(__isl_take isl_space *space,
+	const long *coords);
+
+struct isl_point_filter;
+typedef struct isl_point_filter isl_point_filter;
+
+__isl_give isl_point_filter *isl_point_filter_alloc(__isl_keep isl_set *set,
+	long bound);
+__isl_null isl_point_filter *isl_point_filter_free(
+	__isl_take isl_point_filter *filter);
+isl_bool isl_point_filter_contains(__isl_keep isl_point_filter *filter,
+	const long *coords);
+
 #endif
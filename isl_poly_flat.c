@@ -0,0 +1,527 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <isl_ctx_private.h>
+#include <isl_polynomial_private.h>
+#include <isl_val_private.h>
+#include <isl_vec_private.h>
+#include <isl_sort.h>
+
+/* A polynomial in flat form.
+ * Instead of the recursive representation of an isl_poly,
+ * the polynomial is represented by an array of "n" terms
+ * with a common (positive) denominator "d".
+ * Term i has coefficient num[i]/d and exponent exp[i * n_var + v]
+ * for variable v.
+ * The terms are sorted in increasing lexicographic order of
+ * their exponent vectors, where the exponent of the variable
+ * with the highest index is the most significant one.
+ * This is also the order in which the terms are encountered
+ * in a traversal of the recursive representation.
+ * None of the coefficients is zero.
+ * "size" is the number of terms for which memory has been allocated.
+ *
+ * Only polynomials with finite coefficients can be represented
+ * in flat form.
+ */
+struct isl_poly_flat {
+	isl_ctx *ctx;
+
+	int n_var;
+	int n;
+	int size;
+
+	int *exp;
+	isl_int *num;
+	isl_int d;
+};
+
+__isl_null isl_poly_flat *isl_poly_flat_free(__isl_take isl_poly_flat *flat)
+{
+	int i;
+
+	if (!flat)
+		return NULL;
+
+	for (i = 0; i < flat->size; ++i)
+		isl_int_clear(flat->num[i]);
+	isl_int_clear(flat->d);
+	free(flat->num);
+	free(flat->exp);
+	isl_ctx_deref(flat->ctx);
+	free(flat);
+
+	return NULL;
+}
+
+/* Allocate a flat polynomial over "n_var" variables with room
+ * for "size" terms.
+ * The number of terms is initialized to zero and
+ * the common denominator to one.
+ * The total number of exponents is required to fit in an int.
+ */
+static __isl_give isl_poly_flat *isl_poly_flat_alloc(isl_ctx *ctx,
+	int n_var, int size)
+{
+	int i;
+	isl_poly_flat *flat;
+
+	if (n_var > 0 && size > INT_MAX / n_var)
+		isl_die(ctx, isl_error_invalid,
+			"too many terms in flat polynomial", return NULL);
+	flat = isl_calloc_type(ctx, struct isl_poly_flat);
+	if (!flat)
+		return NULL;
+
+	flat->ctx = ctx;
+	isl_ctx_ref(ctx);
+	flat->n_var = n_var;
+	isl_int_init(flat->d);
+	isl_int_set_si(flat->d, 1);
+	flat->exp = isl_calloc_array(ctx, int, size * n_var);
+	flat->num = isl_alloc_array(ctx, isl_int, size);
+	if ((size && n_var && !flat->exp) || (size && !flat->num))
+		return isl_poly_flat_free(flat);
+	for (i = 0; i < size; ++i)
+		isl_int_init(flat->num[i]);
+	flat->size = size;
+
+	return flat;
+}
+
+/* Internal data structure for isl_poly_flat_from_poly.
+ *
+ * "flat" is the flat polynomial that is being constructed.
+ * "exp" holds the exponents of the term that is currently being visited.
+ */
+struct isl_poly_flat_data {
+	isl_poly_flat *flat;
+	int *exp;
+};
+
+/* Count the number of non-zero terms in "poly", adding them to "n",
+ * and update "lcm" to be the least common multiple of the denominators
+ * of their coefficients.
+ * Return isl_bool_false if "poly" has a coefficient that is not finite,
+ * in which case it cannot be represented in flat form.
+ */
+static isl_bool count_terms(__isl_keep isl_poly *poly, int *n, isl_int *lcm)
+{
+	int i;
+	isl_poly_rec *rec;
+
+	if (poly->var < 0) {
+		isl_poly_cst *cst = isl_poly_as_cst(poly);
+
+		if (!cst)
+			return isl_bool_error;
+		if (isl_int_is_zero(cst->d))
+			return isl_bool_false;
+		if (isl_int_is_zero(cst->n))
+			return isl_bool_true;
+		isl_int_lcm(*lcm, *lcm, cst->d);
+		(*n)++;
+		return isl_bool_true;
+	}
+
+	rec = isl_poly_as_rec(poly);
+	if (!rec)
+		return isl_bool_error;
+	for (i = 0; i < rec->n; ++i) {
+		isl_bool ok = count_terms(rec->p[i], n, lcm);
+		if (ok < 0 || !ok)
+			return ok;
+	}
+
+	return isl_bool_true;
+}
+
+/* Add the terms of "poly" to data->flat, in the order
+ * in which they appear in the recursive representation.
+ * data->exp holds the exponents of the variables with index
+ * greater than that of "poly".
+ */
+static isl_stat add_terms(__isl_keep isl_poly *poly,
+	struct isl_poly_flat_data *data)
+{
+	int i;
+	isl_poly_rec *rec;
+	isl_poly_flat *flat = data->flat;
+
+	if (poly->var < 0) {
+		isl_poly_cst *cst = isl_poly_as_cst(poly);
+		int k = flat->n;
+
+		if (isl_int_is_zero(cst->n))
+			return isl_stat_ok;
+		isl_int_divexact(flat->num[k], flat->d, cst->d);
+		isl_int_mul(flat->num[k], flat->num[k], cst->n);
+		for (i = 0; i < flat->n_var; ++i)
+			flat->exp[k * flat->n_var + i] = data->exp[i];
+		flat->n++;
+		return isl_stat_ok;
+	}
+
+	rec = isl_poly_as_rec(poly);
+	if (!rec)
+		return isl_stat_error;
+	for (i = 0; i < rec->n; ++i) {
+		data->exp[poly->var] = i;
+		if (add_terms(rec->p[i], data) < 0)
+			return isl_stat_error;
+	}
+	data->exp[poly->var] = 0;
+
+	return isl_stat_ok;
+}
+
+/* Construct a flat representation of "poly" over "n_var" variables.
+ * "n_var" needs to be greater than the index of any variable in "poly".
+ *
+ * If "poly" has a coefficient that is not finite, then it cannot
+ * be represented in flat form and *finite is set to 0.
+ * In this case, NULL is returned without an error being raised.
+ */
+__isl_give isl_poly_flat *isl_poly_flat_from_poly(__isl_keep isl_poly *poly,
+	int n_var, int *finite)
+{
+	int n = 0;
+	isl_int lcm;
+	isl_bool ok;
+	isl_poly_flat *flat;
+	struct isl_poly_flat_data data;
+
+	*finite = 1;
+	if (!poly)
+		return NULL;
+	if (n_var <= poly->var)
+		isl_die(poly->ctx, isl_error_internal,
+			"too few variables", return NULL);
+
+	isl_int_init(lcm);
+	isl_int_set_si(lcm, 1);
+	ok = count_terms(poly, &n, &lcm);
+	if (ok < 0 || !ok) {
+		isl_int_clear(lcm);
+		if (!ok)
+			*finite = 0;
+		return NULL;
+	}
+
+	flat = isl_poly_flat_alloc(poly->ctx, n_var, n);
+	if (flat)
+		isl_int_set(flat->d, lcm);
+	isl_int_clear(lcm);
+	if (!flat)
+		return NULL;
+
+	data.flat = flat;
+	data.exp = isl_calloc_array(poly->ctx, int, n_var);
+	if (!data.exp)
+		return isl_poly_flat_free(flat);
+	if (add_terms(poly, &data) < 0)
+		flat = isl_poly_flat_free(flat);
+	free(data.exp);
+
+	return flat;
+}
+
+/* Return the number of terms in "flat".
+ */
+isl_size isl_poly_flat_n_term(__isl_keep isl_poly_flat *flat)
+{
+	return flat ? flat->n : isl_size_error;
+}
+
+/* Construct the constant polynomial num/d, with the fraction reduced.
+ */
+static __isl_give isl_poly *rat_cst(isl_ctx *ctx, isl_int num, isl_int d)
+{
+	isl_poly *poly;
+	isl_poly_cst *cst;
+	isl_int gcd;
+
+	poly = isl_poly_rat_cst(ctx, num, d);
+	cst = isl_poly_as_cst(poly);
+	if (!cst)
+		return isl_poly_free(poly);
+	isl_int_init(gcd);
+	isl_int_gcd(gcd, cst->n, cst->d);
+	if (!isl_int_is_one(gcd)) {
+		isl_int_divexact(cst->n, cst->n, gcd);
+		isl_int_divexact(cst->d, cst->d, gcd);
+	}
+	isl_int_clear(gcd);
+
+	return poly;
+}
+
+/* Construct the recursive representation of the terms
+ * of "flat" in positions "first" up to (but not including) "last",
+ * which do not involve any variable with index greater than "var".
+ *
+ * Since the terms are sorted, the terms with the same exponent
+ * of "var" form consecutive ranges and the last term has
+ * the highest exponent.  If this exponent is zero, then "var"
+ * does not appear in the result.
+ */
+static __isl_give isl_poly *to_poly(__isl_keep isl_poly_flat *flat,
+	int first, int last, int var)
+{
+	int e, max;
+	isl_poly_rec *rec;
+
+	if (first >= last)
+		return isl_poly_zero(flat->ctx);
+	while (var >= 0 && flat->exp[(last - 1) * flat->n_var + var] == 0)
+		--var;
+	if (var < 0)
+		return rat_cst(flat->ctx, flat->num[first], flat->d);
+
+	max = flat->exp[(last - 1) * flat->n_var + var];
+	rec = isl_poly_alloc_rec(flat->ctx, var, max + 1);
+	if (!rec)
+		return NULL;
+	for (e = 0; e <= max; ++e) {
+		int end = first;
+
+		while (end < last && flat->exp[end * flat->n_var + var] == e)
+			++end;
+		rec->p[e] = to_poly(flat, first, end, var - 1);
+		rec->n++;
+		if (!rec->p[e])
+			return isl_poly_free(&rec->poly);
+		first = end;
+	}
+
+	return &rec->poly;
+}
+
+/* Construct the recursive representation of "flat".
+ */
+__isl_give isl_poly *isl_poly_flat_to_poly(__isl_take isl_poly_flat *flat)
+{
+	isl_poly *poly;
+
+	if (!flat)
+		return NULL;
+
+	poly = to_poly(flat, 0, flat->n, flat->n_var - 1);
+	isl_poly_flat_free(flat);
+
+	return poly;
+}
+
+/* Compare the exponent vectors of the terms at positions "i1" and "i2"
+ * of the flat polynomial "user", with the exponent of the variable
+ * with the highest index being the most significant.
+ */
+static int cmp_exp(const void *p1, const void *p2, void *user)
+{
+	isl_poly_flat *flat = user;
+	const int *i1 = p1;
+	const int *i2 = p2;
+	const int *e1 = &flat->exp[*i1 * flat->n_var];
+	const int *e2 = &flat->exp[*i2 * flat->n_var];
+	int v;
+
+	for (v = flat->n_var - 1; v >= 0; --v)
+		if (e1[v] != e2[v])
+			return e1[v] - e2[v];
+	return 0;
+}
+
+/* Sort the terms of "prod", combining terms with the same exponents
+ * and removing terms with a zero coefficient, and store
+ * the result in a new flat polynomial.
+ * Finally, divide out any common factor of the coefficients and
+ * the denominator.
+ */
+static __isl_give isl_poly_flat *sort_and_combine(
+	__isl_take isl_poly_flat *prod)
+{
+	int i, j, n;
+	int *perm;
+	isl_int gcd;
+	isl_poly_flat *res;
+
+	if (!prod)
+		return NULL;
+
+	perm = isl_alloc_array(prod->ctx, int, prod->n);
+	res = isl_poly_flat_alloc(prod->ctx, prod->n_var, prod->n);
+	if ((prod->n && !perm) || !res)
+		goto error;
+	for (i = 0; i < prod->n; ++i)
+		perm[i] = i;
+	if (isl_sort(perm, prod->n, sizeof(int), &cmp_exp, prod) < 0)
+		goto error;
+
+	isl_int_set(res->d, prod->d);
+	n = 0;
+	for (i = 0; i < prod->n; i = j) {
+		isl_int_set(res->num[n], prod->num[perm[i]]);
+		for (j = i + 1; j < prod->n; ++j) {
+			if (cmp_exp(&perm[i], &perm[j], prod) != 0)
+				break;
+			isl_int_add(res->num[n], res->num[n],
+				    prod->num[perm[j]]);
+		}
+		if (isl_int_is_zero(res->num[n]))
+			continue;
+		memcpy(&res->exp[n * res->n_var],
+			&prod->exp[perm[i] * prod->n_var],
+			prod->n_var * sizeof(int));
+		n++;
+	}
+	res->n = n;
+
+	isl_int_init(gcd);
+	isl_int_set(gcd, res->d);
+	for (i = 0; i < n && !isl_int_is_one(gcd); ++i)
+		isl_int_gcd(gcd, gcd, res->num[i]);
+	if (!isl_int_is_one(gcd)) {
+		isl_int_divexact(res->d, res->d, gcd);
+		for (i = 0; i < n; ++i)
+			isl_int_divexact(res->num[i], res->num[i], gcd);
+	}
+	isl_int_clear(gcd);
+
+	free(perm);
+	isl_poly_flat_free(prod);
+	return res;
+error:
+	free(perm);
+	isl_poly_flat_free(prod);
+	isl_poly_flat_free(res);
+	return NULL;
+}
+
+/* Return the product of "flat1" and "flat2".
+ *
+ * Every pair of terms contributes a term to the product,
+ * with the coefficients multiplied and the exponents added.
+ * The terms of the product are then sorted and combined.
+ * The number of pairs is checked to fit in an int before
+ * any memory is allocated for them.
+ */
+__isl_give isl_poly_flat *isl_poly_flat_mul(__isl_take isl_poly_flat *flat1,
+	__isl_take isl_poly_flat *flat2)
+{
+	int i, j, v;
+	int n_var;
+	isl_poly_flat *prod;
+
+	if (!flat1 || !flat2)
+		goto error;
+	if (flat1->n_var != flat2->n_var)
+		isl_die(flat1->ctx, isl_error_internal,
+			"number of variables does not match", goto error);
+
+	if (flat2->n > 0 && flat1->n > INT_MAX / flat2->n)
+		isl_die(flat1->ctx, isl_error_invalid,
+			"too many terms in product of flat polynomials",
+			goto error);
+
+	n_var = flat1->n_var;
+	prod = isl_poly_flat_alloc(flat1->ctx, n_var, flat1->n * flat2->n);
+	if (!prod)
+		goto error;
+
+	isl_int_mul(prod->d, flat1->d, flat2->d);
+	for (i = 0; i < flat1->n; ++i) {
+		int *e1 = &flat1->exp[i * n_var];
+
+		for (j = 0; j < flat2->n; ++j) {
+			int *e2 = &flat2->exp[j * n_var];
+			int *e = &prod->exp[prod->n * n_var];
+
+			isl_int_mul(prod->num[prod->n],
+				    flat1->num[i], flat2->num[j]);
+			for (v = 0; v < n_var; ++v)
+				e[v] = e1[v] + e2[v];
+			prod->n++;
+		}
+	}
+
+	isl_poly_flat_free(flat1);
+	isl_poly_flat_free(flat2);
+
+	return sort_and_combine(prod);
+error:
+	isl_poly_flat_free(flat1);
+	isl_poly_flat_free(flat2);
+	return NULL;
+}
+
+/* Evaluate "flat" in the point with homogeneous coordinates "vec",
+ * i.e., the value of variable v is vec->el[1 + v] / vec->el[0].
+ *
+ * In order to avoid the construction of intermediate rational values,
+ * every term is evaluated with the common denominator d^D of the
+ * coordinates, with d the denominator of "vec" and D the total degree
+ * of "flat".  That is, a term of total degree k is additionally
+ * multiplied by d^(D - k).
+ */
+__isl_give isl_val *isl_poly_flat_eval(__isl_keep isl_poly_flat *flat,
+	__isl_keep isl_vec *vec)
+{
+	int i, v;
+	int deg, max_deg = 0;
+	isl_int num, den, t, p;
+	isl_val *res;
+
+	if (!flat || !vec)
+		return NULL;
+	if (vec->size < 1 + flat->n_var)
+		isl_die(flat->ctx, isl_error_internal,
+			"point has too few coordinates", return NULL);
+
+	for (i = 0; i < flat->n; ++i) {
+		deg = 0;
+		for (v = 0; v < flat->n_var; ++v)
+			deg += flat->exp[i * flat->n_var + v];
+		if (deg > max_deg)
+			max_deg = deg;
+	}
+
+	isl_int_init(num);
+	isl_int_init(den);
+	isl_int_init(t);
+	isl_int_init(p);
+	isl_int_set_si(num, 0);
+	for (i = 0; i < flat->n; ++i) {
+		int *e = &flat->exp[i * flat->n_var];
+
+		isl_int_set(t, flat->num[i]);
+		deg = 0;
+		for (v = 0; v < flat->n_var; ++v) {
+			if (e[v] == 0)
+				continue;
+			deg += e[v];
+			isl_int_pow_ui(p, vec->el[1 + v], e[v]);
+			isl_int_mul(t, t, p);
+		}
+		if (deg < max_deg) {
+			isl_int_pow_ui(p, vec->el[0], max_deg - deg);
+			isl_int_mul(t, t, p);
+		}
+		isl_int_add(num, num, t);
+	}
+	isl_int_pow_ui(den, vec->el[0], max_deg);
+	isl_int_mul(den, den, flat->d);
+
+	res = isl_val_rat_from_isl_int(flat->ctx, num, den);
+	res = isl_val_normalize(res);
+
+	isl_int_clear(num);
+	isl_int_clear(den);
+	isl_int_clear(t);
+	isl_int_clear(p);
+
+	return res;
+}
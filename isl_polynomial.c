@@ -1262,6 +1262,36 @@ error:
 	return NULL;
 }
 
+/* Multiply "poly1" and "poly2", both of which are non-constant and
+ * have the same main variable, by converting them to flat form,
+ * multiplying the flat forms and converting the result back.
+ * Unlike isl_poly_mul_rec, this avoids the construction of
+ * (and the pointer chasing through) many intermediate
+ * recursive polynomials.
+ * Fall back to isl_poly_mul_rec if either of the inputs
+ * cannot be represented in flat form.
+ */
+static __isl_give isl_poly *isl_poly_mul_flat(__isl_take isl_poly *poly1,
+	__isl_take isl_poly *poly2)
+{
+	int n_var;
+	int finite1, finite2;
+	isl_poly_flat *flat1, *flat2;
+
+	n_var = 1 + poly1->var;
+	flat1 = isl_poly_flat_from_poly(poly1, n_var, &finite1);
+	flat2 = isl_poly_flat_from_poly(poly2, n_var, &finite2);
+	if (!finite1 || !finite2) {
+		isl_poly_flat_free(flat1);
+		isl_poly_flat_free(flat2);
+		return isl_poly_mul_rec(poly1, poly2);
+	}
+	isl_poly_free(poly1);
+	isl_poly_free(poly2);
+
+	return isl_poly_flat_to_poly(isl_poly_flat_mul(flat1, flat2));
+}
+
 __isl_give isl_poly *isl_poly_mul(__isl_take isl_poly *poly1,
 	__isl_take isl_poly *poly2)
 {
@@ -1358,7 +1388,7 @@ __isl_give isl_poly *isl_poly_mul(__isl_take isl_poly *poly1,
 	if (is_cst)
 		return isl_poly_mul_cst(poly1, poly2);
 
-	return isl_poly_mul_rec(poly1, poly2);
+	return isl_poly_mul_flat(poly1, poly2);
 error:
 	isl_poly_free(poly1);
 	isl_poly_free(poly2);
@@ -3369,7 +3399,10 @@ error:
 	return NULL;
 }
 
-__isl_give isl_val *isl_poly_eval(__isl_take isl_poly *poly,
+/* Evaluate "poly" in the point with homogeneous coordinates "vec"
+ * by directly evaluating the recursive representation.
+ */
+static __isl_give isl_val *eval_rec(__isl_take isl_poly *poly,
 	__isl_take isl_vec *vec)
 {
 	int i;
@@ -3397,13 +3430,12 @@ __isl_give isl_val *isl_poly_eval(__isl_take isl_poly *poly,
 	base = isl_val_rat_from_isl_int(poly->ctx,
 					vec->el[1 + poly->var], vec->el[0]);
 
-	res = isl_poly_eval(isl_poly_copy(rec->p[rec->n - 1]),
-				isl_vec_copy(vec));
+	res = eval_rec(isl_poly_copy(rec->p[rec->n - 1]), isl_vec_copy(vec));
 
 	for (i = rec->n - 2; i >= 0; --i) {
 		res = isl_val_mul(res, isl_val_copy(base));
-		res = isl_val_add(res, isl_poly_eval(isl_poly_copy(rec->p[i]),
-							    isl_vec_copy(vec)));
+		res = isl_val_add(res, eval_rec(isl_poly_copy(rec->p[i]),
+						isl_vec_copy(vec)));
 	}
 
 	isl_val_free(base);
@@ -3416,6 +3448,37 @@ error:
 	return NULL;
 }
 
+/* Evaluate "poly" in the point with homogeneous coordinates "vec".
+ *
+ * If "poly" is not constant, then evaluate its flat form,
+ * which only requires integer arithmetic and
+ * a single rational value to be constructed.
+ * If "poly" cannot be represented in flat form,
+ * then evaluate the recursive representation instead.
+ */
+__isl_give isl_val *isl_poly_eval(__isl_take isl_poly *poly,
+	__isl_take isl_vec *vec)
+{
+	int finite;
+	isl_bool is_cst;
+	isl_poly_flat *flat;
+	isl_val *res;
+
+	is_cst = isl_poly_is_cst(poly);
+	if (is_cst < 0 || is_cst)
+		return eval_rec(poly, vec);
+
+	flat = isl_poly_flat_from_poly(poly, 1 + poly->var, &finite);
+	if (!finite)
+		return eval_rec(poly, vec);
+	res = isl_poly_flat_eval(flat, vec);
+	isl_poly_flat_free(flat);
+	isl_poly_free(poly);
+	isl_vec_free(vec);
+
+	return res;
+}
+
 /* Evaluate "qp" in the void point "pnt".
  * In particular, return the value NaN.
  */
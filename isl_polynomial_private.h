@@ -126,6 +126,8 @@ struct isl_pw_qpolynomial_fold {
 void isl_term_get_num(__isl_keep isl_term *term, isl_int *n);
 
 __isl_give isl_poly *isl_poly_zero(struct isl_ctx *ctx);
+__isl_give isl_poly *isl_poly_rat_cst(isl_ctx *ctx, isl_int n, isl_int d);
+__isl_give isl_poly_rec *isl_poly_alloc_rec(isl_ctx *ctx, int var, int size);
 __isl_give isl_poly *isl_poly_copy(__isl_keep isl_poly *poly);
 __isl_give isl_poly *isl_poly_cow(__isl_take isl_poly *poly);
 __isl_give isl_poly *isl_poly_dup(__isl_keep isl_poly *poly);
@@ -145,6 +147,19 @@ __isl_give isl_poly *isl_poly_sum(__isl_take isl_poly *poly1,
 __isl_give struct isl_poly *isl_poly_mul_isl_int(
 	__isl_take isl_poly *poly, isl_int v);
 
+struct isl_poly_flat;
+typedef struct isl_poly_flat isl_poly_flat;
+
+__isl_give isl_poly_flat *isl_poly_flat_from_poly(__isl_keep isl_poly *poly,
+	int n_var, int *finite);
+__isl_give isl_poly *isl_poly_flat_to_poly(__isl_take isl_poly_flat *flat);
+__isl_null isl_poly_flat *isl_poly_flat_free(__isl_take isl_poly_flat *flat);
+isl_size isl_poly_flat_n_term(__isl_keep isl_poly_flat *flat);
+__isl_give isl_poly_flat *isl_poly_flat_mul(__isl_take isl_poly_flat *flat1,
+	__isl_take isl_poly_flat *flat2);
+__isl_give isl_val *isl_poly_flat_eval(__isl_keep isl_poly_flat *flat,
+	__isl_keep isl_vec *vec);
+
 __isl_give isl_qpolynomial *isl_qpolynomial_alloc(__isl_take isl_space *space,
 	unsigned n_div, __isl_take isl_poly *poly);
 __isl_give isl_qpolynomial *isl_qpolynomial_cow(__isl_take isl_qpolynomial *qp);
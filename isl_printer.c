@@ -26,7 +26,7 @@ static __isl_give isl_printer *file_flush(__isl_take isl_printer *p)
 static __isl_give isl_printer *file_print_str(__isl_take isl_printer *p,
 	const char *s)
 {
-	fprintf(p->file, "%s", s);
+	fputs(s, p->file);
 	return p;
 }
 
@@ -49,35 +49,113 @@ static __isl_give isl_printer *file_print_isl_int(__isl_take isl_printer *p, isl
 	return p;
 }
 
-static int grow_buf(__isl_keep isl_printer *p, int extra)
+/* The size of the first chunk of a string printer,
+ * the maximal size of the chunks of a string printer and
+ * the size of the single chunk of a callback printer.
+ */
+#define ISL_PRINTER_FIRST_CHUNK_SIZE	256
+#define ISL_PRINTER_MAX_CHUNK_SIZE	(1 << 20)
+#define ISL_PRINTER_BLOCK_SIZE		(1 << 16)
+
+/* Allocate a chunk of size "size".
+ */
+static struct isl_printer_chunk *chunk_alloc(isl_ctx *ctx, size_t size)
 {
-	int new_size;
-	char *new_buf;
+	struct isl_printer_chunk *chunk;
 
-	if (p->buf_size == 0)
-		return -1;
+	chunk = isl_alloc(ctx, struct isl_printer_chunk,
+			sizeof(struct isl_printer_chunk) + size - 1);
+	if (!chunk)
+		return NULL;
+	chunk->next = NULL;
+	chunk->len = 0;
+	chunk->size = size;
+	return chunk;
+}
 
-	new_size = ((p->buf_n + extra + 1) * 3) / 2;
-	new_buf = isl_realloc_array(p->ctx, p->buf, char, new_size);
-	if (!new_buf) {
-		p->buf_size = 0;
-		return -1;
+/* Free all chunks starting at "chunk".
+ */
+static void chunk_free(struct isl_printer_chunk *chunk)
+{
+	while (chunk) {
+		struct isl_printer_chunk *next = chunk->next;
+		free(chunk);
+		chunk = next;
 	}
-	p->buf = new_buf;
-	p->buf_size = new_size;
-
-	return 0;
 }
 
+/* Pass the contents of the single chunk of the callback printer "p"
+ * to the callback and clear the chunk.
+ */
+static isl_stat write_block(__isl_keep isl_printer *p)
+{
+	struct isl_printer_chunk *chunk = p->first;
+	isl_stat r = isl_stat_ok;
+
+	if (chunk->len > 0)
+		r = p->write(chunk->data, chunk->len, p->write_user);
+	chunk->len = 0;
+	if (r < 0)
+		isl_die(p->ctx, isl_error_unknown,
+			"unable to write printer output", return isl_stat_error);
+	return r;
+}
+
+/* Make sure the last chunk of "p" has room for at least one more
+ * character, where "extra" is the number of characters
+ * that still need to be printed.
+ * A string printer appends a new chunk, with a size that is
+ * double that of the previous chunk (up to a maximum) or
+ * large enough to hold the remaining characters.
+ * A callback printer passes the contents of its single chunk
+ * to the callback.
+ */
+static isl_stat make_room(__isl_keep isl_printer *p, size_t extra)
+{
+	size_t size;
+	struct isl_printer_chunk *chunk;
+
+	if (p->write)
+		return write_block(p);
+
+	size = 2 * p->last->size;
+	if (size > ISL_PRINTER_MAX_CHUNK_SIZE)
+		size = ISL_PRINTER_MAX_CHUNK_SIZE;
+	if (size < extra)
+		size = extra;
+	chunk = chunk_alloc(p->ctx, size);
+	if (!chunk)
+		return isl_stat_error;
+	p->last->next = chunk;
+	p->last = chunk;
+	return isl_stat_ok;
+}
+
+/* Append the "len" characters starting at "s" to the output of "p".
+ * For a string printer, the characters are appended to the last chunk,
+ * with new chunks added as needed.
+ * Previously printed characters are never moved.
+ */
 static __isl_give isl_printer *str_print(__isl_take isl_printer *p,
-	const char *s, int len)
+	const char *s, size_t len)
 {
-	if (p->buf_n + len + 1 >= p->buf_size && grow_buf(p, len))
-		goto error;
-	memcpy(p->buf + p->buf_n, s, len);
-	p->buf_n += len;
+	while (len > 0) {
+		size_t n;
+		struct isl_printer_chunk *chunk = p->last;
+
+		if (chunk->len == chunk->size && make_room(p, len) < 0)
+			goto error;
+		chunk = p->last;
+		n = chunk->size - chunk->len;
+		if (n > len)
+			n = len;
+		memcpy(chunk->data + chunk->len, s, n);
+		chunk->len += n;
+		p->len += n;
+		s += n;
+		len -= n;
+	}
 
-	p->buf[p->buf_n] = '\0';
 	return p;
 error:
 	isl_printer_free(p);
@@ -87,17 +165,16 @@ error:
 static __isl_give isl_printer *str_print_indent(__isl_take isl_printer *p,
 	int indent)
 {
-	int i;
+	char spaces[64];
 
-	if (p->buf_n + indent + 1 >= p->buf_size && grow_buf(p, indent))
-		goto error;
-	for (i = 0; i < indent; ++i)
-		p->buf[p->buf_n++] = ' ';
-	p->buf[p->buf_n] = '\0';
+	memset(spaces, ' ', sizeof(spaces));
+	while (p && indent > 0) {
+		int n = indent < sizeof(spaces) ? indent : sizeof(spaces);
+
+		p = str_print(p, spaces, n);
+		indent -= n;
+	}
 	return p;
-error:
-	isl_printer_free(p);
-	return NULL;
 }
 
 static __isl_give isl_printer *str_start_line(__isl_take isl_printer *p)
@@ -105,7 +182,7 @@ static __isl_give isl_printer *str_start_line(__isl_take isl_printer *p)
 	if (p->indent_prefix)
 		p = str_print(p, p->indent_prefix, strlen(p->indent_prefix));
 	p = str_print_indent(p, p->indent);
-	if (p->prefix)
+	if (p && p->prefix)
 		p = str_print(p, p->prefix, strlen(p->prefix));
 	return p;
 }
@@ -114,14 +191,30 @@ static __isl_give isl_printer *str_end_line(__isl_take isl_printer *p)
 {
 	if (p->suffix)
 		p = str_print(p, p->suffix, strlen(p->suffix));
-	p = str_print(p, "\n", strlen("\n"));
+	if (p)
+		p = str_print(p, "\n", strlen("\n"));
 	return p;
 }
 
+/* Clear the output of the string printer "p".
+ * The first chunk is kept for reuse.
+ */
 static __isl_give isl_printer *str_flush(__isl_take isl_printer *p)
 {
-	p->buf_n = 0;
-	p->buf[p->buf_n] = '\0';
+	chunk_free(p->first->next);
+	p->first->next = NULL;
+	p->first->len = 0;
+	p->last = p->first;
+	p->len = 0;
+	return p;
+}
+
+/* Pass any pending output of the callback printer "p" to the callback.
+ */
+static __isl_give isl_printer *callback_flush(__isl_take isl_printer *p)
+{
+	if (write_block(p) < 0)
+		return isl_printer_free(p);
 	return p;
 }
 
@@ -134,36 +227,20 @@ static __isl_give isl_printer *str_print_str(__isl_take isl_printer *p,
 static __isl_give isl_printer *str_print_double(__isl_take isl_printer *p,
 	double d)
 {
-	int left = p->buf_size - p->buf_n;
-	int need = snprintf(p->buf + p->buf_n, left, "%g", d);
-	if (need >= left) {
-		if (grow_buf(p, need))
-			goto error;
-		left = p->buf_size - p->buf_n;
-		need = snprintf(p->buf + p->buf_n, left, "%g", d);
-	}
-	p->buf_n += need;
-	return p;
-error:
-	isl_printer_free(p);
-	return NULL;
+	char buffer[64];
+	int len;
+
+	len = snprintf(buffer, sizeof(buffer), "%g", d);
+	return str_print(p, buffer, len);
 }
 
 static __isl_give isl_printer *str_print_int(__isl_take isl_printer *p, int i)
 {
-	int left = p->buf_size - p->buf_n;
-	int need = snprintf(p->buf + p->buf_n, left, "%d", i);
-	if (need >= left) {
-		if (grow_buf(p, need))
-			goto error;
-		left = p->buf_size - p->buf_n;
-		need = snprintf(p->buf + p->buf_n, left, "%d", i);
-	}
-	p->buf_n += need;
-	return p;
-error:
-	isl_printer_free(p);
-	return NULL;
+	char buffer[32];
+	int len;
+
+	len = snprintf(buffer, sizeof(buffer), "%d", i);
+	return str_print(p, buffer, len);
 }
 
 static __isl_give isl_printer *str_print_isl_int(__isl_take isl_printer *p,
@@ -176,7 +253,8 @@ static __isl_give isl_printer *str_print_isl_int(__isl_take isl_printer *p,
 	len = strlen(s);
 	if (len < p->width)
 		p = str_print_indent(p, p->width - len);
-	p = str_print(p, s, len);
+	if (p)
+		p = str_print(p, s, len);
 	isl_int_free_str(s);
 	return p;
 }
@@ -214,6 +292,16 @@ static struct isl_printer_ops str_ops = {
 	str_flush
 };
 
+static struct isl_printer_ops callback_ops = {
+	str_start_line,
+	str_end_line,
+	str_print_double,
+	str_print_int,
+	str_print_isl_int,
+	str_print_str,
+	callback_flush
+};
+
 __isl_give isl_printer *isl_printer_to_file(isl_ctx *ctx, FILE *file)
 {
 	struct isl_printer *p = isl_calloc_type(ctx, struct isl_printer);
@@ -223,9 +311,6 @@ __isl_give isl_printer *isl_printer_to_file(isl_ctx *ctx, FILE *file)
 	isl_ctx_ref(p->ctx);
 	p->ops = &file_ops;
 	p->file = file;
-	p->buf = NULL;
-	p->buf_n = 0;
-	p->buf_size = 0;
 	p->indent = 0;
 	p->output_format = ISL_FORMAT_ISL;
 	p->indent_prefix = NULL;
@@ -237,21 +322,24 @@ __isl_give isl_printer *isl_printer_to_file(isl_ctx *ctx, FILE *file)
 	return p;
 }
 
-__isl_give isl_printer *isl_printer_to_str(isl_ctx *ctx)
+/* Create a printer that collects its output in a sequence of chunks
+ * and that uses "ops" to print, with the first chunk of size "size".
+ */
+static __isl_give isl_printer *isl_printer_to_chunks(isl_ctx *ctx,
+	struct isl_printer_ops *ops, size_t size)
 {
 	struct isl_printer *p = isl_calloc_type(ctx, struct isl_printer);
 	if (!p)
 		return NULL;
 	p->ctx = ctx;
 	isl_ctx_ref(p->ctx);
-	p->ops = &str_ops;
+	p->ops = ops;
 	p->file = NULL;
-	p->buf = isl_alloc_array(ctx, char, 256);
-	if (!p->buf)
+	p->first = chunk_alloc(ctx, size);
+	if (!p->first)
 		goto error;
-	p->buf_n = 0;
-	p->buf[0] = '\0';
-	p->buf_size = 256;
+	p->last = p->first;
+	p->len = 0;
 	p->indent = 0;
 	p->output_format = ISL_FORMAT_ISL;
 	p->indent_prefix = NULL;
@@ -266,11 +354,41 @@ error:
 	return NULL;
 }
 
+__isl_give isl_printer *isl_printer_to_str(isl_ctx *ctx)
+{
+	return isl_printer_to_chunks(ctx, &str_ops,
+					ISL_PRINTER_FIRST_CHUNK_SIZE);
+}
+
+/* Create a printer that passes its output to "write" in large blocks.
+ * The output is passed to "write" whenever a block is full,
+ * when isl_printer_flush is called and when the printer is freed.
+ * If "write" returns isl_stat_error, then the printer is freed.
+ */
+__isl_give isl_printer *isl_printer_to_callback(isl_ctx *ctx,
+	isl_stat (*write)(const char *data, size_t len, void *user),
+	void *user)
+{
+	isl_printer *p;
+
+	if (!write)
+		isl_die(ctx, isl_error_invalid, "no callback specified",
+			return NULL);
+	p = isl_printer_to_chunks(ctx, &callback_ops, ISL_PRINTER_BLOCK_SIZE);
+	if (!p)
+		return NULL;
+	p->write = write;
+	p->write_user = user;
+	return p;
+}
+
 __isl_null isl_printer *isl_printer_free(__isl_take isl_printer *p)
 {
 	if (!p)
 		return NULL;
-	free(p->buf);
+	if (p->write && p->first)
+		write_block(p);
+	chunk_free(p->first);
 	free(p->indent_prefix);
 	free(p->prefix);
 	free(p->suffix);
@@ -672,7 +790,28 @@ __isl_give isl_printer *isl_printer_end_line(__isl_take isl_printer *p)
 	return p->ops->end_line(p);
 }
 
+/* Return a string containing the concatenation of the chunks of "p".
+ */
+static __isl_give char *assemble(__isl_keep isl_printer *p)
+{
+	char *str, *pos;
+	struct isl_printer_chunk *chunk;
+
+	str = isl_alloc_array(p->ctx, char, p->len + 1);
+	if (!str)
+		return NULL;
+	pos = str;
+	for (chunk = p->first; chunk; chunk = chunk->next) {
+		memcpy(pos, chunk->data, chunk->len);
+		pos += chunk->len;
+	}
+	*pos = '\0';
+	return str;
+}
+
 /* Return a copy of the string constructed by the string printer "printer".
+ * The string is only assembled from the chunks of the printer
+ * at this point.
  */
 __isl_give char *isl_printer_get_str(__isl_keep isl_printer *printer)
 {
@@ -682,9 +821,7 @@ __isl_give char *isl_printer_get_str(__isl_keep isl_printer *printer)
 		isl_die(isl_printer_get_ctx(printer), isl_error_invalid,
 			"isl_printer_get_str can only be called on a string "
 			"printer", return NULL);
-	if (!printer->buf)
-		return NULL;
-	return strdup(printer->buf);
+	return assemble(printer);
 }
 
 __isl_give isl_printer *isl_printer_flush(__isl_take isl_printer *p)
@@ -7,7 +7,24 @@
 
 struct isl_printer_ops;
 
-/* A printer to a file or a string.
+/* A block of output of a string or callback printer.
+ * The first "len" characters of "data", of size "size", are in use.
+ */
+struct isl_printer_chunk {
+	struct isl_printer_chunk *next;
+	size_t len;
+	size_t size;
+	char data[1];
+};
+
+/* A printer to a file, a string or a callback.
+ *
+ * A string printer collects its output in a list of chunks,
+ * starting at "first" and ending at "last", of total length "len".
+ * Each chunk is larger than the previous one, up to some maximum,
+ * so that the output never needs to be moved.
+ * A callback printer has a single chunk and passes its contents
+ * to "write" (along with "write_user") whenever it is full.
  *
  * "dump" is set if the printing is performed from an isl_*_dump function.
  *
@@ -27,9 +44,11 @@ struct isl_printer {
 	struct isl_ctx	*ctx;
 	struct isl_printer_ops *ops;
 	FILE        	*file;
-	int		buf_n;
-	int		buf_size;
-	char		*buf;
+	struct isl_printer_chunk	*first;
+	struct isl_printer_chunk	*last;
+	size_t		len;
+	isl_stat	(*write)(const char *data, size_t len, void *user);
+	void		*write_user;
 	int		indent;
 	int		output_format;
 	int		dump;
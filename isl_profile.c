@@ -0,0 +1,242 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+/* Per-region profiling counters.
+ *
+ * When isl is configured with --enable-profile, each entry into
+ * one of the regions in enum isl_profile_region is counted and
+ * the wall clock time spent inside the region as well as
+ * the number of bytes of memory accounted to the isl_ctx
+ * (see isl_ctx_memory_acquire) while inside the region are accumulated.
+ * Regions may be entered recursively, either directly or
+ * through other regions.  Only the outermost entry of a given region
+ * contributes time and memory such that these are not counted twice.
+ * Different regions are profiled independently, so the numbers
+ * of a region include those of any other region entered from it.
+ *
+ * Without --enable-profile, the calls in the library reduce to nothing
+ * and the functions for retrieving the counters report
+ * an isl_error_unsupported error.
+ */
+
+#include <isl_config.h>
+#include <stdlib.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+
+#include <isl_ctx_private.h>
+#include <isl_profile_private.h>
+
+#ifdef ISL_PROFILE
+
+/* The names of the regions, in the order of enum isl_profile_region.
+ */
+static const char *region_name[isl_profile_n_region] = {
+	"simplify",
+	"coalesce",
+	"subtract",
+	"lexopt",
+	"tab_pivot",
+	"farkas",
+	"sched_lp",
+	"ast_gen",
+};
+
+/* The counters of a single region.
+ *
+ * "calls" is the number of times the region was entered.
+ * "time" is the total wall clock time spent inside the region and
+ * "bytes" is the total number of bytes accounted inside the region.
+ * "depth" is the number of entries into the region that have
+ * not been left yet.
+ * "start" and "start_bytes" are the time and the value of
+ * isl_profile->bytes at the outermost entry that is currently active.
+ */
+struct isl_profile_entry {
+	long		calls;
+	double		time;
+	unsigned long	bytes;
+
+	int		depth;
+	double		start;
+	unsigned long	start_bytes;
+};
+
+/* The profile of an isl_ctx.
+ *
+ * "bytes" is the total number of bytes accounted to the isl_ctx
+ * since the profile was created.
+ */
+struct isl_profile {
+	unsigned long		bytes;
+	struct isl_profile_entry	entry[isl_profile_n_region];
+};
+
+/* Return the current wall clock time in seconds.
+ */
+static double now(void)
+{
+#ifdef HAVE_SYS_TIME_H
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Return the profile of "ctx", creating it if needed.
+ * The profile is allocated directly rather than through the isl_ctx
+ * to avoid affecting the operation count and the memory accounting.
+ * If the profile cannot be allocated, then profiling is silently skipped.
+ */
+static struct isl_profile *get_profile(isl_ctx *ctx)
+{
+	if (!ctx)
+		return NULL;
+	if (!ctx->profile)
+		ctx->profile = calloc(1, sizeof(struct isl_profile));
+	return ctx->profile;
+}
+
+/* Free the profile of "ctx", if any.
+ */
+void isl_profile_free(isl_ctx *ctx)
+{
+	if (!ctx)
+		return;
+	free(ctx->profile);
+	ctx->profile = NULL;
+}
+
+/* Record that "region" is entered on "ctx".
+ */
+void isl_profile_enter(isl_ctx *ctx, enum isl_profile_region region)
+{
+	struct isl_profile *profile;
+	struct isl_profile_entry *entry;
+
+	profile = get_profile(ctx);
+	if (!profile)
+		return;
+	entry = &profile->entry[region];
+	entry->calls++;
+	if (entry->depth++ > 0)
+		return;
+	entry->start_bytes = profile->bytes;
+	entry->start = now();
+}
+
+/* Record that "region" is left on "ctx".
+ * A call that does not match an earlier isl_profile_enter,
+ * e.g., because the profile was reset in between, is ignored.
+ */
+void isl_profile_leave(isl_ctx *ctx, enum isl_profile_region region)
+{
+	struct isl_profile_entry *entry;
+
+	if (!ctx || !ctx->profile)
+		return;
+	entry = &ctx->profile->entry[region];
+	if (entry->depth <= 0 || --entry->depth > 0)
+		return;
+	entry->time += now() - entry->start;
+	entry->bytes += ctx->profile->bytes - entry->start_bytes;
+}
+
+/* Record that "size" more bytes have been accounted to "ctx".
+ * There is no need to keep track of allocations before
+ * any region has been entered.
+ */
+void isl_profile_alloc(isl_ctx *ctx, size_t size)
+{
+	if (ctx && ctx->profile)
+		ctx->profile->bytes += size;
+}
+
+/* Call "fn" on each region of the profile of "ctx" that has been
+ * entered at least once, passing along the name of the region,
+ * the number of calls, the total time and the number of allocated bytes.
+ */
+isl_stat isl_ctx_foreach_profile_entry(isl_ctx *ctx,
+	isl_stat (*fn)(const char *name, long calls, double time,
+		unsigned long bytes, void *user), void *user)
+{
+	int i;
+
+	if (!ctx)
+		return isl_stat_error;
+	if (!ctx->profile)
+		return isl_stat_ok;
+	for (i = 0; i < isl_profile_n_region; ++i) {
+		struct isl_profile_entry *entry = &ctx->profile->entry[i];
+
+		if (entry->calls == 0)
+			continue;
+		if (fn(region_name[i], entry->calls, entry->time,
+			entry->bytes, user) < 0)
+			return isl_stat_error;
+	}
+
+	return isl_stat_ok;
+}
+
+/* Reset all counters of the profile of "ctx".
+ * Any regions that are currently active are no longer considered
+ * to be active.
+ */
+isl_stat isl_ctx_reset_profile(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_stat_error;
+	isl_profile_free(ctx);
+	return isl_stat_ok;
+}
+
+/* Print a line for a single region to the file "user".
+ */
+static isl_stat print_entry(const char *name, long calls, double time,
+	unsigned long bytes, void *user)
+{
+	FILE *out = user;
+
+	fprintf(out, "profile: %-15s %10ld calls %12.6f s %14lu bytes\n",
+		name, calls, time, bytes);
+	return isl_stat_ok;
+}
+
+/* Print the profile of "ctx" to "out".
+ */
+void isl_profile_print(isl_ctx *ctx, FILE *out)
+{
+	isl_ctx_foreach_profile_entry(ctx, &print_entry, out);
+}
+
+#else
+
+isl_stat isl_ctx_foreach_profile_entry(isl_ctx *ctx,
+	isl_stat (*fn)(const char *name, long calls, double time,
+		unsigned long bytes, void *user), void *user)
+{
+	if (!ctx)
+		return isl_stat_error;
+	isl_die(ctx, isl_error_unsupported,
+		"isl was configured without profiling support",
+		return isl_stat_error);
+}
+
+isl_stat isl_ctx_reset_profile(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_stat_error;
+	isl_die(ctx, isl_error_unsupported,
+		"isl was configured without profiling support",
+		return isl_stat_error);
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef ISL_PROFILE_PRIVATE_H
+#define ISL_PROFILE_PRIVATE_H
+
+#include <stddef.h>
+#include <isl_config.h>
+#include <isl/ctx.h>
+
+/* The regions of the library for which calls, time and
+ * allocated memory are recorded when isl is configured
+ * with --enable-profile.
+ * The names of the regions are kept in isl_profile.c.
+ */
+enum isl_profile_region {
+	isl_profile_simplify,
+	isl_profile_coalesce,
+	isl_profile_subtract,
+	isl_profile_lexopt,
+	isl_profile_tab_pivot,
+	isl_profile_farkas,
+	isl_profile_sched_lp,
+	isl_profile_ast_gen,
+	isl_profile_n_region
+};
+
+#ifdef ISL_PROFILE
+
+void isl_profile_free(isl_ctx *ctx);
+void isl_profile_enter(isl_ctx *ctx, enum isl_profile_region region);
+void isl_profile_leave(isl_ctx *ctx, enum isl_profile_region region);
+void isl_profile_alloc(isl_ctx *ctx, size_t size);
+void isl_profile_print(isl_ctx *ctx, FILE *out);
+
+#else
+
+#define isl_profile_free(ctx)			((void) (ctx))
+#define isl_profile_enter(ctx,region)		((void) (ctx))
+#define isl_profile_leave(ctx,region)		((void) (ctx))
+#define isl_profile_alloc(ctx,size)		((void) (ctx))
+#define isl_profile_print(ctx,out)		((void) (ctx))
+
+#endif
+
+#endif
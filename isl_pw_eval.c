@@ -10,6 +10,7 @@
  * and Ecole Normale Superieure, 45 rue d'Ulm, 75230 Paris, France
  */
 
+#include <limits.h>
 #include "isl/val.h"
 #include <isl_space_private.h>
 #include <isl_point_private.h>
@@ -99,3 +100,101 @@ error:
 	isl_point_free(pnt);
 	return NULL;
 }
+
+/* Evaluate "pw" in each of the "n" integer points with coordinates "coords"
+ * and return the results as a list.
+ * The coordinates of each point are stored consecutively in "coords",
+ * with the values of the parameters of "pw" followed
+ * by those of the domain variables.
+ * The result for a point outside the domain of "pw" is
+ * 0 or NaN depending on whether 0 is the default value
+ * for this type of function.
+ * The total number of coordinates is required to fit in an int.
+ *
+ * Rather than calling isl_set_contains_point on every piece
+ * for every point, each cell is compiled into a point filter once.
+ * The filters are compiled for the largest absolute value
+ * of any coordinate, such that the cell containing a point
+ * can typically be found using native integer arithmetic.
+ */
+__isl_give isl_val_list *FN(PW,eval_si_array)(__isl_keep PW *pw, int n,
+	const long *coords)
+{
+	int i, j;
+	isl_ctx *ctx;
+	isl_size dim;
+	isl_space *space;
+	isl_val_list *list;
+	isl_point_filter **filter;
+	long bound = 0;
+
+	if (!pw)
+		return NULL;
+	ctx = FN(PW,get_ctx)(pw);
+	if (n < 0)
+		isl_die(ctx, isl_error_invalid, "negative number of points",
+			return NULL);
+	if (n > 0 && !coords)
+		isl_die(ctx, isl_error_invalid, "no coordinates specified",
+			return NULL);
+	space = FN(PW,get_domain_space)(pw);
+	dim = isl_space_dim(space, isl_dim_all);
+	if (dim < 0)
+		space = isl_space_free(space);
+	if (dim > 0 && n > INT_MAX / dim) {
+		isl_space_free(space);
+		isl_die(ctx, isl_error_invalid, "too many coordinates",
+			return NULL);
+	}
+
+	for (i = 0; i < n * dim; ++i) {
+		if (coords[i] < -LONG_MAX)
+			bound = LONG_MAX;
+		else if (coords[i] > bound)
+			bound = coords[i];
+		else if (-coords[i] > bound)
+			bound = -coords[i];
+	}
+
+	list = isl_val_list_alloc(ctx, n);
+	filter = isl_calloc_array(ctx, isl_point_filter *, pw->n);
+	if (!space || (pw->n && !filter))
+		list = isl_val_list_free(list);
+	for (i = 0; list && i < pw->n; ++i) {
+		filter[i] = isl_point_filter_alloc(pw->p[i].set, bound);
+		if (!filter[i])
+			list = isl_val_list_free(list);
+	}
+
+	for (j = 0; list && j < n; ++j) {
+		isl_bool found = isl_bool_false;
+		isl_val *v;
+
+		for (i = 0; i < pw->n; ++i) {
+			found = isl_point_filter_contains(filter[i],
+							coords + j * dim);
+			if (found < 0 || found)
+				break;
+		}
+		if (found < 0) {
+			v = NULL;
+		} else if (found) {
+			isl_point *pnt;
+
+			pnt = isl_point_from_si_array(isl_space_copy(space),
+							coords + j * dim);
+			v = FN(EL,eval)(FN(EL,copy)(pw->p[i].FIELD), pnt);
+		} else if (DEFAULT_IS_ZERO) {
+			v = isl_val_zero(ctx);
+		} else {
+			v = isl_val_nan(ctx);
+		}
+		list = isl_val_list_add(list, v);
+	}
+
+	for (i = 0; filter && i < pw->n; ++i)
+		isl_point_filter_free(filter[i]);
+	free(filter);
+	isl_space_free(space);
+	return list;
+}
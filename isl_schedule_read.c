@@ -4,6 +4,7 @@
 #include "isl/stream.h"
 #include <isl_schedule_private.h>
 #include <isl_schedule_tree.h>
+#include <isl_trace_private.h>
 
 /* An enumeration of the various keys that may appear in a YAML mapping
  * of a schedule.
@@ -709,6 +710,8 @@ static __isl_give isl_schedule_tree *isl_stream_read_schedule_tree(
 }
 
 /* Read an isl_schedule from "s".
+ * The calls performed while parsing the schedule are not recorded
+ * in the trace of the isl_ctx, if any.
  */
 __isl_give isl_schedule *isl_stream_read_schedule(isl_stream *s)
 {
@@ -719,7 +722,9 @@ __isl_give isl_schedule *isl_stream_read_schedule(isl_stream *s)
 		return NULL;
 
 	ctx = isl_stream_get_ctx(s);
+	isl_trace_suppress(ctx);
 	tree = isl_stream_read_schedule_tree(s);
+	isl_trace_resume(ctx);
 	return isl_schedule_from_schedule_tree(ctx, tree);
 }
 
@@ -39,6 +39,8 @@
 #include <isl_morph.h>
 #include "isl/ilp.h"
 #include <isl_val_private.h>
+#include <isl_trace_private.h>
+#include <isl_profile_private.h>
 
 #include "isl_scheduler.h"
 #include "isl_scheduler_clustering.h"
@@ -2921,8 +2923,10 @@ static __isl_give isl_vec *solve_lp(isl_ctx *ctx, struct isl_sched_graph *graph)
 		graph->region[i].trivial = trivial;
 	}
 	lp = isl_basic_set_copy(graph->lp);
+	isl_profile_enter(ctx, isl_profile_sched_lp);
 	sol = isl_tab_basic_set_non_trivial_lexmin(lp, 2, graph->n,
 				       graph->region, &check_conflict, graph);
+	isl_profile_leave(ctx, isl_profile_sched_lp);
 	for (i = 0; i < graph->n; ++i)
 		isl_mat_free(graph->region[i].trivial);
 	return sol;
@@ -5072,12 +5076,17 @@ static __isl_give isl_vec *compute_carrying_sol_coef(isl_ctx *ctx,
 	int carry_inter)
 {
 	isl_basic_set *lp;
+	isl_vec *sol;
 
 	if (setup_carry_lp(ctx, graph, n_edge, intra, inter, carry_inter) < 0)
 		return NULL;
 
 	lp = isl_basic_set_copy(graph->lp);
-	return non_neg_lexmin(graph, lp, n_edge, want_integral);
+	isl_profile_enter(ctx, isl_profile_sched_lp);
+	sol = non_neg_lexmin(graph, lp, n_edge, want_integral);
+	isl_profile_leave(ctx, isl_profile_sched_lp);
+
+	return sol;
 }
 
 /* Construct an LP problem for finding schedule coefficients
@@ -5893,6 +5902,9 @@ __isl_give isl_schedule *isl_schedule_constraints_compute_schedule(
 	isl_union_set *domain;
 	isl_size n;
 
+	if (isl_ctx_is_tracing(ctx))
+		return isl_schedule_constraints_trace_compute_schedule(sc);
+
 	sc = isl_schedule_constraints_align_params(sc);
 
 	domain = isl_schedule_constraints_get_domain(sc);
@@ -11,6 +11,12 @@
 #include <string.h>
 #include <isl_ctx_private.h>
 #include <isl_stream_private.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "isl/map.h"
 #include "isl/aff.h"
 #include <isl_val_private.h>
@@ -67,12 +73,50 @@ enum isl_token_type isl_stream_register_keyword(__isl_keep isl_stream *s,
 	return keyword->type;
 }
 
+/* The maximal number of freed tokens that are kept around
+ * for reuse by isl_token_new.
+ */
+#define ISL_TOKEN_CACHE_SIZE	16
+
+/* A cache of freed tokens.
+ * "n" is the number of tokens in "token".
+ */
+struct isl_token_cache {
+	int n;
+	struct isl_token *token[ISL_TOKEN_CACHE_SIZE];
+};
+
+/* Free all tokens in the token cache of "ctx" as well as the cache itself.
+ */
+void isl_token_cache_clear(isl_ctx *ctx)
+{
+	int i;
+	struct isl_token_cache *cache;
+
+	if (!ctx || !ctx->token_cache)
+		return;
+
+	cache = ctx->token_cache;
+	for (i = 0; i < cache->n; ++i)
+		free(cache->token[i]);
+	free(cache);
+	ctx->token_cache = NULL;
+}
+
+/* Return a new token, reusing a previously freed token if possible.
+ */
 struct isl_token *isl_token_new(isl_ctx *ctx,
 	int line, int col, unsigned on_new_line)
 {
-	struct isl_token *tok = isl_alloc_type(ctx, struct isl_token);
+	struct isl_token *tok;
+
+	if (ctx->token_cache && ctx->token_cache->n > 0)
+		tok = ctx->token_cache->token[--ctx->token_cache->n];
+	else
+		tok = isl_alloc_type(ctx, struct isl_token);
 	if (!tok)
 		return NULL;
+	tok->ctx = ctx;
 	tok->line = line;
 	tok->col = col;
 	tok->on_new_line = on_new_line;
@@ -81,6 +125,31 @@ struct isl_token *isl_token_new(isl_ctx *ctx,
 	return tok;
 }
 
+/* Set the string representation of "tok" to a copy
+ * of the first "len" characters of "str".
+ * If possible, the copy is stored inside "tok" itself.
+ */
+static isl_stat token_set_str_len(struct isl_token *tok, const char *str,
+	size_t len)
+{
+	if (len < ISL_TOKEN_STR_SIZE)
+		tok->u.s = tok->str;
+	else
+		tok->u.s = isl_alloc_array(tok->ctx, char, len + 1);
+	if (!tok->u.s)
+		return isl_stat_error;
+	memcpy(tok->u.s, str, len);
+	tok->u.s[len] = '\0';
+	return isl_stat_ok;
+}
+
+/* Set the string representation of "tok" to a copy of "str".
+ */
+static isl_stat token_set_str(struct isl_token *tok, const char *str)
+{
+	return token_set_str_len(tok, str, strlen(str));
+}
+
 /* Return the type of "tok".
  */
 int isl_token_get_type(struct isl_token *tok)
@@ -124,6 +193,22 @@ __isl_give char *isl_token_get_str(isl_ctx *ctx, struct isl_token *tok)
 	return strdup(tok->u.s);
 }
 
+/* Keep "tok", which no longer holds any data, for reuse
+ * by isl_token_new, or free it if the token cache is full.
+ */
+static void cache_token(struct isl_token *tok)
+{
+	isl_ctx *ctx = tok->ctx;
+
+	if (!ctx->token_cache)
+		ctx->token_cache = isl_calloc_type(ctx, struct isl_token_cache);
+	if (!ctx->token_cache || ctx->token_cache->n >= ISL_TOKEN_CACHE_SIZE) {
+		free(tok);
+		return;
+	}
+	ctx->token_cache->token[ctx->token_cache->n++] = tok;
+}
+
 void isl_token_free(struct isl_token *tok)
 {
 	if (!tok)
@@ -134,9 +219,9 @@ void isl_token_free(struct isl_token *tok)
 		isl_map_free(tok->u.map);
 	else if (tok->type == ISL_TOKEN_AFF)
 		isl_pw_aff_free(tok->u.pwaff);
-	else
+	else if (tok->u.s != tok->str)
 		free(tok->u.s);
-	free(tok);
+	cache_token(tok);
 }
 
 void isl_stream_error(__isl_keep isl_stream *s, struct isl_token *tok,
@@ -237,6 +322,126 @@ __isl_give isl_stream* isl_stream_new_str(struct isl_ctx *ctx, const char *str)
 	return s;
 }
 
+/* Create a stream that reads the "len" bytes starting at "buf".
+ * The bytes do not need to be NUL terminated, but reading stops
+ * at the first NUL byte, if any.
+ * The caller is responsible for keeping "buf" alive
+ * while the stream is in use.
+ */
+__isl_give isl_stream *isl_stream_new_buffer(isl_ctx *ctx, const char *buf,
+	size_t len)
+{
+	isl_stream *s;
+
+	s = isl_stream_new_str(ctx, buf);
+	if (!s)
+		return NULL;
+	s->end = buf + len;
+	return s;
+}
+
+/* Read the entire contents of "file" into memory and
+ * store the result in s->data and s->data_size.
+ */
+static isl_stat read_file(__isl_keep isl_stream *s, FILE *file)
+{
+	size_t size = 4096;
+	size_t n;
+
+	s->data = isl_alloc_array(s->ctx, char, size);
+	if (!s->data)
+		return isl_stat_error;
+	while ((n = fread((char *) s->data + s->data_size, 1,
+			    size - s->data_size, file)) > 0) {
+		void *data;
+
+		s->data_size += n;
+		if (s->data_size < size)
+			continue;
+		size *= 2;
+		data = isl_realloc_array(s->ctx, s->data, char, size);
+		if (!data)
+			return isl_stat_error;
+		s->data = data;
+	}
+	if (ferror(file))
+		isl_die(s->ctx, isl_error_unknown, "unable to read file",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Try and map the contents of the file called "filename" into memory,
+ * storing the result in s->data and s->data_size.
+ * Return isl_bool_false if the file cannot be mapped,
+ * e.g., because it is not a regular file.
+ */
+static isl_bool map_file(__isl_keep isl_stream *s, const char *filename)
+{
+#ifdef HAVE_SYS_MMAN_H
+	int fd;
+	struct stat st;
+	void *data;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return isl_bool_false;
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+		close(fd);
+		return isl_bool_false;
+	}
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return isl_bool_false;
+	s->data = data;
+	s->data_size = st.st_size;
+	s->mapped = 1;
+	return isl_bool_true;
+#else
+	return isl_bool_false;
+#endif
+}
+
+/* Create a stream that reads the contents of the file called "filename"
+ * directly from memory.
+ * If possible, the file is mapped into memory.
+ * Otherwise, it is read into memory in its entirety.
+ */
+__isl_give isl_stream *isl_stream_new_mapped_file(isl_ctx *ctx,
+	const char *filename)
+{
+	isl_stream *s;
+	isl_bool mapped;
+
+	if (!filename)
+		return NULL;
+	s = isl_stream_new(ctx);
+	if (!s)
+		return NULL;
+	mapped = map_file(s, filename);
+	if (mapped < 0)
+		goto error;
+	if (!mapped) {
+		FILE *file;
+		isl_stat r;
+
+		file = fopen(filename, "r");
+		if (!file)
+			isl_die(ctx, isl_error_invalid, "unable to open file",
+				goto error);
+		r = read_file(s, file);
+		fclose(file);
+		if (r < 0)
+			goto error;
+	}
+	s->str = s->data;
+	s->end = s->str + s->data_size;
+	return s;
+error:
+	isl_stream_free(s);
+	return NULL;
+}
+
 /* Read a character from the stream and advance s->line and s->col
  * to point to the next character.
  */
@@ -249,6 +454,8 @@ static int stream_getc(__isl_keep isl_stream *s)
 		return s->c = s->un[--s->n_un];
 	if (s->file)
 		c = fgetc(s->file);
+	else if (s->end && s->str >= s->end)
+		c = -1;
 	else {
 		c = *s->str++;
 		if (c == '\0')
@@ -314,48 +521,151 @@ void isl_stream_push_token(__isl_keep isl_stream *s, struct isl_token *tok)
 	s->tokens[s->n_token++] = tok;
 }
 
+/* Can the next characters of "s" be read directly from memory?
+ * That is, does "s" read from a string and
+ * are there no characters that have been pushed back?
+ */
+static int in_memory(__isl_keep isl_stream *s)
+{
+	return s->str && !s->n_un && !s->eof;
+}
+
+/* Is the character at "p" part of the string read by "s"?
+ * Note that reading stops at the first NUL character,
+ * which does not satisfy any of the tests applied to
+ * the result of this function.
+ */
+static int available(__isl_keep isl_stream *s, const char *p)
+{
+	return !s->end || p < s->end;
+}
+
+/* Skip the spaces and tabs at the current position of "s",
+ * which is assumed to read from memory, and
+ * also newlines if "same_line" is not set.
+ * Any other white space is handled by the caller.
+ */
+static void skip_blanks(__isl_keep isl_stream *s, int same_line)
+{
+	const char *p = s->str;
+
+	for (; available(s, p); ++p) {
+		if (*p == ' ' || *p == '\t') {
+			s->col++;
+		} else if (*p == '\n' && !same_line) {
+			s->line++;
+			s->col = 1;
+		} else
+			break;
+	}
+	if (p != s->str)
+		s->c = p[-1];
+	s->str = p;
+}
+
+/* Append the "n" characters at the current position of "s",
+ * which is assumed to read from memory, to s->buffer and
+ * advance the position of "s" past those characters.
+ * The characters are assumed not to contain any newlines.
+ */
+static int push_span(__isl_keep isl_stream *s, size_t n)
+{
+	if (n == 0)
+		return 0;
+	if (s->len + n > s->size) {
+		char *buffer;
+		size_t size = (3 * s->size) / 2;
+
+		if (size < s->len + n)
+			size = s->len + n;
+		buffer = isl_realloc_array(s->ctx, s->buffer, char, size);
+		if (!buffer)
+			return -1;
+		s->buffer = buffer;
+		s->size = size;
+	}
+	memcpy(s->buffer + s->len, s->str, n);
+	s->len += n;
+	s->str += n;
+	s->col += n;
+	s->c = (unsigned char) s->str[-1];
+	return 0;
+}
+
+/* Append the digits at the current position of "s",
+ * which is assumed to read from memory, to s->buffer.
+ */
+static int push_digits(__isl_keep isl_stream *s)
+{
+	const char *p = s->str;
+
+	while (available(s, p) && isdigit((unsigned char) *p))
+		++p;
+	return push_span(s, p - s->str);
+}
+
+/* Append the identifier characters at the current position of "s",
+ * which is assumed to read from memory, to s->buffer.
+ */
+static int push_ident(__isl_keep isl_stream *s)
+{
+	const char *p = s->str;
+
+	while (available(s, p) && (isalnum((unsigned char) *p) || *p == '_'))
+		++p;
+	return push_span(s, p - s->str);
+}
+
+/* The keywords that are recognized by every stream, along with
+ * the lengths of their names.
+ * This table is shared by all streams.
+ * Keywords registered through isl_stream_register_keyword
+ * are specific to the stream on which they are registered.
+ */
+static const struct {
+	const char		*name;
+	size_t			len;
+	enum isl_token_type	type;
+} builtin_keywords[] = {
+	{ "and",	3,	ISL_TOKEN_AND },
+	{ "or",		2,	ISL_TOKEN_OR },
+	{ "exists",	6,	ISL_TOKEN_EXISTS },
+	{ "implies",	7,	ISL_TOKEN_IMPLIES },
+	{ "not",	3,	ISL_TOKEN_NOT },
+	{ "infty",	5,	ISL_TOKEN_INFTY },
+	{ "infinity",	8,	ISL_TOKEN_INFTY },
+	{ "NaN",	3,	ISL_TOKEN_NAN },
+	{ "min",	3,	ISL_TOKEN_MIN },
+	{ "max",	3,	ISL_TOKEN_MAX },
+	{ "rat",	3,	ISL_TOKEN_RAT },
+	{ "true",	4,	ISL_TOKEN_TRUE },
+	{ "false",	5,	ISL_TOKEN_FALSE },
+	{ "ceild",	5,	ISL_TOKEN_CEILD },
+	{ "floord",	6,	ISL_TOKEN_FLOORD },
+	{ "mod",	3,	ISL_TOKEN_MOD },
+	{ "ceil",	4,	ISL_TOKEN_CEIL },
+	{ "floor",	5,	ISL_TOKEN_FLOOR },
+};
+static const int n_builtin_keywords =
+	sizeof(builtin_keywords) / sizeof(builtin_keywords[0]);
+
+/* Return the type of the identifier in s->buffer, of length s->len - 1.
+ */
 static enum isl_token_type check_keywords(__isl_keep isl_stream *s)
 {
+	int i;
+	size_t len;
 	struct isl_hash_table_entry *entry;
 	struct isl_keyword *keyword;
 	uint32_t name_hash;
 
-	if (!strcasecmp(s->buffer, "exists"))
-		return ISL_TOKEN_EXISTS;
-	if (!strcasecmp(s->buffer, "and"))
-		return ISL_TOKEN_AND;
-	if (!strcasecmp(s->buffer, "or"))
-		return ISL_TOKEN_OR;
-	if (!strcasecmp(s->buffer, "implies"))
-		return ISL_TOKEN_IMPLIES;
-	if (!strcasecmp(s->buffer, "not"))
-		return ISL_TOKEN_NOT;
-	if (!strcasecmp(s->buffer, "infty"))
-		return ISL_TOKEN_INFTY;
-	if (!strcasecmp(s->buffer, "infinity"))
-		return ISL_TOKEN_INFTY;
-	if (!strcasecmp(s->buffer, "NaN"))
-		return ISL_TOKEN_NAN;
-	if (!strcasecmp(s->buffer, "min"))
-		return ISL_TOKEN_MIN;
-	if (!strcasecmp(s->buffer, "max"))
-		return ISL_TOKEN_MAX;
-	if (!strcasecmp(s->buffer, "rat"))
-		return ISL_TOKEN_RAT;
-	if (!strcasecmp(s->buffer, "true"))
-		return ISL_TOKEN_TRUE;
-	if (!strcasecmp(s->buffer, "false"))
-		return ISL_TOKEN_FALSE;
-	if (!strcasecmp(s->buffer, "ceild"))
-		return ISL_TOKEN_CEILD;
-	if (!strcasecmp(s->buffer, "floord"))
-		return ISL_TOKEN_FLOORD;
-	if (!strcasecmp(s->buffer, "mod"))
-		return ISL_TOKEN_MOD;
-	if (!strcasecmp(s->buffer, "ceil"))
-		return ISL_TOKEN_CEIL;
-	if (!strcasecmp(s->buffer, "floor"))
-		return ISL_TOKEN_FLOOR;
+	len = s->len - 1;
+	for (i = 0; i < n_builtin_keywords; ++i) {
+		if (builtin_keywords[i].len != len)
+			continue;
+		if (!strcasecmp(s->buffer, builtin_keywords[i].name))
+			return builtin_keywords[i].type;
+	}
 
 	if (!s->keywords)
 		return ISL_TOKEN_IDENT;
@@ -384,6 +694,48 @@ int isl_stream_skip_line(__isl_keep isl_stream *s)
 	return c == -1 ? -1 : 0;
 }
 
+/* The characters that form a token by themselves,
+ * with the token type equal to the character.
+ */
+static const char single_char_token[256] = {
+	['('] = 1, [')'] = 1, ['+'] = 1, ['*'] = 1,
+	['%'] = 1, ['?'] = 1, ['^'] = 1, ['@'] = 1,
+	['$'] = 1, [','] = 1, ['.'] = 1, [';'] = 1,
+	['['] = 1, [']'] = 1, ['{'] = 1, ['}'] = 1,
+};
+
+/* Has the token that is being read from memory by "s" ended?
+ * That is, can the next character not be a continuation of the token,
+ * either directly or after skipping a line continuation?
+ * Return 0 if "s" does not read from memory.
+ */
+static int at_token_end(__isl_keep isl_stream *s)
+{
+	if (!in_memory(s))
+		return 0;
+	if (!available(s, s->str))
+		return 1;
+	return *s->str != '\\' && *s->str != '\'';
+}
+
+/* Set the value of "tok" to the non-negative integer in s->buffer,
+ * of length s->len - 1.
+ * Integers with few digits are converted directly.
+ */
+static void set_value(__isl_keep isl_stream *s, struct isl_token *tok)
+{
+	int i;
+	long v = 0;
+
+	if (s->len - 1 > 18) {
+		isl_int_read(tok->u.v, s->buffer);
+		return;
+	}
+	for (i = 0; i + 1 < s->len; ++i)
+		v = 10 * v + (s->buffer[i] - '0');
+	isl_int_set_si(tok->u.v, v);
+}
+
 static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 {
 	int c;
@@ -403,6 +755,8 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 	s->len = 0;
 
 	/* skip spaces and comment lines */
+	if (in_memory(s))
+		skip_blanks(s, same_line);
 	while ((c = isl_stream_getc(s)) != -1) {
 		if (c == '#') {
 			if (isl_stream_skip_line(s) < 0)
@@ -421,22 +775,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		return NULL;
 	s->last_line = line;
 
-	if (c == '(' ||
-	    c == ')' ||
-	    c == '+' ||
-	    c == '*' ||
-	    c == '%' ||
-	    c == '?' ||
-	    c == '^' ||
-	    c == '@' ||
-	    c == '$' ||
-	    c == ',' ||
-	    c == '.' ||
-	    c == ';' ||
-	    c == '[' ||
-	    c == ']' ||
-	    c == '{' ||
-	    c == '}') {
+	if (c >= 0 && c < 256 && single_char_token[c]) {
 		tok = isl_token_new(s->ctx, line, col, old_line != line);
 		if (!tok)
 			return NULL;
@@ -449,7 +788,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			tok = isl_token_new(s->ctx, line, col, old_line != line);
 			if (!tok)
 				return NULL;
-			tok->u.s = strdup("->");
+			token_set_str(tok, "->");
 			tok->type = ISL_TOKEN_TO;
 			return tok;
 		}
@@ -470,13 +809,17 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		isl_int_init(tok->u.v);
 		if (isl_stream_push_char(s, c))
 			goto error;
-		while ((c = isl_stream_getc(s)) != -1 && isdigit(c))
-			if (isl_stream_push_char(s, c))
-				goto error;
-		if (c != -1)
-			isl_stream_ungetc(s, c);
+		if (in_memory(s) && push_digits(s) < 0)
+			goto error;
+		if (!at_token_end(s)) {
+			while ((c = isl_stream_getc(s)) != -1 && isdigit(c))
+				if (isl_stream_push_char(s, c))
+					goto error;
+			if (c != -1)
+				isl_stream_ungetc(s, c);
+		}
 		isl_stream_push_char(s, '\0');
-		isl_int_read(tok->u.v, s->buffer);
+		set_value(s, tok);
 		if (minus && isl_int_is_zero(tok->u.v)) {
 			tok->col++;
 			tok->on_new_line = 0;
@@ -493,21 +836,24 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		isl_stream_push_char(s, c);
-		while ((c = isl_stream_getc(s)) != -1 &&
-				(isalnum(c) || c == '_'))
-			isl_stream_push_char(s, c);
-		if (c != -1)
-			isl_stream_ungetc(s, c);
-		while ((c = isl_stream_getc(s)) != -1 && c == '\'')
-			isl_stream_push_char(s, c);
-		if (c != -1)
-			isl_stream_ungetc(s, c);
+		if (in_memory(s) && push_ident(s) < 0)
+			goto error;
+		if (!at_token_end(s)) {
+			while ((c = isl_stream_getc(s)) != -1 &&
+					(isalnum(c) || c == '_'))
+				isl_stream_push_char(s, c);
+			if (c != -1)
+				isl_stream_ungetc(s, c);
+			while ((c = isl_stream_getc(s)) != -1 && c == '\'')
+				isl_stream_push_char(s, c);
+			if (c != -1)
+				isl_stream_ungetc(s, c);
+		}
 		isl_stream_push_char(s, '\0');
 		tok->type = check_keywords(s);
 		if (tok->type != ISL_TOKEN_IDENT)
 			tok->is_keyword = 1;
-		tok->u.s = strdup(s->buffer);
-		if (!tok->u.s)
+		if (token_set_str_len(tok, s->buffer, s->len - 1) < 0)
 			goto error;
 		return tok;
 	}
@@ -524,7 +870,8 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			goto error;
 		}
 		isl_stream_push_char(s, '\0');
-		tok->u.s = strdup(s->buffer);
+		if (token_set_str_len(tok, s->buffer, s->len - 1) < 0)
+			goto error;
 		return tok;
 	}
 	if (c == '=') {
@@ -533,7 +880,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup("==");
+			token_set_str(tok, "==");
 			tok->type = ISL_TOKEN_EQ_EQ;
 			return tok;
 		}
@@ -548,7 +895,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup(":=");
+			token_set_str(tok, ":=");
 			tok->type = ISL_TOKEN_DEF;
 			return tok;
 		}
@@ -563,19 +910,19 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup(">=");
+			token_set_str(tok, ">=");
 			tok->type = ISL_TOKEN_GE;
 			return tok;
 		} else if (c == '>') {
 			if ((c = isl_stream_getc(s)) == '=') {
-				tok->u.s = strdup(">>=");
+				token_set_str(tok, ">>=");
 				tok->type = ISL_TOKEN_LEX_GE;
 				return tok;
 			}
-			tok->u.s = strdup(">>");
+			token_set_str(tok, ">>");
 			tok->type = ISL_TOKEN_LEX_GT;
 		} else {
-			tok->u.s = strdup(">");
+			token_set_str(tok, ">");
 			tok->type = ISL_TOKEN_GT;
 		}
 		if (c != -1)
@@ -588,19 +935,19 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup("<=");
+			token_set_str(tok, "<=");
 			tok->type = ISL_TOKEN_LE;
 			return tok;
 		} else if (c == '<') {
 			if ((c = isl_stream_getc(s)) == '=') {
-				tok->u.s = strdup("<<=");
+				token_set_str(tok, "<<=");
 				tok->type = ISL_TOKEN_LEX_LE;
 				return tok;
 			}
-			tok->u.s = strdup("<<");
+			token_set_str(tok, "<<");
 			tok->type = ISL_TOKEN_LEX_LT;
 		} else {
-			tok->u.s = strdup("<");
+			token_set_str(tok, "<");
 			tok->type = ISL_TOKEN_LT;
 		}
 		if (c != -1)
@@ -613,10 +960,10 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			return NULL;
 		tok->type = ISL_TOKEN_AND;
 		if ((c = isl_stream_getc(s)) != '&' && c != -1) {
-			tok->u.s = strdup("&");
+			token_set_str(tok, "&");
 			isl_stream_ungetc(s, c);
 		} else
-			tok->u.s = strdup("&&");
+			token_set_str(tok, "&&");
 		return tok;
 	}
 	if (c == '|') {
@@ -625,10 +972,10 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			return NULL;
 		tok->type = ISL_TOKEN_OR;
 		if ((c = isl_stream_getc(s)) != '|' && c != -1) {
-			tok->u.s = strdup("|");
+			token_set_str(tok, "|");
 			isl_stream_ungetc(s, c);
 		} else
-			tok->u.s = strdup("||");
+			token_set_str(tok, "||");
 		return tok;
 	}
 	if (c == '/') {
@@ -636,11 +983,11 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '\\') {
-			tok->u.s = strdup("/\\");
+			token_set_str(tok, "/\\");
 			tok->type = ISL_TOKEN_AND;
 			return tok;
 		} else if (c == '/') {
-			tok->u.s = strdup("//");
+			token_set_str(tok, "//");
 			tok->type = ISL_TOKEN_INT_DIV;
 			return tok;
 		} else {
@@ -658,7 +1005,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			tok->type = (enum isl_token_type) '\\';
 			isl_stream_ungetc(s, c);
 		} else {
-			tok->u.s = strdup("\\/");
+			token_set_str(tok, "\\/");
 			tok->type = ISL_TOKEN_OR;
 		}
 		return tok;
@@ -668,12 +1015,12 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup("!=");
+			token_set_str(tok, "!=");
 			tok->type = ISL_TOKEN_NE;
 			return tok;
 		} else {
 			tok->type = ISL_TOKEN_NOT;
-			tok->u.s = strdup("!");
+			token_set_str(tok, "!");
 		}
 		if (c != -1)
 			isl_stream_ungetc(s, c);
@@ -818,6 +1165,12 @@ void isl_stream_free(__isl_take isl_stream *s)
 	}
 	free(s->yaml_state);
 	free(s->yaml_indent);
+#ifdef HAVE_SYS_MMAN_H
+	if (s->mapped)
+		munmap(s->data, s->data_size);
+	else
+#endif
+		free(s->data);
 	isl_ctx_deref(s->ctx);
 	free(s);
 }
@@ -2,7 +2,16 @@
 #include "isl/stream.h"
 #include <isl_yaml.h>
 
+#define ISL_TOKEN_STR_SIZE	16
+
+/* A token read from an isl_stream.
+ *
+ * "ctx" is the isl_ctx in which the token was created.
+ * If the string representation of the token is short enough,
+ * then u.s points to "str".  Otherwise, it is allocated separately.
+ */
 struct isl_token {
+	isl_ctx *ctx;
 	int type;
 
 	unsigned int on_new_line : 1;
@@ -16,12 +25,20 @@ struct isl_token {
 		isl_map *map;
 		isl_pw_aff *pwaff;
 	} u;
+	char str[ISL_TOKEN_STR_SIZE];
 };
 
 struct isl_token *isl_token_new(isl_ctx *ctx,
 	int line, int col, unsigned on_new_line);
 
 /* An input stream that may be either a file or a string.
+ *
+ * If the stream reads from a string, then "end" points right after
+ * the last character of the string, or is NULL if the string
+ * is terminated by a NUL character.
+ * "data" is the memory backing a stream created by
+ * isl_stream_new_mapped_file, of size "data_size".
+ * It is either memory mapped (if "mapped" is set) or allocated.
  *
  * line and col are the line and column number of the next character (1-based).
  * start_line and start_col are set by isl_stream_getc to point
@@ -42,6 +59,10 @@ struct isl_stream {
 	struct isl_ctx	*ctx;
 	FILE        	*file;
 	const char  	*str;
+	const char	*end;
+	void		*data;
+	size_t		data_size;
+	int		mapped;
 	int	    	line;
 	int	    	col;
 	int		start_line;
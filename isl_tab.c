@@ -20,6 +20,7 @@
 #include "isl_tab.h"
 #include <isl_seq.h>
 #include <isl_config.h>
+#include <isl_profile_private.h>
 
 #include <bset_to_bmap.c>
 #include <bset_from_bmap.c>
@@ -1122,7 +1123,7 @@ static void update_row_sign(struct isl_tab *tab, int row, int col, int row_sgn)
  * s(n_rc)d_r n_jc/(|n_rc| d_j)	(n_ji |n_rc| - s(n_rc)n_jc n_ri)/(|n_rc| d_j)
  *
  */
-int isl_tab_pivot(struct isl_tab *tab, int row, int col)
+static int tab_pivot(struct isl_tab *tab, int row, int col)
 {
 	int i, j;
 	int sgn;
@@ -1135,6 +1136,7 @@ int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 	ctx = isl_tab_get_ctx(tab);
 	if (isl_ctx_next_operation(ctx) < 0)
 		return -1;
+	ctx->stats->tab_pivots++;
 
 	isl_int_swap(mat->row[row][0], mat->row[row][off + col]);
 	sgn = isl_int_sgn(mat->row[row][0]);
@@ -1195,6 +1197,22 @@ int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 	return 0;
 }
 
+/* Pivot "row" and "col" of "tab", keeping track of the time spent
+ * in the profile of the isl_ctx, if needed.
+ */
+int isl_tab_pivot(struct isl_tab *tab, int row, int col)
+{
+	isl_ctx *ctx;
+	int r;
+
+	ctx = isl_tab_get_ctx(tab);
+	isl_profile_enter(ctx, isl_profile_tab_pivot);
+	r = tab_pivot(tab, row, col);
+	isl_profile_leave(ctx, isl_profile_tab_pivot);
+
+	return r;
+}
+
 /* If "var" represents a column variable, then pivot is up (sgn > 0)
  * or down (sgn < 0) to a row.  The variable is assumed not to be
  * unbounded in the specified direction.
@@ -3414,6 +3432,305 @@ enum isl_lp_result isl_tab_min(struct isl_tab *tab,
 	return res;
 }
 
+/* Data used by the floating point simplex in isl_tab_float_warm_start.
+ *
+ * "a" is an (n_row + 1) x (1 + n_col) matrix in row major order,
+ * with row "n_row" representing the objective function.
+ * Each row expresses the value of the corresponding variable
+ * as a constant term followed by the coefficients
+ * of the column variables.
+ * "row_var" and "col_var" keep track of the variables
+ * in the rows and columns, using the same encoding as in isl_tab.
+ */
+struct isl_tab_float {
+	struct isl_tab *tab;
+	int n_row;
+	int n_col;
+	double *a;
+	int *row_var;
+	int *col_var;
+};
+
+static double *float_row(struct isl_tab_float *ft, int row)
+{
+	return ft->a + row * (1 + ft->n_col);
+}
+
+/* Initialize "ft" from the rows of "tab" and the objective function "f",
+ * which is expressed in terms of the variables of "tab",
+ * in the same way as in isl_tab_add_row.
+ */
+static isl_stat tab_float_init(struct isl_tab_float *ft, struct isl_tab *tab,
+	isl_int *f)
+{
+	int i, j;
+	double *obj;
+	unsigned off = 2 + tab->M;
+	isl_ctx *ctx = isl_tab_get_ctx(tab);
+
+	ft->tab = tab;
+	ft->n_row = tab->n_row;
+	ft->n_col = tab->n_col;
+	ft->a = isl_calloc_array(ctx, double,
+				(ft->n_row + 1) * (1 + ft->n_col));
+	ft->row_var = isl_alloc_array(ctx, int, ft->n_row);
+	ft->col_var = isl_alloc_array(ctx, int, ft->n_col);
+	if (!ft->a || (ft->n_row && !ft->row_var) ||
+	    (ft->n_col && !ft->col_var))
+		return isl_stat_error;
+
+	for (i = 0; i < ft->n_row; ++i) {
+		isl_int *row = tab->mat->row[i];
+		double *r = float_row(ft, i);
+		double d = isl_int_get_d(row[0]);
+
+		ft->row_var[i] = tab->row_var[i];
+		r[0] = isl_int_get_d(row[1]) / d;
+		for (j = 0; j < ft->n_col; ++j)
+			r[1 + j] = isl_int_get_d(row[off + j]) / d;
+	}
+	for (j = 0; j < ft->n_col; ++j)
+		ft->col_var[j] = tab->col_var[j];
+
+	obj = float_row(ft, ft->n_row);
+	obj[0] = isl_int_get_d(f[0]);
+	for (i = 0; i < tab->n_var; ++i) {
+		double c = isl_int_get_d(f[1 + i]);
+		double *r;
+
+		if (tab->var[i].is_zero || c == 0)
+			continue;
+		if (!tab->var[i].is_row) {
+			obj[1 + tab->var[i].index] += c;
+			continue;
+		}
+		r = float_row(ft, tab->var[i].index);
+		for (j = 0; j < 1 + ft->n_col; ++j)
+			obj[j] += c * r[j];
+	}
+
+	return isl_stat_ok;
+}
+
+static void tab_float_clear(struct isl_tab_float *ft)
+{
+	free(ft->a);
+	free(ft->row_var);
+	free(ft->col_var);
+	ft->a = NULL;
+	ft->row_var = NULL;
+	ft->col_var = NULL;
+}
+
+/* Pivot the row variable at position "row" of "ft"
+ * with the column variable at position "col".
+ */
+static void tab_float_pivot(struct isl_tab_float *ft, int row, int col)
+{
+	int i, j, t;
+	double *r = float_row(ft, row);
+	double p = r[1 + col];
+
+	for (j = 0; j < 1 + ft->n_col; ++j)
+		r[j] = -r[j] / p;
+	r[1 + col] = 1 / p;
+	for (i = 0; i <= ft->n_row; ++i) {
+		double *ri = float_row(ft, i);
+		double c;
+
+		if (i == row || ri[1 + col] == 0)
+			continue;
+		c = ri[1 + col];
+		ri[1 + col] = 0;
+		for (j = 0; j < 1 + ft->n_col; ++j)
+			ri[j] += c * r[j];
+	}
+	t = ft->row_var[row];
+	ft->row_var[row] = ft->col_var[col];
+	ft->col_var[col] = t;
+}
+
+/* Run the primal simplex method in floating point on "ft",
+ * minimizing the objective function in the final row.
+ * Only variables that are marked non-negative in the original
+ * tableau are constrained.  Dead columns and redundant rows
+ * are ignored, as in the exact version.
+ * Return isl_bool_true if an optimum was found and
+ * isl_bool_false if the floating point computation did not
+ * reach a conclusion, e.g., because the problem appears
+ * to be unbounded or because of numerical problems.
+ */
+static isl_bool tab_float_minimize(struct isl_tab_float *ft)
+{
+	int it, max_it;
+	struct isl_tab *tab = ft->tab;
+	double *obj = float_row(ft, ft->n_row);
+	const double eps = 1e-9;
+
+	max_it = 10 * (ft->n_row + ft->n_col) + 50;
+	for (it = 0; it < max_it; ++it) {
+		int i, j;
+		int row = -1, col = -1;
+		int sgn = 0;
+		double best = eps, ratio = 0;
+
+		for (j = tab->n_dead; j < ft->n_col; ++j) {
+			struct isl_tab_var *var;
+			double c = obj[1 + j];
+
+			var = var_from_index(tab, ft->col_var[j]);
+			if (var->is_zero)
+				continue;
+			if (-c > best) {
+				best = -c;
+				col = j;
+				sgn = 1;
+			} else if (!var->is_nonneg && c > best) {
+				best = c;
+				col = j;
+				sgn = -1;
+			}
+		}
+		if (col < 0)
+			return isl_bool_true;
+
+		for (i = tab->n_redundant; i < ft->n_row; ++i) {
+			struct isl_tab_var *var;
+			double *r = float_row(ft, i);
+			double c = sgn * r[1 + col];
+			double v = r[0] > 0 ? r[0] : 0;
+
+			var = var_from_index(tab, ft->row_var[i]);
+			if (!var->is_nonneg || c > -eps)
+				continue;
+			if (row < 0 || v / -c < ratio) {
+				row = i;
+				ratio = v / -c;
+			}
+		}
+		if (row < 0)
+			return isl_bool_false;
+		tab_float_pivot(ft, row, col);
+	}
+
+	return isl_bool_false;
+}
+
+/* Return the position of the variable encoded as "v" (as in
+ * tab->row_var and tab->col_var) in an array indexed by
+ * the variables of "tab" followed by its constraints.
+ */
+static int var_pos(struct isl_tab *tab, int v)
+{
+	return v >= 0 ? v : tab->n_var + ~v;
+}
+
+/* Pivot "tab" towards the basis described by "is_col",
+ * which marks the variables that should appear in columns.
+ * Return isl_bool_true if the resulting tableau is still feasible,
+ * i.e., if all non-negative variables have a non-negative
+ * sample value.
+ */
+static isl_bool tab_move_to_basis(struct isl_tab *tab, int *is_col)
+{
+	int i, j;
+	unsigned off = 2 + tab->M;
+
+	for (j = tab->n_dead; j < tab->n_col; ++j) {
+		if (is_col[var_pos(tab, tab->col_var[j])])
+			continue;
+		if (var_from_col(tab, j)->is_zero)
+			continue;
+		for (i = tab->n_redundant; i < tab->n_row; ++i) {
+			if (!is_col[var_pos(tab, tab->row_var[i])])
+				continue;
+			if (isl_int_is_zero(tab->mat->row[i][off + j]))
+				continue;
+			if (isl_tab_pivot(tab, i, j) < 0)
+				return isl_bool_error;
+			break;
+		}
+	}
+
+	for (i = tab->n_redundant; i < tab->n_row; ++i) {
+		if (!isl_tab_var_from_row(tab, i)->is_nonneg)
+			continue;
+		if (isl_int_is_neg(tab->mat->row[i][1]))
+			return isl_bool_false;
+	}
+
+	return isl_bool_true;
+}
+
+/* Try and use a floating point version of the simplex method
+ * to bring "tab" close to a basis that is optimal for minimizing "f",
+ * where "f" is of the same form as the argument of isl_tab_min.
+ *
+ * The floating point simplex is performed on a copy of the tableau
+ * and only the final basis is used.  A duplicate of "tab" is pivoted
+ * exactly to this basis and if the result is feasible,
+ * then it replaces "tab".  Otherwise, "tab" is returned unchanged.
+ * Either way, the result represents the same set as the input and
+ * a subsequent call to isl_tab_min performs an exact optimization
+ * starting from the returned basis, so that the optimal value
+ * is not affected by any rounding errors.
+ * If the floating point basis is indeed optimal, then this exact
+ * optimization only needs to verify optimality.
+ */
+struct isl_tab *isl_tab_float_warm_start(struct isl_tab *tab, isl_int *f)
+{
+	int i;
+	isl_ctx *ctx;
+	isl_bool ok;
+	int *is_col = NULL;
+	struct isl_tab *dup = NULL;
+	struct isl_tab_float ft = { NULL };
+
+	if (!tab)
+		return NULL;
+	if (tab->empty || tab->M || tab->n_col == tab->n_dead)
+		return tab;
+
+	ctx = isl_tab_get_ctx(tab);
+	if (tab_float_init(&ft, tab, f) < 0)
+		goto error;
+	ok = tab_float_minimize(&ft);
+	if (ok < 0)
+		goto error;
+	if (!ok) {
+		tab_float_clear(&ft);
+		ctx->stats->lp_float_fallback++;
+		return tab;
+	}
+
+	is_col = isl_calloc_array(ctx, int, tab->n_var + tab->n_con);
+	if (!is_col)
+		goto error;
+	for (i = 0; i < ft.n_col; ++i)
+		is_col[var_pos(tab, ft.col_var[i])] = 1;
+	tab_float_clear(&ft);
+
+	dup = isl_tab_dup(tab);
+	ok = dup ? tab_move_to_basis(dup, is_col) : isl_bool_error;
+	free(is_col);
+	if (ok < 0)
+		goto error;
+	if (!ok) {
+		isl_tab_free(dup);
+		ctx->stats->lp_float_fallback++;
+		return tab;
+	}
+
+	ctx->stats->lp_float_used++;
+	isl_tab_free(tab);
+	return dup;
+error:
+	tab_float_clear(&ft);
+	isl_tab_free(dup);
+	isl_tab_free(tab);
+	return NULL;
+}
+
 /* Is the constraint at position "con" marked as being redundant?
  * If it is marked as representing an equality, then it is not
  * considered to be redundant.
@@ -196,7 +196,7 @@ error:
  * If the domain was extracted from the basic map, then there is
  * no need to add back those constraints again.
  */
-__isl_give TYPE *SF(isl_tab_basic_map_partial_lexopt,SUFFIX)(
+static __isl_give TYPE *SF(tab_basic_map_partial_lexopt,SUFFIX)(
 	__isl_take isl_basic_map *bmap, __isl_take isl_basic_set *dom,
 	__isl_give isl_set **empty, unsigned flags)
 {
@@ -233,3 +233,23 @@ error:
 	isl_basic_map_free(bmap);
 	return NULL;
 }
+
+/* Compute the lexicographic minimum (or maximum if "flags" includes
+ * ISL_OPT_MAX) of "bmap" over the domain "dom",
+ * keeping track of the time spent in the profile of the isl_ctx,
+ * if needed.
+ */
+__isl_give TYPE *SF(isl_tab_basic_map_partial_lexopt,SUFFIX)(
+	__isl_take isl_basic_map *bmap, __isl_take isl_basic_set *dom,
+	__isl_give isl_set **empty, unsigned flags)
+{
+	isl_ctx *ctx;
+	TYPE *res;
+
+	ctx = isl_basic_map_get_ctx(bmap);
+	isl_profile_enter(ctx, isl_profile_lexopt);
+	res = SF(tab_basic_map_partial_lexopt,SUFFIX)(bmap, dom, empty, flags);
+	isl_profile_leave(ctx, isl_profile_lexopt);
+
+	return res;
+}
@@ -22,6 +22,7 @@
 #include <isl_constraint_private.h>
 #include <isl_options_private.h>
 #include <isl_config.h>
+#include <isl_profile_private.h>
 
 #include <bset_to_bmap.c>
 
@@ -39,6 +39,9 @@
 #include "isl/ast_build.h"
 #include "isl/val.h"
 #include "isl/ilp.h"
+#include "isl/lp.h"
+#include "isl/binary.h"
+#include "isl/stream.h"
 #include <isl_ast_build_expr.h>
 #include "isl/options.h"
 
@@ -473,6 +476,18 @@ struct {
 		"[b] : b < a and c >= b and d >= b; "
 		"[c] : c < b and c < a and d >= c; "
 		"[d] : d < c and d < b and d < a }" },
+	{ "{ [x] : x >= 0 AND Exists (e : x = 2e) }",
+	  "{ [x] : x >= 0 and x mod 2 = 0 }" },
+	{ "[a_long_parameter_name] -> { [x] : x <= a_long_parameter_name }",
+	  "[a_long_parameter_name] -> { [x] : x - a_long_parameter_name <= 0 }" },
+	{ "{ [x] : x = 999999999999999999 }",
+	  "{ [x] : x = 1000000000000000000 - 1 }" },
+	{ "{ [x] : x = 1000000000000000000000 }",
+	  "{ [x] : x = 999999999999999999999 + 1 }" },
+	{ "{ [x, x'] : x' = x + 1\\\n2 }",
+	  "{ [x, y] : y = x + 12 }" },
+	{ "[lo\\\nng] -> { [x] : x < lo\\\nng }",
+	  "[long] -> { [x] : x < long }" },
 };
 
 int test_parse(struct isl_ctx *ctx)
@@ -543,35 +558,1113 @@ int test_parse(struct isl_ctx *ctx)
 	return 0;
 }
 
+/* Check that reading a set from a memory mapped file and
+ * from a buffer that is not NUL terminated produces the expected results.
+ * The buffer contains more than one set, but only the first
+ * "len" bytes are used.
+ */
+static isl_stat test_read_mapped(isl_ctx *ctx)
+{
+	char *filename;
+	isl_stream *s;
+	isl_basic_set *bset1, *bset2;
+	isl_set *set1, *set2;
+	const char *str = "{[y]: Exists ( alpha : 2alpha = y)}";
+	const char *buf = "[n] -> { [i] : 0 <= i <= 1234567 }"
+			  "[n] -> { [i] : 0 <= i <= 1234567 and i <= n }";
+	size_t len = 34;
+	isl_bool equal;
+
+	filename = get_filename(ctx, "set", "omega");
+	if (!filename)
+		return isl_stat_error;
+	s = isl_stream_new_mapped_file(ctx, filename);
+	free(filename);
+	bset1 = isl_stream_read_basic_set(s);
+	isl_stream_free(s);
+	bset2 = isl_basic_set_read_from_str(ctx, str);
+	equal = isl_basic_set_is_equal(bset1, bset2);
+	isl_basic_set_free(bset1);
+	isl_basic_set_free(bset2);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"sets read from mapped file not equal",
+			return isl_stat_error);
+
+	s = isl_stream_new_buffer(ctx, buf, len);
+	set1 = isl_stream_read_set(s);
+	if (!isl_stream_is_empty(s))
+		set1 = isl_set_free(set1);
+	isl_stream_free(s);
+	set2 = isl_set_read_from_str(ctx, "[n] -> { [i] : 0 <= i <= 1234567 }");
+	equal = isl_set_is_equal(set1, set2);
+	isl_set_free(set1);
+	isl_set_free(set2);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"sets read from buffer not equal",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
 static int test_read(isl_ctx *ctx)
 {
-	char *filename;
-	FILE *input;
-	isl_basic_set *bset1, *bset2;
-	const char *str = "{[y]: Exists ( alpha : 2alpha = y)}";
-	int equal;
+	char *filename;
+	FILE *input;
+	isl_basic_set *bset1, *bset2;
+	const char *str = "{[y]: Exists ( alpha : 2alpha = y)}";
+	int equal;
+
+	filename = get_filename(ctx, "set", "omega");
+	assert(filename);
+	input = fopen(filename, "r");
+	assert(input);
+
+	bset1 = isl_basic_set_read_from_file(ctx, input);
+	bset2 = isl_basic_set_read_from_str(ctx, str);
+
+	equal = isl_basic_set_is_equal(bset1, bset2);
+
+	isl_basic_set_free(bset1);
+	isl_basic_set_free(bset2);
+	free(filename);
+
+	fclose(input);
+
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"read sets not equal", return -1);
+
+	if (test_read_mapped(ctx) < 0)
+		return -1;
+
+	return 0;
+}
+
+/* Inputs for binary round trip tests of union maps.
+ */
+static const char *binary_map_tests[] = {
+	"{ }",
+	"[n] -> { A[i] -> B[j] : 0 <= i < n and j = 2i + 1 }",
+	"{ [i, j] -> [k] : exists (e = floor((i + j)/3): k = 3e) }",
+	"{ [[s] -> A[i]] -> [[s + 1] -> A[i]] }",
+	"[N] -> { S[i] -> [i + 1] : i >= N; T[x, y] -> [x] : x > y }",
+	"[M] -> { A[i] -> [] : i < 0; A[i] -> B[] : i > M }",
+};
+
+/* Inputs for binary round trip tests of union sets.
+ */
+static const char *binary_set_tests[] = {
+	"[n] -> { : n > 0 }",
+	"{ rat: [x] : 0 <= 3x <= 1 }",
+	"{ [x] : x = 123456789012345678901234567890 }",
+	"{ [x] : x >= -1152921504606846976 and x < 1152921504606846976 }",
+	"[n] -> { A[[i] -> B[j]] : i < j < n; C[] : n = 0 }",
+};
+
+/* Check that writing "umap" in binary format and
+ * reading it back results in the same union map.
+ */
+static isl_stat check_binary_union_map(isl_ctx *ctx,
+	__isl_keep isl_union_map *umap)
+{
+	void *buf;
+	size_t size;
+	isl_union_map *umap2;
+	isl_bool equal;
+
+	buf = isl_union_map_to_binary(umap, &size);
+	umap2 = isl_union_map_read_from_binary(ctx, buf, size);
+	free(buf);
+	equal = isl_union_map_is_equal(umap, umap2);
+	isl_union_map_free(umap2);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"binary round trip changed union map",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Check that writing "uset" in binary format and
+ * reading it back results in the same union set.
+ */
+static isl_stat check_binary_union_set(isl_ctx *ctx,
+	__isl_keep isl_union_set *uset)
+{
+	void *buf;
+	size_t size;
+	isl_union_set *uset2;
+	isl_bool equal;
+
+	buf = isl_union_set_to_binary(uset, &size);
+	uset2 = isl_union_set_read_from_binary(ctx, buf, size);
+	free(buf);
+	equal = isl_union_set_is_equal(uset, uset2);
+	isl_union_set_free(uset2);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"binary round trip changed union set",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Check that writing "map" in binary format and reading it back
+ * results in the same map and that the same holds for
+ * its first basic map, if any.
+ */
+static isl_stat check_binary_map(isl_ctx *ctx, __isl_keep isl_map *map)
+{
+	void *buf;
+	size_t size;
+	isl_map *map2;
+	isl_basic_map_list *list;
+	isl_basic_map *bmap, *bmap2;
+	isl_bool equal;
+
+	buf = isl_map_to_binary(map, &size);
+	map2 = isl_map_read_from_binary(ctx, buf, size);
+	free(buf);
+	equal = isl_map_is_equal(map, map2);
+	isl_map_free(map2);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"binary round trip changed map", return isl_stat_error);
+
+	if (isl_map_n_basic_map(map) == 0)
+		return isl_stat_ok;
+	list = isl_map_get_basic_map_list(map);
+	bmap = isl_basic_map_list_get_at(list, 0);
+	isl_basic_map_list_free(list);
+	buf = isl_basic_map_to_binary(bmap, &size);
+	bmap2 = isl_basic_map_read_from_binary(ctx, buf, size);
+	free(buf);
+	equal = isl_basic_map_is_equal(bmap, bmap2);
+	isl_basic_map_free(bmap);
+	isl_basic_map_free(bmap2);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"binary round trip changed basic map",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Check that writing "set" in binary format and reading it back
+ * results in the same set and that the same holds for
+ * its first basic set, if any.
+ */
+static isl_stat check_binary_set(isl_ctx *ctx, __isl_keep isl_set *set)
+{
+	void *buf;
+	size_t size;
+	isl_set *set2;
+	isl_basic_set_list *list;
+	isl_basic_set *bset, *bset2;
+	isl_bool equal;
+
+	buf = isl_set_to_binary(set, &size);
+	set2 = isl_set_read_from_binary(ctx, buf, size);
+	free(buf);
+	equal = isl_set_is_equal(set, set2);
+	isl_set_free(set2);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"binary round trip changed set", return isl_stat_error);
+
+	if (isl_set_n_basic_set(set) == 0)
+		return isl_stat_ok;
+	list = isl_set_get_basic_set_list(set);
+	bset = isl_basic_set_list_get_at(list, 0);
+	isl_basic_set_list_free(list);
+	buf = isl_basic_set_to_binary(bset, &size);
+	bset2 = isl_basic_set_read_from_binary(ctx, buf, size);
+	free(buf);
+	equal = isl_basic_set_is_equal(bset, bset2);
+	isl_basic_set_free(bset);
+	isl_basic_set_free(bset2);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"binary round trip changed basic set",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+static isl_stat check_binary_map_cb(__isl_take isl_map *map, void *user)
+{
+	isl_stat r;
+
+	r = check_binary_map(isl_map_get_ctx(map), map);
+	isl_map_free(map);
+	return r;
+}
+
+static isl_stat check_binary_set_cb(__isl_take isl_set *set, void *user)
+{
+	isl_stat r;
+
+	r = check_binary_set(isl_set_get_ctx(set), set);
+	isl_set_free(set);
+	return r;
+}
+
+/* Check that objects written to a file in binary format
+ * can be read back sequentially and that corrupted binary data
+ * is rejected.
+ */
+static isl_stat test_binary_file(isl_ctx *ctx)
+{
+	FILE *file;
+	void *buf;
+	size_t size;
+	int on_error;
+	isl_set *set, *set2;
+	isl_union_set *uset, *uset2;
+	isl_bool equal, equal2;
+
+	set = isl_set_read_from_str(ctx, "[n] -> { [i] : 0 <= i < n }");
+	uset = isl_union_set_read_from_str(ctx, "{ A[i] : i > 0; B[] }");
+	file = tmpfile();
+	if (!file)
+		isl_die(ctx, isl_error_unknown, "unable to create file",
+			goto error);
+	if (isl_set_write_binary_file(set, file) < 0 ||
+	    isl_union_set_write_binary_file(uset, file) < 0)
+		goto error;
+	rewind(file);
+	set2 = isl_set_read_from_binary_file(ctx, file);
+	uset2 = isl_union_set_read_from_binary_file(ctx, file);
+	fclose(file);
+	equal = isl_set_is_equal(set, set2);
+	equal2 = isl_union_set_is_equal(uset, uset2);
+	isl_set_free(set2);
+	isl_union_set_free(uset2);
+	if (equal < 0 || equal2 < 0)
+		goto error;
+	if (!equal || !equal2)
+		isl_die(ctx, isl_error_unknown,
+			"binary file round trip changed set", goto error);
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	buf = isl_set_to_binary(set, &size);
+	set2 = isl_set_read_from_binary(ctx, buf, size - 1);
+	isl_set_free(set2);
+	if (!set2)
+		set2 = isl_set_from_union_set(
+			isl_union_set_read_from_binary(ctx, buf, size));
+	isl_set_free(set2);
+	free(buf);
+	isl_options_set_on_error(ctx, on_error);
+	if (set2)
+		isl_die(ctx, isl_error_unknown,
+			"invalid binary data accepted", goto error);
+
+	isl_set_free(set);
+	isl_union_set_free(uset);
+	return isl_stat_ok;
+error:
+	isl_set_free(set);
+	isl_union_set_free(uset);
+	return isl_stat_error;
+}
+
+/* Check that invalid explicit representations of local variables
+ * in binary input are rejected.
+ * The binary input is obtained by writing out a basic set
+ * with a single local variable, the representation of which
+ * is first made to depend on itself and then
+ * given a negative denominator.
+ */
+static isl_stat test_binary_invalid_div(isl_ctx *ctx)
+{
+	int i;
+	int on_error;
+	void *buf;
+	size_t size;
+	isl_size dim;
+	isl_basic_set *bset, *bset2;
+	enum isl_error error = isl_error_none;
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	for (i = 0; i < 2; ++i) {
+		bset = isl_basic_set_read_from_str(ctx, "{ [i] : i mod 3 = 1 }");
+		bset = isl_basic_set_cow(bset);
+		dim = isl_basic_set_dim(bset, isl_dim_all);
+		if (dim < 0 || bset->n_div != 1) {
+			isl_basic_set_free(bset);
+			break;
+		}
+		if (i == 0)
+			isl_int_set_si(bset->div[0][2 + dim - 1], 1);
+		else
+			isl_int_neg(bset->div[0][0], bset->div[0][0]);
+		buf = isl_basic_set_to_binary(bset, &size);
+		isl_basic_set_free(bset);
+		isl_ctx_reset_error(ctx);
+		bset2 = isl_basic_set_read_from_binary(ctx, buf, size);
+		free(buf);
+		isl_basic_set_free(bset2);
+		error = isl_ctx_last_error(ctx);
+		if (bset2 || error != isl_error_invalid)
+			break;
+	}
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (i < 2)
+		isl_die(ctx, isl_error_unknown,
+			"invalid local variable accepted",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Append the variable length encoding of "u" to "buf" at position "pos"
+ * and return the position right after the encoding.
+ */
+static size_t binary_put_uint(unsigned char *buf, size_t pos, size_t u)
+{
+	do {
+		buf[pos] = u & 0x7f;
+		if (u >> 7)
+			buf[pos] |= 0x80;
+		u >>= 7;
+		++pos;
+	} while (u);
+
+	return pos;
+}
+
+/* Return the length of the variable length encoding of "u".
+ */
+static size_t binary_uint_len(size_t u)
+{
+	size_t len = 1;
+
+	while (u >>= 7)
+		++len;
+	return len;
+}
+
+/* Allocate a buffer for the binary representation of a basic set
+ * with a payload of "len" bytes and fill in the header.
+ * The payload starts with an empty identifier table and
+ * a space table containing a single set space without parameters.
+ * Store the position of the tuple of this space in "pos".
+ */
+static unsigned char *binary_basic_set_alloc(size_t len, size_t *pos)
+{
+	unsigned char *buf;
+
+	buf = malloc(6 + 2 * sizeof(size_t) + len);
+	if (!buf)
+		return NULL;
+	memcpy(buf, "ISLB", 4);
+	buf[4] = 2;
+	buf[5] = 1;
+	*pos = binary_put_uint(buf, 6, len);
+	buf[(*pos)++] = 0;
+	buf[(*pos)++] = 1;
+	buf[(*pos)++] = 1;
+	buf[(*pos)++] = 0;
+	return buf;
+}
+
+/* Construct the binary representation of a universe basic set
+ * in a space that consists of "depth" nested wrapped spaces,
+ * storing its size in "size".
+ * Each wrapped tuple is encoded as a zero identifier reference,
+ * a one byte indicating that the tuple is wrapped and
+ * the encodings of the domain and range tuples,
+ * while the innermost tuples are encoded as a zero identifier reference,
+ * a zero byte and a zero number of dimensions.
+ * The basic set itself is encoded as a reference to this space,
+ * zero local variables and constraints and a zero byte
+ * indicating that it is not rational.
+ */
+static unsigned char *binary_nested_set(int depth, size_t *size)
+{
+	int i;
+	size_t pos;
+	unsigned char *buf;
+
+	buf = binary_basic_set_alloc(4 + 2 * depth + 3 * (depth + 1) + 5,
+					&pos);
+	if (!buf)
+		return NULL;
+	for (i = 0; i < depth; ++i) {
+		buf[pos++] = 0;
+		buf[pos++] = 1;
+	}
+	for (i = 0; i < 3 * (depth + 1) + 5; ++i)
+		buf[pos++] = 0;
+	*size = pos;
+	return buf;
+}
+
+/* Construct the binary representation of a basic set
+ * in a space of dimension "dim" that claims to have
+ * "dim" equality constraints, but that only contains
+ * "dim" coefficients for these constraints, storing its size in "size".
+ */
+static unsigned char *binary_many_rows(int dim, size_t *size)
+{
+	int i;
+	size_t pos;
+	unsigned char *buf;
+
+	buf = binary_basic_set_alloc(4 + 2 + binary_uint_len(dim) + dim +
+					2 + binary_uint_len(dim) + 2 + dim, &pos);
+	if (!buf)
+		return NULL;
+	buf[pos++] = 0;
+	buf[pos++] = 0;
+	pos = binary_put_uint(buf, pos, dim);
+	for (i = 0; i < dim; ++i)
+		buf[pos++] = 0;
+	buf[pos++] = 0;
+	buf[pos++] = 0;
+	pos = binary_put_uint(buf, pos, dim);
+	buf[pos++] = 0;
+	buf[pos++] = 0;
+	for (i = 0; i < dim; ++i)
+		buf[pos++] = 0;
+	*size = pos;
+	return buf;
+}
+
+/* Check that binary input describing deeply nested spaces is rejected,
+ * while moderately nested spaces are accepted.
+ */
+static isl_stat test_binary_nesting(isl_ctx *ctx)
+{
+	int on_error;
+	size_t size;
+	unsigned char *buf;
+	isl_basic_set *bset, *bset2;
+
+	buf = binary_nested_set(100, &size);
+	bset = isl_basic_set_read_from_binary(ctx, buf, size);
+	free(buf);
+	isl_basic_set_free(bset);
+	if (!bset)
+		return isl_stat_error;
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	buf = binary_nested_set(1000, &size);
+	bset2 = isl_basic_set_read_from_binary(ctx, buf, size);
+	free(buf);
+	isl_basic_set_free(bset2);
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (bset2)
+		isl_die(ctx, isl_error_unknown,
+			"deeply nested space accepted", return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Check that binary input that claims to contain more constraints
+ * than it can possibly hold is rejected before allocating memory
+ * for these constraints.
+ */
+static isl_stat test_binary_many_rows(isl_ctx *ctx)
+{
+	int on_error;
+	size_t size;
+	unsigned char *buf;
+	isl_basic_set *bset;
+	const char *msg;
+	int rejected;
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	buf = binary_many_rows(1000, &size);
+	bset = isl_basic_set_read_from_binary(ctx, buf, size);
+	free(buf);
+	isl_basic_set_free(bset);
+	msg = isl_ctx_last_error_msg(ctx);
+	rejected = !bset && msg &&
+		    !strcmp(msg, "invalid number of rows in binary input");
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (!rejected)
+		isl_die(ctx, isl_error_unknown,
+			"invalid number of rows not detected",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Piecewise multi-affine expressions that are written out
+ * in binary format and read back by test_binary_pw_multi_aff.
+ */
+static const char *binary_pma_tests[] = {
+	"{ [i] -> [i + 1] }",
+	"{ [] -> [1, 2] }",
+	"[n] -> { A[i, j] -> B[floor(i/2), -j + n] : i > j; "
+		"A[i, j] -> B[0, floor((i + 2j)/3)] : i <= j }",
+	"{ [i] -> [floor((floor(i/2) + 1)/3)] : i >= 0 }",
+	"{ [[i] -> [j]] -> S[(i + 1)/2, 2j] }",
+	"{ [i] -> [i, floor(i/4)] : i < 0; [i] -> [0, floor(i/5)] : i >= 0 }",
+	"[n] -> { [] -> [] : n > 0 }",
+};
+
+/* Check that writing the piecewise multi-affine expressions
+ * in binary_pma_tests in binary format and reading them back
+ * results in the same expressions, with the cells in the same order.
+ */
+static isl_stat test_binary_pw_multi_aff(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(binary_pma_tests); ++i) {
+		void *buf;
+		size_t size;
+		isl_pw_multi_aff *pma, *pma2;
+		isl_bool equal;
+
+		pma = isl_pw_multi_aff_read_from_str(ctx, binary_pma_tests[i]);
+		buf = isl_pw_multi_aff_to_binary(pma, &size);
+		pma2 = isl_pw_multi_aff_read_from_binary(ctx, buf, size);
+		free(buf);
+		equal = isl_pw_multi_aff_plain_is_equal(pma, pma2);
+		isl_pw_multi_aff_free(pma);
+		isl_pw_multi_aff_free(pma2);
+		if (equal < 0)
+			return isl_stat_error;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"binary round trip changed "
+				"piecewise multi-affine expression",
+				return isl_stat_error);
+	}
+
+	return isl_stat_ok;
+}
+
+/* Schedules that are written out in binary format and
+ * read back by test_binary_schedule.
+ * Together, they contain all types of schedule tree nodes.
+ */
+static const char *binary_schedule_tests[] = {
+	"{ domain: \"{ S[i] : 0 <= i < 10; T[i, j] : 0 <= i, j < 10 }\" }",
+	"{ domain: \"[n] -> { S[i] : 0 <= i < n; T[i, j] : 0 <= i, j < n }\", "
+	  "child: { context: \"[n] -> { [] : n >= 0 }\", "
+	  "child: { sequence: [ "
+	    "{ filter: \"[n] -> { S[i] }\", child: { mark: \"m\", "
+	      "child: { schedule: \"[n] -> [{ S[i] -> [(i)] }]\", "
+	      "permutable: 1, coincident: [ 1 ] } } }, "
+	    "{ filter: \"[n] -> { T[i, j] }\", "
+	      "child: { schedule: \"[n] -> [{ T[i, j] -> [(floor(i/2))] }, "
+	      "{ T[i, j] -> [(j)] }]\", coincident: [ 0, 1 ], "
+	      "options: \"[n] -> { separate[0]; atomic[1] }\", "
+	      "child: { guard: \"[n] -> { [i, j] : i < n }\" } } } ] } } }",
+	"{ domain: \"{ S[i] : 0 <= i < 10 }\", child: { set: [ "
+	  "{ filter: \"{ S[i] : i < 5 }\" }, "
+	  "{ filter: \"{ S[i] : i >= 5 }\" } ] } }",
+	"{ domain: \"{ S[i] : 0 <= i < 10 }\", "
+	  "child: { schedule: \"[{ S[i] -> [(i)] }]\", "
+	  "child: { extension: \"{ [i] -> U[] }\", child: { sequence: [ "
+	    "{ filter: \"{ U[] }\" }, { filter: \"{ S[i] }\" } ] } } } }",
+	"{ domain: \"{ C[i] : 0 <= i < 10 }\", "
+	  "child: { contraction: \"{ S[i] -> C[i] }\", "
+	  "expansion: \"{ C[i] -> S[i] }\", "
+	  "child: { schedule: \"[{ S[i] -> [(i)] }]\" } } }",
+	"{ domain: \"[n] -> { S[i] : 0 <= i < n }\", "
+	  "child: { schedule: \"[n] -> ([] : { S[i] : i > 0 })\" } }",
+	"{ domain: \"[n] -> { S[i] : 0 <= i < n }\", "
+	  "child: { schedule: \"[n] -> [{ S[i] -> [(i)] : i > 2; "
+	  "S[i] -> [(0)] : i <= 2 }]\" } }",
+};
+
+/* Check that writing the schedules in binary_schedule_tests
+ * in binary format and reading them back results in the same schedules.
+ * isl_schedule_plain_is_equal ignores the names of the dimensions, so
+ * the textual representations are also compared to check
+ * that these names are preserved.
+ */
+static isl_stat test_binary_schedule(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(binary_schedule_tests); ++i) {
+		void *buf;
+		size_t size;
+		isl_schedule *schedule, *schedule2;
+		char *str, *str2;
+		isl_bool equal;
+
+		schedule = isl_schedule_read_from_str(ctx,
+						binary_schedule_tests[i]);
+		buf = isl_schedule_to_binary(schedule, &size);
+		schedule2 = isl_schedule_read_from_binary(ctx, buf, size);
+		free(buf);
+		equal = isl_schedule_plain_is_equal(schedule, schedule2);
+		str = isl_schedule_to_str(schedule);
+		str2 = isl_schedule_to_str(schedule2);
+		isl_schedule_free(schedule);
+		isl_schedule_free(schedule2);
+		if (equal >= 0 && (!str || !str2))
+			equal = isl_bool_error;
+		if (equal > 0)
+			equal = isl_bool_ok(!strcmp(str, str2));
+		free(str);
+		free(str2);
+		if (equal < 0)
+			return isl_stat_error;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"binary round trip changed schedule",
+				return isl_stat_error);
+	}
+
+	return isl_stat_ok;
+}
+
+/* Construct the binary representation of a schedule tree
+ * consisting of "depth" nested sequence nodes, each with a single child,
+ * ending in a leaf, storing its size in "size".
+ * The identifier and space tables are empty.
+ * Each sequence node is encoded as its type and a one byte
+ * indicating that it has a single child, while the leaf
+ * is encoded as its type and a zero byte.
+ */
+static unsigned char *binary_deep_schedule(int depth, size_t *size)
+{
+	int i;
+	size_t pos, len;
+	unsigned char *buf;
+
+	len = 2 + 2 * depth + 2;
+	buf = malloc(6 + 2 * sizeof(size_t) + len);
+	if (!buf)
+		return NULL;
+	memcpy(buf, "ISLB", 4);
+	buf[4] = 2;
+	buf[5] = 5;
+	pos = binary_put_uint(buf, 6, len);
+	buf[pos++] = 0;
+	buf[pos++] = 0;
+	for (i = 0; i < depth; ++i) {
+		buf[pos++] = isl_schedule_node_sequence;
+		buf[pos++] = 1;
+	}
+	buf[pos++] = isl_schedule_node_leaf;
+	buf[pos++] = 0;
+	*size = pos;
+	return buf;
+}
+
+/* Check that binary input describing a very deep schedule tree
+ * is rejected before running out of stack space.
+ */
+static isl_stat test_binary_deep_schedule(isl_ctx *ctx)
+{
+	int on_error;
+	size_t size;
+	unsigned char *buf;
+	isl_schedule *schedule;
+	const char *msg;
+	int rejected;
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	buf = binary_deep_schedule(100000, &size);
+	schedule = isl_schedule_read_from_binary(ctx, buf, size);
+	free(buf);
+	isl_schedule_free(schedule);
+	msg = isl_ctx_last_error_msg(ctx);
+	rejected = !schedule && msg &&
+		    !strcmp(msg, "schedule tree too deep in binary input");
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (!rejected)
+		isl_die(ctx, isl_error_unknown,
+			"deep schedule tree not detected",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Check that writing "info" in binary format and reading it back
+ * results in the same isl_union_access_info object.
+ * Since there is no function for comparing such objects,
+ * their textual representations are compared instead.
+ */
+static isl_stat check_binary_union_access_info(isl_ctx *ctx,
+	__isl_take isl_union_access_info *info)
+{
+	void *buf;
+	size_t size;
+	char *str, *str2;
+	isl_union_access_info *info2;
+	int equal;
+
+	buf = isl_union_access_info_to_binary(info, &size);
+	info2 = isl_union_access_info_read_from_binary(ctx, buf, size);
+	free(buf);
+	str = isl_union_access_info_to_str(info);
+	str2 = isl_union_access_info_to_str(info2);
+	isl_union_access_info_free(info);
+	isl_union_access_info_free(info2);
+	equal = str && str2 && !strcmp(str, str2);
+	free(str);
+	free(str2);
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"binary round trip changed access info",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Check that isl_union_access_info objects, with the execution order
+ * represented by a schedule map or by a schedule,
+ * survive a round trip through the binary format.
+ */
+static isl_stat test_binary_union_access_info(isl_ctx *ctx)
+{
+	isl_union_map *umap;
+	isl_schedule *schedule;
+	isl_union_access_info *info;
+
+	umap = isl_union_map_read_from_str(ctx, "{ S[i] -> A[i] }");
+	info = isl_union_access_info_from_sink(umap);
+	umap = isl_union_map_read_from_str(ctx, "{ T[i] -> A[i] }");
+	info = isl_union_access_info_set_must_source(info, umap);
+	umap = isl_union_map_read_from_str(ctx, "{ K[] -> A[i] }");
+	info = isl_union_access_info_set_kill(info, umap);
+	umap = isl_union_map_read_from_str(ctx,
+			"{ S[i] -> [1, i]; T[i] -> [0, i]; K[] -> [2, 0] }");
+	info = isl_union_access_info_set_schedule_map(info, umap);
+	if (check_binary_union_access_info(ctx, info) < 0)
+		return isl_stat_error;
+
+	umap = isl_union_map_read_from_str(ctx, "{ S[i] -> A[i] }");
+	info = isl_union_access_info_from_sink(umap);
+	umap = isl_union_map_read_from_str(ctx, "{ T[i] -> A[i] }");
+	info = isl_union_access_info_set_may_source(info, umap);
+	schedule = isl_schedule_read_from_str(ctx,
+		"{ domain: \"{ S[i] : 0 <= i < 10; T[i] : 0 <= i < 10 }\", "
+		"child: { sequence: [ { filter: \"{ T[i] }\" }, "
+		"{ filter: \"{ S[i] }\" } ] } }");
+	info = isl_union_access_info_set_schedule(info, schedule);
+	if (check_binary_union_access_info(ctx, info) < 0)
+		return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
+/* Check that binary input describing a piecewise multi-affine expression
+ * with overlapping cells is rejected.
+ * The input is obtained by writing out such an expression,
+ * constructed using isl_pw_multi_aff_add_disjoint,
+ * which does not check that the cells are disjoint.
+ */
+static isl_stat test_binary_overlapping_cells(isl_ctx *ctx)
+{
+	int on_error;
+	void *buf;
+	size_t size;
+	isl_pw_multi_aff *pma, *pma2;
+
+	pma = isl_pw_multi_aff_read_from_str(ctx, "{ [i] -> [0] : i >= 0 }");
+	pma2 = isl_pw_multi_aff_read_from_str(ctx, "{ [i] -> [1] : i <= 0 }");
+	pma = isl_pw_multi_aff_add_disjoint(pma, pma2);
+	buf = isl_pw_multi_aff_to_binary(pma, &size);
+	isl_pw_multi_aff_free(pma);
+	if (!buf)
+		return isl_stat_error;
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	pma = isl_pw_multi_aff_read_from_binary(ctx, buf, size);
+	free(buf);
+	isl_pw_multi_aff_free(pma);
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (pma)
+		isl_die(ctx, isl_error_unknown,
+			"overlapping cells accepted", return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Check that writing objects in binary format and reading them back
+ * results in the same objects.
+ */
+static int test_binary(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(binary_map_tests); ++i) {
+		isl_union_map *umap;
+		isl_stat r;
+
+		umap = isl_union_map_read_from_str(ctx, binary_map_tests[i]);
+		r = check_binary_union_map(ctx, umap);
+		if (r >= 0)
+			r = isl_union_map_foreach_map(umap,
+						&check_binary_map_cb, NULL);
+		isl_union_map_free(umap);
+		if (r < 0)
+			return -1;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(binary_set_tests); ++i) {
+		isl_union_set *uset;
+		isl_stat r;
+
+		uset = isl_union_set_read_from_str(ctx, binary_set_tests[i]);
+		r = check_binary_union_set(ctx, uset);
+		if (r >= 0)
+			r = isl_union_set_foreach_set(uset,
+						&check_binary_set_cb, NULL);
+		isl_union_set_free(uset);
+		if (r < 0)
+			return -1;
+	}
+
+	if (test_binary_file(ctx) < 0)
+		return -1;
+	if (test_binary_invalid_div(ctx) < 0)
+		return -1;
+	if (test_binary_pw_multi_aff(ctx) < 0)
+		return -1;
+	if (test_binary_nesting(ctx) < 0)
+		return -1;
+	if (test_binary_many_rows(ctx) < 0)
+		return -1;
+	if (test_binary_overlapping_cells(ctx) < 0)
+		return -1;
+	if (test_binary_schedule(ctx) < 0)
+		return -1;
+	if (test_binary_deep_schedule(ctx) < 0)
+		return -1;
+	if (test_binary_union_access_info(ctx) < 0)
+		return -1;
+
+	return 0;
+}
+
+/* Check that the calls of traced functions are recorded,
+ * except for the calls performed from within other traced calls, and
+ * that the recorded result can be read back.
+ * isl_union_map_intersect calls isl_map_intersect internally,
+ * but only the outer call should appear in the trace.
+ */
+static int test_trace(isl_ctx *ctx)
+{
+	const char *expected[] = {
+		"call isl_union_map_intersect\n",
+		"call isl_union_set_coalesce\n",
+	};
+	FILE *file;
+	char line[1024];
+	int n_call = 0;
+	isl_bool equal = isl_bool_false;
+	isl_union_map *umap1, *umap2;
+	isl_union_set *uset, *uset2;
 
-	filename = get_filename(ctx, "set", "omega");
-	assert(filename);
-	input = fopen(filename, "r");
-	assert(input);
+	file = tmpfile();
+	if (!file)
+		isl_die(ctx, isl_error_unknown, "unable to create file",
+			return -1);
+	if (isl_ctx_trace_start_file(ctx, file) < 0) {
+		fclose(file);
+		return -1;
+	}
+	umap1 = isl_union_map_read_from_str(ctx,
+		"{ A[i] -> B[i] : 0 <= i < 10; A[i] -> C[] : i > 0 }");
+	umap2 = isl_union_map_read_from_str(ctx, "{ A[i] -> B[j] : i >= 5 }");
+	umap1 = isl_union_map_intersect(umap1, umap2);
+	uset = isl_union_map_domain(umap1);
+	uset = isl_union_set_coalesce(uset);
+	if (isl_ctx_trace_stop(ctx) < 0 || !uset)
+		goto error;
+
+	rewind(file);
+	while (fgets(line, sizeof(line), file)) {
+		if (strncmp(line, "call ", 5) == 0) {
+			if (n_call >= ARRAY_SIZE(expected) ||
+			    strcmp(line, expected[n_call]) != 0)
+				isl_die(ctx, isl_error_unknown,
+					"unexpected call in trace",
+					goto error);
+			n_call++;
+		}
+		if (n_call == ARRAY_SIZE(expected) &&
+		    strncmp(line, "result ", 7) == 0) {
+			if (!fgets(line, sizeof(line), file))
+				break;
+			uset2 = isl_union_set_read_from_str(ctx, line);
+			equal = isl_union_set_is_equal(uset, uset2);
+			isl_union_set_free(uset2);
+			if (equal < 0)
+				goto error;
+		}
+	}
+	if (n_call != ARRAY_SIZE(expected) || !equal)
+		isl_die(ctx, isl_error_unknown, "unexpected trace",
+			goto error);
 
-	bset1 = isl_basic_set_read_from_file(ctx, input);
-	bset2 = isl_basic_set_read_from_str(ctx, str);
+	fclose(file);
+	isl_union_set_free(uset);
+	return 0;
+error:
+	fclose(file);
+	isl_union_set_free(uset);
+	return -1;
+}
 
-	equal = isl_basic_set_is_equal(bset1, bset2);
+/* Number of profile entries encountered by collect_profile_entry and
+ * the number of calls of the "coalesce" entry.
+ */
+struct isl_test_profile_data {
+	int n;
+	long coalesce;
+};
 
-	isl_basic_set_free(bset1);
-	isl_basic_set_free(bset2);
-	free(filename);
+/* Update the isl_test_profile_data "user" with the profile entry "name".
+ */
+static isl_stat collect_profile_entry(const char *name, long calls,
+	double time, unsigned long bytes, void *user)
+{
+	struct isl_test_profile_data *data = user;
 
-	fclose(input);
+	data->n++;
+	if (!strcmp(name, "coalesce"))
+		data->coalesce = calls;
+	return time < 0 ? isl_stat_error : isl_stat_ok;
+}
 
-	if (equal < 0)
+/* Check that a call to isl_set_coalesce is recorded in the profile
+ * and that resetting the profile removes all entries.
+ * If isl was configured without profiling support, then check
+ * that this is reported as such.
+ */
+static int test_profile(isl_ctx *ctx)
+{
+	struct isl_test_profile_data data = { 0, 0 };
+	int on_error;
+	isl_stat r;
+	isl_set *set;
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	r = isl_ctx_reset_profile(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (r < 0) {
+		if (isl_ctx_last_error(ctx) != isl_error_unsupported)
+			return -1;
+		isl_ctx_reset_error(ctx);
+		return 0;
+	}
+
+	set = isl_set_read_from_str(ctx,
+		"{ [i] : 0 <= i < 10 or 10 <= i < 20 }");
+	set = isl_set_coalesce(set);
+	isl_set_free(set);
+	if (!set)
 		return -1;
-	if (!equal)
+	if (isl_ctx_foreach_profile_entry(ctx, &collect_profile_entry,
+					&data) < 0)
+		return -1;
+	if (data.coalesce != 1)
 		isl_die(ctx, isl_error_unknown,
-			"read sets not equal", return -1);
+			"unexpected number of coalesce calls", return -1);
+
+	data.n = 0;
+	if (isl_ctx_reset_profile(ctx) < 0 ||
+	    isl_ctx_foreach_profile_entry(ctx, &collect_profile_entry,
+					&data) < 0)
+		return -1;
+	if (data.n != 0)
+		isl_die(ctx, isl_error_unknown,
+			"profile not reset", return -1);
+
+	return 0;
+}
+
+/* Perform a computation that allocates some memory and
+ * free the result.
+ */
+static isl_stat compute_and_free(isl_ctx *ctx)
+{
+	isl_set *set;
+
+	set = isl_set_read_from_str(ctx, "{ [i, j] : 0 <= i, j < 10 or "
+		"10 <= i < 20 and 0 <= j < 10 or i = j = 30 }");
+	set = isl_set_coalesce(set);
+	set = isl_set_subtract(set,
+		isl_set_read_from_str(ctx, "{ [i, j] : i = j }"));
+	isl_set_free(set);
+
+	return set ? isl_stat_ok : isl_stat_error;
+}
+
+/* Check that memory is accounted to the isl_ctx, that all of it
+ * is released again when the objects are freed and that
+ * a memory quota is enforced.
+ * Since freed blocks of integers may be kept in a cache,
+ * this cache is cleared before comparing the memory in use.
+ */
+static int test_memory(isl_ctx *ctx)
+{
+	int on_error;
+	unsigned long memory;
+	enum isl_error error;
+	isl_mat *mat;
+
+	isl_blk_clear_cache(ctx);
+	memory = isl_ctx_get_memory(ctx);
+	isl_ctx_reset_peak_memory(ctx);
+	if (compute_and_free(ctx) < 0)
+		return -1;
+	if (isl_ctx_get_peak_memory(ctx) <= memory)
+		isl_die(ctx, isl_error_unknown,
+			"peak memory not larger than memory in use", return -1);
+	isl_blk_clear_cache(ctx);
+	if (isl_ctx_get_memory(ctx) != memory)
+		isl_die(ctx, isl_error_unknown,
+			"memory not released", return -1);
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	isl_ctx_set_max_memory(ctx, memory + 1000);
+	mat = isl_mat_alloc(ctx, 100, 100);
+	error = isl_ctx_last_error(ctx);
+	isl_mat_free(mat);
+	isl_ctx_set_max_memory(ctx, 0);
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (mat || error != isl_error_quota)
+		isl_die(ctx, isl_error_unknown,
+			"memory quota not enforced", return -1);
+	isl_blk_clear_cache(ctx);
+	if (isl_ctx_get_memory(ctx) != memory)
+		isl_die(ctx, isl_error_unknown,
+			"memory not released after quota failure", return -1);
 
 	return 0;
 }
@@ -1531,6 +2624,56 @@ static int test_various_simple_hull(isl_ctx *ctx)
 	return 0;
 }
 
+/* Inputs for isl_set_budget_hull tests, consisting of
+ * the input set, the LP budget and the expected result.
+ */
+struct {
+	const char *set;
+	int max_lp;
+	const char *hull;
+} budget_hull_tests[] = {
+	{ "{ [0, 0]; [1, 2]; [2, 1] }", 0,
+	  "{ [i, j] : 0 <= i <= 2 and 0 <= j <= 2 }" },
+	{ "{ [0, 0]; [1, 2]; [2, 1] }", -1,
+	  "{ [i, j] : 0 <= i <= 2 and 0 <= j <= 2 and i + j <= 3 and "
+		"-1 <= i - j <= 1 }" },
+	{ "{ [i, j] : 0 <= i <= 10 and j = 0; [i, j] : 0 <= i <= 10 and j = i }",
+	  -1, "{ [i, j] : 0 <= j <= i <= 10 }" },
+	{ "{ [i, j] : 0 <= i <= 10 and j = 0; [i, j] : 0 <= i <= 10 and j = i }",
+	  2, "{ [i, j] : 0 <= i <= 10 and 0 <= j <= 10 }" },
+	{ "{ [i, j] : 0 <= i <= 10 and j = 0; [i, j] : 0 <= i <= 10 and j = i }",
+	  0, "{ [i, j] : 0 <= i <= 10 }" },
+};
+
+/* Check that isl_set_budget_hull produces the expected results.
+ */
+static int test_budget_hull(isl_ctx *ctx)
+{
+	int i;
+	isl_set *set;
+	isl_basic_set *hull, *expected;
+	isl_bool equal;
+
+	for (i = 0; i < ARRAY_SIZE(budget_hull_tests); ++i) {
+		const char *str;
+		str = budget_hull_tests[i].set;
+		set = isl_set_read_from_str(ctx, str);
+		str = budget_hull_tests[i].hull;
+		expected = isl_basic_set_read_from_str(ctx, str);
+		hull = isl_set_budget_hull(set, budget_hull_tests[i].max_lp);
+		equal = isl_basic_set_is_equal(hull, expected);
+		isl_basic_set_free(hull);
+		isl_basic_set_free(expected);
+		if (equal < 0)
+			return -1;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown, "unexpected hull",
+				return -1);
+	}
+
+	return 0;
+}
+
 static int test_simple_hull(struct isl_ctx *ctx)
 {
 	const char *str;
@@ -1556,6 +2699,8 @@ static int test_simple_hull(struct isl_ctx *ctx)
 		return -1;
 	if (test_various_simple_hull(ctx) < 0)
 		return -1;
+	if (test_budget_hull(ctx) < 0)
+		return -1;
 
 	return 0;
 }
@@ -2652,6 +3797,88 @@ static isl_stat test_coalesce_special8(isl_ctx *ctx)
 	return test_coalesce_union(ctx, str1, str2);
 }
 
+/* Construct the set described by "str" by adding its basic sets
+ * one at a time using isl_set_coalesce_add_basic_set and
+ * check that the result is equal to the input.
+ */
+static isl_stat test_coalesce_add_set(isl_ctx *ctx, const char *str)
+{
+	int i;
+	isl_set *set, *set2;
+	isl_bool equal;
+
+	set = isl_set_read_from_str(ctx, str);
+	set2 = isl_set_empty(isl_set_get_space(set));
+	for (i = 0; set && i < set->n; ++i)
+		set2 = isl_set_coalesce_add_basic_set(set2,
+					isl_basic_set_copy(set->p[i]));
+	equal = isl_set_is_equal(set, set2);
+	isl_set_free(set);
+	isl_set_free(set2);
+
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"incrementally coalesced set not equal to input",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Check that adding a basic set that bridges the gap between
+ * two previously separated basic sets results in a single basic set.
+ */
+static isl_stat test_coalesce_add_bridge(isl_ctx *ctx)
+{
+	isl_set *set;
+	isl_bool one;
+
+	set = isl_set_read_from_str(ctx, "{ [i, j] : 0 <= i, j <= 9 }");
+	set = isl_set_coalesce_add_basic_set(set, isl_basic_set_read_from_str(
+			ctx, "{ [i, j] : 20 <= i <= 29 and 0 <= j <= 9 }"));
+	set = isl_set_coalesce_add_basic_set(set, isl_basic_set_read_from_str(
+			ctx, "{ [i, j] : 40 <= i <= 49 and 0 <= j <= 9 }"));
+	set = isl_set_coalesce_add_basic_set(set, isl_basic_set_read_from_str(
+			ctx, "{ [i, j] : 10 <= i <= 19 and 0 <= j <= 9 }"));
+	set = isl_set_coalesce_add_basic_set(set, isl_basic_set_read_from_str(
+			ctx, "{ [i, j] : 30 <= i <= 39 and 0 <= j <= 9 }"));
+	one = isl_bool_ok(set && set->n == 1);
+	if (one) {
+		isl_set *set2;
+
+		set2 = isl_set_read_from_str(ctx,
+					"{ [i, j] : 0 <= i <= 49 and 0 <= j <= 9 }");
+		one = isl_set_is_equal(set, set2);
+		isl_set_free(set2);
+	}
+	isl_set_free(set);
+
+	if (one < 0)
+		return isl_stat_error;
+	if (!one)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected result of incremental coalescing",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Test the functionality of isl_set_coalesce_add_basic_set
+ * on the inputs of the coalescing tests as well as
+ * on a set where a later basic set bridges earlier ones.
+ */
+static isl_stat test_coalesce_add(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(coalesce_tests); ++i)
+		if (test_coalesce_add_set(ctx, coalesce_tests[i].str) < 0)
+			return isl_stat_error;
+
+	return test_coalesce_add_bridge(ctx);
+}
+
 /* Test the functionality of isl_set_coalesce.
  * That is, check that the output is always equal to the input
  * and in some cases that the result consists of a single disjunct.
@@ -2685,6 +3912,8 @@ static int test_coalesce(struct isl_ctx *ctx)
 		return -1;
 	if (test_coalesce_special8(ctx) < 0)
 		return -1;
+	if (test_coalesce_add(ctx) < 0)
+		return -1;
 
 	return 0;
 }
@@ -2733,6 +3962,173 @@ static __isl_give isl_map *cocoa_fig_1_right_tc(isl_ctx *ctx)
 	return isl_set_unwrap(isl_map_range(cocoa_fig_1_right_power(ctx)));
 }
 
+/* Check that isl_map_transitive_closure_bounded falls back
+ * to the product of domain and range when it runs out of budget,
+ * that it computes the same result as isl_map_transitive_closure
+ * otherwise, and that the closure cache is used for repeated inputs.
+ */
+static int test_closure_bounded(isl_ctx *ctx)
+{
+	const char *str;
+	int size;
+	long hits, exceeded;
+	isl_map *map, *tc, *expected;
+	isl_bool exact, equal;
+
+	str = "[n] -> { [i,j] -> [i2,j2] : i2 = i + 1 and j2 = j + 1 and "
+		"1 <= i and i < n and 1 <= j and j < n or "
+		"i2 = i + 1 and j2 = j - 1 and "
+		"1 <= i and i < n and 2 <= j and j <= n }";
+
+	isl_ctx_reset_error(ctx);
+	exceeded = ctx->stats->closure_budget_exceeded;
+	map = isl_map_read_from_str(ctx, str);
+	expected = isl_map_from_domain_and_range(
+				isl_map_domain(isl_map_copy(map)),
+				isl_map_range(isl_map_copy(map)));
+	tc = isl_map_transitive_closure_bounded(map, 1, &exact);
+	equal = isl_map_is_equal(tc, expected);
+	isl_map_free(tc);
+	isl_map_free(expected);
+	if (equal < 0)
+		return -1;
+	if (!equal || exact ||
+	    ctx->stats->closure_budget_exceeded != exceeded + 1)
+		isl_die(ctx, isl_error_unknown,
+			"expecting overapproximation", return -1);
+	if (isl_ctx_last_error(ctx) != isl_error_none)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected error", return -1);
+
+	size = isl_options_get_closure_cache_size(ctx);
+	if (isl_options_set_closure_cache_size(ctx, 2) < 0)
+		return -1;
+	hits = ctx->stats->closure_cache_hits;
+	map = isl_map_read_from_str(ctx, str);
+	expected = isl_map_transitive_closure(map, NULL);
+	map = isl_map_read_from_str(ctx, str);
+	tc = isl_map_transitive_closure_bounded(map, 0, &exact);
+	equal = isl_map_is_equal(tc, expected);
+	isl_map_free(tc);
+	isl_map_free(expected);
+	if (equal < 0)
+		return -1;
+	if (!equal || !exact)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected transitive closure", return -1);
+	if (ctx->stats->closure_cache_hits != hits + 1)
+		isl_die(ctx, isl_error_unknown,
+			"expecting cache hit", return -1);
+	if (isl_options_set_closure_cache_size(ctx, size) < 0)
+		return -1;
+
+	return 0;
+}
+
+/* Check that isl_map_transitive_closure_bounded only treats
+ * running out of its own budget as a reason for falling back
+ * to an overapproximation.
+ * In particular, an isl_error_quota error that occurred before the call
+ * should not be mistaken for the budget running out and
+ * should still be available after the call, while
+ * a failure due to a memory quota should be reported as an error.
+ */
+static int test_closure_bounded_errors(isl_ctx *ctx)
+{
+	const char *str;
+	int on_error;
+	long exceeded;
+	unsigned long memory;
+	isl_set *set;
+	isl_map *map, *tc;
+	enum isl_error error;
+
+	str = "[n] -> { [i,j] -> [i2,j2] : i2 = i + 1 and j2 = j + 1 and "
+		"1 <= i and i < n and 1 <= j and j < n or "
+		"i2 = i + 1 and j2 = j - 1 and "
+		"1 <= i and i < n and 2 <= j and j <= n }";
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	exceeded = ctx->stats->closure_budget_exceeded;
+
+	map = isl_map_read_from_str(ctx, str);
+	isl_ctx_set_max_operations(ctx, 1);
+	set = isl_set_read_from_str(ctx, "{ [i] : i >= 0 }");
+	isl_set_free(set);
+	isl_ctx_set_max_operations(ctx, 0);
+	tc = isl_map_transitive_closure_bounded(map, 1000000, NULL);
+	isl_map_free(tc);
+	error = isl_ctx_last_error(ctx);
+	isl_ctx_reset_error(ctx);
+	if (!tc || error != isl_error_quota ||
+	    ctx->stats->closure_budget_exceeded != exceeded) {
+		isl_options_set_on_error(ctx, on_error);
+		isl_die(ctx, isl_error_unknown,
+			"earlier error mistaken for exceeded budget",
+			return -1);
+	}
+
+	map = isl_map_read_from_str(ctx, str);
+	isl_blk_clear_cache(ctx);
+	memory = isl_ctx_get_memory(ctx);
+	isl_ctx_set_max_memory(ctx, memory + 2000);
+	tc = isl_map_transitive_closure_bounded(map, 1000000, NULL);
+	isl_map_free(tc);
+	isl_ctx_set_max_memory(ctx, 0);
+	error = isl_ctx_last_error(ctx);
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (tc || error != isl_error_quota ||
+	    ctx->stats->closure_budget_exceeded != exceeded)
+		isl_die(ctx, isl_error_unknown,
+			"memory quota failure not reported", return -1);
+
+	return 0;
+}
+
+/* Check that a transitive closure computed with one setting
+ * of the closure option is not returned from the closure cache
+ * after the option has been changed.
+ * The closure computed with ISL_CLOSURE_BOX is an overapproximation,
+ * while the one computed with ISL_CLOSURE_ISL is exact.
+ */
+static int test_closure_cache_option(isl_ctx *ctx)
+{
+	const char *str;
+	int size;
+	unsigned closure;
+	long hits;
+	isl_map *map;
+	isl_bool exact = isl_bool_error, exact_box = isl_bool_error;
+
+	str = "{ [x, y] -> [x + 1, y + 1] : x < y; [x, y] -> [x, y + 2] }";
+	size = isl_options_get_closure_cache_size(ctx);
+	closure = ctx->opt->closure;
+	if (isl_options_set_closure_cache_size(ctx, 2) < 0)
+		return -1;
+	hits = ctx->stats->closure_cache_hits;
+	ctx->opt->closure = ISL_CLOSURE_ISL;
+	map = isl_map_read_from_str(ctx, str);
+	map = isl_map_transitive_closure(map, &exact);
+	isl_map_free(map);
+	ctx->opt->closure = ISL_CLOSURE_BOX;
+	map = isl_map_read_from_str(ctx, str);
+	map = isl_map_transitive_closure(map, &exact_box);
+	isl_map_free(map);
+	ctx->opt->closure = closure;
+	if (isl_options_set_closure_cache_size(ctx, size) < 0)
+		return -1;
+	if (exact < 0 || exact_box < 0)
+		return -1;
+	if (ctx->stats->closure_cache_hits != hits || !exact || exact_box)
+		isl_die(ctx, isl_error_unknown,
+			"closure cached across change of closure option",
+			return -1);
+
+	return 0;
+}
+
 static int test_closure(isl_ctx *ctx)
 {
 	const char *str;
@@ -3325,7 +4721,74 @@ struct {
 	  "{ [a, b] -> [floor((b - 2*floor((-a)/4))/5)] }",
 	  &isl_set_max_val, "30" },
 
-};
+};
+
+/* Inputs for rational optimization tests with and without
+ * the lp-float option.
+ * "set" is a basic set, "obj" the objective function and
+ * "res" the expected rational maximum.
+ */
+static struct {
+	const char *set;
+	const char *obj;
+	const char *res;
+} lp_float_tests[] = {
+	{ "{ [x, y] : 3x + 7y <= 100 and 7x + 3y <= 100 and x, y >= 0 }",
+	  "{ [x, y] -> [x + y] }", "20" },
+	{ "{ [x, y] : 3x + 7y <= 101 and 7x + 3y <= 100 and x, y >= 0 }",
+	  "{ [x, y] -> [x + 2y] }", "1211/40" },
+	{ "[n] -> { [x, y, z] : n = 10 and 0 <= x <= y <= z <= n and "
+		"x + y + z <= 3n/2 }", "{ [x, y, z] -> [x + 3y - z] }",
+	  "15" },
+	{ "{ [x, y] : x >= 0 and y >= 0 }", "{ [x, y] -> [x - y] }",
+	  "infty" },
+	{ "{ [x, y] : 1000000000000x + y <= 1 and x >= 0 and "
+		"y >= -1000000000000 }", "{ [x, y] -> [x] }",
+	  "1000000000001/1000000000000" },
+	{ "{ [x] : x >= 1 and x <= 0 }", "{ [x] -> [x] }", "NaN" },
+};
+
+/* Check that isl_basic_set_max_lp_val returns the expected results
+ * with the lp-float option set.
+ */
+static isl_stat test_lp_float(isl_ctx *ctx)
+{
+	int i;
+	int lp_float;
+
+	lp_float = isl_options_get_lp_float(ctx);
+	isl_options_set_lp_float(ctx, 1);
+	for (i = 0; i < ARRAY_SIZE(lp_float_tests); ++i) {
+		isl_basic_set *bset;
+		isl_aff *obj;
+		isl_val *val, *res;
+		isl_bool ok;
+
+		bset = isl_basic_set_read_from_str(ctx, lp_float_tests[i].set);
+		obj = isl_aff_read_from_str(ctx, lp_float_tests[i].obj);
+		res = isl_val_read_from_str(ctx, lp_float_tests[i].res);
+		val = isl_basic_set_max_lp_val(bset, obj);
+		if (isl_val_is_nan(res))
+			ok = isl_val_is_nan(val);
+		else
+			ok = isl_val_eq(res, val);
+		isl_val_free(res);
+		isl_val_free(val);
+		isl_aff_free(obj);
+		isl_basic_set_free(bset);
+
+		if (ok < 0 || !ok) {
+			isl_options_set_lp_float(ctx, lp_float);
+			if (ok < 0)
+				return isl_stat_error;
+			isl_die(ctx, isl_error_unknown,
+				"unexpected optimum", return isl_stat_error);
+		}
+	}
+	isl_options_set_lp_float(ctx, lp_float);
+
+	return isl_stat_ok;
+}
 
 /* Perform basic isl_set_min_val and isl_set_max_val tests.
  * In particular, check the results on non-convex inputs.
@@ -3362,6 +4825,8 @@ static int test_min(struct isl_ctx *ctx)
 		return -1;
 	if (test_min_special2(ctx) < 0)
 		return -1;
+	if (test_lp_float(ctx) < 0)
+		return -1;
 
 	return 0;
 }
@@ -3853,6 +5318,56 @@ static isl_stat test_pwqp_max(isl_ctx *ctx)
 	return isl_stat_ok;
 }
 
+/* Inputs for isl_pw_qpolynomial_mul tests.
+ * "arg1" and "arg2" are the two factors and
+ * "res" is the expected (expanded) product.
+ */
+static struct {
+	const char *arg1;
+	const char *arg2;
+	const char *res;
+} pwqp_mul_tests[] = {
+	{ "{ [x, y] -> (x + 1/2 * y + 1) }", "{ [x, y] -> (x - 1/3 * y) }",
+	  "{ [x, y] -> (x^2 + 1/6 * x * y - 1/6 * y^2 + x - 1/3 * y) }" },
+	{ "[n] -> { [x, y] -> (x * y + n) }", "[n] -> { [x, y] -> (x * y - n) }",
+	  "[n] -> { [x, y] -> (x^2 * y^2 - n^2) }" },
+	{ "{ [x, y, z] -> (x^2 + y * z) }", "{ [x, y, z] -> (z - y) }",
+	  "{ [x, y, z] -> (x^2 * z - x^2 * y + y * z^2 - y^2 * z) }" },
+	{ "{ [x, y] -> (x + y) }", "{ [x, y] -> (x - y) }",
+	  "{ [x, y] -> (x^2 - y^2) }" },
+};
+
+/* Check that multiplying the pairs of piecewise quasipolynomials
+ * in pwqp_mul_tests produces the expected results.
+ */
+static isl_stat test_pwqp_mul(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pwqp_mul_tests); ++i) {
+		isl_pw_qpolynomial *pwqp1, *pwqp2, *res;
+		isl_bool zero;
+
+		pwqp1 = isl_pw_qpolynomial_read_from_str(ctx,
+						pwqp_mul_tests[i].arg1);
+		pwqp2 = isl_pw_qpolynomial_read_from_str(ctx,
+						pwqp_mul_tests[i].arg2);
+		res = isl_pw_qpolynomial_read_from_str(ctx,
+						pwqp_mul_tests[i].res);
+		pwqp1 = isl_pw_qpolynomial_mul(pwqp1, pwqp2);
+		pwqp1 = isl_pw_qpolynomial_sub(pwqp1, res);
+		zero = isl_pw_qpolynomial_is_zero(pwqp1);
+		isl_pw_qpolynomial_free(pwqp1);
+		if (zero < 0)
+			return isl_stat_error;
+		if (!zero)
+			isl_die(ctx, isl_error_unknown, "unexpected product",
+				return isl_stat_error);
+	}
+
+	return isl_stat_ok;
+}
+
 static int test_pwqp(struct isl_ctx *ctx)
 {
 	const char *str;
@@ -3938,6 +5453,8 @@ static int test_pwqp(struct isl_ctx *ctx)
 
 	if (test_pwqp_max(ctx) < 0)
 		return -1;
+	if (test_pwqp_mul(ctx) < 0)
+		return -1;
 
 	return 0;
 }
@@ -4238,6 +5755,131 @@ struct {
 	{ "[a, b] -> { : a = 0 and b = -1 }", "[b, a] -> { : b >= -10 }", 1 },
 };
 
+/* Check that isl_set_is_subset produces the expected results
+ * when the subset cache is enabled and that
+ * the second round of subset checks is answered from the cache.
+ * Also check that a subset check that cannot be decided
+ * by plain checks is refuted using a sample point.
+ */
+static int test_subset_cache(isl_ctx *ctx)
+{
+	int i, j, n;
+	int size;
+	long hits, sample;
+	isl_set *set1, *set2;
+	isl_bool subset;
+
+	size = isl_options_get_subset_cache_size(ctx);
+	n = ARRAY_SIZE(subset_tests);
+	if (isl_options_set_subset_cache_size(ctx, n) < 0)
+		return -1;
+	hits = ctx->stats->subset_cache_hits;
+	for (j = 0; j < 2; ++j) {
+		for (i = 0; i < n; ++i) {
+			set1 = isl_set_read_from_str(ctx, subset_tests[i].set1);
+			set2 = isl_set_read_from_str(ctx, subset_tests[i].set2);
+			subset = isl_set_is_subset(set1, set2);
+			isl_set_free(set1);
+			isl_set_free(set2);
+			if (subset < 0)
+				return -1;
+			if (subset != subset_tests[i].subset)
+				isl_die(ctx, isl_error_unknown,
+					"incorrect subset result", return -1);
+		}
+	}
+	if (ctx->stats->subset_cache_hits - hits != n)
+		isl_die(ctx, isl_error_unknown, "unexpected number of hits",
+			return -1);
+	if (isl_options_set_subset_cache_size(ctx, size) < 0)
+		return -1;
+
+	sample = ctx->stats->subset_sample;
+	set1 = isl_set_read_from_str(ctx, "{ [i, j] : 7 <= i <= 8 and j = i }");
+	set2 = isl_set_read_from_str(ctx, "{ [i, j] : 0 <= i <= 5 }");
+	subset = isl_set_is_subset(set1, set2);
+	isl_set_free(set1);
+	isl_set_free(set2);
+	if (subset < 0)
+		return -1;
+	if (subset || ctx->stats->subset_sample != sample + 1)
+		isl_die(ctx, isl_error_unknown,
+			"expecting refutation by sample point", return -1);
+
+	return 0;
+}
+
+/* Check that identical finalized basic sets share their representation
+ * when the intern-basic-maps option is set and that modifying
+ * one of the sets does not affect the other.
+ */
+static int test_intern_basic_maps(isl_ctx *ctx)
+{
+	int intern;
+	const char *str;
+	isl_set *set1, *set2, *set3;
+	isl_bool shared, equal;
+
+	str = "{ [i, j] : 0 <= i <= 10 and 0 <= j <= i }";
+	intern = isl_options_get_intern_basic_maps(ctx);
+	if (isl_options_set_intern_basic_maps(ctx, 0) < 0)
+		return -1;
+	set3 = isl_set_read_from_str(ctx, str);
+	if (isl_options_set_intern_basic_maps(ctx, 1) < 0)
+		set3 = isl_set_free(set3);
+
+	set1 = isl_set_read_from_str(ctx, str);
+	set2 = isl_set_read_from_str(ctx, str);
+	shared = set1 && set2 && set1->n == 1 && set2->n == 1 &&
+		    set1->p[0] == set2->p[0];
+	set2 = isl_set_intersect(set2,
+			isl_set_read_from_str(ctx, "{ [i, j] : j <= 5 }"));
+	equal = isl_set_plain_is_equal(set1, set3);
+	isl_set_free(set1);
+	isl_set_free(set2);
+	isl_set_free(set3);
+
+	if (isl_options_set_intern_basic_maps(ctx, intern) < 0)
+		return -1;
+	if (equal < 0)
+		return -1;
+	if (!shared)
+		isl_die(ctx, isl_error_unknown,
+			"expecting shared basic set", return -1);
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"shared basic set was modified", return -1);
+
+	return 0;
+}
+
+/* Check that a basic map is not considered to be a strict subset
+ * of itself, both when it is compared to itself and
+ * when it is compared to an identical copy.
+ */
+static int test_strict_subset_self(isl_ctx *ctx)
+{
+	const char *str;
+	isl_basic_map *bmap1, *bmap2;
+	isl_bool strict, strict_copy;
+
+	str = "{ [i] -> [j] : 0 <= i <= 10 and 0 <= j <= i }";
+	bmap1 = isl_basic_map_read_from_str(ctx, str);
+	bmap2 = isl_basic_map_read_from_str(ctx, str);
+	strict = isl_basic_map_is_strict_subset(bmap1, bmap1);
+	strict_copy = isl_basic_map_is_strict_subset(bmap1, bmap2);
+	isl_basic_map_free(bmap1);
+	isl_basic_map_free(bmap2);
+
+	if (strict < 0 || strict_copy < 0)
+		return -1;
+	if (strict || strict_copy)
+		isl_die(ctx, isl_error_unknown,
+			"basic map is strict subset of itself", return -1);
+
+	return 0;
+}
+
 static int test_subset(isl_ctx *ctx)
 {
 	int i;
@@ -4283,6 +5925,67 @@ static isl_stat test_subtract_empty(isl_ctx *ctx)
 	return isl_stat_non_null(s1);
 }
 
+/* Inputs for isl_set_subtract tests.
+ * "difference" is the expected result of subtracting "subtrahend"
+ * from "minuend".
+ * Several of these involve disjuncts that are obviously disjoint
+ * from some of the disjuncts of the other set.
+ * The disjuncts of rational sets may only appear to be disjoint
+ * when considering only their integer points.
+ */
+struct {
+	const char *minuend;
+	const char *subtrahend;
+	const char *difference;
+} subtract_tests[] = {
+	{ "{ [i] : 0 <= i < 10; [i] : 20 <= i < 30 }",
+	  "{ [i] : 5 <= i < 25 }",
+	  "{ [i] : 0 <= i < 5; [i] : 25 <= i < 30 }" },
+	{ "[N] -> { [i, j] : 0 <= i < 10 and 0 <= j < N; "
+		"[i, j] : 10 <= i < 20 and 0 <= j < N }",
+	  "[N] -> { [i, j] : 3 <= i < 8 and 0 <= j < N and (i + j) mod 3 = 0; "
+		"[i, j] : i = 15 and j = 1 }",
+	  "[N] -> { [i, j] : 0 <= i < 20 and 0 <= j < N and "
+		"not (3 <= i < 8 and (i + j) mod 3 = 0) and "
+		"not (i = 15 and j = 1) }" },
+	{ "{ [i, j] : 0 <= i, j < 10; [i, j] : -10 <= i, j < 0 }",
+	  "{ [i, j] : 2 <= i and 2 <= j; [i, j] : i = -3 }",
+	  "{ [i, j] : 0 <= i, j < 10 and (i < 2 or j < 2); "
+		"[i, j] : -10 <= i, j < 0 and i != -3 }" },
+	{ "{ rat: [x] : 2x = 1 }",
+	  "{ rat: [x] : 0 <= 2x <= 1 }",
+	  "{ [x] : false }" },
+};
+
+/* Perform basic isl_set_subtract tests.
+ */
+static isl_stat test_subtract_sets(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(subtract_tests); ++i) {
+		isl_set *set1, *set2, *diff;
+		isl_bool equal;
+
+		set1 = isl_set_read_from_str(ctx, subtract_tests[i].minuend);
+		set2 = isl_set_read_from_str(ctx, subtract_tests[i].subtrahend);
+		diff = isl_set_read_from_str(ctx,
+					subtract_tests[i].difference);
+		set1 = isl_set_subtract(set1, set2);
+		equal = isl_set_is_equal(set1, diff);
+		isl_set_free(set1);
+		isl_set_free(diff);
+		if (equal < 0)
+			return isl_stat_error;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"incorrect subtract result",
+				return isl_stat_error);
+	}
+
+	return isl_stat_ok;
+}
+
 struct {
 	const char *minuend;
 	const char *subtrahend;
@@ -4303,6 +6006,8 @@ static int test_subtract(isl_ctx *ctx)
 
 	if (test_subtract_empty(ctx) < 0)
 		return -1;
+	if (test_subtract_sets(ctx) < 0)
+		return -1;
 
 	for (i = 0; i < ARRAY_SIZE(subtract_domain_tests); ++i) {
 		umap1 = isl_union_map_read_from_str(ctx,
@@ -8059,6 +9764,53 @@ int test_vertices(isl_ctx *ctx)
 	return 0;
 }
 
+/* Check that repeated vertex computations on the same basic set
+ * are answered from the vertices cache when it is enabled and
+ * that the cached result is the same as the original result.
+ * Note that vertices_tests has more entries than the size of the cache,
+ * so that the replacement of cache entries is also exercised.
+ */
+static int test_vertices_cache(isl_ctx *ctx)
+{
+	int i, j;
+	int size;
+	long hits;
+
+	size = isl_options_get_vertices_cache_size(ctx);
+	if (isl_options_set_vertices_cache_size(ctx, 2) < 0)
+		return -1;
+	hits = ctx->stats->vertices_cache_hits;
+	for (i = 0; i < ARRAY_SIZE(vertices_tests); ++i) {
+		isl_basic_set *bset;
+		isl_vertices *vertices[2];
+		isl_size n;
+
+		bset = isl_basic_set_read_from_str(ctx, vertices_tests[i].set);
+		for (j = 0; j < 2; ++j)
+			vertices[j] = isl_basic_set_compute_vertices(bset);
+		n = isl_vertices_get_n_vertices(vertices[1]);
+		if (n >= 0 && vertices[0] != vertices[1])
+			isl_die(ctx, isl_error_unknown,
+				"expecting cached vertices", n = isl_size_error);
+		if (n >= 0 && vertices_tests[i].n != n)
+			isl_die(ctx, isl_error_unknown, "unexpected vertices",
+				n = isl_size_error);
+		for (j = 0; j < 2; ++j)
+			isl_vertices_free(vertices[j]);
+		isl_basic_set_free(bset);
+		if (n < 0)
+			return -1;
+	}
+	if (ctx->stats->vertices_cache_hits - hits !=
+	    ARRAY_SIZE(vertices_tests))
+		isl_die(ctx, isl_error_unknown, "unexpected number of hits",
+			return -1);
+	if (isl_options_set_vertices_cache_size(ctx, size) < 0)
+		return -1;
+
+	return 0;
+}
+
 /* Inputs for basic tests of binary operations on isl_union_map.
  * "fn" is the function that is being tested.
  * "arg1" and "arg2" are string descriptions of the inputs.
@@ -8582,75 +10334,286 @@ static isl_stat test_eval_3(isl_ctx *ctx)
 	isl_val *v;
 	isl_stat r;
 
-	pwqp = isl_pw_qpolynomial_read_from_str(ctx, "{ [x] -> x^2 }");
-	pnt = isl_point_zero(isl_pw_qpolynomial_get_domain_space(pwqp));
-	v = isl_val_read_from_str(ctx, "1/2");
-	pnt = isl_point_set_coordinate_val(pnt, isl_dim_set, 0, v);
-	v = isl_pw_qpolynomial_eval(pwqp, pnt);
-	r = val_check_equal(v, "1/4");
-	isl_val_free(v);
+	pwqp = isl_pw_qpolynomial_read_from_str(ctx, "{ [x] -> x^2 }");
+	pnt = isl_point_zero(isl_pw_qpolynomial_get_domain_space(pwqp));
+	v = isl_val_read_from_str(ctx, "1/2");
+	pnt = isl_point_set_coordinate_val(pnt, isl_dim_set, 0, v);
+	v = isl_pw_qpolynomial_eval(pwqp, pnt);
+	r = val_check_equal(v, "1/4");
+	isl_val_free(v);
+
+	return r;
+}
+
+/* Inputs for isl_pw_aff_eval test.
+ * "f" is the affine function.
+ * "p" is the point where the function should be evaluated.
+ * "res" is the expected result.
+ */
+struct {
+	const char *f;
+	const char *p;
+	const char *res;
+} aff_eval_tests[] = {
+	{ "{ [i] -> [2 * i] }", "{ [4] }", "8" },
+	{ "{ [i] -> [2 * i] }", "{ [x] : false }", "NaN" },
+	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [0] }", "0" },
+	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [1] }", "1" },
+	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [2] }", "3" },
+	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [3] }", "5" },
+	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [4] }", "7" },
+	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [0] }", "0" },
+	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [1] }", "0" },
+	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [2] }", "0" },
+	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [3] }", "0" },
+	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [4] }", "1" },
+	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [6] }", "1" },
+	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [8] }", "2" },
+	{ "{ [i] -> [i] : i > 0; [i] -> [-i] : i < 0 }", "{ [4] }", "4" },
+	{ "{ [i] -> [i] : i > 0; [i] -> [-i] : i < 0 }", "{ [-2] }", "2" },
+	{ "{ [i] -> [i] : i > 0; [i] -> [-i] : i < 0 }", "{ [0] }", "NaN" },
+	{ "[N] -> { [2 * N] }", "[N] -> { : N = 4 }", "8" },
+	{ "{ [i, j] -> [(i + j)/2] }", "{ [1, 1] }", "1" },
+	{ "{ [i, j] -> [(i + j)/2] }", "{ [1, 2] }", "3/2" },
+	{ "{ [i] -> [i] : i mod 2 = 0 }", "{ [4] }", "4" },
+	{ "{ [i] -> [i] : i mod 2 = 0 }", "{ [3] }", "NaN" },
+	{ "{ [i] -> [i] : i mod 2 = 0 }", "{ [x] : false }", "NaN" },
+	{ "[m, n] -> { [2m + 3n] }", "[n=1, m=10] -> { : }", "23" },
+};
+
+/* Perform basic isl_pw_aff_eval tests.
+ */
+static int test_eval_aff(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(aff_eval_tests); ++i) {
+		isl_stat r;
+		isl_pw_aff *pa;
+		isl_set *set;
+		isl_point *pnt;
+		isl_val *v;
+
+		pa = isl_pw_aff_read_from_str(ctx, aff_eval_tests[i].f);
+		set = isl_set_read_from_str(ctx, aff_eval_tests[i].p);
+		pnt = isl_set_sample_point(set);
+		v = isl_pw_aff_eval(pa, pnt);
+		r = val_check_equal(v, aff_eval_tests[i].res);
+		isl_val_free(v);
+		if (r < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* Check that a multivariate polynomial with rational coefficients
+ * can be evaluated in a point with rational coordinates.
+ */
+static isl_stat test_eval_4(isl_ctx *ctx)
+{
+	const char *str;
+	isl_pw_qpolynomial *pwqp;
+	isl_point *pnt;
+	isl_val *v;
+	isl_stat r;
+
+	str = "[n] -> { [x, y] -> 1/2 * x^2 * y - n * y + 1/3 }";
+	pwqp = isl_pw_qpolynomial_read_from_str(ctx, str);
+	pnt = isl_point_zero(isl_pw_qpolynomial_get_domain_space(pwqp));
+	v = isl_val_read_from_str(ctx, "-1/2");
+	pnt = isl_point_set_coordinate_val(pnt, isl_dim_param, 0, v);
+	v = isl_val_read_from_str(ctx, "2/3");
+	pnt = isl_point_set_coordinate_val(pnt, isl_dim_set, 0, v);
+	v = isl_val_read_from_str(ctx, "3");
+	pnt = isl_point_set_coordinate_val(pnt, isl_dim_set, 1, v);
+	v = isl_pw_qpolynomial_eval(pwqp, pnt);
+	r = val_check_equal(v, "5/2");
+	isl_val_free(v);
+
+	return r;
+}
+
+/* Construct the integer point in "space" with coordinates "coords",
+ * consisting of the values of the parameters followed
+ * by those of the set variables.
+ */
+static __isl_give isl_point *point_from_si(__isl_take isl_space *space,
+	const long *coords)
+{
+	int i;
+	isl_size nparam, dim;
+	isl_point *pnt;
+
+	nparam = isl_space_dim(space, isl_dim_param);
+	dim = isl_space_dim(space, isl_dim_set);
+	pnt = isl_point_zero(space);
+	if (nparam < 0 || dim < 0)
+		return isl_point_free(pnt);
+	for (i = 0; i < nparam; ++i) {
+		isl_val *v = isl_val_int_from_si(isl_point_get_ctx(pnt),
+						coords[i]);
+		pnt = isl_point_set_coordinate_val(pnt, isl_dim_param, i, v);
+	}
+	for (i = 0; i < dim; ++i) {
+		isl_val *v = isl_val_int_from_si(isl_point_get_ctx(pnt),
+						coords[nparam + i]);
+		pnt = isl_point_set_coordinate_val(pnt, isl_dim_set, i, v);
+	}
+
+	return pnt;
+}
+
+/* Check that the elements of "list" are equal to the values
+ * of "pa" in the "n" points with "dim" coordinates each in "coords",
+ * as computed by isl_pw_aff_eval.
+ */
+static isl_stat check_eval_list_aff(__isl_keep isl_pw_aff *pa,
+	__isl_take isl_val_list *list, int n, int dim, const long *coords)
+{
+	int i;
+	isl_stat r = list ? isl_stat_ok : isl_stat_error;
+
+	for (i = 0; r >= 0 && i < n; ++i) {
+		isl_space *space;
+		isl_point *pnt;
+		isl_val *v, *res;
+		isl_bool equal;
+
+		space = isl_pw_aff_get_domain_space(pa);
+		pnt = point_from_si(space, coords + i * dim);
+		v = isl_pw_aff_eval(isl_pw_aff_copy(pa), pnt);
+		res = isl_val_list_get_at(list, i);
+		if (isl_val_is_nan(v) == isl_bool_true)
+			equal = isl_val_is_nan(res);
+		else
+			equal = isl_val_eq(v, res);
+		isl_val_free(v);
+		isl_val_free(res);
+		if (equal < 0)
+			r = isl_stat_error;
+		else if (!equal)
+			isl_die(isl_pw_aff_get_ctx(pa), isl_error_unknown,
+				"unexpected value", r = isl_stat_error);
+	}
+
+	isl_val_list_free(list);
+	return r;
+}
+
+/* Check that isl_pw_aff_eval_si_array produces the same results
+ * as isl_pw_aff_eval on a grid of points, including some points
+ * with coordinates that are too large for native integer arithmetic.
+ */
+static isl_stat test_eval_si_array_aff(isl_ctx *ctx, const char *str)
+{
+	int i, j, n;
+	isl_size dim;
+	isl_space *space;
+	isl_pw_aff *pa;
+	isl_val_list *list;
+	long *coords;
+	isl_stat r;
+
+	pa = isl_pw_aff_read_from_str(ctx, str);
+	space = isl_pw_aff_get_domain_space(pa);
+	dim = isl_space_dim(space, isl_dim_all);
+	isl_space_free(space);
+	if (dim < 0 || dim > 3) {
+		isl_pw_aff_free(pa);
+		return isl_stat_error;
+	}
+	n = 1;
+	for (i = 0; i < dim; ++i)
+		n *= 11;
+	n += 2;
+	coords = isl_alloc_array(ctx, long, n * dim);
+	if (dim > 0 && !coords) {
+		isl_pw_aff_free(pa);
+		return isl_stat_error;
+	}
+	for (i = 0; i < n - 2; ++i) {
+		int k = i;
+
+		for (j = 0; j < dim; ++j) {
+			coords[i * dim + j] = k % 11 - 5;
+			k /= 11;
+		}
+	}
+	for (j = 0; j < dim; ++j) {
+		coords[(n - 2) * dim + j] = -(LONG_MAX / 4);
+		coords[(n - 1) * dim + j] = LONG_MAX / 4 + j;
+	}
 
+	list = isl_pw_aff_eval_si_array(pa, n, coords);
+	r = check_eval_list_aff(pa, list, n, dim, coords);
+
+	free(coords);
+	isl_pw_aff_free(pa);
 	return r;
 }
 
-/* Inputs for isl_pw_aff_eval test.
- * "f" is the affine function.
- * "p" is the point where the function should be evaluated.
- * "res" is the expected result.
+/* Functions for testing isl_pw_aff_eval_si_array.
  */
-struct {
-	const char *f;
-	const char *p;
-	const char *res;
-} aff_eval_tests[] = {
-	{ "{ [i] -> [2 * i] }", "{ [4] }", "8" },
-	{ "{ [i] -> [2 * i] }", "{ [x] : false }", "NaN" },
-	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [0] }", "0" },
-	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [1] }", "1" },
-	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [2] }", "3" },
-	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [3] }", "5" },
-	{ "{ [i] -> [i + floor(i/2) + floor(i/3)] }", "{ [4] }", "7" },
-	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [0] }", "0" },
-	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [1] }", "0" },
-	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [2] }", "0" },
-	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [3] }", "0" },
-	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [4] }", "1" },
-	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [6] }", "1" },
-	{ "{ [i] -> [floor((3 * floor(i/2))/5)] }", "{ [8] }", "2" },
-	{ "{ [i] -> [i] : i > 0; [i] -> [-i] : i < 0 }", "{ [4] }", "4" },
-	{ "{ [i] -> [i] : i > 0; [i] -> [-i] : i < 0 }", "{ [-2] }", "2" },
-	{ "{ [i] -> [i] : i > 0; [i] -> [-i] : i < 0 }", "{ [0] }", "NaN" },
-	{ "[N] -> { [2 * N] }", "[N] -> { : N = 4 }", "8" },
-	{ "{ [i, j] -> [(i + j)/2] }", "{ [1, 1] }", "1" },
-	{ "{ [i, j] -> [(i + j)/2] }", "{ [1, 2] }", "3/2" },
-	{ "{ [i] -> [i] : i mod 2 = 0 }", "{ [4] }", "4" },
-	{ "{ [i] -> [i] : i mod 2 = 0 }", "{ [3] }", "NaN" },
-	{ "{ [i] -> [i] : i mod 2 = 0 }", "{ [x] : false }", "NaN" },
-	{ "[m, n] -> { [2m + 3n] }", "[n=1, m=10] -> { : }", "23" },
+static const char *eval_si_array_tests[] = {
+	"{ [i] -> [i + floor(i/2) + floor(i/3)] }",
+	"{ [i] -> [floor((3 * floor(i/2))/5)] }",
+	"{ [i] -> [i] : i > 0; [i] -> [-i] : i < 0 }",
+	"{ [i, j] -> [(i + j)/2] : i >= j }",
+	"[N] -> { [i] -> [N + i] : i mod 3 = 1 and i <= N }",
+	"[N] -> { [i, j] -> [floor((N + i)/4)] : exists (e : j = 2e) }",
 };
 
-/* Perform basic isl_pw_aff_eval tests.
+/* Perform isl_pw_aff_eval_si_array tests and check that
+ * isl_pw_qpolynomial_eval_si_array returns zero outside the domain.
+ * Also check that a number of points for which the total number
+ * of coordinates does not fit in an int is rejected.
  */
-static int test_eval_aff(isl_ctx *ctx)
+static int test_eval_si_array(isl_ctx *ctx)
 {
 	int i;
+	const char *str;
+	isl_pw_qpolynomial *pwqp;
+	isl_val_list *list;
+	isl_val *v;
+	long coords[] = { 3, 2, 1, 2 };
+	int on_error;
+	enum isl_error error;
+	isl_stat r;
 
-	for (i = 0; i < ARRAY_SIZE(aff_eval_tests); ++i) {
-		isl_stat r;
-		isl_pw_aff *pa;
-		isl_set *set;
-		isl_point *pnt;
-		isl_val *v;
-
-		pa = isl_pw_aff_read_from_str(ctx, aff_eval_tests[i].f);
-		set = isl_set_read_from_str(ctx, aff_eval_tests[i].p);
-		pnt = isl_set_sample_point(set);
-		v = isl_pw_aff_eval(pa, pnt);
-		r = val_check_equal(v, aff_eval_tests[i].res);
-		isl_val_free(v);
-		if (r < 0)
+	for (i = 0; i < ARRAY_SIZE(eval_si_array_tests); ++i)
+		if (test_eval_si_array_aff(ctx, eval_si_array_tests[i]) < 0)
 			return -1;
+
+	str = "[n] -> { [x] -> x^2 * n + floor(x/2) : 0 <= x <= n }";
+	pwqp = isl_pw_qpolynomial_read_from_str(ctx, str);
+	list = isl_pw_qpolynomial_eval_si_array(pwqp, 2, coords);
+	isl_pw_qpolynomial_free(pwqp);
+	v = isl_val_list_get_at(list, 0);
+	r = val_check_equal(v, "13");
+	isl_val_free(v);
+	v = isl_val_list_get_at(list, 1);
+	if (r >= 0)
+		r = val_check_equal(v, "0");
+	isl_val_free(v);
+	isl_val_list_free(list);
+	if (r < 0)
+		return -1;
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	pwqp = isl_pw_qpolynomial_read_from_str(ctx, str);
+	isl_ctx_reset_error(ctx);
+	list = isl_pw_qpolynomial_eval_si_array(pwqp, INT_MAX, coords);
+	isl_pw_qpolynomial_free(pwqp);
+	error = isl_ctx_last_error(ctx);
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (list || error != isl_error_invalid) {
+		isl_val_list_free(list);
+		isl_die(ctx, isl_error_unknown,
+			"expecting error for too many coordinates", return -1);
 	}
+
 	return 0;
 }
 
@@ -8664,8 +10627,12 @@ static int test_eval(isl_ctx *ctx)
 		return -1;
 	if (test_eval_3(ctx) < 0)
 		return -1;
+	if (test_eval_4(ctx) < 0)
+		return -1;
 	if (test_eval_aff(ctx) < 0)
 		return -1;
+	if (test_eval_si_array(ctx) < 0)
+		return -1;
 	return 0;
 }
 
@@ -8769,6 +10736,114 @@ static isl_stat test_output_mpa(isl_ctx *ctx)
 	return isl_stat_ok;
 }
 
+/* Data used by collect_output.
+ *
+ * "str" collects the output, with "len" the number of characters
+ * collected so far and "n_call" the number of calls.
+ * If "fail" is set, then collect_output fails.
+ */
+struct isl_test_output_data {
+	char *str;
+	size_t len;
+	int n_call;
+	int fail;
+};
+
+/* isl_printer_to_callback callback that appends "data" of length "len"
+ * to the output collected in "user".
+ */
+static isl_stat collect_output(const char *data, size_t len, void *user)
+{
+	struct isl_test_output_data *out = user;
+	char *str;
+
+	out->n_call++;
+	if (out->fail)
+		return isl_stat_error;
+	str = realloc(out->str, out->len + len + 1);
+	if (!str)
+		return isl_stat_error;
+	out->str = str;
+	memcpy(out->str + out->len, data, len);
+	out->len += len;
+	out->str[out->len] = '\0';
+	return isl_stat_ok;
+}
+
+/* Check that printing "set" many times to a callback printer
+ * with a failing callback results in an error.
+ */
+static isl_stat test_output_callback_fail(isl_ctx *ctx,
+	__isl_keep isl_set *set)
+{
+	int i;
+	int on_error;
+	isl_printer *p;
+	struct isl_test_output_data out = { NULL, 0, 0, 1 };
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	p = isl_printer_to_callback(ctx, &collect_output, &out);
+	for (i = 0; p && i < 10000; ++i)
+		p = isl_printer_print_set(p, set);
+	isl_printer_free(p);
+	free(out.str);
+	isl_options_set_on_error(ctx, on_error);
+
+	if (p)
+		isl_die(ctx, isl_error_unknown,
+			"failure of callback not reported",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Check that printing a large set to a string printer and
+ * to a callback printer produces the same result and
+ * that the callback printer passes its output in large blocks.
+ * Also check that a failure of the callback is reported.
+ */
+static isl_stat test_output_callback(isl_ctx *ctx)
+{
+	int i;
+	char *str;
+	isl_set *set;
+	isl_printer *p, *p2;
+	struct isl_test_output_data out = { NULL, 0, 0, 0 };
+	int equal;
+
+	set = isl_set_read_from_str(ctx,
+		"[n] -> { [i, j] : 0 <= i < n and 0 <= j < i + 10 }");
+	p = isl_printer_to_str(ctx);
+	p2 = isl_printer_to_callback(ctx, &collect_output, &out);
+	for (i = 0; i < 10000; ++i) {
+		p = isl_printer_print_set(p, set);
+		p = isl_printer_end_line(p);
+		p2 = isl_printer_print_set(p2, set);
+		p2 = isl_printer_end_line(p2);
+	}
+	p2 = isl_printer_flush(p2);
+	str = isl_printer_get_str(p);
+	equal = p2 && str && out.str && !strcmp(str, out.str) &&
+		out.n_call <= 1 + out.len / 4096;
+	isl_printer_free(p);
+	isl_printer_free(p2);
+	free(str);
+	free(out.str);
+
+	if (equal && test_output_callback_fail(ctx, set) < 0)
+		equal = -1;
+	isl_set_free(set);
+
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected callback printer output",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
 int test_output(isl_ctx *ctx)
 {
 	char *s;
@@ -8783,6 +10858,8 @@ int test_output(isl_ctx *ctx)
 		return -1;
 	if (test_output_mpa(ctx) < 0)
 		return -1;
+	if (test_output_callback(ctx) < 0)
+		return -1;
 
 	str = "[x] -> { [1] : x % 4 <= 2; [2] : x = 3 }";
 	pa = isl_pw_aff_read_from_str(ctx, str);
@@ -10001,6 +12078,164 @@ static int test_ast_expr(isl_ctx *ctx)
 	return 0;
 }
 
+/* Data used in test_ast_bytecode.
+ * "n" is the number of executed statement instances and
+ * "sum" is the sum of all arguments of the executed instances.
+ */
+struct isl_test_ast_bytecode_data {
+	int n;
+	long sum;
+};
+
+/* Update "user", of type struct isl_test_ast_bytecode_data,
+ * with the statement instance with arguments "arg".
+ */
+static isl_stat count_instance(int stmt, int n_arg, const long *arg,
+	void *user)
+{
+	struct isl_test_ast_bytecode_data *data = user;
+	int i;
+
+	data->n++;
+	for (i = 0; i < n_arg; ++i)
+		data->sum += arg[i];
+
+	return isl_stat_ok;
+}
+
+/* Inputs for isl_ast_bytecode tests.
+ * "schedule" is the schedule from which an AST is generated.
+ * "n" and "m" are the values of the parameters with these names.
+ * "count" is the expected number of executed statement instances and
+ * "sum" is the expected sum of all their arguments.
+ */
+struct {
+	const char *schedule;
+	long n;
+	long m;
+	int count;
+	long sum;
+} ast_bytecode_tests[] = {
+	{ "[n] -> { S[i, j] -> [i, j] : 0 <= i < n and 0 <= j <= i }",
+	  10, 0, 55, 495 },
+	{ "{ S[i] -> [i] : 0 <= i < 20 and i mod 3 = 1 }", 0, 0, 7, 70 },
+	{ "{ S[i] -> [i] : -10 <= i <= 10 and i mod 4 = 0 }", 0, 0, 5, 0 },
+	{ "[n] -> { S[i, j] -> [i, j] : 0 <= i < n and 0 <= 2j <= i }",
+	  7, 0, 16, 76 },
+	{ "{ S[i, j] -> [i, j] : 0 <= i < 5 and j = 2i }", 0, 0, 5, 30 },
+	{ "[n, m] -> { S[i] -> [i, 0] : 0 <= i < n and i < m; "
+		"T[i] -> [i, 1] : 0 <= i < m }", 5, 3, 6, 6 },
+	{ "[n, m] -> { S[i] -> [i, 0] : 0 <= i < n and i < m; "
+		"T[i] -> [i, 1] : 0 <= i < m }", 2, 4, 6, 7 },
+};
+
+/* Generate an AST from each of the schedules in ast_bytecode_tests,
+ * compile it into bytecode and check that executing the bytecode
+ * results in the expected statement instances.
+ */
+static int test_ast_bytecode(isl_ctx *ctx)
+{
+	int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(ast_bytecode_tests); ++i) {
+		struct isl_test_ast_bytecode_data data = { 0, 0 };
+		isl_union_map *schedule;
+		isl_ast_build *build;
+		isl_ast_node *tree;
+		isl_ast_bytecode *bc;
+		isl_size n_param;
+		long param[2];
+		isl_stat r;
+
+		schedule = isl_union_map_read_from_str(ctx,
+					ast_bytecode_tests[i].schedule);
+		build = isl_ast_build_alloc(ctx);
+		tree = isl_ast_build_node_from_schedule_map(build, schedule);
+		isl_ast_build_free(build);
+		bc = isl_ast_node_compile_bytecode(tree);
+		isl_ast_node_free(tree);
+		n_param = isl_ast_bytecode_n_param(bc);
+		if (n_param < 0 || n_param > 2) {
+			isl_ast_bytecode_free(bc);
+			return -1;
+		}
+		for (j = 0; j < n_param; ++j) {
+			isl_id *id;
+			const char *name;
+
+			id = isl_ast_bytecode_get_param_id(bc, j);
+			name = isl_id_get_name(id);
+			param[j] = name && !strcmp(name, "m") ?
+				ast_bytecode_tests[i].m : ast_bytecode_tests[i].n;
+			isl_id_free(id);
+		}
+		r = isl_ast_bytecode_run(bc, param, &count_instance, &data);
+		isl_ast_bytecode_free(bc);
+		if (r < 0)
+			return -1;
+		if (data.n != ast_bytecode_tests[i].count ||
+		    data.sum != ast_bytecode_tests[i].sum)
+			isl_die(ctx, isl_error_unknown,
+				"unexpected statement instances", return -1);
+	}
+
+	return 0;
+}
+
+/* Check that the AST generated for a schedule where some pairs of
+ * domains are obviously separated by constant bounds
+ * on an outer schedule dimension is the expected one,
+ * i.e., the one that was generated before the pairwise emptiness tests
+ * were skipped for such pairs, and that such a pair is actually detected.
+ */
+static int test_ast_gen_plain_separated(isl_ctx *ctx)
+{
+	const char *str;
+	char *s;
+	long separated;
+	isl_set *context;
+	isl_union_map *schedule;
+	isl_ast_build *build;
+	isl_ast_node *tree;
+	int equal;
+
+	str = "[Ncl] -> { S[j, 28] -> [j] : j <= -2 + Ncl and Ncl <= 256 and "
+		"Ncl >= 40 and j >= 1; S[0, 26] -> [0] : Ncl <= 256 and "
+		"Ncl >= 40; S[-1 + Ncl, 27] -> [-1 + Ncl] : Ncl <= 256 and "
+		"Ncl >= 40 }";
+	schedule = isl_union_map_read_from_str(ctx, str);
+	str = "[Ncl] -> { : Ncl >= 40 and Ncl <= 256 }";
+	context = isl_set_read_from_str(ctx, str);
+	separated = ctx->stats->ast_plain_separated;
+	build = isl_ast_build_from_context(context);
+	tree = isl_ast_build_node_from_schedule_map(build, schedule);
+	isl_ast_build_free(build);
+	s = isl_ast_node_to_C_str(tree);
+	isl_ast_node_free(tree);
+	if (!s)
+		return -1;
+
+	str = "for (int c0 = 0; c0 < Ncl; c0 += 1) {\n"
+		"  if (Ncl >= c0 + 2 && c0 >= 1) {\n"
+		"    S(c0, 28);\n"
+		"  } else if (c0 == 0) {\n"
+		"    S(0, 26);\n"
+		"  } else {\n"
+		"    S(Ncl - 1, 27);\n"
+		"  }\n"
+		"}\n";
+	equal = !strcmp(s, str);
+	free(s);
+	if (!equal)
+		isl_die(ctx, isl_error_unknown, "unexpected AST", return -1);
+	if (ctx->stats->ast_plain_separated == separated)
+		isl_die(ctx, isl_error_unknown,
+			"expecting domains separated by constant bounds",
+			return -1);
+
+	return 0;
+}
+
 static int test_ast_gen(isl_ctx *ctx)
 {
 	if (test_ast_gen1(ctx) < 0)
@@ -10013,8 +12248,12 @@ static int test_ast_gen(isl_ctx *ctx)
 		return -1;
 	if (test_ast_gen5(ctx) < 0)
 		return -1;
+	if (test_ast_gen_plain_separated(ctx) < 0)
+		return -1;
 	if (test_ast_expr(ctx) < 0)
 		return -1;
+	if (test_ast_bytecode(ctx) < 0)
+		return -1;
 	return 0;
 }
 
@@ -10310,6 +12549,115 @@ static int test_partial_lexmin(isl_ctx *ctx)
 	return 0;
 }
 
+/* Callback for isl_ctx_set_disjunct_callback that counts
+ * the number of times it is called in "user" and that
+ * aborts the computation if the count reaches zero
+ * from a negative value.
+ */
+static isl_stat count_disjunct(isl_ctx *ctx, const char *name, int pos,
+	int n, int n_result, unsigned long operations, void *user)
+{
+	int *count = user;
+
+	if (pos < 0 || pos >= n || n_result < 0)
+		return isl_stat_error;
+	++*count;
+	return *count == 0 ? isl_stat_error : isl_stat_ok;
+}
+
+/* Check that isl_set_compute_divs and isl_set_make_disjoint
+ * produce a result that is equal to the input and
+ * report on each disjunct they handle,
+ * and that they can be aborted from the callback.
+ * The input has some local variables without explicit representation
+ * such that isl_set_compute_divs handles each of the three disjuncts.
+ */
+static isl_stat test_disjunct_callback(isl_ctx *ctx)
+{
+	const char *str;
+	isl_set *set, *set2;
+	isl_bool equal;
+	int count = 0;
+	int expected = 3;
+	int on_error;
+
+	str = "{ [i] : exists (a : 3a <= i <= 3a + 1 and 0 <= i <= 20); "
+		"[i] : exists (a : 2i <= 5a <= 2i + 3 and 0 <= i <= 30); "
+		"[i] : exists (a, b : i = a + b and 0 <= a <= 10 and "
+			"7b >= a and 7b <= 2a + 1) }";
+	set = isl_set_read_from_str(ctx, str);
+	isl_ctx_set_disjunct_callback(ctx, &count_disjunct, &count);
+	set2 = isl_set_compute_divs(isl_set_copy(set));
+	if (set2)
+		expected += set2->n - 1;
+	set2 = isl_set_make_disjoint(set2);
+	isl_ctx_set_disjunct_callback(ctx, NULL, NULL);
+	equal = isl_set_is_equal(set, set2);
+	isl_set_free(set2);
+	if (equal >= 0 && equal && count != expected)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected number of callbacks", equal = isl_bool_error);
+
+	count = -1;
+	isl_ctx_set_disjunct_callback(ctx, &count_disjunct, &count);
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	set = isl_set_compute_divs(set);
+	isl_options_set_on_error(ctx, on_error);
+	isl_ctx_set_disjunct_callback(ctx, NULL, NULL);
+	if (set) {
+		isl_set_free(set);
+		isl_die(ctx, isl_error_unknown,
+			"computation should have been aborted",
+			return isl_stat_error);
+	}
+	isl_ctx_reset_error(ctx);
+
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown, "result not equal to input",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Check that isl_set_compute_divs does not keep duplicates
+ * when applied to a set that contains the same basic set twice,
+ * as it did when the results for the basic sets were combined
+ * using isl_set_union.
+ * The basic set has a local variable without explicit representation
+ * and isl_basic_set_compute_divs splits it into two basic sets.
+ */
+static isl_stat test_compute_divs_duplicate(isl_ctx *ctx)
+{
+	const char *str;
+	isl_basic_set *bset;
+	isl_set *set, *single;
+	isl_size n, n_single;
+
+	str = "{ [i] : exists (a, b : i = a + b and 0 <= a <= 10 and "
+		"7b >= a and 7b <= 2a + 1) }";
+	bset = isl_basic_set_read_from_str(ctx, str);
+	set = isl_set_alloc_space(isl_basic_set_get_space(bset), 2, 0);
+	set = isl_set_add_basic_set(set, isl_basic_set_copy(bset));
+	set = isl_set_add_basic_set(set, isl_basic_set_copy(bset));
+	set = isl_set_compute_divs(set);
+	single = isl_basic_set_compute_divs(bset);
+	n = isl_set_n_basic_set(set);
+	n_single = isl_set_n_basic_set(single);
+	isl_set_free(set);
+	isl_set_free(single);
+
+	if (n < 0 || n_single < 0)
+		return isl_stat_error;
+	if (n != n_single)
+		isl_die(ctx, isl_error_unknown, "duplicates not removed",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
 /* Check that the variable compression performed on the existentially
  * quantified variables inside isl_basic_set_compute_divs is not confused
  * by the implicit equalities among the parameters.
@@ -10330,6 +12678,11 @@ static int test_compute_divs(isl_ctx *ctx)
 	if (!set)
 		return -1;
 
+	if (test_disjunct_callback(ctx) < 0)
+		return -1;
+	if (test_compute_divs_duplicate(ctx) < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -10926,6 +13279,7 @@ struct {
 	{ "empty projection", &test_empty_projection },
 	{ "output", &test_output },
 	{ "vertices", &test_vertices },
+	{ "vertices cache", &test_vertices_cache },
 	{ "chambers", &test_chambers },
 	{ "fixed", &test_fixed },
 	{ "equal", &test_equal },
@@ -10945,6 +13299,10 @@ struct {
 	{ "locus", &test_locus },
 	{ "eval", &test_eval },
 	{ "parse", &test_parse },
+	{ "binary", &test_binary },
+	{ "trace", &test_trace },
+	{ "profile", &test_profile },
+	{ "memory", &test_memory },
 	{ "single-valued", &test_sv },
 	{ "recession cone", &test_recession_cone },
 	{ "affine hull", &test_affine_hull },
@@ -10953,6 +13311,9 @@ struct {
 	{ "coalesce", &test_coalesce },
 	{ "factorize", &test_factorize },
 	{ "subset", &test_subset },
+	{ "subset cache", &test_subset_cache },
+	{ "interned basic maps", &test_intern_basic_maps },
+	{ "strict subset of itself", &test_strict_subset_self },
 	{ "subtract", &test_subtract },
 	{ "intersect", &test_intersect },
 	{ "lexmin", &test_lexmin },
@@ -10977,6 +13338,9 @@ struct {
 	{ "map application", &test_application },
 	{ "convex hull", &test_convex_hull },
 	{ "transitive closure", &test_closure },
+	{ "bounded transitive closure", &test_closure_bounded },
+	{ "bounded transitive closure errors", &test_closure_bounded_errors },
+	{ "closure cache option", &test_closure_cache_option },
 	{ "isl_bool", &test_isl_bool},
 };
 
@@ -0,0 +1,332 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+/* Recording of calls of selected isl functions in a trace file.
+ *
+ * The trace consists of a header line, followed by a record
+ * for each traced call that is not performed from within
+ * another traced call.  Each record has the form
+ *
+ *	call <function>
+ *	arg <type> <length>
+ *	<text>
+ *	...
+ *	result <type> <length>
+ *	<text>
+ *	time <seconds>
+ *	end
+ *
+ * where each <text> is the textual representation of an argument
+ * or the result, of exactly <length> bytes, followed by a newline.
+ * If the call fails, then the result is replaced by an "error" line.
+ * The time is the wall clock time spent in the call itself,
+ * excluding the time needed to write the trace.
+ * The isl_replay tool reads such a trace and performs the calls again.
+ */
+
+#include <isl_config.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+
+#include <isl_ctx_private.h>
+#include <isl_options_private.h>
+#include <isl_trace_private.h>
+
+/* The state of the trace of an isl_ctx.
+ *
+ * "file" is the file to which the trace is written.
+ * "owned" is set if "file" was opened by isl_ctx_trace_start and
+ * should therefore be closed when tracing stops.
+ * "depth" is the number of traced calls currently in progress.
+ * Only calls that are performed while "depth" is zero are recorded.
+ * "start" is the time at which the current outermost traced call started and
+ * "time" is the time it took.
+ */
+struct isl_trace {
+	FILE	*file;
+	int	 owned;
+	int	 depth;
+	double	 start;
+	double	 time;
+};
+
+/* Return the current wall clock time in seconds.
+ */
+static double now(void)
+{
+#ifdef HAVE_SYS_TIME_H
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Start recording traced calls on "ctx" to "file".
+ * If "owned" is set, then "file" is closed when tracing stops.
+ */
+static isl_stat trace_start(isl_ctx *ctx, FILE *file, int owned)
+{
+	ctx->trace_option_handled = 1;
+	if (isl_ctx_trace_stop(ctx) < 0)
+		goto error;
+	ctx->trace = isl_calloc_type(ctx, struct isl_trace);
+	if (!ctx->trace)
+		goto error;
+	ctx->trace->file = file;
+	ctx->trace->owned = owned;
+	fprintf(file, "# isl trace\n");
+	return isl_stat_ok;
+error:
+	if (owned)
+		fclose(file);
+	return isl_stat_error;
+}
+
+/* Start recording the calls of the traced isl functions on "ctx"
+ * in a newly created file called "filename".
+ * Any trace that was being recorded before is stopped first.
+ */
+isl_stat isl_ctx_trace_start(isl_ctx *ctx, const char *filename)
+{
+	FILE *file;
+
+	if (!ctx || !filename)
+		return isl_stat_error;
+	ctx->trace_option_handled = 1;
+	file = fopen(filename, "w");
+	if (!file)
+		isl_die(ctx, isl_error_invalid, "unable to open trace file",
+			return isl_stat_error);
+	return trace_start(ctx, file, 1);
+}
+
+/* Start recording the calls of the traced isl functions on "ctx"
+ * to "file".  The caller remains responsible for closing "file",
+ * after tracing has been stopped.
+ */
+isl_stat isl_ctx_trace_start_file(isl_ctx *ctx, FILE *file)
+{
+	if (!ctx || !file)
+		return isl_stat_error;
+	return trace_start(ctx, file, 0);
+}
+
+/* Free the trace state of "ctx", if any, without any further checks.
+ */
+void isl_trace_free(isl_ctx *ctx)
+{
+	if (!ctx->trace)
+		return;
+	if (ctx->trace->owned)
+		fclose(ctx->trace->file);
+	else
+		fflush(ctx->trace->file);
+	free(ctx->trace);
+	ctx->trace = NULL;
+}
+
+/* Stop recording calls on "ctx".
+ * It is not an error if no trace was being recorded.
+ * Tracing cannot be stopped from within a traced call.
+ */
+isl_stat isl_ctx_trace_stop(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_stat_error;
+	if (!ctx->trace)
+		return isl_stat_ok;
+	if (ctx->trace->depth != 0)
+		isl_die(ctx, isl_error_invalid,
+			"cannot stop tracing inside traced call",
+			return isl_stat_error);
+	isl_trace_free(ctx);
+	return isl_stat_ok;
+}
+
+/* Start tracing on "ctx" if the trace-file option is set and
+ * if this has not been handled before.
+ *
+ * Tracing is started the first time it is needed rather than
+ * when "ctx" is allocated since the options may get parsed
+ * after the allocation.
+ * The option is ignored if tracing was started explicitly before.
+ * If the trace file cannot be opened, then an error is reported
+ * (once), but the computation proceeds without tracing.
+ */
+static void trace_check_option(isl_ctx *ctx)
+{
+	if (!ctx->trace_option_handled && ctx->opt->trace_file)
+		isl_ctx_trace_start(ctx, ctx->opt->trace_file);
+}
+
+/* Should a call of a traced function on "ctx" be recorded?
+ * That is, is a trace being recorded and is the call not
+ * being performed from within another traced call?
+ */
+isl_bool isl_ctx_is_tracing(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_bool_false;
+	trace_check_option(ctx);
+	if (!ctx->trace)
+		return isl_bool_false;
+	return isl_bool_ok(ctx->trace->depth == 0);
+}
+
+/* Do not record any calls on "ctx" until the matching call
+ * to isl_trace_resume.
+ * This is used to hide the calls that are performed internally
+ * by some untraced functions, e.g., while parsing input.
+ */
+void isl_trace_suppress(isl_ctx *ctx)
+{
+	if (!ctx)
+		return;
+	trace_check_option(ctx);
+	if (ctx->trace)
+		ctx->trace->depth++;
+}
+
+/* Undo the effect of the matching call to isl_trace_suppress.
+ */
+void isl_trace_resume(isl_ctx *ctx)
+{
+	if (ctx && ctx->trace && ctx->trace->depth > 0)
+		ctx->trace->depth--;
+}
+
+/* Start the record of a call of the function called "name" on "ctx".
+ */
+static void trace_call_start(isl_ctx *ctx, const char *name)
+{
+	ctx->trace->depth++;
+	fprintf(ctx->trace->file, "call %s\n", name);
+}
+
+/* Write the textual representation "str" of an object of type "type"
+ * in the trace of "ctx" as an element of the given kind,
+ * i.e., "arg" or "result".
+ * "str" is freed by this function.
+ * If "str" is NULL, i.e., if the object could not be printed,
+ * then an empty text is written.
+ */
+static void trace_obj(isl_ctx *ctx, const char *kind, const char *type,
+	char *str)
+{
+	size_t len;
+
+	len = str ? strlen(str) : 0;
+	fprintf(ctx->trace->file, "%s %s %lu\n%s\n", kind, type,
+		(unsigned long) len, str ? str : "");
+	free(str);
+}
+
+/* Write the result of type "type" of the current call with
+ * textual representation "str" in the trace of "ctx".
+ * "str" is NULL if the call failed.
+ */
+static void trace_result(isl_ctx *ctx, const char *type, char *str)
+{
+	if (!str) {
+		fprintf(ctx->trace->file, "error\n");
+		return;
+	}
+	trace_obj(ctx, "result", type, str);
+}
+
+/* Start timing the current call on "ctx".
+ */
+static void trace_time_start(isl_ctx *ctx)
+{
+	ctx->trace->start = now();
+}
+
+/* Stop timing the current call on "ctx".
+ */
+static void trace_time_stop(isl_ctx *ctx)
+{
+	ctx->trace->time = now() - ctx->trace->start;
+}
+
+/* Finish the record of the current call on "ctx".
+ * The output is flushed such that the trace is complete
+ * up to the last finished call, even if the program
+ * does not terminate normally.
+ */
+static void trace_call_end(isl_ctx *ctx)
+{
+	fprintf(ctx->trace->file, "time %.6f\nend\n", ctx->trace->time);
+	fflush(ctx->trace->file);
+	ctx->trace->depth--;
+}
+
+#undef TYPE
+#define TYPE	isl_set
+#include "isl_trace_templ.c"
+
+#undef TYPE
+#define TYPE	isl_map
+#include "isl_trace_templ.c"
+
+#undef TYPE
+#define TYPE	isl_union_set
+#include "isl_trace_templ.c"
+
+#undef TYPE
+#define TYPE	isl_union_map
+#include "isl_trace_templ.c"
+
+/* Record the call of isl_union_access_info_compute_flow on "access"
+ * and perform the call.
+ */
+__isl_give isl_union_flow *isl_union_access_info_trace_compute_flow(
+	__isl_take isl_union_access_info *access)
+{
+	isl_ctx *ctx;
+	isl_union_flow *flow;
+
+	ctx = isl_union_access_info_get_ctx(access);
+	trace_call_start(ctx, "isl_union_access_info_compute_flow");
+	trace_obj(ctx, "arg", "isl_union_access_info",
+		isl_union_access_info_to_str(access));
+	trace_time_start(ctx);
+	flow = isl_union_access_info_compute_flow(access);
+	trace_time_stop(ctx);
+	trace_result(ctx, "isl_union_flow",
+		flow ? isl_union_flow_to_str(flow) : NULL);
+	trace_call_end(ctx);
+
+	return flow;
+}
+
+/* Record the call of isl_schedule_constraints_compute_schedule on "sc"
+ * and perform the call.
+ */
+__isl_give isl_schedule *isl_schedule_constraints_trace_compute_schedule(
+	__isl_take isl_schedule_constraints *sc)
+{
+	isl_ctx *ctx;
+	isl_schedule *schedule;
+
+	ctx = isl_schedule_constraints_get_ctx(sc);
+	trace_call_start(ctx, "isl_schedule_constraints_compute_schedule");
+	trace_obj(ctx, "arg", "isl_schedule_constraints",
+		isl_schedule_constraints_to_str(sc));
+	trace_time_start(ctx);
+	schedule = isl_schedule_constraints_compute_schedule(sc);
+	trace_time_stop(ctx);
+	trace_result(ctx, "isl_schedule",
+		schedule ? isl_schedule_to_str(schedule) : NULL);
+	trace_call_end(ctx);
+
+	return schedule;
+}
@@ -0,0 +1,71 @@
+#ifndef ISL_TRACE_PRIVATE_H
+#define ISL_TRACE_PRIVATE_H
+
+#include <isl/ctx.h>
+#include <isl/set.h>
+#include <isl/map.h>
+#include <isl/union_set.h>
+#include <isl/union_map.h>
+#include <isl/flow.h>
+#include <isl/schedule.h>
+
+void isl_trace_free(isl_ctx *ctx);
+isl_bool isl_ctx_is_tracing(isl_ctx *ctx);
+void isl_trace_suppress(isl_ctx *ctx);
+void isl_trace_resume(isl_ctx *ctx);
+
+/* Record the call of the unary operation "fn" on "obj" of type TYPE
+ * in the trace of the isl_ctx of "obj", if any, and perform the call.
+ * The name of the operation is obtained from the name of "fn".
+ */
+#define ISL_TRACE_UN(TYPE,fn,obj)					\
+	do {								\
+		if (isl_ctx_is_tracing(TYPE ## _get_ctx(obj)))		\
+			return TYPE ## _trace_un(#fn, &fn, obj);	\
+	} while (0)
+
+/* Record the call of the binary operation "fn" on "obj1" and "obj2"
+ * of type TYPE in the trace of the isl_ctx of "obj1", if any,
+ * and perform the call.
+ */
+#define ISL_TRACE_BIN(TYPE,fn,obj1,obj2)				\
+	do {								\
+		if (obj2 && isl_ctx_is_tracing(TYPE ## _get_ctx(obj1)))	\
+			return TYPE ## _trace_bin(#fn, &fn, obj1, obj2);\
+	} while (0)
+
+__isl_give isl_set *isl_set_trace_un(const char *name,
+	__isl_give isl_set *(*fn)(__isl_take isl_set *set),
+	__isl_take isl_set *set);
+__isl_give isl_set *isl_set_trace_bin(const char *name,
+	__isl_give isl_set *(*fn)(__isl_take isl_set *set1,
+		__isl_take isl_set *set2),
+	__isl_take isl_set *set1, __isl_take isl_set *set2);
+__isl_give isl_map *isl_map_trace_un(const char *name,
+	__isl_give isl_map *(*fn)(__isl_take isl_map *map),
+	__isl_take isl_map *map);
+__isl_give isl_map *isl_map_trace_bin(const char *name,
+	__isl_give isl_map *(*fn)(__isl_take isl_map *map1,
+		__isl_take isl_map *map2),
+	__isl_take isl_map *map1, __isl_take isl_map *map2);
+__isl_give isl_union_set *isl_union_set_trace_un(const char *name,
+	__isl_give isl_union_set *(*fn)(__isl_take isl_union_set *uset),
+	__isl_take isl_union_set *uset);
+__isl_give isl_union_set *isl_union_set_trace_bin(const char *name,
+	__isl_give isl_union_set *(*fn)(__isl_take isl_union_set *uset1,
+		__isl_take isl_union_set *uset2),
+	__isl_take isl_union_set *uset1, __isl_take isl_union_set *uset2);
+__isl_give isl_union_map *isl_union_map_trace_un(const char *name,
+	__isl_give isl_union_map *(*fn)(__isl_take isl_union_map *umap),
+	__isl_take isl_union_map *umap);
+__isl_give isl_union_map *isl_union_map_trace_bin(const char *name,
+	__isl_give isl_union_map *(*fn)(__isl_take isl_union_map *umap1,
+		__isl_take isl_union_map *umap2),
+	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2);
+
+__isl_give isl_union_flow *isl_union_access_info_trace_compute_flow(
+	__isl_take isl_union_access_info *access);
+__isl_give isl_schedule *isl_schedule_constraints_trace_compute_schedule(
+	__isl_take isl_schedule_constraints *sc);
+
+#endif
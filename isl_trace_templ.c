@@ -0,0 +1,47 @@
+#define xFN(TYPE,NAME) TYPE ## _ ## NAME
+#define FN(TYPE,NAME) xFN(TYPE,NAME)
+#define xSTR(x) #x
+#define STR(x) xSTR(x)
+
+/* Record the call of the unary operation "fn" called "name" on "obj"
+ * in the trace of the isl_ctx of "obj" and perform the call.
+ */
+__isl_give TYPE *FN(TYPE,trace_un)(const char *name,
+	__isl_give TYPE *(*fn)(__isl_take TYPE *obj), __isl_take TYPE *obj)
+{
+	isl_ctx *ctx;
+
+	ctx = FN(TYPE,get_ctx)(obj);
+	trace_call_start(ctx, name);
+	trace_obj(ctx, "arg", STR(TYPE), FN(TYPE,to_str)(obj));
+	trace_time_start(ctx);
+	obj = fn(obj);
+	trace_time_stop(ctx);
+	trace_result(ctx, STR(TYPE), obj ? FN(TYPE,to_str)(obj) : NULL);
+	trace_call_end(ctx);
+
+	return obj;
+}
+
+/* Record the call of the binary operation "fn" called "name"
+ * on "obj1" and "obj2" in the trace of the isl_ctx of "obj1" and
+ * perform the call.
+ */
+__isl_give TYPE *FN(TYPE,trace_bin)(const char *name,
+	__isl_give TYPE *(*fn)(__isl_take TYPE *obj1, __isl_take TYPE *obj2),
+	__isl_take TYPE *obj1, __isl_take TYPE *obj2)
+{
+	isl_ctx *ctx;
+
+	ctx = FN(TYPE,get_ctx)(obj1);
+	trace_call_start(ctx, name);
+	trace_obj(ctx, "arg", STR(TYPE), FN(TYPE,to_str)(obj1));
+	trace_obj(ctx, "arg", STR(TYPE), FN(TYPE,to_str)(obj2));
+	trace_time_start(ctx);
+	obj1 = fn(obj1, obj2);
+	trace_time_stop(ctx);
+	trace_result(ctx, STR(TYPE), obj1 ? FN(TYPE,to_str)(obj1) : NULL);
+	trace_call_end(ctx);
+
+	return obj1;
+}
@@ -2554,7 +2554,7 @@ error:
  * it to project out the lengths of the paths instead of equating
  * the length to a parameter.
  */
-__isl_give isl_map *isl_map_transitive_closure(__isl_take isl_map *map,
+static __isl_give isl_map *map_transitive_closure(__isl_take isl_map *map,
 	isl_bool *exact)
 {
 	isl_space *target_dim;
@@ -2587,6 +2587,251 @@ error:
 	return NULL;
 }
 
+/* The data of an entry in the closure cache, recording that
+ * the transitive closure of "map" is "closure" and
+ * whether this result is exact.
+ */
+struct isl_closure_cache_data {
+	isl_map *map;
+	isl_map *closure;
+	isl_bool exact;
+};
+
+static void closure_cache_data_free(void *user)
+{
+	struct isl_closure_cache_data *data = user;
+
+	isl_map_free(data->map);
+	isl_map_free(data->closure);
+	free(data);
+}
+
+/* isl_ctx_cache_find callback that checks whether the cache entry
+ * with data "entry" holds the transitive closure of the map "val".
+ *
+ * The maps are compared using isl_map_plain_is_equal, which
+ * compares the normalized forms of the maps.
+ */
+static isl_bool has_map(const void *entry, const void *val)
+{
+	const struct isl_closure_cache_data *data = entry;
+	isl_map *map = (isl_map *) val;
+
+	return isl_map_plain_is_equal(data->map, map);
+}
+
+/* Record in "cache" that the transitive closure of "map" is "closure",
+ * with "exact" indicating whether it is exact.
+ */
+static void closure_cache_add(isl_ctx *ctx, struct isl_ctx_cache *cache,
+	uint32_t hash, __isl_keep isl_map *map, __isl_keep isl_map *closure,
+	isl_bool exact)
+{
+	struct isl_closure_cache_data *data;
+
+	data = isl_alloc_type(ctx, struct isl_closure_cache_data);
+	if (!data)
+		return;
+	data->map = isl_map_copy(map);
+	data->closure = isl_map_copy(closure);
+	data->exact = exact;
+	isl_ctx_cache_add(cache, hash, data);
+}
+
+/* Compute the transitive closure  of "map", or an overapproximation.
+ * If the result is exact, then *exact is set to 1.
+ *
+ * If the closure-cache-size option is set, then first check
+ * whether the closure of the same relation has already been computed
+ * in the same isl_ctx.
+ * Since the result depends on the closure option,
+ * the cache is flushed whenever this option changes.
+ * The statistics of the context keep track of how many of
+ * the computed closures are exact and of the number of operations
+ * spent on computing them.
+ */
+__isl_give isl_map *isl_map_transitive_closure(__isl_take isl_map *map,
+	isl_bool *exact)
+{
+	isl_ctx *ctx;
+	uint32_t hash = 0;
+	unsigned long start;
+	isl_bool exact_tc = isl_bool_false;
+	struct isl_ctx_cache *cache;
+	struct isl_closure_cache_data *data;
+	isl_map *input = NULL;
+	isl_map *tc;
+
+	if (!map)
+		return NULL;
+
+	ctx = isl_map_get_ctx(map);
+	cache = isl_ctx_cache_get(ctx, &ctx->closure_cache,
+				ctx->opt->closure_cache_size, ctx->opt->closure,
+				&closure_cache_data_free);
+	if (cache) {
+		hash = isl_map_get_hash(map);
+		data = isl_ctx_cache_find(cache, hash, &has_map, map);
+		if (data) {
+			ctx->stats->closure_cache_hits++;
+			if (exact)
+				*exact = data->exact;
+			isl_map_free(map);
+			return isl_map_copy(data->closure);
+		}
+		ctx->stats->closure_cache_misses++;
+		input = isl_map_copy(map);
+	}
+
+	start = ctx->operations;
+	tc = map_transitive_closure(map, &exact_tc);
+	ctx->stats->closure_operations += ctx->operations - start;
+	if (tc && exact_tc)
+		ctx->stats->closure_exact++;
+	else if (tc)
+		ctx->stats->closure_approx++;
+
+	if (cache && tc)
+		closure_cache_add(ctx, cache, hash, input, tc, exact_tc);
+	isl_map_free(input);
+
+	if (exact)
+		*exact = exact_tc;
+	return tc;
+}
+
+/* State of "ctx" that is modified by budget_start
+ * and restored by budget_end.
+ * "max_operations" is the original limit on the number of operations.
+ * "limit" is the limit imposed by budget_start, or zero if
+ * no limit was imposed because the original limit is at least as strict.
+ * "on_error" is the original value of the on-error option.
+ * "error", "msg", "file" and "line" describe the last error
+ * that occurred before budget_start was called.
+ */
+struct isl_closure_budget {
+	unsigned long max_operations;
+	unsigned long limit;
+	int on_error;
+
+	enum isl_error error;
+	const char *msg;
+	const char *file;
+	int line;
+};
+
+/* Limit the number of operations that can be performed in "ctx"
+ * to "max_operations" more than the number of operations that
+ * have already been performed, unless "max_operations" is zero.
+ * A stricter limit that is already in place is preserved.
+ * The original state is stored in "budget".
+ *
+ * The last error is reset such that budget_end can tell whether
+ * any error occurred in between.
+ * Since running out of budget is not considered to be an error
+ * by the caller, errors are not reported while the limit is in place.
+ * Any other error is reported by budget_end instead.
+ */
+static void budget_start(isl_ctx *ctx, unsigned long max_operations,
+	struct isl_closure_budget *budget)
+{
+	unsigned long limit;
+
+	budget->max_operations = ctx->max_operations;
+	budget->limit = 0;
+	budget->on_error = ctx->opt->on_error;
+	budget->error = ctx->error;
+	budget->msg = ctx->error_msg;
+	budget->file = ctx->error_file;
+	budget->line = ctx->error_line;
+	isl_ctx_reset_error(ctx);
+	if (max_operations == 0)
+		return;
+	limit = ctx->operations + max_operations;
+	if (limit < ctx->operations)
+		return;
+	if (ctx->max_operations && ctx->max_operations <= limit)
+		return;
+	budget->limit = limit;
+	ctx->max_operations = limit;
+	ctx->opt->on_error = ISL_ON_ERROR_CONTINUE;
+}
+
+/* Restore the state of "ctx" saved in "budget" by budget_start.
+ * Return isl_bool_true if the computation was aborted because
+ * it exceeded the budget set by budget_start, i.e., if
+ * an isl_error_quota error occurred after the number of operations
+ * reached the limit imposed by budget_start.
+ * In this case, the error is cleared.
+ * Any other error that occurred since budget_start,
+ * including one caused by exceeding a memory quota, is reported
+ * according to the original value of the on-error option.
+ * If no error occurred, then the last error before budget_start
+ * is restored.
+ */
+static isl_bool budget_end(isl_ctx *ctx, struct isl_closure_budget *budget)
+{
+	enum isl_error error;
+	int exceeded;
+
+	error = isl_ctx_last_error(ctx);
+	exceeded = budget->limit != 0 && error == isl_error_quota &&
+		    ctx->operations >= budget->limit;
+	ctx->max_operations = budget->max_operations;
+	ctx->opt->on_error = budget->on_error;
+	if (error != isl_error_none && !exceeded) {
+		if (budget->limit != 0)
+			isl_handle_error(ctx, error, ctx->error_msg,
+					ctx->error_file, ctx->error_line);
+		return isl_bool_false;
+	}
+	isl_ctx_set_full_error(ctx, budget->error, budget->msg,
+				budget->file, budget->line);
+	if (!exceeded)
+		return isl_bool_false;
+	ctx->stats->closure_budget_exceeded++;
+	return isl_bool_true;
+}
+
+/* Compute the transitive closure of "map", or an overapproximation,
+ * performing at most "max_operations" operations
+ * (as counted by isl_ctx_next_operation),
+ * or an unlimited number if "max_operations" is zero.
+ * If the result is exact, then *exact is set to 1.
+ *
+ * If the computation exceeds the budget, then the cheap
+ * overapproximation consisting of the pairs of elements in
+ * the domain and the range of "map" is returned instead.
+ * Since the transitive closure can only relate elements of
+ * the domain to elements of the range, this result is valid.
+ */
+__isl_give isl_map *isl_map_transitive_closure_bounded(
+	__isl_take isl_map *map, unsigned long max_operations, isl_bool *exact)
+{
+	isl_ctx *ctx;
+	isl_map *tc;
+	isl_bool exceeded;
+	struct isl_closure_budget budget;
+
+	if (!map)
+		return NULL;
+
+	ctx = isl_map_get_ctx(map);
+	budget_start(ctx, max_operations, &budget);
+	tc = isl_map_transitive_closure(isl_map_copy(map), exact);
+	exceeded = budget_end(ctx, &budget);
+	if (!tc && exceeded) {
+		if (exact)
+			*exact = isl_bool_false;
+		tc = isl_map_from_domain_and_range(
+					isl_map_domain(isl_map_copy(map)),
+					isl_map_range(isl_map_copy(map)));
+	}
+	isl_map_free(map);
+
+	return tc;
+}
+
 static isl_stat inc_count(__isl_take isl_map *map, void *user)
 {
 	int *n = user;
@@ -2877,6 +3122,44 @@ error:
 	return NULL;
 }
 
+/* Compute the transitive closure of "umap", or an overapproximation,
+ * performing at most "max_operations" operations
+ * (as counted by isl_ctx_next_operation),
+ * or an unlimited number if "max_operations" is zero.
+ * If the result is exact, then *exact is set to 1.
+ *
+ * If the computation exceeds the budget, then the pairs of elements in
+ * the domain and the range of "umap" are returned instead,
+ * as in isl_map_transitive_closure_bounded.
+ */
+__isl_give isl_union_map *isl_union_map_transitive_closure_bounded(
+	__isl_take isl_union_map *umap, unsigned long max_operations,
+	isl_bool *exact)
+{
+	isl_ctx *ctx;
+	isl_union_map *tc;
+	isl_bool exceeded;
+	struct isl_closure_budget budget;
+
+	if (!umap)
+		return NULL;
+
+	ctx = isl_union_map_get_ctx(umap);
+	budget_start(ctx, max_operations, &budget);
+	tc = isl_union_map_transitive_closure(isl_union_map_copy(umap), exact);
+	exceeded = budget_end(ctx, &budget);
+	if (!tc && exceeded) {
+		if (exact)
+			*exact = isl_bool_false;
+		tc = isl_union_map_from_domain_and_range(
+				isl_union_map_domain(isl_union_map_copy(umap)),
+				isl_union_map_range(isl_union_map_copy(umap)));
+	}
+	isl_union_map_free(umap);
+
+	return tc;
+}
+
 struct isl_union_power {
 	isl_union_map *pow;
 	isl_bool *exact;
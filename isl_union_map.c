@@ -26,6 +26,7 @@
 #include "isl/union_set.h"
 #include <isl_maybe_map.h>
 #include <isl_id_private.h>
+#include <isl_trace_private.h>
 
 #include <bset_from_bmap.c>
 #include <set_to_map.c>
@@ -373,6 +374,8 @@ __isl_give isl_union_set *isl_union_set_drop_unused_params(
 __isl_give isl_union_map *isl_union_map_union(__isl_take isl_union_map *umap1,
 	__isl_take isl_union_map *umap2)
 {
+	ISL_TRACE_BIN(isl_union_map, isl_union_map_union, umap1, umap2);
+
 	umap1 = isl_union_map_align_params(umap1, isl_union_map_get_space(umap2));
 	umap2 = isl_union_map_align_params(umap2, isl_union_map_get_space(umap1));
 
@@ -396,6 +399,8 @@ error:
 __isl_give isl_union_set *isl_union_set_union(__isl_take isl_union_set *uset1,
 	__isl_take isl_union_set *uset2)
 {
+	ISL_TRACE_BIN(isl_union_set, isl_union_set_union, uset1, uset2);
+
 	return isl_union_map_union(uset1, uset2);
 }
 
@@ -1102,12 +1107,16 @@ __isl_give isl_union_map *isl_union_map_subtract(
 		.fn_map = &isl_map_subtract,
 	};
 
+	ISL_TRACE_BIN(isl_union_map, isl_union_map_subtract, umap1, umap2);
+
 	return gen_bin_op(umap1, umap2, &control);
 }
 
 __isl_give isl_union_set *isl_union_set_subtract(
 	__isl_take isl_union_set *uset1, __isl_take isl_union_set *uset2)
 {
+	ISL_TRACE_BIN(isl_union_set, isl_union_set_subtract, uset1, uset2);
+
 	return isl_union_map_subtract(uset1, uset2);
 }
 
@@ -1278,6 +1287,8 @@ error:
 __isl_give isl_union_map *isl_union_map_intersect(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
+	ISL_TRACE_BIN(isl_union_map, isl_union_map_intersect, umap1, umap2);
+
 	return match_bin_op(umap1, umap2, &isl_map_intersect);
 }
 
@@ -1291,6 +1302,8 @@ __isl_give isl_union_set *isl_union_set_intersect(
 {
 	int p1, p2;
 
+	ISL_TRACE_BIN(isl_union_set, isl_union_set_intersect, uset1, uset2);
+
 	p1 = isl_union_set_is_params(uset1);
 	p2 = isl_union_set_is_params(uset2);
 	if (p1 < 0 || p2 < 0)
@@ -1341,12 +1354,16 @@ __isl_give isl_union_set *isl_union_set_gist_params(
 __isl_give isl_union_map *isl_union_map_gist(__isl_take isl_union_map *umap,
 	__isl_take isl_union_map *context)
 {
+	ISL_TRACE_BIN(isl_union_map, isl_union_map_gist, umap, context);
+
 	return match_bin_op(umap, context, &isl_map_gist);
 }
 
 __isl_give isl_union_set *isl_union_set_gist(__isl_take isl_union_set *uset,
 	__isl_take isl_union_set *context)
 {
+	ISL_TRACE_BIN(isl_union_set, isl_union_set_gist, uset, context);
+
 	if (isl_union_set_is_params(context))
 		return union_map_gist_params(uset, context);
 	return isl_union_map_gist(uset, context);
@@ -1722,12 +1739,16 @@ isl_union_map_intersect_range_wrapped_domain_union_set(
 __isl_give isl_union_map *isl_union_map_apply_range(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
+	ISL_TRACE_BIN(isl_union_map, isl_union_map_apply_range, umap1, umap2);
+
 	return bin_op(umap1, umap2, &apply_range_entry);
 }
 
 __isl_give isl_union_map *isl_union_map_apply_domain(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
+	ISL_TRACE_BIN(isl_union_map, isl_union_map_apply_domain, umap1, umap2);
+
 	umap1 = isl_union_map_reverse(umap1);
 	umap1 = isl_union_map_apply_range(umap1, umap2);
 	return isl_union_map_reverse(umap1);
@@ -2230,24 +2251,32 @@ __isl_give isl_union_set *isl_union_set_remove_redundancies(
 __isl_give isl_union_map *isl_union_map_coalesce(
 	__isl_take isl_union_map *umap)
 {
+	ISL_TRACE_UN(isl_union_map, isl_union_map_coalesce, umap);
+
 	return inplace(umap, &isl_map_coalesce);
 }
 
 __isl_give isl_union_set *isl_union_set_coalesce(
 	__isl_take isl_union_set *uset)
 {
+	ISL_TRACE_UN(isl_union_set, isl_union_set_coalesce, uset);
+
 	return isl_union_map_coalesce(uset);
 }
 
 __isl_give isl_union_map *isl_union_map_detect_equalities(
 	__isl_take isl_union_map *umap)
 {
+	ISL_TRACE_UN(isl_union_map, isl_union_map_detect_equalities, umap);
+
 	return inplace(umap, &isl_map_detect_equalities);
 }
 
 __isl_give isl_union_set *isl_union_set_detect_equalities(
 	__isl_take isl_union_set *uset)
 {
+	ISL_TRACE_UN(isl_union_set, isl_union_set_detect_equalities, uset);
+
 	return isl_union_map_detect_equalities(uset);
 }
 
@@ -2266,24 +2295,32 @@ __isl_give isl_union_set *isl_union_set_compute_divs(
 __isl_give isl_union_map *isl_union_map_lexmin(
 	__isl_take isl_union_map *umap)
 {
+	ISL_TRACE_UN(isl_union_map, isl_union_map_lexmin, umap);
+
 	return total(umap, &isl_map_lexmin);
 }
 
 __isl_give isl_union_set *isl_union_set_lexmin(
 	__isl_take isl_union_set *uset)
 {
+	ISL_TRACE_UN(isl_union_set, isl_union_set_lexmin, uset);
+
 	return isl_union_map_lexmin(uset);
 }
 
 __isl_give isl_union_map *isl_union_map_lexmax(
 	__isl_take isl_union_map *umap)
 {
+	ISL_TRACE_UN(isl_union_map, isl_union_map_lexmax, umap);
+
 	return total(umap, &isl_map_lexmax);
 }
 
 __isl_give isl_union_set *isl_union_set_lexmax(
 	__isl_take isl_union_set *uset)
 {
+	ISL_TRACE_UN(isl_union_set, isl_union_set_lexmax, uset);
+
 	return isl_union_map_lexmax(uset);
 }
 
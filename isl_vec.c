@@ -34,9 +34,11 @@ __isl_give isl_vec *isl_vec_alloc(struct isl_ctx *ctx, unsigned size)
 {
 	struct isl_vec *vec;
 
+	if (isl_ctx_memory_acquire(ctx, sizeof(struct isl_vec)) < 0)
+		return NULL;
 	vec = isl_alloc_type(ctx, struct isl_vec);
 	if (!vec)
-		return NULL;
+		goto error_memory;
 
 	vec->block = isl_blk_alloc(ctx, size);
 	if (isl_blk_is_error(vec->block))
@@ -52,6 +54,8 @@ __isl_give isl_vec *isl_vec_alloc(struct isl_ctx *ctx, unsigned size)
 error:
 	isl_blk_free(ctx, vec->block);
 	free(vec);
+error_memory:
+	isl_ctx_memory_release(ctx, sizeof(struct isl_vec));
 	return NULL;
 }
 
@@ -239,6 +243,7 @@ __isl_null isl_vec *isl_vec_free(__isl_take isl_vec *vec)
 	if (--vec->ref > 0)
 		return NULL;
 
+	isl_ctx_memory_release(vec->ctx, sizeof(struct isl_vec));
 	isl_ctx_deref(vec->ctx);
 	isl_blk_free(vec->ctx, vec->block);
 	free(vec);
@@ -8,6 +8,7 @@
  * 91893 Orsay, France 
  */
 
+#include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl_aff_private.h>
 #include "isl/set.h"
@@ -18,11 +19,14 @@
 #include <isl_vertices_private.h>
 #include <isl_mat_private.h>
 #include <isl_vec_private.h>
+#include <isl_options_private.h>
 
 #define SELECTED	1
 #define DESELECTED	-1
 #define UNSELECTED	0
 
+static __isl_give isl_vertices *compute_vertices(
+	__isl_keep isl_basic_set *bset);
 static __isl_give isl_vertices *compute_chambers(__isl_take isl_basic_set *bset,
 	__isl_take isl_vertices *vertices);
 
@@ -334,7 +338,7 @@ static __isl_give isl_vertices *lower_dim_vertices(
 	morph = isl_basic_set_full_compression(bset);
 	bset = isl_morph_basic_set(isl_morph_copy(morph), bset);
 
-	vertices = isl_basic_set_compute_vertices(bset);
+	vertices = compute_vertices(bset);
 	isl_basic_set_free(bset);
 
 	morph = isl_morph_inverse(morph);
@@ -417,7 +421,7 @@ static __isl_give isl_basic_set *detect_implicit_equality_constraints(
  * The set variable coefficients of the selected constraints are stored
  * in the facets matrix.
  */
-__isl_give isl_vertices *isl_basic_set_compute_vertices(
+static __isl_give isl_vertices *compute_vertices(
 	__isl_keep isl_basic_set *bset)
 {
 	struct isl_tab *tab;
@@ -549,6 +553,127 @@ error:
 	return NULL;
 }
 
+/* The data of an entry in the vertices cache, holding
+ * the parametric vertices and chamber decomposition "vertices"
+ * computed for "bset".
+ */
+struct isl_vertices_cache_data {
+	isl_basic_set *bset;
+	isl_vertices *vertices;
+};
+
+static void vertices_cache_data_free(void *user)
+{
+	struct isl_vertices_cache_data *data = user;
+
+	isl_basic_set_free(data->bset);
+	isl_vertices_free(data->vertices);
+	free(data);
+}
+
+/* Compute a hash value of "bset" based on its plain representation.
+ *
+ * The cache is keyed on the plain representation of the input
+ * (rather than on a normalized version) such that a result
+ * retrieved from the cache is identical to the one that would
+ * have been computed from scratch.
+ */
+static uint32_t plain_hash(__isl_keep isl_basic_set *bset)
+{
+	int i;
+	uint32_t hash = isl_hash_init();
+	isl_size total;
+
+	total = isl_basic_set_dim(bset, isl_dim_all);
+	if (total < 0)
+		return 0;
+	isl_hash_hash(hash, isl_space_get_full_hash(bset->dim));
+	isl_hash_byte(hash, bset->n_eq & 0xFF);
+	for (i = 0; i < bset->n_eq; ++i)
+		isl_hash_hash(hash, isl_seq_get_hash(bset->eq[i], 1 + total));
+	isl_hash_byte(hash, bset->n_ineq & 0xFF);
+	for (i = 0; i < bset->n_ineq; ++i)
+		isl_hash_hash(hash, isl_seq_get_hash(bset->ineq[i], 1 + total));
+
+	return hash;
+}
+
+/* isl_ctx_cache_find callback that checks whether the cache entry
+ * with data "entry" holds the result for the basic set "val".
+ */
+static isl_bool has_bset(const void *entry, const void *val)
+{
+	const struct isl_vertices_cache_data *data = entry;
+	isl_basic_set *bset = (isl_basic_set *) val;
+
+	return isl_basic_set_plain_is_equal(data->bset, bset);
+}
+
+/* Add "vertices", computed for "bset", to "cache".
+ */
+static void cache_add(isl_ctx *ctx, struct isl_ctx_cache *cache,
+	uint32_t hash, __isl_keep isl_basic_set *bset,
+	__isl_keep isl_vertices *vertices)
+{
+	struct isl_vertices_cache_data *data;
+
+	if (!vertices)
+		return;
+
+	data = isl_alloc_type(ctx, struct isl_vertices_cache_data);
+	if (!data)
+		return;
+	data->bset = isl_basic_set_copy(bset);
+	data->vertices = isl_vertices_copy(vertices);
+	isl_ctx_cache_add(cache, hash, data);
+}
+
+/* Compute the parametric vertices and the chamber decomposition
+ * of the parametric polytope "bset".
+ *
+ * If the vertices-cache-size option is set, then first check
+ * whether the same computation has already been performed
+ * on an identical basic set in the same isl_ctx and, if so,
+ * return (a copy of) the cached result.
+ * Otherwise, perform the computation and store the result in the cache.
+ * Note that the cached isl_vertices object is shared with the caller,
+ * which is fine since isl_vertices objects are not modified
+ * after they have been constructed, except internally,
+ * on objects that are not stored in the cache.
+ */
+__isl_give isl_vertices *isl_basic_set_compute_vertices(
+	__isl_keep isl_basic_set *bset)
+{
+	isl_ctx *ctx;
+	uint32_t hash;
+	isl_vertices *vertices;
+	struct isl_ctx_cache *cache;
+	struct isl_vertices_cache_data *data;
+
+	if (!bset)
+		return NULL;
+
+	ctx = isl_basic_set_get_ctx(bset);
+	cache = isl_ctx_cache_get(ctx, &ctx->vertices_cache,
+				ctx->opt->vertices_cache_size, 0,
+				&vertices_cache_data_free);
+	if (!cache)
+		return compute_vertices(bset);
+
+	hash = plain_hash(bset);
+	data = isl_ctx_cache_find(cache, hash, &has_bset, bset);
+	if (data) {
+		ctx->stats->vertices_cache_hits++;
+		return isl_vertices_copy(data->vertices);
+	}
+	ctx->stats->vertices_cache_misses++;
+
+	vertices = compute_vertices(bset);
+	cache_add(ctx, cache, hash, bset, vertices);
+
+	return vertices;
+}
+
 struct isl_chamber_list {
 	struct isl_chamber c;
 	struct isl_chamber_list *next;
@@ -0,0 +1,697 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+/* This program measures the performance of some of the core kernels
+ * of isl in isolation.
+ *
+ * Each kernel is applied to families of generated basic maps
+ * of varying dimension and coefficient size.
+ *	polytope	random inequalities and equalities through the origin,
+ *			inside a box
+ *	stencil		a dependence relation of a stencil computation
+ *			with random distances
+ *	tiled		a tiled loop nest with random tile sizes
+ * The instances are generated from a fixed seed such that
+ * different runs and builds measure the same computations.
+ *
+ * The output has the same format as that of isl_bench, such that
+ * two runs, for example using builds with different integer backends,
+ * can be compared using "isl_bench --compare".
+ * The integer backend of the build is reported as the category.
+ */
+
+#include <isl_config.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+
+#include <isl_ctx_private.h>
+#include <isl_map_private.h>
+#include <isl_mat_private.h>
+#include <isl_vec_private.h>
+#include <isl_seq.h>
+#include "isl_tab.h"
+#include "isl/arg.h"
+#include "isl/options.h"
+
+#if defined(USE_GMP_FOR_MP)
+#define BACKEND	"gmp"
+#elif defined(USE_SMALL_INT_OPT)
+#define BACKEND	"sioimath"
+#else
+#define BACKEND	"imath"
+#endif
+
+struct options {
+	struct isl_options	*isl;
+	int			 repeat;
+	int			 size;
+	char			*dims;
+	char			*bits;
+};
+
+ISL_ARGS_START(struct options, options_args)
+ISL_ARG_CHILD(struct options, isl, "isl", &isl_options_args, "isl options")
+ISL_ARG_INT(struct options, repeat, 'r', "repeat", "n", 5,
+	"number of times each measurement is performed")
+ISL_ARG_INT(struct options, size, 0, "size", "n", 50,
+	"number of instances in each measurement")
+ISL_ARG_STR(struct options, dims, 0, "dims", "list", "2,4,8",
+	"comma separated list of dimensions")
+ISL_ARG_STR(struct options, bits, 0, "bits", "list", "8,32,128",
+	"comma separated list of coefficient sizes in bits")
+ISL_ARGS_END
+
+ISL_ARG_DEF(options, struct options, options_args)
+
+/* The state of the pseudo-random number generator.
+ * A simple linear congruential generator is used such that
+ * the generated instances do not depend on the platform.
+ */
+static unsigned long random_state;
+
+static void set_seed(unsigned long seed)
+{
+	random_state = seed;
+}
+
+/* Return 15 pseudo-random bits.
+ */
+static unsigned next_random(void)
+{
+	random_state = (random_state * 1103515245UL + 12345UL) & 0xffffffffUL;
+	return (random_state >> 16) & 0x7fff;
+}
+
+/* Set "v" to a pseudo-random value with absolute value
+ * smaller than 2^"bits".
+ */
+static void random_int(isl_int v, int bits)
+{
+	int b;
+
+	isl_int_set_si(v, 0);
+	for (b = 0; b < bits; b += 15) {
+		int chunk = bits - b < 15 ? bits - b : 15;
+		isl_int_mul_2exp(v, v, chunk);
+		isl_int_add_ui(v, v, next_random() & ((1u << chunk) - 1));
+	}
+	if (next_random() & 1)
+		isl_int_neg(v, v);
+}
+
+/* Set "v" to a pseudo-random positive value smaller than 2^"bits".
+ */
+static void random_pos(isl_int v, int bits)
+{
+	random_int(v, bits);
+	isl_int_abs(v, v);
+	isl_int_add_ui(v, v, 1);
+}
+
+/* Add the constraint "c_1 x_pos1 + c_2 x_pos2 + cst >= 0" to "bmap",
+ * where the positions are offsets in the constraint rows,
+ * "pos2" is ignored if it is zero and "cst" is stored in
+ * the constant term.
+ */
+static __isl_give isl_basic_map *add_ineq(__isl_take isl_basic_map *bmap,
+	unsigned pos1, int c1, unsigned pos2, int c2, isl_int cst)
+{
+	int k;
+	isl_size total;
+
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	k = isl_basic_map_alloc_inequality(bmap);
+	if (total < 0 || k < 0)
+		return isl_basic_map_free(bmap);
+	isl_seq_clr(bmap->ineq[k], 1 + total);
+	isl_int_set(bmap->ineq[k][0], cst);
+	isl_int_set_si(bmap->ineq[k][pos1], c1);
+	if (pos2)
+		isl_int_set_si(bmap->ineq[k][pos2], c2);
+	return bmap;
+}
+
+/* Generate a "dim"-dimensional polytope described by dim/2
+ * random equalities through the origin, 2 * "dim" random
+ * inequalities that are satisfied by the origin and
+ * a box of size 2^"bits" around the origin.
+ */
+static __isl_give isl_basic_map *generate_polytope(isl_ctx *ctx,
+	int dim, int bits)
+{
+	isl_space *space;
+	isl_basic_map *bmap;
+	isl_int bound;
+	int i, j, k;
+
+	space = isl_space_set_alloc(ctx, 0, dim);
+	bmap = isl_basic_map_alloc_space(space, 0, dim / 2, 4 * dim);
+	if (!bmap)
+		return NULL;
+
+	for (i = 0; i < dim / 2; ++i) {
+		k = isl_basic_map_alloc_equality(bmap);
+		if (k < 0)
+			return isl_basic_map_free(bmap);
+		isl_int_set_si(bmap->eq[k][0], 0);
+		for (j = 0; j < dim; ++j)
+			random_int(bmap->eq[k][1 + j], bits);
+	}
+	for (i = 0; i < 2 * dim; ++i) {
+		k = isl_basic_map_alloc_inequality(bmap);
+		if (k < 0)
+			return isl_basic_map_free(bmap);
+		random_pos(bmap->ineq[k][0], bits);
+		for (j = 0; j < dim; ++j)
+			random_int(bmap->ineq[k][1 + j], bits);
+	}
+	isl_int_init(bound);
+	isl_int_set_si(bound, 1);
+	isl_int_mul_2exp(bound, bound, bits);
+	for (j = 0; j < dim; ++j) {
+		bmap = add_ineq(bmap, 1 + j, 1, 0, 0, bound);
+		bmap = add_ineq(bmap, 1 + j, -1, 0, 0, bound);
+	}
+	isl_int_clear(bound);
+
+	return bmap;
+}
+
+/* Generate the dependence relation
+ *
+ *	[N] -> { S[t, i_1, ..., i_n] -> S[t + 1, i_1 + d_1, ..., i_n + d_n] :
+ *			0 <= t, i_j, t', i'_j <= N }
+ *
+ * with n = "dim" - 1 and random distances d_j of "bits" bits.
+ */
+static __isl_give isl_basic_map *generate_stencil(isl_ctx *ctx,
+	int dim, int bits)
+{
+	isl_space *space;
+	isl_basic_map *bmap;
+	isl_int zero;
+	unsigned in, out;
+	int j, k;
+
+	space = isl_space_alloc(ctx, 1, dim, dim);
+	bmap = isl_basic_map_alloc_space(space, 0, dim, 4 * dim);
+	if (!bmap)
+		return NULL;
+	in = isl_basic_map_offset(bmap, isl_dim_in);
+	out = isl_basic_map_offset(bmap, isl_dim_out);
+
+	for (j = 0; j < dim; ++j) {
+		k = isl_basic_map_alloc_equality(bmap);
+		if (k < 0)
+			return isl_basic_map_free(bmap);
+		isl_seq_clr(bmap->eq[k], 1 + 1 + 2 * dim);
+		if (j == 0)
+			isl_int_set_si(bmap->eq[k][0], 1);
+		else
+			random_int(bmap->eq[k][0], bits);
+		isl_int_set_si(bmap->eq[k][in + j], 1);
+		isl_int_set_si(bmap->eq[k][out + j], -1);
+	}
+	isl_int_init(zero);
+	isl_int_set_si(zero, 0);
+	for (j = 0; j < dim; ++j) {
+		bmap = add_ineq(bmap, in + j, 1, 0, 0, zero);
+		bmap = add_ineq(bmap, in + j, -1, 1, 1, zero);
+		bmap = add_ineq(bmap, out + j, 1, 0, 0, zero);
+		bmap = add_ineq(bmap, out + j, -1, 1, 1, zero);
+	}
+	isl_int_clear(zero);
+
+	return bmap;
+}
+
+/* Generate the tiled loop nest
+ *
+ *	[N] -> { [T_1, ..., T_n, i_1, ..., i_n] :
+ *			s_j T_j <= i_j < s_j T_j + s_j and 0 <= i_j <= N }
+ *
+ * with n = "dim" / 2 (at least 1) and random tile sizes s_j
+ * of "bits" bits.
+ */
+static __isl_give isl_basic_map *generate_tiled(isl_ctx *ctx,
+	int dim, int bits)
+{
+	isl_space *space;
+	isl_basic_map *bmap;
+	isl_int size;
+	int n = dim / 2 > 0 ? dim / 2 : 1;
+	int j, k;
+
+	space = isl_space_set_alloc(ctx, 1, 2 * n);
+	bmap = isl_basic_map_alloc_space(space, 0, 0, 4 * n);
+	if (!bmap)
+		return NULL;
+
+	isl_int_init(size);
+	for (j = 0; j < n; ++j) {
+		isl_int zero;
+
+		random_pos(size, bits);
+		k = isl_basic_map_alloc_inequality(bmap);
+		if (k < 0)
+			break;
+		isl_seq_clr(bmap->ineq[k], 1 + 1 + 2 * n);
+		isl_int_neg(bmap->ineq[k][2 + j], size);
+		isl_int_set_si(bmap->ineq[k][2 + n + j], 1);
+		k = isl_basic_map_alloc_inequality(bmap);
+		if (k < 0)
+			break;
+		isl_seq_clr(bmap->ineq[k], 1 + 1 + 2 * n);
+		isl_int_sub_ui(bmap->ineq[k][0], size, 1);
+		isl_int_set(bmap->ineq[k][2 + j], size);
+		isl_int_set_si(bmap->ineq[k][2 + n + j], -1);
+		isl_int_init(zero);
+		isl_int_set_si(zero, 0);
+		bmap = add_ineq(bmap, 2 + n + j, 1, 0, 0, zero);
+		bmap = add_ineq(bmap, 2 + n + j, -1, 1, 1, zero);
+		isl_int_clear(zero);
+	}
+	isl_int_clear(size);
+	if (j < n)
+		return isl_basic_map_free(bmap);
+
+	return bmap;
+}
+
+struct family {
+	const char *name;
+	__isl_give isl_basic_map *(*generate)(isl_ctx *ctx, int dim, int bits);
+};
+
+static struct family families[] = {
+	{ "polytope", &generate_polytope },
+	{ "stencil", &generate_stencil },
+	{ "tiled", &generate_tiled },
+};
+
+/* Return a copy of "bmap" that can be modified in place.
+ */
+static void *prepare_copy(__isl_keep isl_basic_map *bmap)
+{
+	return isl_basic_map_cow(isl_basic_map_copy(bmap));
+}
+
+static void release_bmap(void *data)
+{
+	isl_basic_map_free(data);
+}
+
+static isl_stat run_gauss(void **data, int n)
+{
+	int i;
+
+	for (i = 0; i < n; ++i)
+		if (!(data[i] = isl_basic_map_gauss(data[i], NULL)))
+			return isl_stat_error;
+	return isl_stat_ok;
+}
+
+static isl_stat run_simplify(void **data, int n)
+{
+	int i;
+
+	for (i = 0; i < n; ++i)
+		if (!(data[i] = isl_basic_map_simplify(data[i])))
+			return isl_stat_error;
+	return isl_stat_ok;
+}
+
+/* A tableau along with an objective function for isl_tab_min.
+ */
+struct tab_data {
+	struct isl_tab	*tab;
+	isl_vec		*obj;
+};
+
+/* Construct a tableau for "bmap" with the first inequality
+ * of "bmap" as objective function.
+ */
+static void *prepare_tab(__isl_keep isl_basic_map *bmap)
+{
+	isl_ctx *ctx = isl_basic_map_get_ctx(bmap);
+	struct tab_data *data;
+	isl_size total;
+
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	if (total < 0)
+		return NULL;
+	data = isl_alloc_type(ctx, struct tab_data);
+	if (!data)
+		return NULL;
+	data->tab = isl_tab_from_basic_map(bmap, 0);
+	data->obj = isl_vec_alloc(ctx, 1 + total);
+	if (!data->tab || !data->obj) {
+		isl_tab_free(data->tab);
+		isl_vec_free(data->obj);
+		free(data);
+		return NULL;
+	}
+	isl_seq_cpy(data->obj->el, bmap->ineq[0], 1 + total);
+	return data;
+}
+
+static void release_tab(void *user)
+{
+	struct tab_data *data = user;
+
+	isl_tab_free(data->tab);
+	isl_vec_free(data->obj);
+	free(data);
+}
+
+static isl_stat run_detect_redundant(void **data, int n)
+{
+	int i;
+
+	for (i = 0; i < n; ++i) {
+		struct tab_data *td = data[i];
+		if (isl_tab_detect_redundant(td->tab) < 0)
+			return isl_stat_error;
+	}
+	return isl_stat_ok;
+}
+
+static isl_stat run_tab_min(void **data, int n)
+{
+	int i;
+	isl_int opt, opt_denom;
+	enum isl_lp_result res = isl_lp_ok;
+
+	isl_int_init(opt);
+	isl_int_init(opt_denom);
+	for (i = 0; i < n; ++i) {
+		struct tab_data *td = data[i];
+		isl_ctx *ctx = isl_tab_get_ctx(td->tab);
+		res = isl_tab_min(td->tab, td->obj->el, ctx->one,
+				&opt, &opt_denom, 0);
+		if (res == isl_lp_error)
+			break;
+	}
+	isl_int_clear(opt);
+	isl_int_clear(opt_denom);
+
+	return res == isl_lp_error ? isl_stat_error : isl_stat_ok;
+}
+
+/* Return a copy of the inequality constraint matrix of "bmap".
+ */
+static void *prepare_mat(__isl_keep isl_basic_map *bmap)
+{
+	isl_ctx *ctx = isl_basic_map_get_ctx(bmap);
+	isl_size total;
+	isl_mat *sub, *mat;
+
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	if (total < 0)
+		return NULL;
+	sub = isl_mat_sub_alloc6(ctx, bmap->ineq, 0, bmap->n_ineq,
+				0, 1 + total);
+	mat = isl_mat_dup(sub);
+	isl_mat_free(sub);
+	return mat;
+}
+
+static void release_mat(void *data)
+{
+	isl_mat_free(data);
+}
+
+static isl_stat run_left_hermite(void **data, int n)
+{
+	int i;
+
+	for (i = 0; i < n; ++i)
+		if (!(data[i] = isl_mat_left_hermite(data[i], 0, NULL, NULL)))
+			return isl_stat_error;
+	return isl_stat_ok;
+}
+
+/* Eliminate the second coefficient of each inequality of each
+ * of the basic maps in "data" using the next inequality,
+ * as in Fourier-Motzkin elimination or Gaussian elimination.
+ */
+static isl_stat run_seq_combine(void **data, int n)
+{
+	int i, j;
+	isl_int a, b;
+
+	isl_int_init(a);
+	isl_int_init(b);
+	for (i = 0; i < n; ++i) {
+		isl_basic_map *bmap = data[i];
+		isl_size total = isl_basic_map_dim(bmap, isl_dim_all);
+
+		if (total < 1)
+			continue;
+		for (j = 0; j + 1 < bmap->n_ineq; ++j) {
+			isl_int_set(a, bmap->ineq[j + 1][1]);
+			isl_int_neg(b, bmap->ineq[j][1]);
+			isl_seq_combine(bmap->ineq[j], a, bmap->ineq[j],
+					b, bmap->ineq[j + 1], 1 + total);
+		}
+	}
+	isl_int_clear(a);
+	isl_int_clear(b);
+
+	return isl_stat_ok;
+}
+
+/* Compute the gcd of the coefficients of each constraint and
+ * the inner product of each pair of consecutive constraints.
+ */
+static isl_stat run_seq_gcd(void **data, int n)
+{
+	int i, j;
+	isl_int gcd, prod;
+
+	isl_int_init(gcd);
+	isl_int_init(prod);
+	for (i = 0; i < n; ++i) {
+		isl_basic_map *bmap = data[i];
+		isl_size total = isl_basic_map_dim(bmap, isl_dim_all);
+
+		for (j = 0; j < bmap->n_ineq; ++j) {
+			isl_seq_gcd(bmap->ineq[j] + 1, total, &gcd);
+			if (j + 1 < bmap->n_ineq)
+				isl_seq_inner_product(bmap->ineq[j],
+					bmap->ineq[j + 1], 1 + total, &prod);
+		}
+	}
+	isl_int_clear(gcd);
+	isl_int_clear(prod);
+
+	return isl_stat_ok;
+}
+
+/* A kernel that is measured.
+ * "prepare" constructs the input of the kernel from a generated instance
+ * and "release" frees this input (or the output of "run").
+ * Only "run" is timed.
+ */
+struct kernel {
+	const char *name;
+	void *(*prepare)(__isl_keep isl_basic_map *bmap);
+	isl_stat (*run)(void **data, int n);
+	void (*release)(void *data);
+};
+
+static struct kernel kernels[] = {
+	{ "basic_map_gauss", &prepare_copy, &run_gauss, &release_bmap },
+	{ "basic_map_simplify", &prepare_copy, &run_simplify, &release_bmap },
+	{ "tab_detect_redundant", &prepare_tab, &run_detect_redundant,
+		&release_tab },
+	{ "tab_min", &prepare_tab, &run_tab_min, &release_tab },
+	{ "mat_left_hermite", &prepare_mat, &run_left_hermite, &release_mat },
+	{ "seq_combine", &prepare_copy, &run_seq_combine, &release_bmap },
+	{ "seq_gcd", &prepare_copy, &run_seq_gcd, &release_bmap },
+};
+
+/* Return the current wall clock time in seconds.
+ */
+static double now(void)
+{
+#ifdef HAVE_SYS_TIME_H
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *) a;
+	double y = *(const double *) b;
+
+	return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/* Measure "kernel" on the "n" instances in "bmap" "repeat" times
+ * and print a line with the results under the name "name".
+ * The number of operations and pivots are reported for the first run.
+ */
+static isl_stat measure(isl_ctx *ctx, const char *name, struct kernel *kernel,
+	isl_basic_map **bmap, int n, int repeat)
+{
+	void **data;
+	double *times;
+	unsigned long operations = 0;
+	long pivots = 0;
+	int i, r, ok = 1;
+
+	data = isl_calloc_array(ctx, void *, n);
+	times = isl_alloc_array(ctx, double, repeat);
+	if (!data || !times)
+		goto error;
+	for (r = 0; r < repeat; ++r) {
+		double start;
+
+		for (i = 0; i < n; ++i)
+			if (!(data[i] = kernel->prepare(bmap[i])))
+				goto error;
+		isl_ctx_reset_operations(ctx);
+		ctx->stats->tab_pivots = 0;
+		start = now();
+		if (kernel->run(data, n) < 0)
+			ok = 0;
+		times[r] = now() - start;
+		if (r == 0) {
+			operations = ctx->operations;
+			pivots = ctx->stats->tab_pivots;
+		}
+		for (i = 0; i < n; ++i) {
+			if (data[i])
+				kernel->release(data[i]);
+			data[i] = NULL;
+		}
+	}
+	qsort(times, repeat, sizeof(double), &cmp_double);
+	printf("%s\t%s\t%s\t%d\t%.6f\t%.6f\t%ld\t%lu\t%ld\n", name, BACKEND,
+		ok ? "ok" : "error", repeat, times[0], times[repeat / 2],
+		-1L, operations, pivots);
+	fflush(stdout);
+
+	free(data);
+	free(times);
+	return ok ? isl_stat_ok : isl_stat_error;
+error:
+	if (data)
+		for (i = 0; i < n; ++i)
+			if (data[i])
+				kernel->release(data[i]);
+	free(data);
+	free(times);
+	return isl_stat_error;
+}
+
+/* Measure all kernels on "n" instances of "family" of dimension "dim"
+ * with coefficients of "bits" bits.
+ * The instances only depend on the family, the dimension and
+ * the coefficient size.
+ */
+static isl_stat bench_family(isl_ctx *ctx, struct family *family,
+	int dim, int bits, int n, int repeat)
+{
+	isl_basic_map **bmap;
+	isl_stat r = isl_stat_ok;
+	int i, k;
+
+	bmap = isl_calloc_array(ctx, isl_basic_map *, n);
+	if (!bmap)
+		return isl_stat_error;
+	set_seed(1000 * dim + bits);
+	for (i = 0; i < n; ++i)
+		if (!(bmap[i] = family->generate(ctx, dim, bits)))
+			r = isl_stat_error;
+
+	for (k = 0; r >= 0 && k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+		char name[128];
+
+		snprintf(name, sizeof(name), "%s/%s/d%d/b%d",
+			kernels[k].name, family->name, dim, bits);
+		if (measure(ctx, name, &kernels[k], bmap, n, repeat) < 0)
+			r = isl_stat_error;
+	}
+
+	for (i = 0; i < n; ++i)
+		isl_basic_map_free(bmap[i]);
+	free(bmap);
+
+	return r;
+}
+
+/* Parse the next element of the comma separated list of
+ * positive integers at "*list" into "*value" and advance "*list".
+ * Return 0 at the end of the list and -1 on error.
+ */
+static int next_value(const char **list, int *value)
+{
+	char *end;
+	long v;
+
+	if (!**list)
+		return 0;
+	v = strtol(*list, &end, 10);
+	if (end == *list || v <= 0 || (*end && *end != ','))
+		return -1;
+	*value = v;
+	*list = *end ? end + 1 : end;
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	isl_ctx *ctx;
+	struct options *options;
+	const char *dims, *bits;
+	int dim, bit, f, d, b = 0;
+	int r = 0;
+
+	options = options_new_with_defaults();
+	assert(options);
+	argc = options_parse(options, argc, argv, ISL_ARG_ALL);
+	ctx = isl_ctx_alloc_with_options(&options_args, options);
+
+	if (options->repeat < 1 || options->size < 1)
+		isl_die(ctx, isl_error_invalid,
+			"expecting positive number of repetitions and instances",
+			goto error);
+
+	printf("# kernel\tbackend\tstatus\truns\tmin_time\tmedian_time"
+		"\tmax_rss_kb\toperations\tpivots\n");
+	for (f = 0; f < sizeof(families) / sizeof(families[0]); ++f) {
+		dims = options->dims;
+		while ((d = next_value(&dims, &dim)) > 0) {
+			bits = options->bits;
+			while ((b = next_value(&bits, &bit)) > 0)
+				if (bench_family(ctx, &families[f], dim, bit,
+					    options->size, options->repeat) < 0)
+					r = -1;
+			if (b < 0)
+				break;
+		}
+		if (d < 0 || b < 0)
+			isl_die(ctx, isl_error_invalid, "invalid list",
+				goto error);
+	}
+
+	isl_ctx_free(ctx);
+	return r < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+error:
+	isl_ctx_free(ctx);
+	return EXIT_FAILURE;
+}
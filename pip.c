@@ -8,6 +8,7 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include <isl_map_private.h>
 #include "isl/aff.h"
@@ -20,7 +21,10 @@
 #include <isl_point_private.h>
 #include <isl_vec_private.h>
 #include "isl/options.h"
+#include "isl/stream.h"
+#include "isl/val.h"
 #include <isl_config.h>
+#include "server.h"
 
 /* The input of this program is the same as that of the "example" program
  * from the PipLib distribution, except that the "big parameter column"
@@ -40,6 +44,7 @@
 
 struct options {
 	struct isl_options	*isl;
+	struct server_options	*server;
 	unsigned		 verify;
 	unsigned		 format;
 };
@@ -55,6 +60,8 @@ struct isl_arg_choice pip_format[] = {
 
 ISL_ARGS_START(struct options, options_args)
 ISL_ARG_CHILD(struct options, isl, "isl", &isl_options_args, "isl options")
+ISL_ARG_CHILD(struct options, server, "server", &server_options_args,
+	"server options")
 ISL_ARG_BOOL(struct options, verify, 'T', "verify", 0, NULL)
 ISL_ARG_CHOICE(struct options, format, 0, "format",
 	pip_format, FORMAT_SET, "output format")
@@ -175,11 +182,13 @@ static __isl_give isl_set *set_plug_in_parameters(__isl_take isl_set *set,
 /* Compute the lexicographically minimal (or maximal if max is set)
  * element of bset for the given values of the parameters, by
  * successively solving an ilp problem in each direction.
+ * Return a zero-length vector if there is no such element.
  */
 static __isl_give isl_vec *opt_at(__isl_take isl_basic_set *bset,
 	__isl_take isl_vec *params, int max)
 {
 	isl_size dim;
+	isl_bool empty;
 	isl_ctx *ctx;
 	struct isl_vec *opt;
 	struct isl_vec *obj;
@@ -190,19 +199,23 @@ static __isl_give isl_vec *opt_at(__isl_take isl_basic_set *bset,
 		goto error;
 
 	bset = plug_in_parameters(bset, params);
+	empty = isl_basic_set_plain_is_empty(bset);
+	if (empty < 0) {
+		isl_basic_set_free(bset);
+		return NULL;
+	}
 
 	ctx = isl_basic_set_get_ctx(bset);
-	if (isl_basic_set_plain_is_empty(bset)) {
+	if (empty) {
 		opt = isl_vec_alloc(ctx, 0);
 		isl_basic_set_free(bset);
 		return opt;
 	}
 
 	opt = isl_vec_alloc(ctx, 1 + dim);
-	assert(opt);
-
 	obj = isl_vec_alloc(ctx, 1 + dim);
-	assert(obj);
+	if (!opt || !obj)
+		goto error_opt;
 
 	isl_int_set_si(opt->el[0], 1);
 	isl_int_set_si(obj->el[0], 0);
@@ -216,7 +229,11 @@ static __isl_give isl_vec *opt_at(__isl_take isl_basic_set *bset,
 						&opt->el[1 + i], NULL);
 		if (res == isl_lp_empty)
 			goto empty;
-		assert(res == isl_lp_ok);
+		if (res == isl_lp_error)
+			goto error_opt;
+		if (res != isl_lp_ok)
+			isl_die(ctx, isl_error_internal, "unbounded optimum",
+				goto error_opt);
 		bset = isl_basic_set_fix(bset, isl_dim_set, i, opt->el[1 + i]);
 	}
 
@@ -228,6 +245,11 @@ error:
 	isl_basic_set_free(bset);
 	isl_vec_free(params);
 	return NULL;
+error_opt:
+	isl_basic_set_free(bset);
+	isl_vec_free(opt);
+	isl_vec_free(obj);
+	return NULL;
 empty:
 	isl_vec_free(opt);
 	opt = isl_vec_alloc(ctx, 0);
@@ -245,6 +267,7 @@ struct isl_scan_pip {
 	int stride;
 	int n;
 	int max;
+	int failed;
 };
 
 /* Check if the "manually" computed optimum of bset at the "sample"
@@ -254,22 +277,27 @@ struct isl_scan_pip {
  * then it should be an element of the parameter domain "empty".
  * Otherwise, the optimal solution, should be equal to the result of
  * plugging in the value of the parameters in "sol".
+ * If the check fails, then sp->failed is set to distinguish
+ * the failure from the end of the scan.
  */
 static isl_stat scan_one(struct isl_scan_callback *callback,
 	__isl_take isl_vec *sample)
 {
 	struct isl_scan_pip *sp = (struct isl_scan_pip *)callback;
 	struct isl_vec *opt;
+	isl_bool ok;
 
 	sp->n--;
 
 	opt = opt_at(isl_basic_set_copy(sp->bset), isl_vec_copy(sample), sp->max);
-	assert(opt);
 
-	if (opt->size == 0) {
+	if (!opt) {
+		isl_vec_free(sample);
+		ok = isl_bool_error;
+	} else if (opt->size == 0) {
 		isl_point *sample_pnt;
 		sample_pnt = isl_point_alloc(isl_set_get_space(sp->empty), sample);
-		assert(isl_set_contains_point(sp->empty, sample_pnt));
+		ok = isl_set_contains_point(sp->empty, sample_pnt);
 		isl_point_free(sample_pnt);
 		isl_vec_free(opt);
 	} else {
@@ -277,10 +305,18 @@ static isl_stat scan_one(struct isl_scan_callback *callback,
 		isl_set *opt_set;
 		opt_set = isl_set_from_basic_set(isl_basic_set_from_vec(opt));
 		sol = set_plug_in_parameters(isl_set_copy(sp->sol), sample);
-		assert(isl_set_is_equal(opt_set, sol));
+		ok = isl_set_is_equal(opt_set, sol);
 		isl_set_free(sol);
 		isl_set_free(opt_set);
 	}
+	if (ok < 0 || !ok)
+		sp->failed = 1;
+	if (ok < 0)
+		return isl_stat_error;
+	if (!ok)
+		isl_die(isl_set_get_ctx(sp->empty), isl_error_internal,
+			"solution does not match optimum at sample",
+			return isl_stat_error);
 
 	if (!(sp->n % sp->stride)) {
 		printf("o");
@@ -290,14 +326,21 @@ static isl_stat scan_one(struct isl_scan_callback *callback,
 	return sp->n >= 1 ? isl_stat_ok : isl_stat_error;
 }
 
-static void check_solution(isl_basic_set *bset, isl_basic_set *context,
-	isl_set *sol, isl_set *empty, int max)
+/* Check the solution (sol, empty) of the pilp problem "bset"
+ * for the parameter values in (a bounded part of) "context".
+ */
+static isl_stat check_solution(__isl_take isl_basic_set *bset,
+	__isl_take isl_basic_set *context, __isl_keep isl_set *sol,
+	__isl_keep isl_set *empty, int max)
 {
 	struct isl_scan_pip sp;
 	isl_int count, count_max;
 	int i, n;
 	int r;
 
+	if (!sol || !empty)
+		goto error;
+
 	context = set_bounds(context);
 	context = isl_basic_set_underlying_set(context);
 
@@ -306,12 +349,14 @@ static void check_solution(isl_basic_set *bset, isl_basic_set *context,
 
 	isl_int_set_si(count_max, 2000);
 	r = isl_basic_set_count_upto(context, count_max, &count);
-	assert(r >= 0);
 	n = isl_int_get_si(count);
 
 	isl_int_clear(count_max);
 	isl_int_clear(count);
 
+	if (r < 0)
+		goto error;
+
 	sp.callback.add = scan_one;
 	sp.bset = bset;
 	sp.sol = sol;
@@ -319,6 +364,7 @@ static void check_solution(isl_basic_set *bset, isl_basic_set *context,
 	sp.n = n;
 	sp.stride = n > 70 ? 1 + (n + 1)/70 : 1;
 	sp.max = max;
+	sp.failed = 0;
 
 	for (i = 0; i < n; i += sp.stride)
 		printf(".");
@@ -330,48 +376,90 @@ static void check_solution(isl_basic_set *bset, isl_basic_set *context,
 	printf("\n");
 
 	isl_basic_set_free(bset);
+
+	return sp.failed ? isl_stat_error : isl_stat_ok;
+error:
+	isl_basic_set_free(context);
+	isl_basic_set_free(bset);
+	return isl_stat_error;
 }
 
-int main(int argc, char **argv)
+/* Read the context constraints, the big parameter column and
+ * the problem constraints from "s".
+ * The big parameter column is required to be -1.
+ */
+static isl_stat read_problem(__isl_keep isl_stream *s,
+	isl_basic_set **context, isl_basic_set **bset)
 {
-	struct isl_ctx *ctx;
+	isl_val *v;
+	isl_bool neg_one;
+
+	*context = isl_stream_read_basic_set(s);
+	v = isl_stream_read_val(s);
+	neg_one = isl_val_is_negone(v);
+	isl_val_free(v);
+	if (neg_one < 0) {
+		*context = isl_basic_set_free(*context);
+		return isl_stat_error;
+	}
+	if (!neg_one) {
+		*context = isl_basic_set_free(*context);
+		isl_die(isl_stream_get_ctx(s), isl_error_invalid,
+			"big parameter column should be -1",
+			return isl_stat_error);
+	}
+	*bset = isl_stream_read_basic_set(s);
+	if (!*context || !*bset) {
+		*context = isl_basic_set_free(*context);
+		*bset = isl_basic_set_free(*bset);
+		return isl_stat_error;
+	}
+
+	return isl_stat_ok;
+}
+
+/* Read a problem in the format described at the top of this file
+ * from "s", solve it and print the solution to "out" or,
+ * if requested, check the correctness of the solution.
+ */
+static isl_stat solve(__isl_keep isl_stream *s, FILE *out, void *user)
+{
+	struct options *options = user;
+	isl_ctx *ctx;
 	struct isl_basic_set *context, *bset, *copy, *context_copy;
 	struct isl_set *set = NULL;
 	struct isl_set *empty;
 	isl_pw_multi_aff *pma = NULL;
-	int neg_one;
-	char s[1024];
+	struct isl_token *tok;
 	int urs_parms = 0;
 	int urs_unknowns = 0;
 	int max = 0;
 	int rational = 0;
-	int n;
-	struct options *options;
+	isl_stat r;
 
-	options = options_new_with_defaults();
-	assert(options);
-	argc = options_parse(options, argc, argv, ISL_ARG_ALL);
+	ctx = isl_stream_get_ctx(s);
+	if (read_problem(s, &context, &bset) < 0)
+		return isl_stat_error;
 
-	ctx = isl_ctx_alloc_with_options(&options_args, options);
+	while ((tok = isl_stream_next_token(s)) != NULL) {
+		char *str = NULL;
 
-	context = isl_basic_set_read_from_file(ctx, stdin);
-	assert(context);
-	n = fscanf(stdin, "%d", &neg_one);
-	assert(n == 1);
-	assert(neg_one == -1);
-	bset = isl_basic_set_read_from_file(ctx, stdin);
-
-	while (fgets(s, sizeof(s), stdin)) {
-		if (strncasecmp(s, "Maximize", 8) == 0)
+		if (isl_token_has_str(tok))
+			str = isl_token_get_str(ctx, tok);
+		isl_token_free(tok);
+		if (!str)
+			continue;
+		if (strncasecmp(str, "Maximize", 8) == 0)
 			max = 1;
-		if (strncasecmp(s, "Rational", 8) == 0) {
+		if (strncasecmp(str, "Rational", 8) == 0) {
 			rational = 1;
 			bset = isl_basic_set_set_rational(bset);
 		}
-		if (strncasecmp(s, "Urs_parms", 9) == 0)
+		if (strncasecmp(str, "Urs_parms", 9) == 0)
 			urs_parms = 1;
-		if (strncasecmp(s, "Urs_unknowns", 12) == 0)
+		if (strncasecmp(str, "Urs_unknowns", 12) == 0)
 			urs_unknowns = 1;
+		free(str);
 	}
 	if (!urs_parms)
 		context = isl_basic_set_intersect(context,
@@ -394,6 +482,7 @@ int main(int argc, char **argv)
 		else
 			pma = isl_basic_set_partial_lexmin_pw_multi_aff(bset,
 								context, &empty);
+		r = pma ? isl_stat_ok : isl_stat_error;
 	} else {
 		if (max)
 			set = isl_basic_set_partial_lexmax(bset,
@@ -401,17 +490,25 @@ int main(int argc, char **argv)
 		else
 			set = isl_basic_set_partial_lexmin(bset,
 								context, &empty);
+		r = set ? isl_stat_ok : isl_stat_error;
 	}
 
 	if (options->verify) {
-		assert(!rational);
 		if (options->format == FORMAT_AFF)
 			set = isl_set_from_pw_multi_aff(pma);
-		check_solution(copy, context_copy, set, empty, max);
+		if (rational) {
+			isl_basic_set_free(copy);
+			isl_basic_set_free(context_copy);
+			isl_die(ctx, isl_error_unsupported,
+				"cannot verify rational solutions",
+				r = isl_stat_error);
+		} else if (check_solution(copy, context_copy, set, empty,
+				max) < 0)
+			r = isl_stat_error;
 		isl_set_free(set);
 	} else {
 		isl_printer *p;
-		p = isl_printer_to_file(ctx, stdout);
+		p = isl_printer_to_file(ctx, out);
 		if (options->format == FORMAT_AFF)
 			p = isl_printer_print_pw_multi_aff(p, pma);
 		else
@@ -426,7 +523,32 @@ int main(int argc, char **argv)
 	}
 
 	isl_set_free(empty);
+
+	return r;
+}
+
+int main(int argc, char **argv)
+{
+	struct isl_ctx *ctx;
+	isl_stream *s;
+	struct options *options;
+	int r;
+
+	options = options_new_with_defaults();
+	assert(options);
+	argc = options_parse(options, argc, argv, ISL_ARG_ALL);
+
+	ctx = isl_ctx_alloc_with_options(&options_args, options);
+
+	if (server_is_enabled(options->server)) {
+		r = server_run(ctx, options->server, &solve, options);
+	} else {
+		s = isl_stream_new_file(ctx, stdin);
+		r = solve(s, stdout, options) < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+		isl_stream_free(s);
+	}
+
 	isl_ctx_free(ctx);
 
-	return 0;
+	return r;
 }
@@ -0,0 +1,607 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+/* This program performs the calls recorded in a trace produced
+ * by isl_ctx_trace_start or the --isl-trace-file option again
+ * and prints the time taken by each of them.
+ *
+ * For each call, a line is printed with the position of the call
+ * in the trace, the name of the called function, the time
+ * recorded in the trace and the minimal time over the replays
+ * of the call, followed by the status of the replay.
+ * The status is "ok" if the result is equal to the recorded result,
+ * "mismatch" if it is not, "error" if the replayed call failed
+ * while the recorded call did not, "unsupported" if the function
+ * cannot be replayed by this program and "unreadable" if
+ * the recorded arguments cannot be read back.
+ * The latter may happen for calls performed internally by isl
+ * on objects with anonymous nested spaces.
+ * Since the arguments of each call are read from the trace,
+ * a single call can be replayed in isolation using the --call option,
+ * e.g., to profile it.
+ * Note that options that affect the result, e.g., scheduling options,
+ * need to be set in the same way as in the traced program.
+ */
+
+#include <isl_config.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+
+#include "isl/arg.h"
+#include "isl/options.h"
+#include "isl/ctx.h"
+#include "isl/set.h"
+#include "isl/map.h"
+#include "isl/union_set.h"
+#include "isl/union_map.h"
+#include "isl/flow.h"
+#include "isl/schedule.h"
+#include "isl/stream.h"
+
+struct options {
+	struct isl_options	*isl;
+	int			 repeat;
+	int			 call;
+	unsigned		 check;
+};
+
+ISL_ARGS_START(struct options, options_args)
+ISL_ARG_CHILD(struct options, isl, "isl", &isl_options_args, "isl options")
+ISL_ARG_INT(struct options, repeat, 'r', "repeat", "n", 1,
+	"number of times each call is replayed")
+ISL_ARG_INT(struct options, call, 0, "call", "n", 0,
+	"only replay the call at position n (starting from 1)")
+ISL_ARG_BOOL(struct options, check, 0, "check", 1,
+	"compare the results to the recorded results")
+ISL_ARGS_END
+
+ISL_ARG_DEF(options, struct options, options_args)
+
+/* The operations on a type of objects that can appear in a trace.
+ * "read" is NULL if objects of this type cannot be read back.
+ * "is_equal" is NULL if objects of this type should be compared
+ * based on their textual representations.
+ */
+struct replay_type {
+	const char *name;
+	void *(*read)(isl_ctx *ctx, const char *str);
+	void *(*free)(void *obj);
+	char *(*to_str)(void *obj);
+	isl_bool (*is_equal)(void *obj1, void *obj2);
+};
+
+#define REPLAY_TYPE_FN(T)						\
+static void *T ## _read(isl_ctx *ctx, const char *str)			\
+{									\
+	return isl_ ## T ## _read_from_str(ctx, str);			\
+}									\
+static void *T ## _free(void *obj)					\
+{									\
+	return isl_ ## T ## _free(obj);					\
+}									\
+static char *T ## _to_str(void *obj)					\
+{									\
+	return isl_ ## T ## _to_str(obj);				\
+}
+
+#define REPLAY_TYPE_EQUAL(T,is_equal)					\
+static isl_bool T ## _is_equal(void *obj1, void *obj2)			\
+{									\
+	return isl_ ## T ## _ ## is_equal(obj1, obj2);			\
+}
+
+REPLAY_TYPE_FN(set)
+REPLAY_TYPE_EQUAL(set, is_equal)
+REPLAY_TYPE_FN(map)
+REPLAY_TYPE_EQUAL(map, is_equal)
+REPLAY_TYPE_FN(union_set)
+REPLAY_TYPE_EQUAL(union_set, is_equal)
+REPLAY_TYPE_FN(union_map)
+REPLAY_TYPE_EQUAL(union_map, is_equal)
+REPLAY_TYPE_FN(schedule_constraints)
+REPLAY_TYPE_FN(schedule)
+REPLAY_TYPE_EQUAL(schedule, plain_is_equal)
+
+/* isl_union_access_info does not have an isl_*_read_from_str function.
+ */
+static void *union_access_info_read(isl_ctx *ctx, const char *str)
+{
+	isl_stream *s;
+	isl_union_access_info *access;
+
+	s = isl_stream_new_str(ctx, str);
+	if (!s)
+		return NULL;
+	access = isl_stream_read_union_access_info(s);
+	isl_stream_free(s);
+
+	return access;
+}
+
+static void *union_access_info_free(void *obj)
+{
+	return isl_union_access_info_free(obj);
+}
+
+static char *union_access_info_to_str(void *obj)
+{
+	return isl_union_access_info_to_str(obj);
+}
+
+static void *union_flow_free(void *obj)
+{
+	return isl_union_flow_free(obj);
+}
+
+static char *union_flow_to_str(void *obj)
+{
+	return isl_union_flow_to_str(obj);
+}
+
+#define REPLAY_TYPE(T)							\
+	{ "isl_" #T, &T ## _read, &T ## _free, &T ## _to_str,		\
+	  &T ## _is_equal }
+
+static struct replay_type set_type = REPLAY_TYPE(set);
+static struct replay_type map_type = REPLAY_TYPE(map);
+static struct replay_type union_set_type = REPLAY_TYPE(union_set);
+static struct replay_type union_map_type = REPLAY_TYPE(union_map);
+static struct replay_type schedule_type = REPLAY_TYPE(schedule);
+static struct replay_type schedule_constraints_type = {
+	"isl_schedule_constraints", &schedule_constraints_read,
+	&schedule_constraints_free, &schedule_constraints_to_str, NULL
+};
+static struct replay_type union_access_info_type = {
+	"isl_union_access_info", &union_access_info_read,
+	&union_access_info_free, &union_access_info_to_str, NULL
+};
+static struct replay_type union_flow_type = {
+	"isl_union_flow", NULL, &union_flow_free, &union_flow_to_str, NULL
+};
+
+/* A function that can be replayed.
+ * "arg" is the type of the arguments and "res" the type of the result.
+ * Exactly one of "un" and "bin" is set, depending on
+ * the number of arguments.
+ */
+struct replay_fn {
+	const char *name;
+	struct replay_type *arg;
+	struct replay_type *res;
+	void *(*un)(void *obj);
+	void *(*bin)(void *obj1, void *obj2);
+};
+
+#define REPLAY_UN(T,op)							\
+static void *T ## _ ## op(void *obj)					\
+{									\
+	return isl_ ## T ## _ ## op(obj);				\
+}
+
+#define REPLAY_BIN(T,op)						\
+static void *T ## _ ## op(void *obj1, void *obj2)			\
+{									\
+	return isl_ ## T ## _ ## op(obj1, obj2);			\
+}
+
+REPLAY_UN(set, coalesce)
+REPLAY_UN(set, detect_equalities)
+REPLAY_BIN(set, intersect)
+REPLAY_BIN(set, union)
+REPLAY_BIN(set, subtract)
+REPLAY_BIN(set, gist)
+REPLAY_UN(map, coalesce)
+REPLAY_UN(map, detect_equalities)
+REPLAY_BIN(map, intersect)
+REPLAY_BIN(map, union)
+REPLAY_BIN(map, subtract)
+REPLAY_BIN(map, gist)
+REPLAY_BIN(map, apply_range)
+REPLAY_BIN(map, apply_domain)
+REPLAY_UN(union_set, coalesce)
+REPLAY_UN(union_set, detect_equalities)
+REPLAY_UN(union_set, lexmin)
+REPLAY_UN(union_set, lexmax)
+REPLAY_BIN(union_set, intersect)
+REPLAY_BIN(union_set, union)
+REPLAY_BIN(union_set, subtract)
+REPLAY_BIN(union_set, gist)
+REPLAY_UN(union_map, coalesce)
+REPLAY_UN(union_map, detect_equalities)
+REPLAY_UN(union_map, lexmin)
+REPLAY_UN(union_map, lexmax)
+REPLAY_BIN(union_map, intersect)
+REPLAY_BIN(union_map, union)
+REPLAY_BIN(union_map, subtract)
+REPLAY_BIN(union_map, gist)
+REPLAY_BIN(union_map, apply_range)
+REPLAY_BIN(union_map, apply_domain)
+REPLAY_UN(union_access_info, compute_flow)
+REPLAY_UN(schedule_constraints, compute_schedule)
+
+#define UN(T,op)							\
+	{ "isl_" #T "_" #op, &T ## _type, &T ## _type, &T ## _ ## op, NULL }
+#define BIN(T,op)							\
+	{ "isl_" #T "_" #op, &T ## _type, &T ## _type, NULL, &T ## _ ## op }
+
+static struct replay_fn replay_fns[] = {
+	UN(set, coalesce),
+	UN(set, detect_equalities),
+	BIN(set, intersect),
+	BIN(set, union),
+	BIN(set, subtract),
+	BIN(set, gist),
+	UN(map, coalesce),
+	UN(map, detect_equalities),
+	BIN(map, intersect),
+	BIN(map, union),
+	BIN(map, subtract),
+	BIN(map, gist),
+	BIN(map, apply_range),
+	BIN(map, apply_domain),
+	UN(union_set, coalesce),
+	UN(union_set, detect_equalities),
+	UN(union_set, lexmin),
+	UN(union_set, lexmax),
+	BIN(union_set, intersect),
+	BIN(union_set, union),
+	BIN(union_set, subtract),
+	BIN(union_set, gist),
+	UN(union_map, coalesce),
+	UN(union_map, detect_equalities),
+	UN(union_map, lexmin),
+	UN(union_map, lexmax),
+	BIN(union_map, intersect),
+	BIN(union_map, union),
+	BIN(union_map, subtract),
+	BIN(union_map, gist),
+	BIN(union_map, apply_range),
+	BIN(union_map, apply_domain),
+	{ "isl_union_access_info_compute_flow", &union_access_info_type,
+	  &union_flow_type, &union_access_info_compute_flow, NULL },
+	{ "isl_schedule_constraints_compute_schedule",
+	  &schedule_constraints_type, &schedule_type,
+	  &schedule_constraints_compute_schedule, NULL },
+};
+
+/* Return the replayable function called "name", if any.
+ */
+static struct replay_fn *find_fn(const char *name)
+{
+	int i;
+
+	for (i = 0; i < sizeof(replay_fns) / sizeof(replay_fns[0]); ++i)
+		if (strcmp(replay_fns[i].name, name) == 0)
+			return &replay_fns[i];
+	return NULL;
+}
+
+/* A call read from a trace.
+ * "arg" holds the textual representations of the "n_arg" arguments and
+ * "result" that of the result, or NULL if the recorded call failed.
+ * "time" is the recorded time.
+ * "complete" is set if the record of the call is complete.
+ * The record of the final call in a trace may be incomplete
+ * if the traced program was interrupted during that call.
+ */
+struct replay_call {
+	char	 name[256];
+	int	 n_arg;
+	char	*arg[2];
+	char	*result;
+	double	 time;
+	int	 complete;
+};
+
+/* Free the texts in "call" and reset it.
+ */
+static void clear_call(struct replay_call *call)
+{
+	int i;
+
+	for (i = 0; i < call->n_arg; ++i)
+		free(call->arg[i]);
+	free(call->result);
+	call->n_arg = 0;
+	call->result = NULL;
+	call->time = 0;
+	call->complete = 0;
+}
+
+/* Read a text of the given length, followed by a newline, from "in".
+ */
+static char *read_text(isl_ctx *ctx, FILE *in, unsigned long len)
+{
+	char *text;
+
+	if (getc(in) != '\n')
+		isl_die(ctx, isl_error_invalid, "invalid trace", return NULL);
+	text = isl_alloc_array(ctx, char, len + 1);
+	if (!text)
+		return NULL;
+	if (fread(text, 1, len, in) != len || getc(in) != '\n') {
+		free(text);
+		isl_die(ctx, isl_error_invalid, "truncated trace",
+			return NULL);
+	}
+	text[len] = '\0';
+	return text;
+}
+
+/* Read the next call from "in" into "call".
+ * Return isl_bool_false if there are no more calls.
+ * Comment lines starting with '#' are skipped.
+ * If the trace ends after the arguments of the call have been read,
+ * then the call is returned as an incomplete call.
+ */
+static isl_bool read_call(isl_ctx *ctx, FILE *in, struct replay_call *call)
+{
+	char word[64];
+	char type[64];
+	unsigned long len;
+	int c;
+
+	for (;;) {
+		if (fscanf(in, " %63s", word) != 1)
+			return isl_bool_false;
+		if (word[0] != '#')
+			break;
+		while ((c = getc(in)) != EOF && c != '\n')
+			;
+	}
+	if (strcmp(word, "call") != 0 || fscanf(in, " %255s", call->name) != 1)
+		isl_die(ctx, isl_error_invalid, "expecting call",
+			return isl_bool_error);
+
+	for (;;) {
+		if (fscanf(in, " %63s", word) != 1) {
+			if (call->n_arg > 0)
+				return isl_bool_true;
+			isl_die(ctx, isl_error_invalid, "truncated trace",
+				return isl_bool_error);
+		}
+		if (strcmp(word, "end") == 0) {
+			call->complete = 1;
+			return isl_bool_true;
+		}
+		if (strcmp(word, "error") == 0)
+			continue;
+		if (strcmp(word, "time") == 0) {
+			if (fscanf(in, " %lf", &call->time) != 1)
+				isl_die(ctx, isl_error_invalid,
+					"expecting time",
+					return isl_bool_error);
+			continue;
+		}
+		if (fscanf(in, " %63s %lu", type, &len) != 2)
+			isl_die(ctx, isl_error_invalid, "invalid trace",
+				return isl_bool_error);
+		if (strcmp(word, "result") == 0) {
+			call->result = read_text(ctx, in, len);
+			if (!call->result)
+				return isl_bool_error;
+		} else if (strcmp(word, "arg") == 0 && call->n_arg < 2) {
+			call->arg[call->n_arg] = read_text(ctx, in, len);
+			if (!call->arg[call->n_arg])
+				return isl_bool_error;
+			call->n_arg++;
+		} else {
+			isl_die(ctx, isl_error_invalid, "invalid trace",
+				return isl_bool_error);
+		}
+	}
+}
+
+/* Return the current wall clock time in seconds.
+ */
+static double now(void)
+{
+#ifdef HAVE_SYS_TIME_H
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Perform "call" to "fn" once, storing the time it took in "time".
+ * The arguments are read from their textual representations
+ * before the clock is started.
+ * If any of them cannot be read back, then *unreadable is set.
+ */
+static void *perform(isl_ctx *ctx, struct replay_fn *fn,
+	struct replay_call *call, double *time, int *unreadable)
+{
+	void *arg[2] = { NULL, NULL };
+	void *res;
+	double start;
+	int i;
+
+	for (i = 0; i < call->n_arg; ++i) {
+		arg[i] = fn->arg->read(ctx, call->arg[i]);
+		if (!arg[i])
+			break;
+	}
+	if (i < call->n_arg) {
+		for (i = 0; i < call->n_arg; ++i)
+			fn->arg->free(arg[i]);
+		*unreadable = 1;
+		return NULL;
+	}
+
+	start = now();
+	if (fn->un)
+		res = fn->un(arg[0]);
+	else
+		res = fn->bin(arg[0], arg[1]);
+	*time = now() - start;
+
+	return res;
+}
+
+/* Is "res" equal to the result recorded in "call"?
+ */
+static isl_bool check_result(isl_ctx *ctx, struct replay_fn *fn,
+	struct replay_call *call, void *res)
+{
+	void *expected;
+	char *str;
+	isl_bool equal;
+
+	if (fn->res->read && fn->res->is_equal) {
+		expected = fn->res->read(ctx, call->result);
+		if (!expected)
+			return isl_bool_error;
+		equal = fn->res->is_equal(res, expected);
+		fn->res->free(expected);
+		return equal;
+	}
+
+	str = fn->res->to_str(res);
+	if (!str)
+		return isl_bool_error;
+	equal = isl_bool_ok(strcmp(str, call->result) == 0);
+	free(str);
+	return equal;
+}
+
+/* Replay "call" "repeat" times and print the minimal time it took,
+ * along with the status of the replay.
+ * If "check" is set, then the result is compared to the recorded result.
+ * Return -1 if the replay failed or if the results do not match.
+ *
+ * There is no recorded result or time for an incomplete call.
+ */
+static int replay(isl_ctx *ctx, int pos, struct replay_call *call,
+	int repeat, int check)
+{
+	struct replay_fn *fn;
+	void *res = NULL;
+	char recorded[32];
+	double time, best = 0;
+	const char *status = "ok";
+	int unreadable = 0;
+	int i;
+
+	if (call->complete)
+		snprintf(recorded, sizeof(recorded), "%.6f", call->time);
+	else
+		strcpy(recorded, "-");
+
+	fn = find_fn(call->name);
+	if (!fn || call->n_arg != (fn->un ? 1 : 2)) {
+		printf("%d\t%s\t%s\t-\tunsupported\n",
+			pos, call->name, recorded);
+		return 0;
+	}
+
+	for (i = 0; i < repeat; ++i) {
+		fn->res->free(res);
+		res = perform(ctx, fn, call, &time, &unreadable);
+		if (!res)
+			break;
+		if (i == 0 || time < best)
+			best = time;
+	}
+
+	if (unreadable) {
+		status = "unreadable";
+		isl_ctx_reset_error(ctx);
+	} else if (!call->complete) {
+		if (!res)
+			status = "error";
+		isl_ctx_reset_error(ctx);
+	} else if (!res) {
+		if (call->result)
+			status = "error";
+		isl_ctx_reset_error(ctx);
+	} else if (!call->result) {
+		status = "mismatch";
+	} else if (check) {
+		isl_bool equal = check_result(ctx, fn, call, res);
+		if (equal < 0)
+			status = "error";
+		else if (!equal)
+			status = "mismatch";
+	}
+	fn->res->free(res);
+
+	if (i >= repeat)
+		printf("%d\t%s\t%s\t%.6f\t%s\n",
+			pos, call->name, recorded, best, status);
+	else
+		printf("%d\t%s\t%s\t-\t%s\n",
+			pos, call->name, recorded, status);
+
+	return strcmp(status, "ok") == 0 ? 0 : -1;
+}
+
+/* Replay the calls in the trace read from "in".
+ * If "only" is positive, then only the call at that position is replayed.
+ */
+static int replay_trace(isl_ctx *ctx, FILE *in, struct options *options)
+{
+	struct replay_call call = { 0 };
+	isl_bool more;
+	int pos = 0;
+	int r = 0;
+
+	printf("# call\tfunction\trecorded\treplayed\tstatus\n");
+	while ((more = read_call(ctx, in, &call)) == isl_bool_true) {
+		++pos;
+		if (options->call <= 0 || options->call == pos)
+			if (replay(ctx, pos, &call, options->repeat,
+				    options->check) < 0)
+				r = -1;
+		clear_call(&call);
+	}
+	clear_call(&call);
+
+	return more < 0 ? -1 : r;
+}
+
+int main(int argc, char **argv)
+{
+	isl_ctx *ctx;
+	struct options *options;
+	FILE *in = stdin;
+	int r;
+
+	options = options_new_with_defaults();
+	assert(options);
+	argc = options_parse(options, argc, argv, 0);
+	ctx = isl_ctx_alloc_with_options(&options_args, options);
+
+	if (argc > 2)
+		isl_die(ctx, isl_error_invalid, "expecting single trace file",
+			goto error);
+	if (options->repeat < 1)
+		isl_die(ctx, isl_error_invalid,
+			"expecting positive number of repetitions",
+			goto error);
+	if (argc == 2) {
+		in = fopen(argv[1], "r");
+		if (!in)
+			isl_die(ctx, isl_error_invalid,
+				"unable to open trace file", goto error);
+	}
+
+	r = replay_trace(ctx, in, options);
+
+	if (in != stdin)
+		fclose(in);
+	isl_ctx_free(ctx);
+	return r < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+error:
+	isl_ctx_free(ctx);
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,413 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+/* Support for handling a sequence of requests in a single process
+ * in the command-line tools.
+ *
+ * In server mode (--server), requests are read from standard input.
+ * Each request is either a single non-empty line or a header line
+ * of the form "@n" followed by exactly n bytes of input.
+ * Blank lines and lines starting with '#' between requests are skipped.
+ * In socket mode (--socket), the same protocol is spoken
+ * on each connection accepted on a Unix socket, one connection at a time.
+ * In batch mode (--batch), each non-empty line of the batch file
+ * is the name of a file holding a single input.
+ *
+ * The response to each request is the output of the tool,
+ * followed by a "---" line on success or by a "--- error" line
+ * on failure, after which the output is flushed.
+ * For the tools that produce YAML output, this makes the sequence
+ * of responses a valid sequence of YAML documents.
+ * All requests are handled by the same isl_ctx such that any
+ * caches attached to the context are reused across requests.
+ */
+
+#include <isl_config.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H)
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+#include "server.h"
+
+ISL_ARGS_START(struct server_options, server_options_args)
+ISL_ARG_BOOL(struct server_options, serve, 0, "server", 0,
+	"handle a sequence of requests read from standard input")
+ISL_ARG_STR(struct server_options, socket, 0, "socket", "path", NULL,
+	"handle requests on connections to the Unix socket \"path\"")
+ISL_ARG_STR(struct server_options, batch, 0, "batch", "file", NULL,
+	"handle each of the input files listed in \"file\"")
+ISL_ARGS_END
+
+/* A growable buffer holding the text of a request.
+ * "len" is the number of characters in "data", which is always
+ * followed by a terminating NUL character.
+ */
+struct server_buffer {
+	char	*data;
+	size_t	 len;
+	size_t	 size;
+};
+
+/* Make sure "buf" has room for "extra" more characters,
+ * besides the terminating NUL character.
+ */
+static isl_stat buffer_reserve(isl_ctx *ctx, struct server_buffer *buf,
+	size_t extra)
+{
+	size_t size;
+	char *data;
+
+	if (buf->len + extra < buf->size)
+		return isl_stat_ok;
+	size = 2 * buf->size;
+	if (size < buf->len + extra + 1)
+		size = buf->len + extra + 1;
+	if (size < 256)
+		size = 256;
+	data = isl_realloc_array(ctx, buf->data, char, size);
+	if (!data)
+		return isl_stat_error;
+	buf->data = data;
+	buf->size = size;
+	return isl_stat_ok;
+}
+
+/* Append the next line of "in", including the newline, if any, to "buf".
+ * Return the number of characters read, i.e., 0 at end of file,
+ * or -1 on error.
+ */
+static int read_line(isl_ctx *ctx, FILE *in, struct server_buffer *buf)
+{
+	int c;
+	int n = 0;
+
+	if (buffer_reserve(ctx, buf, 0) < 0)
+		return -1;
+	while ((c = getc(in)) != EOF) {
+		if (buffer_reserve(ctx, buf, 1) < 0)
+			return -1;
+		buf->data[buf->len++] = c;
+		++n;
+		if (c == '\n')
+			break;
+	}
+	buf->data[buf->len] = '\0';
+	if (ferror(in))
+		isl_die(ctx, isl_error_unknown, "error reading request",
+			return -1);
+	return n;
+}
+
+/* Is "c" a white space character?
+ */
+static int is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/* Does "line" only consist of white space?
+ */
+static int is_blank(const char *line)
+{
+	for (; *line; ++line)
+		if (!is_space(*line))
+			return 0;
+	return 1;
+}
+
+/* Read the length in a header line "@n" of a length-delimited request.
+ */
+static isl_stat read_length(isl_ctx *ctx, const char *line, size_t *len)
+{
+	char *end;
+	unsigned long n;
+
+	errno = 0;
+	n = strtoul(line + 1, &end, 10);
+	if (end == line + 1 || errno != 0 || !is_blank(end))
+		isl_die(ctx, isl_error_invalid, "invalid request header",
+			return isl_stat_error);
+	*len = n;
+	return isl_stat_ok;
+}
+
+/* Read the next request from "in" into "buf".
+ * Return isl_bool_false if there are no more requests.
+ *
+ * A request is either a length-delimited block of text or
+ * a single line.
+ */
+static isl_bool read_request(isl_ctx *ctx, FILE *in, struct server_buffer *buf)
+{
+	size_t len;
+	int n;
+
+	do {
+		buf->len = 0;
+		n = read_line(ctx, in, buf);
+		if (n <= 0)
+			return n < 0 ? isl_bool_error : isl_bool_false;
+	} while (is_blank(buf->data) || buf->data[0] == '#');
+
+	if (buf->data[0] != '@')
+		return isl_bool_true;
+
+	if (read_length(ctx, buf->data, &len) < 0)
+		return isl_bool_error;
+	buf->len = 0;
+	if (buffer_reserve(ctx, buf, len) < 0)
+		return isl_bool_error;
+	if (fread(buf->data, 1, len, in) != len)
+		isl_die(ctx, isl_error_invalid, "truncated request",
+			return isl_bool_error);
+	buf->len = len;
+	buf->data[len] = '\0';
+	return isl_bool_true;
+}
+
+/* Terminate the response to a request that was handled with result "r"
+ * and flush the output such that the client can pick it up.
+ * Any error that occurred while handling the request is reported
+ * in the terminating line and then cleared such that
+ * it does not affect the next request.
+ */
+static isl_stat finish_response(isl_ctx *ctx, FILE *out, isl_stat r)
+{
+	const char *msg;
+
+	if (r >= 0 && isl_ctx_last_error(ctx) == isl_error_none) {
+		fprintf(out, "---\n");
+	} else {
+		r = isl_stat_error;
+		msg = isl_ctx_last_error_msg(ctx);
+		if (msg)
+			fprintf(out, "--- error: %s\n", msg);
+		else
+			fprintf(out, "--- error\n");
+	}
+	isl_ctx_reset_error(ctx);
+	fflush(out);
+
+	return r;
+}
+
+/* Handle the request read from "s", if any, by calling "handle" and
+ * write the response to "out".
+ * "s" is freed by this function.
+ */
+static isl_stat handle_request(isl_ctx *ctx, __isl_take isl_stream *s,
+	FILE *out, server_handler handle, void *user)
+{
+	isl_stat r = isl_stat_error;
+
+	if (s)
+		r = handle(s, out, user);
+	isl_stream_free(s);
+
+	return finish_response(ctx, out, r);
+}
+
+/* Handle all requests read from "in", writing the responses to "out".
+ * Set *failed if any of the requests could not be handled.
+ * Return isl_stat_error if the requests themselves could not be read.
+ */
+static isl_stat serve_file(isl_ctx *ctx, FILE *in, FILE *out,
+	server_handler handle, void *user, int *failed)
+{
+	struct server_buffer buf = { NULL, 0, 0 };
+	isl_bool more;
+	isl_stream *s;
+
+	isl_ctx_reset_error(ctx);
+	while ((more = read_request(ctx, in, &buf)) == isl_bool_true) {
+		s = isl_stream_new_buffer(ctx, buf.data, buf.len);
+		if (handle_request(ctx, s, out, handle, user) < 0)
+			*failed = 1;
+	}
+	free(buf.data);
+
+	if (more < 0) {
+		finish_response(ctx, out, isl_stat_error);
+		return isl_stat_error;
+	}
+	return isl_stat_ok;
+}
+
+/* Handle each of the input files listed in the file called "name".
+ * Leading and trailing white space on each line is ignored.
+ */
+static isl_stat serve_batch(isl_ctx *ctx, const char *name,
+	server_handler handle, void *user, int *failed)
+{
+	struct server_buffer buf = { NULL, 0, 0 };
+	FILE *in;
+	int n;
+
+	in = fopen(name, "r");
+	if (!in)
+		isl_die(ctx, isl_error_invalid, "unable to open batch file",
+			return isl_stat_error);
+
+	isl_ctx_reset_error(ctx);
+	while ((n = read_line(ctx, in, &buf)) > 0) {
+		char *file = buf.data;
+		isl_stream *s;
+
+		while (buf.len > 0 && is_space(buf.data[buf.len - 1]))
+			buf.data[--buf.len] = '\0';
+		while (is_space(*file))
+			++file;
+		if (*file && *file != '#') {
+			s = isl_stream_new_mapped_file(ctx, file);
+			if (handle_request(ctx, s, stdout, handle, user) < 0)
+				*failed = 1;
+		}
+		buf.len = 0;
+	}
+	free(buf.data);
+	fclose(in);
+
+	return n < 0 ? isl_stat_error : isl_stat_ok;
+}
+
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H)
+
+/* Is some server accepting connections on the Unix socket at "addr"?
+ * Only a socket that refuses connections is considered to be stale.
+ * If the check cannot be performed, then the socket is considered
+ * to be in use.
+ */
+static int socket_in_use(struct sockaddr_un *addr)
+{
+	int fd, r;
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return 1;
+	r = connect(fd, (struct sockaddr *) addr, sizeof(*addr));
+	if (r < 0 && errno == ECONNREFUSED)
+		r = 0;
+	else
+		r = 1;
+	close(fd);
+
+	return r;
+}
+
+/* Handle the requests on each connection accepted on the Unix socket
+ * at "path", one connection at a time.
+ * A stale socket at "path" left behind by an earlier server is removed,
+ * but if some other server is still listening on "path",
+ * then an error is reported instead.
+ * Since the server only stops when it is killed, this function
+ * only returns if something goes wrong.
+ * SIGPIPE is ignored such that a client that disconnects before
+ * reading its response does not bring down the server.
+ */
+static isl_stat serve_socket(isl_ctx *ctx, const char *path,
+	server_handler handle, void *user)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	int fd;
+
+	if (strlen(path) >= sizeof(addr.sun_path))
+		isl_die(ctx, isl_error_invalid, "socket path too long",
+			return isl_stat_error);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+		if (socket_in_use(&addr))
+			isl_die(ctx, isl_error_invalid, "socket already in use",
+				return isl_stat_error);
+		unlink(path);
+	}
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		isl_die(ctx, isl_error_unknown, "unable to create socket",
+			return isl_stat_error);
+	if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+	    listen(fd, 16) < 0) {
+		close(fd);
+		isl_die(ctx, isl_error_unknown, "unable to listen on socket",
+			return isl_stat_error);
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	for (;;) {
+		FILE *in, *out;
+		int conn, failed = 0;
+
+		conn = accept(fd, NULL, NULL);
+		if (conn < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		in = fdopen(conn, "r");
+		out = in ? fdopen(dup(conn), "w") : NULL;
+		if (in && out)
+			serve_file(ctx, in, out, handle, user, &failed);
+		if (out)
+			fclose(out);
+		if (in)
+			fclose(in);
+		else
+			close(conn);
+		isl_ctx_reset_error(ctx);
+	}
+
+	close(fd);
+	isl_die(ctx, isl_error_unknown, "unable to accept connection",
+		return isl_stat_error);
+}
+
+#else
+
+static isl_stat serve_socket(isl_ctx *ctx, const char *path,
+	server_handler handle, void *user)
+{
+	isl_die(ctx, isl_error_unsupported,
+		"Unix sockets not supported on this platform",
+		return isl_stat_error);
+}
+
+#endif
+
+/* Has any of the modes for handling several requests been selected?
+ */
+int server_is_enabled(struct server_options *options)
+{
+	return options->serve || options->socket || options->batch;
+}
+
+/* Handle a sequence of requests in the mode selected by "options",
+ * calling "handle" on each of them.
+ * Return EXIT_FAILURE if the requests could not be read or
+ * if any of them could not be handled.
+ */
+int server_run(isl_ctx *ctx, struct server_options *options,
+	server_handler handle, void *user)
+{
+	isl_stat r;
+	int failed = 0;
+
+	if (options->socket)
+		r = serve_socket(ctx, options->socket, handle, user);
+	else if (options->batch)
+		r = serve_batch(ctx, options->batch, handle, user, &failed);
+	else
+		r = serve_file(ctx, stdin, stdout, handle, user, &failed);
+
+	return r < 0 || failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
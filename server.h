@@ -0,0 +1,36 @@
+#ifndef ISL_SERVER_H
+#define ISL_SERVER_H
+
+#include <stdio.h>
+#include "isl/arg.h"
+#include "isl/ctx.h"
+#include "isl/stream.h"
+
+/* Options selecting the request handling mode of a command-line tool.
+ *
+ * "serve" is set if requests should be read from standard input.
+ * "socket" is the path of a Unix socket on which to accept connections.
+ * "batch" is the name of a file listing input files, one per line.
+ *
+ * If none of these is set, then the tool handles a single input
+ * read from standard input.
+ */
+struct server_options {
+	unsigned	 serve;
+	char		*socket;
+	char		*batch;
+};
+
+extern struct isl_args server_options_args;
+
+/* A callback that handles a single request read from "s",
+ * writing the response to "out".
+ */
+typedef isl_stat (*server_handler)(__isl_keep isl_stream *s, FILE *out,
+	void *user);
+
+int server_is_enabled(struct server_options *options);
+int server_run(isl_ctx *ctx, struct server_options *options,
+	server_handler handle, void *user);
+
+#endif